@@ -4,7 +4,21 @@ module.exports = {
   server: {
     port: process.env.PORT || 3000,
     host: '0.0.0.0',
-    env: process.env.NODE_ENV || 'development'
+    env: process.env.NODE_ENV || 'development',
+    // 设备端复用长连接，空闲超时需长于设备上报/轮询间隔
+    keepAliveTimeoutMs: 65000
+  },
+
+  // 设备指令下发配置
+  commands: {
+    longPollMaxWaitS: 30,      // 长轮询最长挂起时间
+    longPollRecheckMs: 5000    // 挂起期间兜底查询间隔（覆盖直接写入数据库的指令）
+  },
+
+  // OTA配置
+  ota: {
+    // 下发压缩固件（需设备固件支持 OTAZ 格式，旧固件无法解压）
+    compressedImages: process.env.OTA_COMPRESSED_IMAGES === 'true'
   },
 
   // ESP32代理配置
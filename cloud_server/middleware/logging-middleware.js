@@ -149,7 +149,8 @@ function slowRequestDetector(threshold = 1000) {
     res.on('finish', () => {
       const duration = Date.now() - startTime;
       
-      if (duration > threshold) {
+      // 长轮询请求按设计挂起，不计为慢请求
+      if (duration > threshold && !req.query.wait) {
         logger.warn(`🐌 慢请求检测: ${req.method} ${req.originalUrl} ${duration}ms`, {
           method: req.method,
           url: req.originalUrl,
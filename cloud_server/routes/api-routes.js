@@ -3,6 +3,8 @@ const express = require('express');
 const router = express.Router();
 const supabaseService = require('../services/supabase-service');
 const logger = require('../utils/logger');
+const config = require('../config/server-config');
+const commandNotifier = require('../services/command-notifier');
 
 /**
  * 健康检查接口
@@ -289,21 +291,70 @@ router.post('/firmware/test-post', (req, res) => {
   });
 });
 
+/**
+ * 附加指令排队时长，供设备统计端到端下发延迟
+ */
+function withDeliveryTiming(command, now) {
+  const createdAtMs = Date.parse(command.created_at);
+  if (Number.isNaN(createdAtMs)) {
+    return command;
+  }
+  return {
+    ...command,
+    created_at_ms: createdAtMs,
+    queued_ms: Math.max(0, now - createdAtMs)
+  };
+}
+
 /**
  * 获取设备待处理指令
- * GET /api/device-commands/:deviceId/pending
+ * GET /api/device-commands/:deviceId/pending[?wait=秒]
+ *
+ * 带 wait 参数时为长轮询：没有待处理指令则挂起，直到新指令入队或超时。
+ * 返回的指令已标记为 sent，不会再次下发；执行结果由设备反馈。
  */
 router.get('/device-commands/:deviceId/pending', async (req, res) => {
   try {
     const deviceId = req.params.deviceId;
-    logger.info(`📥 获取设备 ${deviceId} 的待处理指令`);
+    const waitSeconds = Math.min(Math.max(parseInt(req.query.wait, 10) || 0, 0),
+                                 config.commands.longPollMaxWaitS);
+    logger.debug(`📥 获取设备 ${deviceId} 的待处理指令${waitSeconds > 0 ? ` (长轮询 ${waitSeconds}s)` : ''}`);
 
     const supabaseService = require('../services/supabase-service');
-    const commands = await supabaseService.getDeviceCommands(deviceId);
+    let commands = await supabaseService.getDeviceCommands(deviceId) || [];
+
+    if (commands.length === 0 && waitSeconds > 0) {
+      let closed = false;
+      res.on('close', () => { closed = true; });
+
+      const deadline = Date.now() + waitSeconds * 1000;
+      while (!closed && commands.length === 0 && Date.now() < deadline) {
+        const remaining = deadline - Date.now();
+        await commandNotifier.waitForCommand(deviceId, Math.min(remaining, config.commands.longPollRecheckMs));
+        if (closed) {
+          return;
+        }
+        commands = await supabaseService.getDeviceCommands(deviceId) || [];
+      }
+
+      if (closed) {
+        // 领取后设备已断开，退回 pending 等下次请求
+        await Promise.all(commands.map(command =>
+          supabaseService.updateCommandStatus(command.id, 'pending')));
+        return;
+      }
+    }
+
+    if (commands.length > 0) {
+      logger.info(`📤 向设备 ${deviceId} 下发 ${commands.length} 个指令`);
+    }
 
+    const now = Date.now();
     res.json({
       status: 'success',
-      commands: commands || []
+      long_poll: waitSeconds > 0,
+      server_time_ms: now,
+      commands: commands.map(command => withDeliveryTiming(command, now))
     });
   } catch (error) {
     logger.error(`获取设备指令失败: ${error.message}`);
@@ -350,6 +401,56 @@ router.post('/device-commands/feedback', async (req, res) => {
   }
 });
 
+/**
+ * 设备指令反馈批量上报
+ * POST /api/device-commands/feedback/batch
+ * 设备把一个周期内的反馈合并为一次请求，同一指令只携带最新状态；返回 200 后设备才清除这些条目
+ */
+const FEEDBACK_BATCH_MAX_UPDATES = 50;
+
+router.post('/device-commands/feedback/batch', async (req, res) => {
+  try {
+    const { deviceId, updates } = req.body;
+
+    if (!deviceId || typeof deviceId !== 'string') {
+      return res.status(400).json({
+        status: 'error',
+        message: '设备ID不能为空'
+      });
+    }
+    if (!Array.isArray(updates) || updates.length === 0 || updates.length > FEEDBACK_BATCH_MAX_UPDATES) {
+      return res.status(400).json({
+        status: 'error',
+        message: `updates 必须是 1-${FEEDBACK_BATCH_MAX_UPDATES} 条记录的数组`
+      });
+    }
+    if (updates.some(update => !update || !update.commandId || !update.status)) {
+      return res.status(400).json({
+        status: 'error',
+        message: '每条反馈都需要指令ID和状态'
+      });
+    }
+
+    logger.info(`📥 收到设备指令反馈批次: deviceId=${deviceId}, ${updates.length}条`);
+
+    const supabaseService = require('../services/supabase-service');
+    await Promise.all(updates.map(({ commandId, status, message }) =>
+      supabaseService.updateCommandStatus(commandId, status, message || null)));
+
+    res.json({
+      status: 'success',
+      accepted: updates.length
+    });
+  } catch (error) {
+    logger.error(`处理指令反馈批次失败: ${error.message}`);
+    // 503 让设备稍后重发，反馈仍保留在设备端
+    res.status(503).json({
+      status: 'error',
+      message: error.message
+    });
+  }
+});
+
 /**
  * 更新OTA进度
  * POST /api/firmware/ota-progress
@@ -401,12 +502,16 @@ router.post('/firmware/ota-progress', async (req, res) => {
 
 /**
  * 下载固件文件
- * GET /api/firmware/download/:firmwareId
+ * GET /api/firmware/download/:firmwareId[?format=otaz]
+ * 支持单段 Range 请求（设备断点续传）
  */
 router.get('/firmware/download/:firmwareId', async (req, res) => {
   try {
     const firmwareService = require('../services/firmware-service');
-    const result = await firmwareService.downloadFirmware(req.params.firmwareId, res);
+    const result = await firmwareService.downloadFirmware(req.params.firmwareId, res, {
+      compressed: req.query.format === 'otaz',
+      range: req.headers.range
+    });
     // 响应已在downloadFirmware中处理
   } catch (error) {
     logger.error(`固件下载失败: ${error.message}`);
@@ -5,6 +5,10 @@ const supabaseService = require('../services/supabase-service');
 const proxyService = require('../services/proxy-service');
 const { validateDeviceRegistration, validateCommand, validateDeviceStatus, sanitizeDeviceData, sanitizeStatusData } = require('../utils/validation');
 const logger = require('../utils/logger');
+const statusCodec = require('../utils/status-codec');
+
+// 二进制状态帧解码器（按设备保存增量基准）
+const statusFrameDecoder = new statusCodec.StatusFrameDecoder();
 
 /**
  * 设备注册接口 (Supabase版本)
@@ -86,9 +90,35 @@ router.post('/register-device-local', (req, res) => {
  * 设备状态更新接口 (Supabase版本)
  * POST /device-status
  */
-router.post('/device-status', async (req, res) => {
+router.post('/device-status', express.raw({ type: statusCodec.CONTENT_TYPE, limit: '4kb' }), async (req, res) => {
+  // 声明支持的状态编码，设备据此切换为二进制上报
+  res.set('X-Status-Encodings', `json, ${statusCodec.ENCODING_NAME}`);
+
   try {
-    const { deviceId, ...statusData } = req.body;
+    let deviceId;
+    let statusData;
+    let frame = null;
+    if (Buffer.isBuffer(req.body)) {
+      try {
+        frame = statusFrameDecoder.decode(req.body);
+        deviceId = frame.deviceId;
+        statusData = frame.status;
+        logger.debug(`📦 二进制状态帧: ${deviceId} #${frame.seq} (${frame.keyframe ? '关键帧' : '增量帧'}, ${req.body.length}字节)`);
+      } catch (error) {
+        if (!(error instanceof statusCodec.StatusCodecError)) {
+          throw error;
+        }
+        // 409：缺少增量基准，设备下一帧发送关键帧
+        const httpStatus = error.code === 'BASE_MISMATCH' ? 409 : (error.code === 'UNSUPPORTED_VERSION' ? 415 : 400);
+        return res.status(httpStatus).json({
+          status: 'error',
+          message: error.message,
+          code: error.code
+        });
+      }
+    } else {
+      ({ deviceId, ...statusData } = req.body);
+    }
 
     logger.debug(`📊 收到设备状态更新: ${deviceId} (Supabase)`);
 
@@ -108,6 +138,11 @@ router.post('/device-status', async (req, res) => {
     // 更新到Supabase
     const result = await supabaseService.updateDeviceStatus(deviceId, cleanStatusData);
 
+    // 写入成功后才推进增量基准；写入失败时设备收到 5xx 会改发关键帧
+    if (frame) {
+      statusFrameDecoder.commit(frame);
+    }
+
     // 构建响应格式，确保包含指令
     const response = {
       status: 'success',
@@ -130,6 +165,55 @@ router.post('/device-status', async (req, res) => {
   }
 });
 
+/**
+ * 离线状态批量回补接口
+ * POST /device-status/batch
+ * 设备断网期间缓存的样本，恢复连接后按批上传；返回 200 后设备才删除本地记录
+ */
+const STATUS_BATCH_MAX_SAMPLES = 50;
+
+router.post('/device-status/batch', async (req, res) => {
+  try {
+    const { deviceId, samples } = req.body;
+
+    if (!deviceId || typeof deviceId !== 'string') {
+      return res.status(400).json({
+        status: 'error',
+        message: '设备ID不能为空'
+      });
+    }
+    if (!Array.isArray(samples) || samples.length === 0 || samples.length > STATUS_BATCH_MAX_SAMPLES) {
+      return res.status(400).json({
+        status: 'error',
+        message: `samples 必须是 1-${STATUS_BATCH_MAX_SAMPLES} 条记录的数组`
+      });
+    }
+
+    // 设备未同步时钟时 timestamp_ms 为 null，以接收时间代替
+    const receivedAt = new Date().toISOString();
+    const rows = samples.map(({ timestamp_ms, ...statusData }) => ({
+      timestamp: Number.isFinite(timestamp_ms) && timestamp_ms > 0
+        ? new Date(timestamp_ms).toISOString()
+        : receivedAt,
+      ...sanitizeStatusData(statusData)
+    }));
+
+    const accepted = await supabaseService.insertDeviceStatusHistory(deviceId, rows);
+
+    res.json({
+      status: 'success',
+      accepted
+    });
+  } catch (error) {
+    logger.error(`设备历史状态回补失败: ${error.message}`);
+    // 503 让设备退避后重试，样本仍保留在设备端
+    res.status(503).json({
+      status: 'error',
+      message: error.message
+    });
+  }
+});
+
 /**
  * 设备状态更新接口 (本地版本)
  * POST /device-status-local
@@ -0,0 +1,41 @@
+// 设备指令通知模块（长轮询唤醒）
+const { EventEmitter } = require('events');
+const logger = require('../utils/logger');
+
+class CommandNotifier {
+  constructor() {
+    this.emitter = new EventEmitter();
+    // 每个长轮询连接注册一个监听器，设备数量不设上限
+    this.emitter.setMaxListeners(0);
+  }
+
+  /**
+   * 新指令入队后唤醒该设备挂起的长轮询
+   */
+  notify(deviceId) {
+    if (this.emitter.listenerCount(deviceId) > 0) {
+      logger.debug(`🔔 唤醒设备 ${deviceId} 的长轮询`);
+    }
+    this.emitter.emit(deviceId);
+  }
+
+  /**
+   * 等待设备的新指令通知
+   * @returns {Promise<boolean>} true=收到通知, false=超时
+   */
+  waitForCommand(deviceId, timeoutMs) {
+    return new Promise((resolve) => {
+      const onNotify = () => {
+        clearTimeout(timer);
+        resolve(true);
+      };
+      const timer = setTimeout(() => {
+        this.emitter.removeListener(deviceId, onNotify);
+        resolve(false);
+      }, timeoutMs);
+      this.emitter.once(deviceId, onNotify);
+    });
+  }
+}
+
+module.exports = new CommandNotifier();
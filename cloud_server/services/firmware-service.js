@@ -4,7 +4,10 @@ const path = require('path');
 const crypto = require('crypto');
 const multer = require('multer');
 
+const config = require('../config/server-config');
 const logger = require('../utils/logger');
+const commandNotifier = require('./command-notifier');
+const firmwareCompress = require('../utils/firmware-compress');
 
 
 // 使用统一的Supabase配置
@@ -192,6 +195,7 @@ class FirmwareService {
       } catch (fileError) {
         logger.warn(`删除固件文件失败: ${fileError.message}`);
       }
+      await fs.unlink(`${firmware.file_path}.otaz`).catch(() => {});
 
       // 删除数据库记录
       const { error: deleteError } = await supabaseClient
@@ -380,7 +384,9 @@ class FirmwareService {
       logger.info(`📤 开始向设备 ${device.device_id} (${device.local_ip}) 发送OTA指令`);
 
       // 构建固件下载URL (云服务器提供固件下载服务)
-      const firmwareUrl = `http://www.nagaflow.top/api/firmware/download/${firmware.id}`;
+      const compressed = config.ota.compressedImages;
+      const firmwareUrl = `http://www.nagaflow.top/api/firmware/download/${firmware.id}` +
+        (compressed ? '?format=otaz' : '');
 
       // 通过Supabase指令队列发送OTA升级指令
       const { data, error } = await supabaseClient
@@ -393,6 +399,7 @@ class FirmwareService {
             firmware_size: firmware.file_size,
             firmware_version: firmware.version,
             firmware_hash: firmware.file_hash,
+            firmware_compressed: compressed,
             deployment_id: deploymentId // 添加部署ID用于跟踪
           },
           status: 'pending',
@@ -404,6 +411,7 @@ class FirmwareService {
       if (error) {
         throw new Error(`发送OTA指令失败: ${error.message}`);
       }
+      commandNotifier.notify(device.device_id);
 
       logger.info(`✅ OTA指令已发送到设备 ${device.device_id} (指令ID: ${data.id})`);
 
@@ -664,10 +672,58 @@ class FirmwareService {
     }
   }
 
+  /**
+   * 获取压缩固件文件（首次请求时生成并缓存在原文件旁）
+   */
+  async getCompressedImage(firmware) {
+    const compressedPath = `${firmware.file_path}.otaz`;
+    try {
+      const stat = await fs.stat(compressedPath);
+      return { path: compressedPath, size: stat.size };
+    } catch (error) {
+      // 尚未生成
+    }
+
+    const raw = await fs.readFile(firmware.file_path);
+    const startTime = Date.now();
+    const image = firmwareCompress.compressFirmware(raw);
+    const elapsedMs = Date.now() - startTime;
+
+    // 写临时文件再改名，避免并发下载读到半个文件
+    const tmpPath = `${compressedPath}.${process.pid}.tmp`;
+    await fs.writeFile(tmpPath, image);
+    await fs.rename(tmpPath, compressedPath);
+
+    logger.info(`🗜️ 生成压缩固件: ${firmware.filename} ${raw.length} -> ${image.length} bytes ` +
+      `(${(image.length * 100 / raw.length).toFixed(1)}%, ${elapsedMs}ms)`);
+    return { path: compressedPath, size: image.length };
+  }
+
+  /**
+   * 解析单段 Range 请求头（bytes=start-[end]）
+   * @param {string} header - Range 请求头
+   * @param {number} size - 文件大小
+   * @returns {Object|null} { start, end } 或 { unsatisfiable: true }，无 Range 或格式不支持时返回 null
+   */
+  parseRange(header, size) {
+    const match = /^bytes=(\d+)-(\d*)$/.exec((header || '').trim());
+    if (!match) {
+      return null;
+    }
+
+    const start = parseInt(match[1], 10);
+    const end = match[2] ? Math.min(parseInt(match[2], 10), size - 1) : size - 1;
+    if (start >= size || end < start) {
+      return { unsatisfiable: true };
+    }
+    return { start, end };
+  }
+
   /**
    * 下载固件文件
+   * @param {Object} options - { compressed: 返回OTAZ压缩镜像, range: Range 请求头 }
    */
-  async downloadFirmware(firmwareId, res) {
+  async downloadFirmware(firmwareId, res, options = {}) {
     try {
       // 获取固件信息
       const { data: firmware, error: fetchError } = await supabaseClient
@@ -687,17 +743,47 @@ class FirmwareService {
         throw new Error('固件文件不存在');
       }
 
-      logger.info(`📤 开始下载固件: ${firmware.filename} (${firmware.version})`);
+      let filePath = firmware.file_path;
+      let fileSize = firmware.file_size;
+      let contentType = 'application/octet-stream';
+      if (options.compressed) {
+        const compressedImage = await this.getCompressedImage(firmware);
+        filePath = compressedImage.path;
+        fileSize = compressedImage.size;
+        contentType = firmwareCompress.CONTENT_TYPE;
+      }
+
+      // 断点续传：设备带 Range 请求剩余部分
+      const range = this.parseRange(options.range, fileSize);
+      if (range && range.unsatisfiable) {
+        logger.warn(`⚠️ 无效的下载范围: ${options.range} (文件 ${fileSize} bytes)`);
+        res.status(416);
+        res.setHeader('Content-Range', `bytes */${fileSize}`);
+        res.end();
+        return;
+      }
+
+      logger.info(`📤 开始下载固件: ${firmware.filename} (${firmware.version}, ${fileSize} bytes` +
+        `${options.compressed ? `, 压缩, 原始 ${firmware.file_size} bytes` : ''}` +
+        `${range ? `, 续传 ${range.start}-${range.end}` : ''})`);
 
       // 设置响应头
-      res.setHeader('Content-Type', 'application/octet-stream');
+      res.setHeader('Content-Type', contentType);
       res.setHeader('Content-Disposition', `attachment; filename="${firmware.original_name}"`);
-      res.setHeader('Content-Length', firmware.file_size);
+      res.setHeader('Accept-Ranges', 'bytes');
       res.setHeader('X-Firmware-Version', firmware.version);
       res.setHeader('X-Firmware-Hash', firmware.file_hash);
+      res.setHeader('X-Firmware-Raw-Size', firmware.file_size);
+      if (range) {
+        res.status(206);
+        res.setHeader('Content-Range', `bytes ${range.start}-${range.end}/${fileSize}`);
+        res.setHeader('Content-Length', range.end - range.start + 1);
+      } else {
+        res.setHeader('Content-Length', fileSize);
+      }
 
       // 创建文件流并发送
-      const fileStream = require('fs').createReadStream(firmware.file_path);
+      const fileStream = require('fs').createReadStream(filePath, range ? { start: range.start, end: range.end } : {});
 
       fileStream.on('error', (error) => {
         logger.error(`固件文件读取失败: ${error.message}`);
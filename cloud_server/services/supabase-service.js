@@ -1,6 +1,7 @@
 // Supabase服务模块
 const { deviceService } = require('../supabase-config');
 const logger = require('../utils/logger');
+const commandNotifier = require('./command-notifier');
 
 class SupabaseService {
   constructor() {
@@ -57,6 +58,20 @@ class SupabaseService {
     }
   }
 
+  /**
+   * 批量写入设备历史状态
+   */
+  async insertDeviceStatusHistory(deviceId, samples) {
+    try {
+      logger.debug(`📦 回补设备历史状态: ${deviceId} (${samples.length} 条)`);
+
+      return await this.deviceService.insertDeviceStatusHistory(deviceId, samples);
+    } catch (error) {
+      logger.error(`❌ 设备历史状态写入失败: ${error.message}`);
+      throw error;
+    }
+  }
+
   /**
    * 发送指令到设备
    */
@@ -65,6 +80,7 @@ class SupabaseService {
       logger.info(`📤 发送指令: ${deviceId} - ${command}`);
       
       const result = await this.deviceService.sendCommand(deviceId, command, data);
+      commandNotifier.notify(deviceId);
       
       logger.info(`✅ 指令发送成功: ${deviceId} - ${command}`);
       return {
@@ -177,6 +177,35 @@ class SupabaseDeviceService {
     }
   }
 
+  /**
+   * 批量写入设备历史状态（断网期间离线缓存的样本）
+   * 不更新设备在线状态与 last_seen，避免回补旧样本覆盖实时状态
+   */
+  async insertDeviceStatusHistory(deviceId, samples) {
+    try {
+      const rows = samples.map(({ timestamp, ...statusData }) => ({
+        device_id: deviceId,
+        timestamp,
+        status_data: statusData
+      }))
+
+      const { error } = await this.admin
+        .from('device_status')
+        .insert(rows)
+
+      if (error) {
+        console.error('写入设备历史状态失败:', error)
+        throw error
+      }
+
+      console.log(`[STATUS] 设备 ${deviceId} 回补 ${rows.length} 条历史状态`)
+      return rows.length
+    } catch (error) {
+      console.error('写入设备历史状态时发生错误:', error)
+      throw error
+    }
+  }
+
   /**
    * 发送指令到设备
    */
@@ -252,33 +281,25 @@ class SupabaseDeviceService {
   }
 
   /**
-   * 获取设备的待处理指令
+   * 领取设备的待处理指令
+   * 只返回 'pending' 指令，并在同一条 UPDATE 中标记为 'sent'，
+   * 每条指令只下发一次（并发请求不会领取到同一条）
    */
   async getPendingCommands(deviceId) {
     try {
-      const { data, error } = await this.client
+      const { data, error } = await this.admin
         .from('device_commands')
-        .select('*')
+        .update({ status: 'sent', sent_at: new Date().toISOString() })
         .eq('device_id', deviceId)
-        .in('status', ['pending', 'sent'])
-        .order('created_at', { ascending: true })
+        .eq('status', 'pending')
+        .select('*')
 
       if (error) {
         console.error('获取待处理指令失败:', error)
         throw error
       }
 
-      // 如果有指令，将状态更新为'sent'
-      if (data && data.length > 0) {
-        const commandIds = data.map(cmd => cmd.id);
-        await this.admin
-          .from('device_commands')
-          .update({ status: 'sent', sent_at: new Date().toISOString() })
-          .in('id', commandIds)
-          .eq('status', 'pending');
-      }
-
-      return data || []
+      return (data || []).sort((a, b) => Date.parse(a.created_at) - Date.parse(b.created_at))
     } catch (error) {
       console.error('获取待处理指令时发生错误:', error)
       throw error
@@ -0,0 +1,53 @@
+#!/usr/bin/env node
+
+/**
+ * OTA压缩固件基准脚本
+ * 对比原始镜像与OTAZ压缩镜像的传输字节数，校验解压结果，并估算不同链路速率下的传输耗时
+ *
+ * 用法: node test-ota-compression.js <firmware.bin> [链路速率KB/s ...]
+ */
+
+const fs = require('fs');
+const firmwareCompress = require('./utils/firmware-compress');
+
+function main() {
+  const file = process.argv[2];
+  if (!file) {
+    console.log('用法: node test-ota-compression.js <firmware.bin> [链路速率KB/s ...]');
+    process.exit(1);
+  }
+  const rates = process.argv.slice(3).map(Number).filter(n => n > 0);
+  if (rates.length === 0) {
+    rates.push(20, 50, 100, 200);
+  }
+
+  const raw = fs.readFileSync(file);
+  console.log(`🧪 固件: ${file} (${raw.length} bytes)\n`);
+
+  const compressStart = process.hrtime.bigint();
+  const image = firmwareCompress.compressFirmware(raw);
+  const compressMs = Number(process.hrtime.bigint() - compressStart) / 1e6;
+
+  const decompressStart = process.hrtime.bigint();
+  const restored = firmwareCompress.decompressFirmware(image);
+  const decompressMs = Number(process.hrtime.bigint() - decompressStart) / 1e6;
+
+  if (!restored.equals(raw)) {
+    console.log('❌ 解压结果与原始镜像不一致');
+    process.exit(1);
+  }
+  console.log('✅ 解压校验通过');
+  console.log(`📦 原始镜像: ${raw.length} bytes`);
+  console.log(`🗜️ 压缩镜像: ${image.length} bytes (${(image.length * 100 / raw.length).toFixed(1)}%)`);
+  console.log(`⏱️ 压缩 ${compressMs.toFixed(1)} ms, 解压 ${decompressMs.toFixed(1)} ms (主机)\n`);
+
+  console.log('链路速率      原始传输     压缩传输');
+  for (const rate of rates) {
+    const rawS = raw.length / 1024 / rate;
+    const zS = image.length / 1024 / rate;
+    console.log(`${String(rate).padStart(5)} KB/s   ${rawS.toFixed(1).padStart(7)} s   ${zS.toFixed(1).padStart(7)} s`);
+  }
+  console.log('\nℹ️ 设备端实际耗时见 OTA 结束时的 "OTA流水线" 日志及 /api/health 的 ota_pipeline');
+}
+
+main();
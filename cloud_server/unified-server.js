@@ -106,6 +106,10 @@ const server = app.listen(PORT, config.server.host, () => {
   logger.info('✅ 所有功能模块已加载完成');
 });
 
+// 设备端使用 keep-alive 与长轮询，延长空闲连接保持时间
+server.keepAliveTimeout = config.server.keepAliveTimeoutMs;
+server.headersTimeout = config.server.keepAliveTimeoutMs + 1000;
+
 // 优雅关闭处理
 function gracefulShutdown(signal) {
   logger.info(`\n🛑 收到 ${signal} 信号，开始优雅关闭...`);
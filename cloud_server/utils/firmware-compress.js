@@ -0,0 +1,64 @@
+// 压缩固件镜像（与固件 main/ota_manager.h 中 ota_compressed_header_t 保持一致）
+//
+// 文件布局（小端）：
+//   [0..3]   "OTAZ"
+//   [4]      版本号 1
+//   [5]      算法 1 = raw deflate
+//   [6..7]   保留
+//   [8..11]  解压后固件大小
+//   [12..15] 头之后的压缩数据长度
+//   [16..]   raw deflate 流（设备端用32KB滑动窗口边收边解压）
+
+const zlib = require('zlib');
+
+const MAGIC = 'OTAZ';
+const VERSION = 1;
+const ALGO_DEFLATE = 1;
+const HEADER_SIZE = 16;
+const CONTENT_TYPE = 'application/x-esp32-ota-z';
+
+// 设备端解压窗口为32KB，压缩时窗口不能更大
+const DEFLATE_OPTIONS = { level: zlib.constants.Z_BEST_COMPRESSION, windowBits: 15, memLevel: 9 };
+
+function compressFirmware(raw) {
+  const deflated = zlib.deflateRawSync(raw, DEFLATE_OPTIONS);
+  const header = Buffer.alloc(HEADER_SIZE);
+  header.write(MAGIC, 0, 'ascii');
+  header.writeUInt8(VERSION, 4);
+  header.writeUInt8(ALGO_DEFLATE, 5);
+  header.writeUInt16LE(0, 6);
+  header.writeUInt32LE(raw.length, 8);
+  header.writeUInt32LE(deflated.length, 12);
+  return Buffer.concat([header, deflated]);
+}
+
+function isCompressedImage(buf) {
+  return buf.length >= HEADER_SIZE && buf.toString('ascii', 0, 4) === MAGIC;
+}
+
+function decompressFirmware(image) {
+  if (!isCompressedImage(image)) {
+    throw new Error('不是压缩固件镜像');
+  }
+  if (image.readUInt8(4) !== VERSION || image.readUInt8(5) !== ALGO_DEFLATE) {
+    throw new Error('不支持的压缩固件格式');
+  }
+  const rawSize = image.readUInt32LE(8);
+  const compressedSize = image.readUInt32LE(12);
+  if (HEADER_SIZE + compressedSize !== image.length) {
+    throw new Error('压缩固件长度不匹配');
+  }
+  const raw = zlib.inflateRawSync(image.subarray(HEADER_SIZE));
+  if (raw.length !== rawSize) {
+    throw new Error('解压后固件大小不匹配');
+  }
+  return raw;
+}
+
+module.exports = {
+  CONTENT_TYPE,
+  HEADER_SIZE,
+  compressFirmware,
+  decompressFirmware,
+  isCompressedImage
+};
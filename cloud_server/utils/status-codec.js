@@ -0,0 +1,147 @@
+// 设备状态二进制帧解码（ESB1，与固件 main/status_codec.c 保持一致）
+//
+// 报文布局：
+//   [0] 版本号  [1] 标志（bit0 关键帧, bit1 sbus, bit2 can, bit3 wifi）
+//   [2] 设备ID长度 N + N 字节设备ID
+//   varint 帧序号, varint 基准帧序号（仅增量帧）, varint 字段变化掩码
+//   每个置位字段一个 zigzag varint 差值（关键帧相对全零，增量帧相对基准帧）
+
+const CONTENT_TYPE = 'application/x-esp32-status';
+const ENCODING_NAME = 'esb1';
+const VERSION = 1;
+
+const FLAG_KEYFRAME = 0x01;
+const FLAG_SBUS_CONNECTED = 0x02;
+const FLAG_CAN_CONNECTED = 0x04;
+const FLAG_WIFI_CONNECTED = 0x08;
+
+// 字段顺序只能在末尾追加
+const SCALAR_FIELDS = [
+  'wifi_rssi', 'free_heap', 'total_heap', 'uptime_seconds', 'task_count',
+  'can_tx_count', 'can_rx_count', 'motor_left_speed', 'motor_right_speed',
+  'last_sbus_time', 'last_cmd_time', 'wifi_ip'
+];
+const SBUS_CHANNELS = 16;
+const FIELD_COUNT = SCALAR_FIELDS.length + SBUS_CHANNELS;
+
+// 保存增量基准的设备数上限，超出时淘汰最久未更新的设备（其下一增量帧得到 409 后改发关键帧）
+const MAX_DEVICE_BASES = 256;
+
+class StatusCodecError extends Error {
+  constructor(message, code) {
+    super(message);
+    this.code = code;
+  }
+}
+
+function readVarint(buf, state) {
+  let result = 0n;
+  let shift = 0n;
+  for (;;) {
+    if (state.pos >= buf.length || shift > 63n) {
+      throw new StatusCodecError('报文截断或varint过长', 'MALFORMED');
+    }
+    const byte = buf[state.pos++];
+    result |= BigInt(byte & 0x7f) << shift;
+    if ((byte & 0x80) === 0) {
+      return result;
+    }
+    shift += 7n;
+  }
+}
+
+function unzigzag(value) {
+  return Number((value >> 1n) ^ -(value & 1n));
+}
+
+function ipv4FromNumber(value) {
+  if (!value) {
+    return '';
+  }
+  return [24, 16, 8, 0].map(shift => (value >>> shift) & 0xff).join('.');
+}
+
+/**
+ * 有状态解码器：按设备保存最近一帧已入库的状态作为增量基准
+ * 服务器重启、基准被淘汰或不一致时抛出 BASE_MISMATCH，路由返回 409 让设备发送关键帧
+ *
+ * decode() 不修改基准；调用方在状态写入成功（设备收到 2xx 并确认该帧）后调用 commit()，
+ * 保证服务器基准与设备基准一致
+ */
+class StatusFrameDecoder {
+  constructor(maxDevices = MAX_DEVICE_BASES) {
+    this.maxDevices = maxDevices;
+    this.bases = new Map(); // deviceId -> { seq, values }，按最近提交顺序排列
+  }
+
+  decode(buf) {
+    if (!Buffer.isBuffer(buf) || buf.length < 3) {
+      throw new StatusCodecError('报文为空', 'MALFORMED');
+    }
+    if (buf[0] !== VERSION) {
+      throw new StatusCodecError(`不支持的编码版本: ${buf[0]}`, 'UNSUPPORTED_VERSION');
+    }
+
+    const flags = buf[1];
+    const idLength = buf[2];
+    if (3 + idLength > buf.length) {
+      throw new StatusCodecError('设备ID截断', 'MALFORMED');
+    }
+    const deviceId = buf.toString('utf8', 3, 3 + idLength);
+    const state = { pos: 3 + idLength };
+
+    const keyframe = (flags & FLAG_KEYFRAME) !== 0;
+    const seq = Number(readVarint(buf, state));
+    let values;
+    if (keyframe) {
+      values = new Array(FIELD_COUNT).fill(0);
+    } else {
+      const baseSeq = Number(readVarint(buf, state));
+      const base = this.bases.get(deviceId);
+      if (!base || base.seq !== baseSeq) {
+        throw new StatusCodecError(`缺少增量基准帧 ${baseSeq}`, 'BASE_MISMATCH');
+      }
+      values = base.values.slice();
+    }
+
+    const mask = readVarint(buf, state);
+    for (let i = 0; i < FIELD_COUNT; i++) {
+      if (mask & (1n << BigInt(i))) {
+        values[i] += unzigzag(readVarint(buf, state));
+      }
+    }
+    if (state.pos !== buf.length) {
+      throw new StatusCodecError('报文含多余字节', 'MALFORMED');
+    }
+
+    const status = {
+      sbus_connected: (flags & FLAG_SBUS_CONNECTED) !== 0,
+      can_connected: (flags & FLAG_CAN_CONNECTED) !== 0,
+      wifi_connected: (flags & FLAG_WIFI_CONNECTED) !== 0
+    };
+    SCALAR_FIELDS.forEach((name, i) => {
+      status[name] = name === 'wifi_ip' ? ipv4FromNumber(values[i]) : values[i];
+    });
+    status.sbus_channels = values.slice(SCALAR_FIELDS.length);
+
+    return { deviceId, seq, keyframe, status, values };
+  }
+
+  /**
+   * 将解码成功且已入库的帧提交为该设备的增量基准
+   */
+  commit(frame) {
+    this.bases.delete(frame.deviceId);
+    this.bases.set(frame.deviceId, { seq: frame.seq, values: frame.values });
+    while (this.bases.size > this.maxDevices) {
+      this.bases.delete(this.bases.keys().next().value);
+    }
+  }
+}
+
+module.exports = {
+  CONTENT_TYPE,
+  ENCODING_NAME,
+  StatusFrameDecoder,
+  StatusCodecError
+};
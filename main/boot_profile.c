@@ -0,0 +1,91 @@
+#include "boot_profile.h"
+
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BOOT_PROFILE";
+
+// 0 表示未到达（esp_timer 在 app_main 之前已启动，时间戳不会为 0）
+static int64_t s_phase_us[BOOT_PHASE_COUNT] = {0};
+static bool s_reported = false;
+
+static const char *const s_phase_names[BOOT_PHASE_COUNT] = {
+    [BOOT_PHASE_APP_MAIN]           = "app_main",
+    [BOOT_PHASE_GPIO_READY]         = "GPIO",
+    [BOOT_PHASE_UART_READY]         = "UART",
+    [BOOT_PHASE_SBUS_READY]         = "SBUS init",
+    [BOOT_PHASE_CAN_READY]          = "CAN init",
+    [BOOT_PHASE_CONTROL_TASKS]      = "control tasks",
+    [BOOT_PHASE_CAN_UNLOCKED]       = "driver unlock",
+    [BOOT_PHASE_FIRST_SBUS_FRAME]   = "first SBUS frame",
+    [BOOT_PHASE_FIRST_CAN_FRAME]    = "first CAN frame",
+    [BOOT_PHASE_SERVICES_STARTED]   = "services started",
+};
+
+void boot_profile_mark(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT) {
+        return;
+    }
+    if (__atomic_load_n(&s_phase_us[phase], __ATOMIC_RELAXED) != 0) {
+        return;
+    }
+
+    int64_t expected = 0;
+    int64_t now = esp_timer_get_time();
+    __atomic_compare_exchange_n(&s_phase_us[phase], &expected, now, false,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+int64_t boot_profile_get_us(boot_phase_t phase)
+{
+    if (phase >= BOOT_PHASE_COUNT) {
+        return -1;
+    }
+    int64_t us = __atomic_load_n(&s_phase_us[phase], __ATOMIC_RELAXED);
+    return us != 0 ? us : -1;
+}
+
+const char *boot_profile_phase_name(boot_phase_t phase)
+{
+    return phase < BOOT_PHASE_COUNT ? s_phase_names[phase] : "unknown";
+}
+
+bool boot_profile_report_if_ready(void)
+{
+    if (s_reported) {
+        return true;
+    }
+
+    bool frames_seen = boot_profile_get_us(BOOT_PHASE_FIRST_SBUS_FRAME) >= 0 &&
+                       boot_profile_get_us(BOOT_PHASE_FIRST_CAN_FRAME) >= 0;
+    if (!frames_seen && esp_timer_get_time() < (int64_t)BOOT_PROFILE_REPORT_TIMEOUT_MS * 1000) {
+        return false;
+    }
+    s_reported = true;
+
+    ESP_LOGI(TAG, "⏱️ 启动阶段耗时（自应用启动起）:");
+    int64_t prev_us = 0;
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        int64_t us = boot_profile_get_us((boot_phase_t)i);
+        if (us < 0) {
+            ESP_LOGW(TAG, "   %-18s   未到达", s_phase_names[i]);
+            continue;
+        }
+        ESP_LOGI(TAG, "   %-18s %6" PRId64 " ms  (+%" PRId64 " ms)",
+                 s_phase_names[i], us / 1000, (us - prev_us) / 1000);
+        prev_us = us;
+    }
+
+    int64_t live_us = boot_profile_get_us(BOOT_PHASE_CONTROL_TASKS);
+    if (live_us >= 0) {
+        if (live_us / 1000 <= BOOT_PROFILE_TARGET_MS) {
+            ESP_LOGI(TAG, "✅ 控制链路就绪: %" PRId64 " ms (目标 %d ms)", live_us / 1000, BOOT_PROFILE_TARGET_MS);
+        } else {
+            ESP_LOGW(TAG, "⚠️ 控制链路就绪: %" PRId64 " ms，超过目标 %d ms", live_us / 1000, BOOT_PROFILE_TARGET_MS);
+        }
+    }
+    return true;
+}
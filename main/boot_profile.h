@@ -0,0 +1,62 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 启动阶段计时
+ *
+ *   - 各阶段首次到达时记录 esp_timer 时间戳（自应用启动起的微秒数，不含二级引导耗时）
+ *   - 控制链路（SBUS → 电机控制 → CAN）优先启动，LED指示、放线设备、OTA、Wi-Fi、HTTP
+ *     等非关键初始化在控制任务运行后进行
+ *   - 首个有效SBUS帧与首个CAN控制帧都到达后（或超时后）打印一次启动耗时报告
+ */
+
+#define BOOT_PROFILE_REPORT_TIMEOUT_MS      10000   // 超时仍未收齐首帧时也输出报告
+#define BOOT_PROFILE_TARGET_MS              500     // 控制链路就绪目标耗时
+
+typedef enum {
+    BOOT_PHASE_APP_MAIN = 0,        // 进入 app_main
+    BOOT_PHASE_GPIO_READY,          // GPIO 配置完成
+    BOOT_PHASE_UART_READY,          // UART 配置完成
+    BOOT_PHASE_SBUS_READY,          // SBUS 接收初始化完成
+    BOOT_PHASE_CAN_READY,           // CAN 驱动启动、发送任务创建完成
+    BOOT_PHASE_CONTROL_TASKS,       // SBUS/电机控制任务已创建
+    BOOT_PHASE_CAN_UNLOCKED,        // 驱动器零速解锁帧发送完成
+    BOOT_PHASE_FIRST_SBUS_FRAME,    // 首个有效SBUS帧
+    BOOT_PHASE_FIRST_CAN_FRAME,     // 首个CAN控制帧发出
+    BOOT_PHASE_SERVICES_STARTED,    // 非关键服务任务已创建
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+/**
+ * 记录阶段时间戳（仅首次有效，可在任意任务中调用）
+ */
+void boot_profile_mark(boot_phase_t phase);
+
+/**
+ * 获取阶段时间戳（微秒），未到达返回 -1
+ */
+int64_t boot_profile_get_us(boot_phase_t phase);
+
+/**
+ * 阶段名称
+ */
+const char *boot_profile_phase_name(boot_phase_t phase);
+
+/**
+ * 首帧都已到达或超时后输出一次启动报告（周期性调用）
+ * @return true 报告已输出
+ */
+bool boot_profile_report_if_ready(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOT_PROFILE_H */
@@ -0,0 +1,317 @@
+#include "can_bus_monitor.h"
+#include "main.h"
+#include <inttypes.h>
+#include <string.h>
+
+static const char *TAG = "CAN_MON";
+
+// CAN 2.0 帧结构常量（位数）
+#define CAN_FRAME_TAIL_BITS   13U   // CRC界定符1 + ACK槽/界定符2 + EOF7 + 帧间隔3
+#define CAN_CRC15_POLY        0x4599U
+#define CAN_STUFF_RUN         5U    // 连续5个相同位后插入1个填充位
+
+// 单个ID的窗口内累计量，仅在CAN任务中读写
+typedef struct {
+  uint32_t identifier;
+  bool extd;
+  bool tx;
+  bool in_use;
+  uint32_t frames_total;
+  uint32_t win_frames;
+  int64_t last_us;
+  uint64_t win_interval_sum_us;
+  uint32_t win_intervals;
+  uint32_t win_min_interval_us;
+  uint32_t win_max_interval_us;
+} can_id_slot_t;
+
+static can_id_slot_t s_slots[CAN_BUS_MONITOR_MAX_IDS];
+static uint32_t s_win_bits = 0;
+static uint32_t s_win_tx_frames = 0;
+static uint32_t s_win_rx_frames = 0;
+static uint32_t s_untracked_frames = 0;
+static uint32_t s_tx_frames_total = 0;
+static uint32_t s_rx_frames_total = 0;
+static uint32_t s_win_start_ms = 0;
+static bool s_err_baseline_valid = false;
+static twai_status_info_t s_err_baseline;
+
+// 对外发布的快照，由自旋锁保护（HTTP/诊断任务读取）
+static can_bus_stats_t s_published;
+static bool s_published_valid = false;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t can_counter_delta32(uint32_t current, uint32_t last) {
+  return (current >= last) ? (current - last) : current;
+}
+
+/**
+ * 计算填充区（SOF..CRC）的实际填充位数量
+ * 按真实位流逐位模拟，CRC15 同步计算并参与填充
+ */
+uint32_t can_bus_monitor_frame_bits(const twai_message_t *message) {
+  uint8_t bits[160];
+  uint32_t n = 0;
+
+  if (message == NULL) {
+    return 0;
+  }
+
+  uint32_t dlc = message->data_length_code > 8 ? 8 : message->data_length_code;
+  uint32_t data_len = message->rtr ? 0 : dlc;
+
+#define PUSH_BITS(value, width)                                  \
+  do {                                                           \
+    for (int _b = (int)(width) - 1; _b >= 0; _b--) {             \
+      bits[n++] = (uint8_t)(((value) >> _b) & 0x1U);             \
+    }                                                            \
+  } while (0)
+
+  PUSH_BITS(0U, 1);                                   // SOF
+  if (message->extd) {
+    PUSH_BITS(message->identifier >> 18, 11);          // 基本ID
+    PUSH_BITS(1U, 1);                                  // SRR
+    PUSH_BITS(1U, 1);                                  // IDE
+    PUSH_BITS(message->identifier & 0x3FFFFU, 18);     // 扩展ID
+    PUSH_BITS(message->rtr ? 1U : 0U, 1);              // RTR
+    PUSH_BITS(0U, 2);                                  // r1 r0
+  } else {
+    PUSH_BITS(message->identifier & 0x7FFU, 11);
+    PUSH_BITS(message->rtr ? 1U : 0U, 1);              // RTR
+    PUSH_BITS(0U, 2);                                  // IDE r0
+  }
+  PUSH_BITS(dlc, 4);
+  for (uint32_t i = 0; i < data_len; i++) {
+    PUSH_BITS(message->data[i], 8);
+  }
+
+  uint16_t crc = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    uint16_t crc_next = bits[i] ^ ((crc >> 14) & 0x1U);
+    crc = (uint16_t)((crc << 1) & 0x7FFFU);
+    if (crc_next) {
+      crc ^= CAN_CRC15_POLY;
+    }
+  }
+  PUSH_BITS(crc, 15);
+#undef PUSH_BITS
+
+  uint32_t stuff_bits = 0;
+  uint32_t run = 1;
+  uint8_t last = bits[0];
+  for (uint32_t i = 1; i < n; i++) {
+    if (bits[i] == last) {
+      run++;
+      if (run == CAN_STUFF_RUN) {
+        // 插入的填充位为相反电平，并作为下一段连续位的起点
+        stuff_bits++;
+        last = (uint8_t)!last;
+        run = 1;
+      }
+    } else {
+      last = bits[i];
+      run = 1;
+    }
+  }
+
+  return n + stuff_bits + CAN_FRAME_TAIL_BITS;
+}
+
+static can_id_slot_t *can_bus_monitor_find_slot(uint32_t identifier, bool extd) {
+  can_id_slot_t *free_slot = NULL;
+
+  for (int i = 0; i < CAN_BUS_MONITOR_MAX_IDS; i++) {
+    if (s_slots[i].in_use) {
+      if (s_slots[i].identifier == identifier && s_slots[i].extd == extd) {
+        return &s_slots[i];
+      }
+    } else if (free_slot == NULL) {
+      free_slot = &s_slots[i];
+    }
+  }
+
+  if (free_slot != NULL) {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->in_use = true;
+    free_slot->identifier = identifier;
+    free_slot->extd = extd;
+    free_slot->win_min_interval_us = UINT32_MAX;
+  }
+  return free_slot;
+}
+
+void can_bus_monitor_init(void) {
+  memset(s_slots, 0, sizeof(s_slots));
+  s_win_bits = 0;
+  s_win_tx_frames = 0;
+  s_win_rx_frames = 0;
+  s_untracked_frames = 0;
+  s_tx_frames_total = 0;
+  s_rx_frames_total = 0;
+  s_win_start_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  s_err_baseline_valid = false;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  memset(&s_published, 0, sizeof(s_published));
+  s_published_valid = false;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void can_bus_monitor_record(const twai_message_t *message, bool is_tx) {
+  if (message == NULL) {
+    return;
+  }
+
+  int64_t now_us = esp_timer_get_time();
+  s_win_bits += can_bus_monitor_frame_bits(message);
+  if (is_tx) {
+    s_win_tx_frames++;
+    s_tx_frames_total++;
+  } else {
+    s_win_rx_frames++;
+    s_rx_frames_total++;
+  }
+
+  can_id_slot_t *slot = can_bus_monitor_find_slot(message->identifier, message->extd);
+  if (slot == NULL) {
+    s_untracked_frames++;
+    return;
+  }
+
+  if (slot->last_us != 0) {
+    int64_t delta = now_us - slot->last_us;
+    uint32_t interval_us = delta > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+    slot->win_interval_sum_us += interval_us;
+    slot->win_intervals++;
+    if (interval_us < slot->win_min_interval_us) {
+      slot->win_min_interval_us = interval_us;
+    }
+    if (interval_us > slot->win_max_interval_us) {
+      slot->win_max_interval_us = interval_us;
+    }
+  }
+  slot->last_us = now_us;
+  slot->tx = is_tx;
+  slot->frames_total++;
+  slot->win_frames++;
+}
+
+void can_bus_monitor_update(uint32_t now_ms) {
+  uint32_t elapsed_ms = now_ms - s_win_start_ms;
+  if (elapsed_ms < CAN_BUS_MONITOR_WINDOW_MS) {
+    return;
+  }
+
+  can_bus_stats_t stats;
+  memset(&stats, 0, sizeof(stats));
+
+  // 负载 = 窗口内总线位数 / (波特率 × 窗口时长)
+  uint64_t capacity_bits = (uint64_t)CAN_BUS_MONITOR_BITRATE * elapsed_ms / 1000U;
+  stats.load_percent = capacity_bits > 0 ? (float)s_win_bits * 100.0f / (float)capacity_bits : 0.0f;
+  stats.bits_per_sec = (uint32_t)((uint64_t)s_win_bits * 1000U / elapsed_ms);
+  stats.tx_frames_per_sec = (uint32_t)((uint64_t)s_win_tx_frames * 1000U / elapsed_ms);
+  stats.rx_frames_per_sec = (uint32_t)((uint64_t)s_win_rx_frames * 1000U / elapsed_ms);
+  stats.untracked_frames = s_untracked_frames;
+  stats.tx_frames_total = s_tx_frames_total;
+  stats.rx_frames_total = s_rx_frames_total;
+
+  twai_status_info_t status_info;
+  if (twai_get_status_info(&status_info) == ESP_OK) {
+    stats.tx_error_counter = status_info.tx_error_counter;
+    stats.rx_error_counter = status_info.rx_error_counter;
+    if (s_err_baseline_valid) {
+      stats.bus_error_delta = can_counter_delta32(status_info.bus_error_count, s_err_baseline.bus_error_count);
+      stats.arb_lost_delta = can_counter_delta32(status_info.arb_lost_count, s_err_baseline.arb_lost_count);
+      stats.tx_failed_delta = can_counter_delta32(status_info.tx_failed_count, s_err_baseline.tx_failed_count);
+      stats.rx_missed_delta = can_counter_delta32(status_info.rx_missed_count, s_err_baseline.rx_missed_count);
+    }
+    s_err_baseline = status_info;
+    s_err_baseline_valid = true;
+  }
+
+  for (int i = 0; i < CAN_BUS_MONITOR_MAX_IDS; i++) {
+    can_id_slot_t *slot = &s_slots[i];
+    if (!slot->in_use) {
+      continue;
+    }
+    can_bus_id_stats_t *out = &stats.ids[stats.id_count++];
+    out->identifier = slot->identifier;
+    out->extd = slot->extd;
+    out->tx = slot->tx;
+    out->frames_total = slot->frames_total;
+    out->frames_per_sec = (uint32_t)((uint64_t)slot->win_frames * 1000U / elapsed_ms);
+    if (slot->win_intervals > 0) {
+      out->mean_interval_us = (uint32_t)(slot->win_interval_sum_us / slot->win_intervals);
+      out->jitter_us = slot->win_max_interval_us - slot->win_min_interval_us;
+      out->max_interval_us = slot->win_max_interval_us;
+    }
+
+    slot->win_frames = 0;
+    slot->win_interval_sum_us = 0;
+    slot->win_intervals = 0;
+    slot->win_min_interval_us = UINT32_MAX;
+    slot->win_max_interval_us = 0;
+  }
+
+  s_win_bits = 0;
+  s_win_tx_frames = 0;
+  s_win_rx_frames = 0;
+  s_win_start_ms = now_ms;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  stats.window_count = s_published.window_count + 1;
+  stats.peak_load_percent = stats.load_percent > s_published.peak_load_percent
+                                ? stats.load_percent
+                                : s_published.peak_load_percent;
+  s_published = stats;
+  s_published_valid = true;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+esp_err_t can_bus_monitor_get_stats(can_bus_stats_t *stats) {
+  if (stats == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  bool valid = s_published_valid;
+  *stats = s_published;
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  return valid ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+void can_bus_monitor_print_diag(void) {
+  can_bus_stats_t stats;
+
+  if (can_bus_monitor_get_stats(&stats) != ESP_OK) {
+    ESP_LOGW(TAG, "总线负载统计: 尚未完成第一个%ums窗口", CAN_BUS_MONITOR_WINDOW_MS);
+    return;
+  }
+
+  ESP_LOGI(TAG, "───────────────────────────────────────────");
+  ESP_LOGI(TAG, "📊 总线负载: %.1f%% (峰值%.1f%%), %lu bit/s @ %lu bit/s",
+           stats.load_percent, stats.peak_load_percent,
+           (unsigned long)stats.bits_per_sec, (unsigned long)CAN_BUS_MONITOR_BITRATE);
+  ESP_LOGI(TAG, "帧率: TX=%lu/s RX=%lu/s, 未跟踪帧=%lu",
+           (unsigned long)stats.tx_frames_per_sec,
+           (unsigned long)stats.rx_frames_per_sec,
+           (unsigned long)stats.untracked_frames);
+  ESP_LOGI(TAG, "错误/秒: 总线错误=%lu 仲裁丢失=%lu 发送失败=%lu 接收丢失=%lu (TEC=%lu REC=%lu)",
+           (unsigned long)stats.bus_error_delta,
+           (unsigned long)stats.arb_lost_delta,
+           (unsigned long)stats.tx_failed_delta,
+           (unsigned long)stats.rx_missed_delta,
+           (unsigned long)stats.tx_error_counter,
+           (unsigned long)stats.rx_error_counter);
+  for (int i = 0; i < stats.id_count; i++) {
+    const can_bus_id_stats_t *id = &stats.ids[i];
+    ESP_LOGI(TAG, "  %s ID=0x%08" PRIX32 "%s %lu/s 间隔=%luus 抖动=%luus 最大=%luus 累计=%lu",
+             id->tx ? "TX" : "RX", id->identifier, id->extd ? "x" : " ",
+             (unsigned long)id->frames_per_sec,
+             (unsigned long)id->mean_interval_us,
+             (unsigned long)id->jitter_us,
+             (unsigned long)id->max_interval_us,
+             (unsigned long)id->frames_total);
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef CAN_BUS_MONITOR_H
+#define CAN_BUS_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+#define CAN_BUS_MONITOR_BITRATE     500000U  // 总线波特率（与 TWAI_TIMING_CONFIG_500KBITS 一致）
+#define CAN_BUS_MONITOR_WINDOW_MS   1000U    // 统计窗口，负载/帧率/错误增量均按窗口计算
+#define CAN_BUS_MONITOR_MAX_IDS     16       // 跟踪的不同CAN ID数量上限
+
+/**
+ * 单个CAN ID的帧率与到达间隔统计（上一统计窗口）
+ */
+typedef struct {
+  uint32_t identifier;
+  bool extd;
+  bool tx;                      // 最近一次观测方向（true=本机发送）
+  uint32_t frames_total;        // 累计帧数
+  uint32_t frames_per_sec;      // 上一窗口帧率
+  uint32_t mean_interval_us;    // 上一窗口平均到达间隔
+  uint32_t jitter_us;           // 上一窗口到达间隔峰峰值（max-min）
+  uint32_t max_interval_us;     // 上一窗口最大到达间隔
+} can_bus_id_stats_t;
+
+/**
+ * CAN总线负载统计快照
+ */
+typedef struct {
+  float load_percent;           // 上一窗口总线负载（按填充后位长估算）
+  float peak_load_percent;      // 启动以来最大窗口负载
+  uint32_t bits_per_sec;        // 上一窗口总线位数（含位填充/帧间隔）
+  uint32_t tx_frames_per_sec;
+  uint32_t rx_frames_per_sec;
+  uint32_t tx_error_counter;    // 当前TEC
+  uint32_t rx_error_counter;    // 当前REC
+  uint32_t bus_error_delta;     // 上一窗口新增总线错误
+  uint32_t arb_lost_delta;      // 上一窗口新增仲裁丢失
+  uint32_t tx_failed_delta;     // 上一窗口新增发送失败
+  uint32_t rx_missed_delta;     // 上一窗口新增接收丢失
+  uint32_t window_count;        // 已完成的统计窗口数
+  uint32_t untracked_frames;    // ID表已满未能跟踪的帧数
+  uint32_t tx_frames_total;     // 启动以来累计发送成功帧数
+  uint32_t rx_frames_total;     // 启动以来累计接收帧数
+  uint8_t id_count;
+  can_bus_id_stats_t ids[CAN_BUS_MONITOR_MAX_IDS];
+} can_bus_stats_t;
+
+/**
+ * 初始化总线监测（清空统计）
+ */
+void can_bus_monitor_init(void);
+
+/**
+ * 记录一帧已发送/已接收的报文（在CAN任务中调用）
+ * @param message 报文
+ * @param is_tx true=本机发送成功，false=接收
+ */
+void can_bus_monitor_record(const twai_message_t *message, bool is_tx);
+
+/**
+ * 周期更新：窗口到期时读取TWAI错误计数并发布统计快照（在CAN任务循环中调用）
+ * @param now_ms 当前时间
+ */
+void can_bus_monitor_update(uint32_t now_ms);
+
+/**
+ * 获取最近一个窗口的统计快照
+ * @param stats 输出统计
+ * @return ESP_OK=成功，ESP_ERR_INVALID_STATE=尚未完成第一个窗口
+ */
+esp_err_t can_bus_monitor_get_stats(can_bus_stats_t *stats);
+
+/**
+ * 估算一帧在总线上占用的位数（含位填充、ACK/EOF/帧间隔）
+ */
+uint32_t can_bus_monitor_frame_bits(const twai_message_t *message);
+
+/**
+ * 打印总线负载与各ID统计
+ */
+void can_bus_monitor_print_diag(void);
+
+#endif /* CAN_BUS_MONITOR_H */
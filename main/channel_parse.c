@@ -21,9 +21,16 @@ static uint8_t (*intf_move)(int8_t, int8_t) = motor_driver_move;
 static uint16_t last_ch_val[16] = {0};
 static bool first_run = true;
 #define CLAIM_WINDOW_MS 500
-static int8_t last_left_speed = 0;
+static int8_t last_left_speed = 0;              // 最近一次下发的履带速度（任一输入源）
 static int8_t last_right_speed = 0;
 
+#if ENABLE_PAYOUT_DEVICE && PAYOUT_SYNC_MODE_ENABLE
+// 同步放线设置：由 SBUS 通道解析写入，控制任务每周期按地速刷新目标
+static bool payout_sync_active = false;
+static int8_t payout_sync_direction = 0;
+static uint16_t payout_sync_trim_channel = PAYOUT_CHANNEL_MID;
+#endif
+
 void channel_parse_force_stop(const char *reason)
 {
     if (last_left_speed != 0 || last_right_speed != 0) {
@@ -37,7 +44,11 @@ void channel_parse_force_stop(const char *reason)
     last_right_speed = 0;
 
 #if ENABLE_PAYOUT_DEVICE
-    // 失能/失步 → 放线设备也强制停止，两路执行机构同步置零
+    // 失能/失步 → 放线设备也强制停止，两路执行机构同步置零；
+    // 同步放线待 SBUS 重新接管后再恢复
+#if PAYOUT_SYNC_MODE_ENABLE
+    payout_sync_active = false;
+#endif
     drv_payout_stop();
 #endif
 }
@@ -133,6 +144,54 @@ static uint16_t payout_speed_channel_to_signed_value(uint16_t speed_channel_valu
     }
     return PAYOUT_CHANNEL_MID;
 }
+
+#if PAYOUT_SYNC_MODE_ENABLE
+/**
+ * 同步放线的地速：优先取驱动器速度反馈，否则用本周期命令速度
+ * @param from_feedback 输出：是否来自速度反馈
+ * @return 履带前进速度，满量程千分比（-1000~1000）
+ */
+static int16_t payout_sync_ground_speed(bool *from_feedback)
+{
+#if PAYOUT_SYNC_USE_FEEDBACK
+    int16_t feedback_permille;
+    if (motor_driver_get_track_speed(&feedback_permille) == ESP_OK) {
+        *from_feedback = true;
+        return feedback_permille;
+    }
+#endif
+    *from_feedback = false;
+    // 命令速度 -100~100 → ‰；原地转向时左右抵消为 0，不放线
+    return (int16_t)(((int16_t)last_left_speed + (int16_t)last_right_speed) * 10 / 2);
+}
+
+/**
+ * 同步放线目标：地速 × 滚筒比 × (1 + CH10 微调)，方向由 CH7 决定
+ */
+static int16_t payout_sync_target_pwm(int16_t ground_permille, uint16_t trim_channel_value,
+                                      int8_t direction_sign)
+{
+    int32_t trim_channel = trim_channel_value;
+    if (trim_channel < PAYOUT_CHANNEL_MIN) {
+        trim_channel = PAYOUT_CHANNEL_MIN;
+    } else if (trim_channel > PAYOUT_CHANNEL_MAX) {
+        trim_channel = PAYOUT_CHANNEL_MAX;
+    }
+    int32_t trim_percent = (trim_channel - PAYOUT_CHANNEL_MID) * PAYOUT_SYNC_TRIM_PERCENT /
+                           (PAYOUT_CHANNEL_MAX - PAYOUT_CHANNEL_MID);
+
+    int32_t pwm = (int32_t)ground_permille * PAYOUT_SYNC_DRUM_RATIO_PERMILLE / 1000;
+    pwm = pwm * (100 + trim_percent) / 100;
+    pwm *= direction_sign;
+
+    if (pwm > PAYOUT_PWM_LIMIT) {
+        pwm = PAYOUT_PWM_LIMIT;
+    } else if (pwm < -PAYOUT_PWM_LIMIT) {
+        pwm = -PAYOUT_PWM_LIMIT;
+    }
+    return (int16_t)pwm;
+}
+#endif /* PAYOUT_SYNC_MODE_ENABLE */
 #endif
 
 /**
@@ -147,6 +206,7 @@ static uint16_t payout_speed_channel_to_signed_value(uint16_t speed_channel_valu
  * - CH5 (ch_val[4]): 遥控使能开关，低档/低位=使能
  * - CH7 (ch_val[6]): 放线器方向开关
  * - CH8 (ch_val[7]): 低速模式开关，高档/高位=启用
+ * - CH9 (ch_val[8]): 放线同步模式开关，高档=随地速放线
  */
 uint8_t parse_chan_val(uint16_t* ch_val)
 {
@@ -340,6 +400,7 @@ uint8_t parse_chan_val(uint16_t* ch_val)
         // 放线设备控制（与履带车完全独立，共用 SBUS 通道）
         // - CH7  (ch_val[6])：方向开关（高档=正转，低档=反转，中位=停止）
         // - CH10 (ch_val[9])：速度大小（最小=0，最大=满速）
+        // - CH9  (ch_val[8])：高档=同步放线，目标随地速每周期更新，CH10 变为 ±微调
         // 限频 PAYOUT_SEND_INTERVAL_MS，并在状态变化时立即下发一次
         // ============================================================
         static int8_t last_payout_direction = 0;
@@ -365,12 +426,35 @@ uint8_t parse_chan_val(uint16_t* ch_val)
         }
 
         uint32_t now_tick = xTaskGetTickCount();
-        bool should_send = payout_state_changed ||
-            ((now_tick - last_payout_send_tick) >= pdMS_TO_TICKS(PAYOUT_SEND_INTERVAL_MS));
+#if PAYOUT_SYNC_MODE_ENABLE
+        static bool last_payout_sync = false;
+        bool payout_sync = t12d_receiver_switch_is_high(ch_val[PAYOUT_SYNC_SWITCH_CHANNEL_IDX]);
+
+        if (payout_sync != last_payout_sync) {
+            ESP_LOGI(TAG, "🪢 Payout mode: %s (CH%u=%u)",
+                     payout_sync ? "SYNC" : "MANUAL",
+                     (unsigned)(PAYOUT_SYNC_SWITCH_CHANNEL_IDX + 1U),
+                     (unsigned)ch_val[PAYOUT_SYNC_SWITCH_CHANNEL_IDX]);
+            last_payout_sync = payout_sync;
+            payout_state_changed = true;
+        }
 
-        if (should_send) {
-            drv_payout_send_channel_pwm(payout_channel_value);
+        // 同步模式只记录方向与微调，目标由控制任务每周期按地速刷新（channel_parse_payout_sync_step）
+        payout_sync_direction = payout_direction;
+        payout_sync_trim_channel = ch_val[PAYOUT_SPEED_CHANNEL_IDX];
+        payout_sync_active = payout_sync;
+        if (payout_sync) {
             last_payout_send_tick = now_tick;
+        } else
+#endif
+        {
+            bool should_send = payout_state_changed ||
+                ((now_tick - last_payout_send_tick) >= pdMS_TO_TICKS(PAYOUT_SEND_INTERVAL_MS));
+
+            if (should_send) {
+                drv_payout_send_channel_pwm(payout_channel_value);
+                last_payout_send_tick = now_tick;
+            }
         }
 #endif /* ENABLE_PAYOUT_DEVICE */
 
@@ -387,5 +471,32 @@ uint8_t parse_chan_val(uint16_t* ch_val)
 uint8_t parse_cmd_vel(uint8_t spl, uint8_t spr)
 {
     intf_move((int8_t)spl, (int8_t)spr);
+    last_left_speed = (int8_t)spl;
+    last_right_speed = (int8_t)spr;
     return 0;
 }
+
+/**
+ * 同步放线：按当前地速刷新放线目标（控制任务每周期调用，与当前控制源无关）
+ */
+void channel_parse_payout_sync_step(void)
+{
+#if ENABLE_PAYOUT_DEVICE && PAYOUT_SYNC_MODE_ENABLE
+    static bool last_sync_from_feedback = false;
+
+    if (!payout_sync_active) {
+        return;
+    }
+
+    // 总线侧由 RS485 调度器合并限频，这里每周期只更新目标邮箱
+    bool from_feedback = false;
+    int16_t ground_permille = payout_sync_ground_speed(&from_feedback);
+    if (from_feedback != last_sync_from_feedback) {
+        ESP_LOGI(TAG, "🪢 Payout sync source: %s",
+                 from_feedback ? "driver speed feedback" : "commanded track speed");
+        last_sync_from_feedback = from_feedback;
+    }
+    drv_payout_set_target_pwm(payout_sync_target_pwm(ground_permille, payout_sync_trim_channel,
+                                                     payout_sync_direction));
+#endif
+}
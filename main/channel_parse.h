@@ -25,4 +25,11 @@ uint8_t parse_cmd_vel(uint8_t spl, uint8_t spr);
  */
 void channel_parse_force_stop(const char *reason);
 
+/**
+ * 同步放线：按地速（驱动器速度反馈，无反馈时为最近下发的履带速度）刷新放线目标
+ * 由电机控制任务每个控制周期调用，任一输入源控制履带时都生效；
+ * 是否同步、方向与微调由 SBUS 通道（CH9/CH7/CH10）决定，强制停车后需 SBUS 重新接管才恢复
+ */
+void channel_parse_payout_sync_step(void);
+
 #endif /* CHANNEL_PARSE_H */
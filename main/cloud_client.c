@@ -1,6 +1,6 @@
 #include "cloud_client.h"
 #include "main.h"
-#include "data_integration.h"
+#include "device_state.h"
 #include "wifi_manager.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
@@ -8,22 +8,52 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_mac.h"
 #include "ota_manager.h"
+#include "json_writer.h"
+#include "json_tokenizer.h"
+#include "http_client_pool.h"
+#include "time_manager.h"
+#include "telemetry_store.h"
+#include "status_codec.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include <string.h>
+#include <strings.h>
 #include <inttypes.h>
+#include <sys/time.h>
 
 static const char *TAG = "CLOUD_CLIENT";
 
 // 函数声明
 static void set_last_error(const char* error_msg);
 static cloud_command_type_t parse_command_type(const char* command_str);
-static esp_err_t handle_ota_command(const cJSON* data);
-static esp_err_t download_and_install_firmware(const char* url, uint32_t expected_size);
+// OTA任务参数（从指令JSON复制，指令解析完成后JSON即可释放）
+typedef struct {
+    char command_id[64];
+    char url[256];
+    char version[32];
+    char hash[72];
+    uint32_t size;
+} ota_job_t;
+
+static esp_err_t download_and_install_firmware(const ota_job_t* job);
 static void ota_progress_callback(uint8_t progress_percent, const char* status_message);
-static esp_http_client_handle_t create_http_client(const char* url);
 static esp_err_t add_auth_headers(esp_http_client_handle_t client);
-static esp_err_t fetch_pending_commands(void);
+static esp_err_t fetch_pending_commands(uint32_t wait_s, bool* long_poll_ack);
+static int parse_commands(const char* body, size_t body_len, cloud_command_t* commands, int max_commands, bool* long_poll_ack);
+static esp_err_t send_http_post(const char* url, const char* data);
+static esp_err_t flush_command_feedback(bool force);
+static esp_err_t submit_ota_job(const char* command_id, const char* js, size_t js_len);
+static void benchmark_command_parsing(const char* body, size_t body_len);
+static void write_status_fields(json_writer_t *w, const device_status_data_t* status_data);
+static esp_err_t build_status_json(const device_status_data_t* status_data, size_t* json_len);
+#if STATUS_BINARY_ENABLE
+static void benchmark_status_encoding(const device_status_data_t* status);
+#endif
 
 // 全局变量
 static cloud_device_info_t s_device_info = {0};
@@ -34,13 +64,98 @@ static TaskHandle_t s_command_task_handle = NULL;
 static void (*s_command_callback)(const cloud_command_t* command) = NULL;
 static void (*s_status_callback)(const device_status_data_t* status) = NULL;
 
-// OTA相关变量
-static char s_current_command_id[64] = {0};
+// 指令响应解析统计
+static cloud_command_parse_stats_t s_parse_stats = {0};
+
+// OTA任务（独立任务执行下载，指令轮询不被阻塞）
+static ota_job_t *s_ota_job = NULL;
+static cloud_ota_job_stats_t s_ota_job_stats = {0};
+static uint32_t s_ota_last_report_ms = 0;
 
 // HTTP响应缓冲区
 static char s_response_buffer[MAX_HTTP_RESPONSE_SIZE];
 static int s_response_len = 0;
 
+// 指令通道响应缓冲区（长轮询挂起期间状态上报仍在使用 s_response_buffer）
+static char s_command_response_buffer[MAX_HTTP_RESPONSE_SIZE];
+static int s_command_response_len = 0;
+
+// 指令下发延迟与执行器统计（指令轮询、状态上报、执行、OTA 任务写，HTTP 任务读）
+static portMUX_TYPE s_command_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static cloud_command_latency_stats_t s_latency_stats = {0};
+static uint64_t s_latency_sum_ms = 0;
+
+// 指令执行器：每个优先级一个队列，执行任务总是先取高优先级
+typedef struct {
+    cloud_command_t command;            // 出队后 command.data 指向 data
+    char data[COMMAND_EXEC_DATA_SIZE];
+    int64_t enqueued_us;
+} command_exec_item_t;
+
+static QueueHandle_t s_exec_queues[CLOUD_CMD_PRIORITY_COUNT] = {NULL};
+static SemaphoreHandle_t s_exec_signal = NULL;      // 入队计数，唤醒执行任务
+static TaskHandle_t s_exec_task_handle = NULL;
+static command_exec_item_t s_dispatch_item;         // 由 s_dispatch_mutex 保护
+static SemaphoreHandle_t s_dispatch_mutex = NULL;   // 指令轮询与状态上报任务都会分发指令
+static char s_recent_command_ids[COMMAND_RECENT_ID_COUNT][64];
+static int s_recent_command_next = 0;
+static command_exec_item_t s_exec_item;             // 仅指令执行任务使用
+static cloud_command_exec_stats_t s_exec_stats = {0};
+static uint64_t s_exec_queue_sum_us[CLOUD_CMD_TYPE_COUNT] = {0};
+static uint64_t s_exec_run_sum_us[CLOUD_CMD_TYPE_COUNT] = {0};
+
+// 指令反馈：同一指令只保留最新状态，每个周期合并为一次批量上报
+typedef struct {
+    char command_id[64];
+    char status[16];
+    char message[80];
+} command_feedback_t;
+
+static command_feedback_t s_feedback_pending[COMMAND_FEEDBACK_MAX_PENDING];
+static int s_feedback_pending_count = 0;
+static int64_t s_feedback_first_us = 0;             // 最早一条待上报反馈的提交时刻
+static int64_t s_feedback_retry_us = 0;             // 上次发送失败后的下次重试时刻
+static command_feedback_t s_feedback_inflight[COMMAND_FEEDBACK_MAX_PENDING];
+static SemaphoreHandle_t s_feedback_mutex = NULL;       // 保护待上报列表
+static SemaphoreHandle_t s_feedback_flush_mutex = NULL; // 串行化批量上报（执行任务、OTA重启前）
+static char s_feedback_json_buffer[COMMAND_FEEDBACK_JSON_BUF_SIZE];
+
+static const char *const s_command_type_names[CLOUD_CMD_TYPE_COUNT] = {
+    [CLOUD_CMD_UNKNOWN]         = "unknown",
+    [CLOUD_CMD_SBUS_UPDATE]     = "sbus_update",
+    [CLOUD_CMD_MOTOR_CONTROL]   = "motor_control",
+    [CLOUD_CMD_WIFI_CONFIG]     = "wifi_config",
+    [CLOUD_CMD_OTA_UPDATE]      = "ota_update",
+    [CLOUD_CMD_REBOOT]          = "reboot",
+};
+
+#if TELEMETRY_STORE_ENABLE
+// 离线遥测样本（写入 SPIFFS 的定长记录）
+typedef struct {
+    uint64_t timestamp_ms;          // 采样时刻（Unix毫秒，时钟未同步时为0）
+    uint32_t boot_id;               // 采样时的启动标识，用于上传时补算时间戳
+    device_status_data_t status;
+} telemetry_sample_t;
+
+static uint32_t s_boot_id = 0;
+static telemetry_sample_t s_upload_samples[TELEMETRY_UPLOAD_BATCH];
+static char s_batch_json_buffer[TELEMETRY_BATCH_JSON_BUF_SIZE];
+static uint32_t s_upload_backoff_ms = 0;
+static uint32_t s_next_upload_time = 0;
+#endif
+
+// 状态上报 JSON 缓冲区（仅状态任务使用）与序列化统计
+static char s_status_json_buffer[DEVICE_STATUS_JSON_BUF_SIZE];
+static cloud_report_stats_t s_report_stats = {0};
+
+#if STATUS_BINARY_ENABLE
+// 二进制状态编码（服务器在响应头中声明支持后启用）
+static status_codec_ctx_t s_status_codec;
+static uint8_t s_status_bin_buffer[STATUS_CODEC_MAX_SIZE];
+static volatile bool s_status_binary_supported = false;
+static uint32_t s_frames_since_keyframe = 0;
+#endif
+
 // 错误处理和重连机制
 static char s_last_error[256] = {0};
 static uint32_t s_retry_count = 0;
@@ -80,11 +195,19 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
         case HTTP_EVENT_ON_CONNECTED:
             ESP_LOGD(TAG, "HTTP_EVENT_ON_CONNECTED");
             break;
-        case HTTP_EVENT_HEADER_SENT:
-            ESP_LOGD(TAG, "HTTP_EVENT_HEADER_SENT");
+        case HTTP_EVENT_HEADERS_SENT:
+            ESP_LOGD(TAG, "HTTP_EVENT_HEADERS_SENT");
             break;
         case HTTP_EVENT_ON_HEADER:
             ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
+#if STATUS_BINARY_ENABLE
+            if (!s_status_binary_supported &&
+                strcasecmp(evt->header_key, "X-Status-Encodings") == 0 &&
+                strstr(evt->header_value, STATUS_CODEC_ENCODING_NAME) != NULL) {
+                s_status_binary_supported = true;
+                ESP_LOGI(TAG, "📦 服务器支持二进制状态编码，后续上报使用 %s", STATUS_CODEC_ENCODING_NAME);
+            }
+#endif
             break;
         case HTTP_EVENT_ON_DATA:
             if (s_response_len + evt->data_len < sizeof(s_response_buffer) - 1) {
@@ -106,6 +229,447 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
+/**
+ * 指令通道HTTP事件处理函数（写入独立的响应缓冲区）
+ */
+static esp_err_t command_event_handler(esp_http_client_event_t *evt)
+{
+    if (evt->event_id == HTTP_EVENT_ON_DATA) {
+        if (s_command_response_len + evt->data_len < sizeof(s_command_response_buffer) - 1) {
+            memcpy(s_command_response_buffer + s_command_response_len, evt->data, evt->data_len);
+            s_command_response_len += evt->data_len;
+            s_command_response_buffer[s_command_response_len] = '\0';
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * 固件下载响应头（esp_http_client_get_header 只能读请求头，响应头在事件回调中获取）
+ */
+typedef struct {
+    char content_type[64];
+    char content_range[64];
+    char firmware_hash[72];
+} firmware_response_headers_t;
+
+static void copy_header_value(char* dest, size_t dest_size, const char* value)
+{
+    strncpy(dest, value, dest_size - 1);
+    dest[dest_size - 1] = '\0';
+}
+
+/**
+ * 固件下载HTTP事件处理函数
+ */
+static esp_err_t firmware_event_handler(esp_http_client_event_t *evt)
+{
+    firmware_response_headers_t *headers = (firmware_response_headers_t *)evt->user_data;
+
+    if (evt->event_id == HTTP_EVENT_ON_HEADER && headers != NULL) {
+        if (strcasecmp(evt->header_key, "Content-Type") == 0) {
+            copy_header_value(headers->content_type, sizeof(headers->content_type), evt->header_value);
+        } else if (strcasecmp(evt->header_key, "Content-Range") == 0) {
+            copy_header_value(headers->content_range, sizeof(headers->content_range), evt->header_value);
+        } else if (strcasecmp(evt->header_key, "X-Firmware-Hash") == 0) {
+            copy_header_value(headers->firmware_hash, sizeof(headers->firmware_hash), evt->header_value);
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * 当前Unix毫秒时间（时钟未同步返回0）
+ */
+static uint64_t current_unix_ms(void)
+{
+    if (!time_manager_is_time_valid()) {
+        return 0;
+    }
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * 记录指令端到端下发延迟
+ * 时钟已同步时按云端创建时刻计算；否则为云端排队时长 + 设备侧处理时长（不含单程网络传输）
+ */
+static void record_command_latency(const cloud_command_t* command, int64_t received_us)
+{
+    uint32_t device_ms = (uint32_t)((esp_timer_get_time() - received_us) / 1000);
+    uint32_t latency_ms = command->queued_ms + device_ms;
+
+    uint64_t now_ms = current_unix_ms();
+    if (command->created_at_ms > 0 && now_ms > 0) {
+        int64_t diff_ms = (int64_t)(now_ms - command->created_at_ms);
+        latency_ms = diff_ms > 0 ? (uint32_t)diff_ms : 0;
+    }
+
+    bool over_target = latency_ms > COMMAND_LATENCY_TARGET_MS;
+    taskENTER_CRITICAL(&s_command_stats_lock);
+    s_latency_stats.delivered++;
+    s_latency_stats.last_ms = latency_ms;
+    s_latency_sum_ms += latency_ms;
+    s_latency_stats.avg_ms = (uint32_t)(s_latency_sum_ms / s_latency_stats.delivered);
+    if (latency_ms > s_latency_stats.max_ms) {
+        s_latency_stats.max_ms = latency_ms;
+    }
+    if (over_target) {
+        s_latency_stats.over_target++;
+    }
+    uint32_t avg_ms = s_latency_stats.avg_ms;
+    taskEXIT_CRITICAL(&s_command_stats_lock);
+
+    if (over_target) {
+        ESP_LOGW(TAG, "⚠️ 指令下发延迟 %" PRIu32 "ms (云端排队 %" PRIu32 "ms, 设备处理 %" PRIu32 "ms)",
+                 latency_ms, command->queued_ms, device_ms);
+    } else {
+        ESP_LOGI(TAG, "📨 指令下发延迟 %" PRIu32 "ms (平均 %" PRIu32 "ms)", latency_ms, avg_ms);
+    }
+}
+
+/**
+ * 指令类型对应的执行优先级
+ */
+static cloud_command_priority_t command_priority(cloud_command_type_t type)
+{
+    switch (type) {
+        case CLOUD_CMD_SBUS_UPDATE:
+        case CLOUD_CMD_MOTOR_CONTROL:
+            return CLOUD_CMD_PRIORITY_SAFETY;
+        case CLOUD_CMD_OTA_UPDATE:
+        case CLOUD_CMD_REBOOT:
+            return CLOUD_CMD_PRIORITY_SYSTEM;
+        default:
+            return CLOUD_CMD_PRIORITY_CONFIG;
+    }
+}
+
+/**
+ * 指令最近是否已下发过；未下发过则记入环形缓冲（调用方持有 s_dispatch_mutex）
+ */
+static bool command_seen_recently(const char* command_id)
+{
+    for (int i = 0; i < COMMAND_RECENT_ID_COUNT; i++) {
+        if (strcmp(s_recent_command_ids[i], command_id) == 0) {
+            return true;
+        }
+    }
+    strncpy(s_recent_command_ids[s_recent_command_next], command_id, sizeof(s_recent_command_ids[0]) - 1);
+    s_recent_command_next = (s_recent_command_next + 1) % COMMAND_RECENT_ID_COUNT;
+    return false;
+}
+
+/**
+ * 记录延迟后按优先级入队，由指令执行任务执行（data 在入队时复制，响应缓冲区可立即复用）
+ * 服务器在反馈到达前可能重复下发同一指令，最近下发过的指令ID直接丢弃
+ */
+static void dispatch_commands(const cloud_command_t* commands, int count, int64_t received_us)
+{
+    command_exec_item_t *item = &s_dispatch_item;
+
+    xSemaphoreTake(s_dispatch_mutex, portMAX_DELAY);
+    for (int i = 0; i < count; i++) {
+        const cloud_command_t *command = &commands[i];
+        if (command->command_id[0] == '\0' || command_seen_recently(command->command_id)) {
+            ESP_LOGD(TAG, "🔁 指令 %s 已下发过，忽略", command->command_id);
+            taskENTER_CRITICAL(&s_command_stats_lock);
+            s_exec_stats.duplicates++;
+            taskEXIT_CRITICAL(&s_command_stats_lock);
+            continue;
+        }
+        record_command_latency(command, received_us);
+
+        if (command->data_len >= sizeof(item->data)) {
+            ESP_LOGW(TAG, "⚠️ 指令 %s 数据过长 (%u bytes)，拒绝执行", command->command_id, (unsigned)command->data_len);
+            taskENTER_CRITICAL(&s_command_stats_lock);
+            s_exec_stats.dropped++;
+            taskEXIT_CRITICAL(&s_command_stats_lock);
+            cloud_client_send_command_feedback(command->command_id, "failed", "指令数据过长");
+            continue;
+        }
+
+        item->command = *command;
+        item->command.data = NULL;
+        if (command->data_len > 0) {
+            memcpy(item->data, command->data, command->data_len);
+        }
+        item->data[command->data_len] = '\0';
+        item->enqueued_us = esp_timer_get_time();
+
+        cloud_command_priority_t priority = command_priority(command->command);
+        if (xQueueSend(s_exec_queues[priority], item, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "⚠️ 指令队列已满 (优先级%d)，拒绝指令 %s", priority, command->command_id);
+            taskENTER_CRITICAL(&s_command_stats_lock);
+            s_exec_stats.dropped++;
+            taskEXIT_CRITICAL(&s_command_stats_lock);
+            cloud_client_send_command_feedback(command->command_id, "failed", "设备指令队列已满");
+            continue;
+        }
+
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        s_exec_stats.queued++;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+        cloud_client_send_command_feedback(command->command_id, "received", NULL);
+        xSemaphoreGive(s_exec_signal);
+    }
+    xSemaphoreGive(s_dispatch_mutex);
+}
+
+/**
+ * 取出优先级最高的待执行指令
+ */
+static bool dequeue_command(command_exec_item_t* item)
+{
+    for (int priority = 0; priority < CLOUD_CMD_PRIORITY_COUNT; priority++) {
+        if (xQueueReceive(s_exec_queues[priority], item, 0) == pdTRUE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 记录单条指令的排队与执行耗时
+ */
+static void record_command_exec(cloud_command_type_t type, uint32_t queue_us, uint32_t exec_us)
+{
+    cloud_command_type_stats_t *stats = &s_exec_stats.types[type];
+
+    taskENTER_CRITICAL(&s_command_stats_lock);
+    stats->executed++;
+    s_exec_queue_sum_us[type] += queue_us;
+    s_exec_run_sum_us[type] += exec_us;
+
+    stats->last_queue_us = queue_us;
+    stats->avg_queue_us = (uint32_t)(s_exec_queue_sum_us[type] / stats->executed);
+    if (queue_us > stats->max_queue_us) {
+        stats->max_queue_us = queue_us;
+    }
+    stats->last_exec_us = exec_us;
+    stats->avg_exec_us = (uint32_t)(s_exec_run_sum_us[type] / stats->executed);
+    if (exec_us > stats->max_exec_us) {
+        stats->max_exec_us = exec_us;
+    }
+    s_exec_stats.executed++;
+    taskEXIT_CRITICAL(&s_command_stats_lock);
+}
+
+/**
+ * OTA指令：参数复制后交给OTA任务，下载进度与结果由OTA任务反馈
+ */
+static void execute_ota_command(const cloud_command_t* command)
+{
+#if !ENABLE_CLOUD_OTA
+    ESP_LOGW(TAG, "⚠️ 云端OTA已禁用，忽略升级指令");
+    cloud_client_send_command_feedback(command->command_id, "failed", "Cloud OTA disabled");
+    return;
+#endif
+    ESP_LOGI(TAG, "🚀 收到OTA升级指令: %s", command->command_id);
+
+    esp_err_t ret = submit_ota_job(command->command_id, command->data, command->data_len);
+    if (ret != ESP_OK) {
+        char error_msg[80];
+        if (ret == ESP_ERR_INVALID_STATE) {
+            snprintf(error_msg, sizeof(error_msg), "已有OTA升级进行中 (%.40s)", s_ota_job_stats.command_id);
+        } else {
+            snprintf(error_msg, sizeof(error_msg), "OTA升级失败: %s", esp_err_to_name(ret));
+        }
+        cloud_client_send_command_feedback(command->command_id, "failed", error_msg);
+    }
+}
+
+/**
+ * 执行一条出队的指令
+ */
+static void execute_command(command_exec_item_t* item)
+{
+    cloud_command_t *command = &item->command;
+    command->data = command->data_len > 0 ? item->data : NULL;
+
+    int64_t start = esp_timer_get_time();
+    uint32_t queue_us = (uint32_t)(start - item->enqueued_us);
+    ESP_LOGI(TAG, "🔧 执行指令 %s (%s, 排队 %" PRIu32 "us)",
+             command->command_id, cloud_client_command_type_name(command->command), queue_us);
+
+    if (command->command == CLOUD_CMD_OTA_UPDATE) {
+        execute_ota_command(command);
+    } else if (command->command == CLOUD_CMD_UNKNOWN) {
+        cloud_client_send_command_feedback(command->command_id, "failed", "不支持的指令类型");
+    } else if (s_command_callback) {
+        cloud_client_send_command_feedback(command->command_id, "processing", NULL);
+        s_command_callback(command);
+        cloud_client_send_command_feedback(command->command_id, "completed", NULL);
+    } else {
+        cloud_client_send_command_feedback(command->command_id, "failed", "设备未注册指令处理");
+    }
+
+    record_command_exec(command->command, queue_us, (uint32_t)(esp_timer_get_time() - start));
+}
+
+/**
+ * 指令执行任务：按优先级执行队列中的指令，队列清空（或到达上报周期）后批量上报反馈
+ */
+static void command_exec_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "⚙️ 指令执行任务已启动 (反馈批量周期: %dms)", COMMAND_FEEDBACK_FLUSH_MS);
+
+    while (s_client_running) {
+        if (xSemaphoreTake(s_exec_signal, pdMS_TO_TICKS(COMMAND_FEEDBACK_FLUSH_MS)) == pdTRUE &&
+            dequeue_command(&s_exec_item)) {
+            execute_command(&s_exec_item);
+
+            // 还有排队指令时先继续执行，本周期的反馈合并到一次上报
+            bool flush_due = s_feedback_first_us > 0 &&
+                             esp_timer_get_time() - s_feedback_first_us >= (int64_t)COMMAND_FEEDBACK_FLUSH_MS * 1000;
+            if (uxSemaphoreGetCount(s_exec_signal) > 0 && !flush_due) {
+                continue;
+            }
+        }
+        flush_command_feedback(false);
+    }
+
+    flush_command_feedback(false);
+    ESP_LOGI(TAG, "⚙️ 指令执行任务已停止");
+    s_exec_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+/**
+ * 在列表中查找指令的反馈条目
+ */
+static command_feedback_t* find_feedback(command_feedback_t* list, int count, const char* command_id)
+{
+    for (int i = 0; i < count; i++) {
+        if (strcmp(list[i].command_id, command_id) == 0) {
+            return &list[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_terminal_feedback(const char* status)
+{
+    return strcmp(status, "completed") == 0 || strcmp(status, "failed") == 0;
+}
+
+/**
+ * 批量上报待发送的指令反馈；失败时放回待上报列表，下个周期重发
+ * @param force 忽略失败后的重试间隔；等待正在进行的上报结束后再检查待上报列表，
+ *              确保调用前提交的反馈已送达或由本次发送
+ */
+static esp_err_t flush_command_feedback(bool force)
+{
+    if (!force && s_feedback_pending_count == 0) {
+        return ESP_OK;
+    }
+    if (!wifi_manager_is_connected()) {
+        return ESP_ERR_WIFI_NOT_CONNECT;
+    }
+    if (!force && esp_timer_get_time() < s_feedback_retry_us) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_feedback_flush_mutex, portMAX_DELAY);
+
+    xSemaphoreTake(s_feedback_mutex, portMAX_DELAY);
+    int count = s_feedback_pending_count;
+    memcpy(s_feedback_inflight, s_feedback_pending, count * sizeof(command_feedback_t));
+    s_feedback_pending_count = 0;
+    s_feedback_first_us = 0;
+    xSemaphoreGive(s_feedback_mutex);
+
+    if (count == 0) {
+        xSemaphoreGive(s_feedback_flush_mutex);
+        return ESP_OK;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, s_feedback_json_buffer, sizeof(s_feedback_json_buffer));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "deviceId", s_device_info.device_id);
+    json_writer_begin_array(&w, "updates");
+    for (int i = 0; i < count; i++) {
+        json_writer_begin_object(&w, NULL);
+        json_writer_string(&w, "commandId", s_feedback_inflight[i].command_id);
+        json_writer_string(&w, "status", s_feedback_inflight[i].status);
+        if (s_feedback_inflight[i].message[0]) {
+            json_writer_string(&w, "message", s_feedback_inflight[i].message);
+        }
+        json_writer_end_object(&w);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+
+    size_t json_len = 0;
+    esp_err_t ret = json_writer_finish(&w, &json_len);
+    if (ret == ESP_OK) {
+        char url[256];
+        snprintf(url, sizeof(url), "%s/api/device-commands/feedback/batch", CLOUD_SERVER_URL);
+        ret = send_http_post(url, s_feedback_json_buffer);
+    }
+
+    if (ret == ESP_OK) {
+        s_feedback_retry_us = 0;
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        s_exec_stats.feedback_batches++;
+        s_exec_stats.feedback_sent += (uint32_t)count;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+        ESP_LOGI(TAG, "✅ 指令反馈批量发送成功 (%d条)", count);
+    } else {
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        s_exec_stats.feedback_failed++;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+        s_feedback_retry_us = esp_timer_get_time() + (int64_t)RETRY_DELAY_MS * 1000;
+        ESP_LOGW(TAG, "⚠️ 指令反馈批量发送失败: %s，%d秒后重发", esp_err_to_name(ret), RETRY_DELAY_MS / 1000);
+
+        // 放回列表头部；期间已有同一指令的新状态时以新状态为准
+        xSemaphoreTake(s_feedback_mutex, portMAX_DELAY);
+        int keep = 0;
+        for (int i = 0; i < count; i++) {
+            if (!find_feedback(s_feedback_pending, s_feedback_pending_count, s_feedback_inflight[i].command_id)) {
+                s_feedback_inflight[keep++] = s_feedback_inflight[i];
+            }
+        }
+        if (keep + s_feedback_pending_count > COMMAND_FEEDBACK_MAX_PENDING) {
+            taskENTER_CRITICAL(&s_command_stats_lock);
+            s_exec_stats.feedback_dropped += (uint32_t)(keep + s_feedback_pending_count - COMMAND_FEEDBACK_MAX_PENDING);
+            taskEXIT_CRITICAL(&s_command_stats_lock);
+            keep = COMMAND_FEEDBACK_MAX_PENDING - s_feedback_pending_count;
+        }
+        memmove(&s_feedback_pending[keep], s_feedback_pending, s_feedback_pending_count * sizeof(command_feedback_t));
+        memcpy(s_feedback_pending, s_feedback_inflight, keep * sizeof(command_feedback_t));
+        s_feedback_pending_count += keep;
+        if (s_feedback_pending_count > 0) {
+            s_feedback_first_us = esp_timer_get_time();
+        }
+        xSemaphoreGive(s_feedback_mutex);
+    }
+
+    xSemaphoreGive(s_feedback_flush_mutex);
+    return ret;
+}
+
+/**
+ * 重启前同步上报终态反馈（有限次重试），不等待执行任务的上报周期与重试间隔
+ */
+static esp_err_t flush_command_feedback_before_restart(void)
+{
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 0; attempt < COMMAND_FEEDBACK_FINAL_ATTEMPTS; attempt++) {
+        ret = flush_command_feedback(true);
+        if (ret == ESP_OK || attempt + 1 == COMMAND_FEEDBACK_FINAL_ATTEMPTS) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(COMMAND_FEEDBACK_FINAL_RETRY_MS));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 重启前指令反馈上报失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
 /**
  * 发送HTTP POST请求
  */
@@ -121,33 +685,24 @@ static esp_err_t send_http_post(const char* url, const char* data)
     s_response_len = 0;
     memset(s_response_buffer, 0, sizeof(s_response_buffer));
     
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = 10000,
-        .buffer_size = 1024,
-        .buffer_size_tx = 1024,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
+    esp_http_client_handle_t client = http_client_pool_acquire(url, http_event_handler);
     if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        ESP_LOGE(TAG, "Failed to acquire HTTP client");
         return ESP_FAIL;
     }
     
     esp_http_client_set_method(client, HTTP_METHOD_POST);
     esp_http_client_set_header(client, "Content-Type", "application/json");
     esp_http_client_set_header(client, "User-Agent", "ESP32-CloudClient/1.0");
-    esp_http_client_set_header(client, "Connection", "close");
     
     esp_err_t err = esp_http_client_set_post_field(client, data, strlen(data));
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set POST data: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
+        http_client_pool_release(client);
         return err;
     }
     
-    err = esp_http_client_perform(client);
+    err = http_client_pool_perform(client, NULL);
     if (err == ESP_OK) {
         int status_code = esp_http_client_get_status_code(client);
         ESP_LOGI(TAG, "HTTP POST Status = %d, content_length = %lld",
@@ -163,7 +718,7 @@ static esp_err_t send_http_post(const char* url, const char* data)
         ESP_LOGE(TAG, "HTTP POST request failed: %s", esp_err_to_name(err));
     }
     
-    esp_http_client_cleanup(client);
+    http_client_pool_release(client);
     return err;
 }
 
@@ -188,22 +743,161 @@ static esp_err_t collect_current_status(device_status_data_t* status)
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 检查可用内存
-    uint32_t free_heap = esp_get_free_heap_size();
-    if (free_heap < 30 * 1024) { // 至少需要30KB可用内存
-        ESP_LOGW(TAG, "⚠️ 可用内存不足 (%lu KB)，跳过状态收集", (unsigned long)free_heap / 1024);
-        return ESP_ERR_NO_MEM;
+    // 读取共享状态快照（由 device_state 发布任务统一采集）
+    esp_err_t ret = device_state_get_status(status);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 设备状态快照尚未发布");
+    }
+
+    return ret;
+}
+
+#if TELEMETRY_STORE_ENABLE
+/**
+ * 将无法实时上报的状态样本写入离线存储
+ */
+static void record_telemetry_sample(const device_status_data_t* status)
+{
+    if (!telemetry_store_is_ready()) {
+        return;
+    }
+
+    telemetry_sample_t sample = {
+        .timestamp_ms = current_unix_ms(),
+        .boot_id = s_boot_id,
+        .status = *status,
+    };
+    if (telemetry_store_append(&sample, sizeof(sample)) == ESP_OK) {
+        ESP_LOGD(TAG, "💾 状态样本已离线保存 (待上传 %" PRIu32 ")", telemetry_store_pending());
+    }
+}
+
+/**
+ * 上传一批离线样本，服务器确认后才前移存储游标
+ */
+static esp_err_t upload_telemetry_batch(int* uploaded)
+{
+    *uploaded = 0;
+
+    telemetry_cursor_t next;
+    int count = telemetry_store_peek(s_upload_samples, sizeof(telemetry_sample_t),
+                                     TELEMETRY_UPLOAD_BATCH, &next);
+    if (count == 0) {
+        return ESP_OK;
     }
 
-    // 使用数据集成模块收集状态
-    esp_err_t ret = data_integration_collect_status(status);
+    uint64_t now_ms = current_unix_ms();
+    uint32_t uptime_now = (uint32_t)(esp_timer_get_time() / 1000000);
+
+    json_writer_t w;
+    json_writer_init(&w, s_batch_json_buffer, sizeof(s_batch_json_buffer));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "deviceId", s_device_info.device_id);
+    json_writer_begin_array(&w, "samples");
+    for (int i = 0; i < count; i++) {
+        const telemetry_sample_t *sample = &s_upload_samples[i];
+        uint64_t timestamp_ms = sample->timestamp_ms;
+
+        // 采样时时钟未同步：同一次启动内按运行时间差补算
+        if (timestamp_ms == 0 && now_ms > 0 && sample->boot_id == s_boot_id &&
+            uptime_now >= sample->status.uptime_seconds) {
+            timestamp_ms = now_ms - (uint64_t)(uptime_now - sample->status.uptime_seconds) * 1000;
+        }
+
+        json_writer_begin_object(&w, NULL);
+        if (timestamp_ms > 0) {
+            json_writer_uint(&w, "timestamp_ms", timestamp_ms);
+        } else {
+            json_writer_null(&w, "timestamp_ms");
+        }
+        write_status_fields(&w, &sample->status);
+        json_writer_end_object(&w);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+
+    size_t json_len = 0;
+    esp_err_t ret = json_writer_finish(&w, &json_len);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "❌ 数据集成收集失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "❌ 序列化离线样本批次失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    char url[256];
+    snprintf(url, sizeof(url), "%s/device-status/batch", CLOUD_SERVER_URL);
+    esp_http_client_handle_t client = http_client_pool_acquire(url, NULL);
+    if (!client) {
+        return ESP_FAIL;
+    }
+
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+    ret = add_auth_headers(client);
+    if (ret == ESP_OK) {
+        ret = esp_http_client_set_post_field(client, s_batch_json_buffer, (int)json_len);
+    }
+    if (ret == ESP_OK) {
+        ret = http_client_pool_perform(client, NULL);
+    }
+    if (ret == ESP_OK) {
+        int status_code = esp_http_client_get_status_code(client);
+        if (status_code == 200) {
+            telemetry_store_commit(&next, (uint32_t)count);
+            *uploaded = count;
+        } else {
+            // 429/503 等表示服务器繁忙，由调用方退避
+            ESP_LOGW(TAG, "⚠️ 离线样本回补被拒绝，HTTP状态码: %d", status_code);
+            ret = ESP_FAIL;
+        }
     }
 
+    http_client_pool_release(client);
     return ret;
 }
 
+/**
+ * 回补离线样本：按批次限速上传，失败或服务器限流时指数退避
+ */
+static void drain_telemetry_backlog(void)
+{
+    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (telemetry_store_pending() == 0 || (int32_t)(current_time - s_next_upload_time) < 0) {
+        return;
+    }
+
+    int total = 0;
+    for (int batch = 0; batch < TELEMETRY_UPLOAD_MAX_BATCHES; batch++) {
+        if (!s_client_running || !wifi_manager_is_connected() || telemetry_store_pending() == 0) {
+            break;
+        }
+        if (batch > 0) {
+            vTaskDelay(pdMS_TO_TICKS(TELEMETRY_UPLOAD_INTERVAL_MS));
+        }
+
+        int uploaded = 0;
+        esp_err_t ret = upload_telemetry_batch(&uploaded);
+        if (ret != ESP_OK) {
+            s_upload_backoff_ms = s_upload_backoff_ms ? s_upload_backoff_ms * 2 : RETRY_DELAY_MS;
+            if (s_upload_backoff_ms > TELEMETRY_BACKOFF_MAX_MS) {
+                s_upload_backoff_ms = TELEMETRY_BACKOFF_MAX_MS;
+            }
+            s_next_upload_time = xTaskGetTickCount() * portTICK_PERIOD_MS + s_upload_backoff_ms;
+            ESP_LOGW(TAG, "⚠️ 离线样本回补失败，%" PRIu32 "秒后重试 (待上传 %" PRIu32 ")",
+                     s_upload_backoff_ms / 1000, telemetry_store_pending());
+            break;
+        }
+        s_upload_backoff_ms = 0;
+        if (uploaded == 0) {
+            break;
+        }
+        total += uploaded;
+    }
+
+    if (total > 0) {
+        ESP_LOGI(TAG, "📤 已回补 %d 个离线样本 (剩余 %" PRIu32 ")", total, telemetry_store_pending());
+    }
+}
+#endif
+
 /**
  * 状态上报任务
  */
@@ -217,10 +911,23 @@ static void status_task(void *pvParameters)
     vTaskDelay(pdMS_TO_TICKS(5000)); // 等待5秒
     ESP_LOGI(TAG, "✅ 系统稳定，开始状态上报");
 
+#if TELEMETRY_STORE_ENABLE
+    // 挂载离线存储（首次使用需格式化分区，放在后台任务中进行）
+    if (s_boot_id == 0) {
+        s_boot_id = esp_random() | 1U;
+    }
+    if (telemetry_store_init() != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 离线遥测存储不可用，断网期间的状态将被丢弃");
+    }
+#endif
+
     device_status_data_t status_data;
     uint32_t report_count = 0;
     uint32_t success_count = 0;
     uint32_t error_count = 0;
+#if STATUS_BINARY_ENABLE
+    bool encoding_benchmarked = false;
+#endif
 
     while (s_client_running) {
         if (wifi_manager_is_connected()) {
@@ -231,6 +938,12 @@ static void status_task(void *pvParameters)
 
             // 收集设备状态
             esp_err_t ret = collect_current_status(&status_data);
+#if STATUS_BINARY_ENABLE
+            if (ret == ESP_OK && !encoding_benchmarked) {
+                benchmark_status_encoding(&status_data);
+                encoding_benchmarked = true;
+            }
+#endif
             if (ret == ESP_OK) {
                 ESP_LOGD(TAG, "📊 状态数据收集成功 - 堆内存: %" PRIu32 ", 运行时间: %" PRIu32 "s, WiFi: %s",
                          status_data.free_heap,
@@ -250,6 +963,15 @@ static void status_task(void *pvParameters)
                     ESP_LOGI(TAG, "✅ 状态上报成功 [%" PRIu32 "/%" PRIu32 "] - 成功率: %.1f%%",
                              success_count, report_count + 1,
                              (float)success_count / (report_count + 1) * 100);
+
+                    if (success_count % CLOUD_HTTP_DIAG_REPORTS == 0) {
+                        http_client_pool_print_diag();
+                    }
+
+#if TELEMETRY_STORE_ENABLE
+                    // 链路恢复：回补断网期间保存的样本
+                    drain_telemetry_backlog();
+#endif
                 } else {
                     s_client_connected = false;
                     s_device_info.network_status = NETWORK_ERROR;
@@ -259,6 +981,10 @@ static void status_task(void *pvParameters)
                              error_count, report_count + 1,
                              cloud_client_get_last_error());
 
+#if TELEMETRY_STORE_ENABLE
+                    record_telemetry_sample(&status_data);
+#endif
+
                     // 尝试重连
                     if (s_retry_count < MAX_RETRY_ATTEMPTS) {
                         ESP_LOGI(TAG, "🔄 尝试重连 (第%" PRIu32 "次)...", s_retry_count + 1);
@@ -277,11 +1003,26 @@ static void status_task(void *pvParameters)
             s_client_connected = false;
             s_device_info.network_status = NETWORK_DISCONNECTED;
             ESP_LOGW(TAG, "📡 Wi-Fi未连接，跳过状态上报");
+
+            // 断网后原有连接已失效
+            http_client_pool_close_idle();
+
+#if TELEMETRY_STORE_ENABLE
+            // 断网期间的状态写入离线存储，恢复后回补
+            if (collect_current_status(&status_data) == ESP_OK) {
+                record_telemetry_sample(&status_data);
+            }
+#endif
         }
 
         // 等待下次上报 - 减少日志频率
-        ESP_LOGV(TAG, "⏳ 等待%d秒后进行下次上报...", DEVICE_STATUS_INTERVAL_MS / 1000);
-        vTaskDelay(pdMS_TO_TICKS(DEVICE_STATUS_INTERVAL_MS));
+#if TELEMETRY_STORE_ENABLE
+        uint32_t interval_ms = wifi_manager_is_connected() ? DEVICE_STATUS_INTERVAL_MS : TELEMETRY_SAMPLE_INTERVAL_MS;
+#else
+        uint32_t interval_ms = DEVICE_STATUS_INTERVAL_MS;
+#endif
+        ESP_LOGV(TAG, "⏳ 等待%" PRIu32 "秒后进行下次上报...", interval_ms / 1000);
+        vTaskDelay(pdMS_TO_TICKS(interval_ms));
     }
 
     ESP_LOGI(TAG, "📊 状态上报任务已停止");
@@ -294,9 +1035,14 @@ static void status_task(void *pvParameters)
 
 /**
  * 主动获取待处理指令
+ * @param wait_s 长轮询挂起时间（0=普通查询）
+ * @param long_poll_ack 输出服务器是否确认长轮询，可为NULL
  */
-static esp_err_t fetch_pending_commands(void)
+static esp_err_t fetch_pending_commands(uint32_t wait_s, bool* long_poll_ack)
 {
+    if (long_poll_ack) {
+        *long_poll_ack = false;
+    }
     if (!wifi_manager_is_connected()) {
         return ESP_ERR_WIFI_NOT_CONNECT;
     }
@@ -305,11 +1051,16 @@ static esp_err_t fetch_pending_commands(void)
 
     // 构建请求URL
     char url[256];
-    snprintf(url, sizeof(url), "%s/api/device-commands/%s/pending",
-             CLOUD_SERVER_URL, s_device_info.device_id);
+    if (wait_s > 0) {
+        snprintf(url, sizeof(url), "%s/api/device-commands/%s/pending?wait=%" PRIu32,
+                 CLOUD_SERVER_URL, s_device_info.device_id, wait_s);
+    } else {
+        snprintf(url, sizeof(url), "%s/api/device-commands/%s/pending",
+                 CLOUD_SERVER_URL, s_device_info.device_id);
+    }
 
-    // 创建HTTP客户端
-    esp_http_client_handle_t client = create_http_client(url);
+    // 获取指令轮询专用的长连接HTTP客户端（长轮询挂起期间不占用共享客户端）
+    esp_http_client_handle_t client = http_client_pool_acquire_dedicated(url, command_event_handler);
     if (!client) {
         ESP_LOGE(TAG, "❌ 创建HTTP客户端失败");
         return ESP_FAIL;
@@ -319,14 +1070,19 @@ static esp_err_t fetch_pending_commands(void)
 
     // 设置请求方法和头部
     esp_http_client_set_method(client, HTTP_METHOD_GET);
+    if (wait_s > 0) {
+        // 请求超时须长于服务器挂起时间
+        esp_http_client_set_timeout_ms(client, (int)(wait_s * 1000) + HTTP_POOL_TIMEOUT_MS);
+    }
     ret = add_auth_headers(client);
 
     if (ret == ESP_OK) {
         // 清空响应缓冲区
-        s_response_len = 0;
-        memset(s_response_buffer, 0, sizeof(s_response_buffer));
+        s_command_response_len = 0;
+        memset(s_command_response_buffer, 0, sizeof(s_command_response_buffer));
 
-        ret = esp_http_client_perform(client);
+        ret = http_client_pool_perform(client, NULL);
+        int64_t received_us = esp_timer_get_time();
         if (ret == ESP_OK) {
             int status_code = esp_http_client_get_status_code(client);
             if (status_code == 200) {
@@ -334,19 +1090,19 @@ static esp_err_t fetch_pending_commands(void)
 
                 // 处理响应中的指令
                 cloud_command_t commands[MAX_COMMANDS_PER_REQUEST];
-                int command_count = cloud_client_get_commands(commands, MAX_COMMANDS_PER_REQUEST);
+                int command_count = parse_commands(s_command_response_buffer, (size_t)s_command_response_len,
+                                                   commands, MAX_COMMANDS_PER_REQUEST, long_poll_ack);
 
                 if (command_count > 0) {
                     ESP_LOGI(TAG, "📤 获取到 %d 个待处理指令", command_count);
+                    if (s_parse_stats.bench_bytes == 0) {
+                        benchmark_command_parsing(s_command_response_buffer, (size_t)s_command_response_len);
+                    }
 
-                    // 处理每个指令
                     for (int i = 0; i < command_count; i++) {
                         ESP_LOGI(TAG, "🔧 处理指令: %" PRIu32 ", 类型: %d", commands[i].id, commands[i].command);
-
-                        if (s_command_callback) {
-                            s_command_callback(&commands[i]);
-                        }
                     }
+                    dispatch_commands(commands, command_count, received_us);
                 } else {
                     ESP_LOGD(TAG, "📭 没有待处理指令");
                 }
@@ -359,7 +1115,7 @@ static esp_err_t fetch_pending_commands(void)
         }
     }
 
-    esp_http_client_cleanup(client);
+    http_client_pool_release(client);
     return ret;
 }
 
@@ -369,7 +1125,11 @@ static esp_err_t fetch_pending_commands(void)
 static void command_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "📋 指令轮询任务已启动");
+#if COMMAND_LONG_POLL_ENABLE
+    ESP_LOGI(TAG, "⏰ 长轮询挂起: %d秒 (回退轮询间隔: %d秒)", COMMAND_LONG_POLL_WAIT_S, COMMAND_POLL_INTERVAL_MS / 1000);
+#else
     ESP_LOGI(TAG, "⏰ 轮询间隔: %d秒", COMMAND_POLL_INTERVAL_MS / 1000);
+#endif
 
     // 等待系统完全初始化 - 防止启动时的内存访问冲突
     ESP_LOGI(TAG, "⏳ 等待系统稳定...");
@@ -377,14 +1137,60 @@ static void command_task(void *pvParameters)
     ESP_LOGI(TAG, "✅ 系统稳定，开始指令轮询");
 
     uint32_t poll_count = 0;
+#if COMMAND_LONG_POLL_ENABLE
+    bool long_poll = true;
+    uint32_t long_poll_failures = 0;
+    uint32_t long_poll_retry_time = 0;
+    taskENTER_CRITICAL(&s_command_stats_lock);
+    s_latency_stats.long_poll_active = true;
+    taskEXIT_CRITICAL(&s_command_stats_lock);
+#endif
 
     while (s_client_running) {
         if (wifi_manager_is_connected() && s_client_connected) {
             poll_count++;
             ESP_LOGV(TAG, "🔍 第%" PRIu32 "次指令轮询...", poll_count);
 
+#if COMMAND_LONG_POLL_ENABLE
+            uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            if (!long_poll && (int32_t)(current_time - long_poll_retry_time) >= 0) {
+                ESP_LOGI(TAG, "🔄 重新尝试长轮询指令通道");
+                long_poll = true;
+            }
+
+            if (long_poll) {
+                // 服务器挂起请求直到有新指令或超时，返回后立即重新挂起
+                bool ack = false;
+                esp_err_t ret = fetch_pending_commands(COMMAND_LONG_POLL_WAIT_S, &ack);
+                if (ret == ESP_OK && ack) {
+                    long_poll_failures = 0;
+                    taskENTER_CRITICAL(&s_command_stats_lock);
+                    s_latency_stats.long_poll_active = true;
+                    taskEXIT_CRITICAL(&s_command_stats_lock);
+                    continue;
+                }
+
+                // 服务器未确认长轮询（旧版本）立即回退；请求失败累计到阈值再回退
+                if (ret == ESP_OK || ++long_poll_failures >= COMMAND_LONG_POLL_FAIL_LIMIT) {
+                    ESP_LOGW(TAG, "⚠️ 长轮询不可用 (%s)，回退到%d秒周期轮询",
+                             ret == ESP_OK ? "服务器未确认" : esp_err_to_name(ret),
+                             COMMAND_POLL_INTERVAL_MS / 1000);
+                    long_poll = false;
+                    long_poll_failures = 0;
+                    long_poll_retry_time = current_time + COMMAND_LONG_POLL_RETRY_MS;
+                    taskENTER_CRITICAL(&s_command_stats_lock);
+                    s_latency_stats.long_poll_active = false;
+                    s_latency_stats.long_poll_fallbacks++;
+                    taskEXIT_CRITICAL(&s_command_stats_lock);
+                } else {
+                    vTaskDelay(pdMS_TO_TICKS(RETRY_DELAY_MS));
+                    continue;
+                }
+            }
+#endif
+
             // 主动获取待处理指令
-            esp_err_t ret = fetch_pending_commands();
+            esp_err_t ret = fetch_pending_commands(0, NULL);
             if (ret != ESP_OK) {
                 ESP_LOGV(TAG, "⚠️ 指令轮询失败: %s", esp_err_to_name(ret));
             }
@@ -409,6 +1215,12 @@ esp_err_t cloud_client_init(void)
     ESP_LOGI(TAG, "📍 服务器地址: %s", CLOUD_SERVER_URL);
     ESP_LOGI(TAG, "📍 Supabase项目: %s", SUPABASE_PROJECT_URL);
 
+    // 云端请求复用长连接
+    esp_err_t pool_ret = http_client_pool_init();
+    if (pool_ret != ESP_OK) {
+        return pool_ret;
+    }
+
     // 生成设备ID
     generate_device_id(s_device_info.device_id, sizeof(s_device_info.device_id));
     ESP_LOGI(TAG, "🆔 生成设备ID: %s", s_device_info.device_id);
@@ -439,6 +1251,27 @@ esp_err_t cloud_client_init(void)
     // 初始化错误信息
     memset(s_last_error, 0, sizeof(s_last_error));
 
+    // 指令执行队列与反馈合并
+    for (int priority = 0; priority < CLOUD_CMD_PRIORITY_COUNT; priority++) {
+        s_exec_queues[priority] = xQueueCreate(COMMAND_EXEC_QUEUE_DEPTH, sizeof(command_exec_item_t));
+        if (!s_exec_queues[priority]) {
+            ESP_LOGE(TAG, "❌ 创建指令执行队列失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_exec_signal = xSemaphoreCreateCounting(COMMAND_EXEC_QUEUE_DEPTH * CLOUD_CMD_PRIORITY_COUNT, 0);
+    s_feedback_mutex = xSemaphoreCreateMutex();
+    s_feedback_flush_mutex = xSemaphoreCreateMutex();
+    s_dispatch_mutex = xSemaphoreCreateMutex();
+    if (!s_exec_signal || !s_feedback_mutex || !s_feedback_flush_mutex || !s_dispatch_mutex) {
+        ESP_LOGE(TAG, "❌ 创建指令执行同步对象失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+#if STATUS_BINARY_ENABLE
+    status_codec_init(&s_status_codec);
+#endif
+
     ESP_LOGI(TAG, "✅ 云客户端初始化完成");
     ESP_LOGI(TAG, "⚙️ 状态上报间隔: %d秒", DEVICE_STATUS_INTERVAL_MS / 1000);
     ESP_LOGI(TAG, "⚙️ 指令轮询间隔: %d秒", COMMAND_POLL_INTERVAL_MS / 1000);
@@ -490,6 +1323,16 @@ esp_err_t cloud_client_start(void)
     }
     ESP_LOGI(TAG, "✅ 指令轮询任务创建成功");
 
+    // 创建指令执行任务（按优先级执行指令，批量上报反馈）
+    ret = xTaskCreate(command_exec_task, "cloud_cmd_exec", COMMAND_EXEC_TASK_STACK_SIZE, NULL,
+                      COMMAND_EXEC_TASK_PRIORITY, &s_exec_task_handle);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建指令执行任务失败");
+        s_client_running = false;
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "✅ 指令执行任务创建成功");
+
     ESP_LOGI(TAG, "✅ 云客户端启动成功");
     ESP_LOGI(TAG, "🔄 后台任务已开始运行");
 
@@ -512,7 +1355,7 @@ esp_err_t cloud_client_stop(void)
 
     // 等待任务结束
     int timeout = 50; // 5秒超时
-    while ((s_status_task_handle || s_command_task_handle) && timeout > 0) {
+    while ((s_status_task_handle || s_command_task_handle || s_exec_task_handle) && timeout > 0) {
         vTaskDelay(pdMS_TO_TICKS(100));
         timeout--;
     }
@@ -521,6 +1364,8 @@ esp_err_t cloud_client_stop(void)
         ESP_LOGW(TAG, "⚠️ 任务停止超时");
     }
 
+    http_client_pool_close_idle();
+
     ESP_LOGI(TAG, "✅ 云客户端已停止");
     return ESP_OK;
 }
@@ -693,111 +1538,218 @@ static cloud_command_type_t parse_command_type(const char* command_str)
         return CLOUD_CMD_UNKNOWN;
     }
 
-    if (strcmp(command_str, "sbus_update") == 0) {
-        return CLOUD_CMD_SBUS_UPDATE;
-    } else if (strcmp(command_str, "motor_control") == 0) {
-        return CLOUD_CMD_MOTOR_CONTROL;
-    } else if (strcmp(command_str, "wifi_config") == 0) {
-        return CLOUD_CMD_WIFI_CONFIG;
-    } else if (strcmp(command_str, "ota_update") == 0) {
-        return CLOUD_CMD_OTA_UPDATE;
-    } else if (strcmp(command_str, "reboot") == 0) {
-        return CLOUD_CMD_REBOOT;
+    for (int type = CLOUD_CMD_UNKNOWN + 1; type < CLOUD_CMD_TYPE_COUNT; type++) {
+        if (strcmp(command_str, s_command_type_names[type]) == 0) {
+            return (cloud_command_type_t)type;
+        }
     }
 
     return CLOUD_CMD_UNKNOWN;
 }
 
 /**
- * 处理OTA升级指令
+ * 执行OTA任务：检查版本与内存后下载安装，中断时从断点续传
  */
-static esp_err_t handle_ota_command(const cJSON* data)
+static esp_err_t run_ota_job(const ota_job_t* job)
 {
     ESP_LOGI(TAG, "🚀 开始处理OTA升级指令");
+    ESP_LOGI(TAG, "📦 OTA升级参数:");
+    ESP_LOGI(TAG, "   📍 固件URL: %s", job->url);
+    ESP_LOGI(TAG, "   📏 固件大小: %lu bytes (%.2f KB)", (unsigned long)job->size, (float)job->size / 1024.0);
+    ESP_LOGI(TAG, "   🏷️ 固件版本: %s", job->version);
+    if (job->hash[0]) {
+        ESP_LOGI(TAG, "   🔐 固件哈希: %.16s...", job->hash);
+    }
 
-#if !ENABLE_CLOUD_OTA
-    (void)data;
-    ESP_LOGW(TAG, "⚠️ 云端OTA已禁用，拒绝执行指令");
-    return ESP_ERR_NOT_SUPPORTED;
-#endif
+    // 检查当前固件版本
+    ESP_LOGI(TAG, "🔍 当前固件版本: %s", s_device_info.firmware_version);
+    if (strcmp(job->version, s_device_info.firmware_version) == 0) {
+        ESP_LOGW(TAG, "⚠️ 目标版本与当前版本相同，跳过升级");
+        cloud_client_send_command_feedback(job->command_id, "completed", "目标版本与当前版本相同，无需升级");
+        return ESP_OK;
+    }
 
-    if (!data) {
-        ESP_LOGE(TAG, "❌ OTA指令数据为空");
-        return ESP_ERR_INVALID_ARG;
+    // 检查可用内存
+    uint32_t free_heap = esp_get_free_heap_size();
+    ESP_LOGI(TAG, "💾 当前可用内存: %lu bytes (%.2f KB)", (unsigned long)free_heap, (float)free_heap / 1024.0);
+
+    if (free_heap < 100 * 1024) { // 至少需要100KB可用内存
+        ESP_LOGE(TAG, "❌ 可用内存不足，无法进行OTA升级");
+        return ESP_ERR_NO_MEM;
     }
 
-    // 解析OTA参数
-    cJSON *firmware_url = cJSON_GetObjectItem(data, "firmware_url");
-    cJSON *firmware_size = cJSON_GetObjectItem(data, "firmware_size");
-    cJSON *firmware_version = cJSON_GetObjectItem(data, "firmware_version");
-    cJSON *firmware_hash = cJSON_GetObjectItem(data, "firmware_hash");
+    // 发送开始升级状态
+    cloud_client_send_command_feedback(job->command_id, "processing", "开始下载固件");
 
-    if (!firmware_url || !cJSON_IsString(firmware_url)) {
-        ESP_LOGE(TAG, "❌ 固件URL无效或缺失");
-        return ESP_ERR_INVALID_ARG;
+    // 下载并安装固件；中断后从NVS断点续传，已写入的部分不再重新下载
+    ESP_LOGI(TAG, "📥 开始下载并安装固件...");
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 1; attempt <= OTA_DOWNLOAD_MAX_ATTEMPTS; attempt++) {
+        ret = download_and_install_firmware(job);
+        if (ret == ESP_OK || attempt == OTA_DOWNLOAD_MAX_ATTEMPTS) {
+            break;
+        }
+        ESP_LOGW(TAG, "⚠️ 固件下载中断 (%d/%d)，%d 秒后续传",
+                 attempt, OTA_DOWNLOAD_MAX_ATTEMPTS, OTA_DOWNLOAD_RETRY_DELAY_MS / 1000);
+        vTaskDelay(pdMS_TO_TICKS(OTA_DOWNLOAD_RETRY_DELAY_MS));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ OTA升级失败: %s", esp_err_to_name(ret));
+        return ret;
     }
 
-    const char* url = cJSON_GetStringValue(firmware_url);
-    uint32_t size = firmware_size ? (uint32_t)cJSON_GetNumberValue(firmware_size) : 0;
-    const char* version = firmware_version ? cJSON_GetStringValue(firmware_version) : "unknown";
-    const char* hash = firmware_hash ? cJSON_GetStringValue(firmware_hash) : NULL;
+    // 成功时 download_and_install_firmware 已发送完成反馈并重启，不会执行到这里
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "📦 OTA升级参数:");
-    ESP_LOGI(TAG, "   📍 固件URL: %s", url);
-    ESP_LOGI(TAG, "   📏 固件大小: %lu bytes (%.2f KB)", (unsigned long)size, (float)size / 1024.0);
-    ESP_LOGI(TAG, "   🏷️ 固件版本: %s", version);
-    if (hash) {
-        ESP_LOGI(TAG, "   🔐 固件哈希: %.16s...", hash);
+/**
+ * OTA任务：独立于指令轮询执行下载，结束后释放任务参数并退出
+ */
+static void ota_job_task(void *pvParameters)
+{
+    ota_job_t *job = (ota_job_t *)pvParameters;
+
+    cloud_client_send_command_feedback(job->command_id, "received", "OTA指令已接收，开始处理");
+    ota_manager_set_progress_callback(ota_progress_callback);
+
+    esp_err_t ret = run_ota_job(job);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ OTA升级处理失败: %s", esp_err_to_name(ret));
+
+        // 发送失败反馈
+        char error_msg[128];
+        snprintf(error_msg, sizeof(error_msg), "OTA升级失败: %s", esp_err_to_name(ret));
+        cloud_client_send_command_feedback(job->command_id, "failed", error_msg);
     }
 
-    // 检查当前固件版本
-    ESP_LOGI(TAG, "🔍 当前固件版本: %s", s_device_info.firmware_version);
-    if (strcmp(version, s_device_info.firmware_version) == 0) {
-        ESP_LOGW(TAG, "⚠️ 目标版本与当前版本相同，跳过升级");
-        return ESP_OK;
+    ota_manager_set_progress_callback(NULL);
+    s_ota_job_stats.last_result = ret;
+    s_ota_job = NULL;
+    free(job);
+
+    __atomic_store_n(&s_ota_job_stats.active, false, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+/**
+ * 提交OTA任务：从指令数据复制参数后创建OTA任务，调用方无需保留JSON
+ * @return ESP_ERR_INVALID_STATE 已有OTA任务进行中
+ */
+static esp_err_t submit_ota_job(const char* command_id, const char* js, size_t js_len)
+{
+    json_token_t tokens[OTA_JOB_JSON_MAX_TOKENS];
+    int token_count = js ? json_tokenize(js, js_len, tokens, OTA_JOB_JSON_MAX_TOKENS) : JSON_TOK_ERROR_INVAL;
+    if (token_count <= 0 || tokens[0].type != JSON_TOK_OBJECT) {
+        ESP_LOGE(TAG, "❌ OTA指令数据无效 (%d)", token_count);
+        return ESP_ERR_INVALID_ARG;
+    }
+    const int data = 0;
+
+    int firmware_url = json_tok_object_get(js, tokens, token_count, data, "firmware_url");
+    int firmware_size = json_tok_object_get(js, tokens, token_count, data, "firmware_size");
+    int firmware_version = json_tok_object_get(js, tokens, token_count, data, "firmware_version");
+    int firmware_hash = json_tok_object_get(js, tokens, token_count, data, "firmware_hash");
+
+    if (firmware_url < 0 || tokens[firmware_url].type != JSON_TOK_STRING ||
+        tokens[firmware_url].end - tokens[firmware_url].start >= (int)sizeof(((ota_job_t *)0)->url)) {
+        ESP_LOGE(TAG, "❌ 固件URL无效或缺失");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // 检查可用内存
-    uint32_t free_heap = esp_get_free_heap_size();
-    ESP_LOGI(TAG, "💾 当前可用内存: %lu bytes (%.2f KB)", (unsigned long)free_heap, (float)free_heap / 1024.0);
+    if (__atomic_load_n(&s_ota_job_stats.active, __ATOMIC_ACQUIRE)) {
+        ESP_LOGW(TAG, "⚠️ OTA任务进行中 (%s)，拒绝新的升级指令", s_ota_job_stats.command_id);
+        s_ota_job_stats.rejected++;
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    if (free_heap < 100 * 1024) { // 至少需要100KB可用内存
-        ESP_LOGE(TAG, "❌ 可用内存不足，无法进行OTA升级");
+    ota_job_t *job = calloc(1, sizeof(ota_job_t));
+    if (!job) {
         return ESP_ERR_NO_MEM;
     }
 
-    // 发送开始升级状态
-    cloud_client_send_command_feedback(s_current_command_id, "processing", "开始下载固件");
-
-    // 下载并安装固件
-    ESP_LOGI(TAG, "📥 开始下载并安装固件...");
-    esp_err_t ret = download_and_install_firmware(url, size);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "❌ OTA升级失败: %s", esp_err_to_name(ret));
-        return ret;
+    snprintf(job->command_id, sizeof(job->command_id), "%s", command_id);
+    json_tok_copy_string(js, &tokens[firmware_url], job->url, sizeof(job->url));
+    if (firmware_version < 0 || !json_tok_copy_string(js, &tokens[firmware_version], job->version, sizeof(job->version))) {
+        snprintf(job->version, sizeof(job->version), "%s", "unknown");
     }
+    if (firmware_hash >= 0) {
+        json_tok_copy_string(js, &tokens[firmware_hash], job->hash, sizeof(job->hash));
+    }
+    uint64_t size = 0;
+    if (firmware_size >= 0) {
+        json_tok_get_uint64(js, &tokens[firmware_size], &size);
+    }
+    job->size = (uint32_t)size;
 
-    ESP_LOGI(TAG, "✅ OTA升级成功，准备重启应用新固件");
+    s_ota_job = job;
+    s_ota_job_stats.active = true;
+    s_ota_job_stats.progress = 0;
+    s_ota_job_stats.progress_reports = 0;
+    s_ota_job_stats.progress_throttled = 0;
+    s_ota_job_stats.last_result = ESP_OK;
+    snprintf(s_ota_job_stats.command_id, sizeof(s_ota_job_stats.command_id), "%s", command_id);
+    s_ota_last_report_ms = 0;
 
-    // 发送成功状态（在重启前）
-    cloud_client_send_command_feedback(s_current_command_id, "completed", "固件升级成功，即将重启");
+    if (xTaskCreate(ota_job_task, "cloud_ota", OTA_JOB_TASK_STACK_SIZE, job,
+                    OTA_JOB_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建OTA任务失败");
+        s_ota_job = NULL;
+        free(job);
+        s_ota_job_stats.active = false;
+        return ESP_ERR_NO_MEM;
+    }
 
+    s_ota_job_stats.started++;
+    ESP_LOGI(TAG, "🚀 OTA任务已启动: 指令 %s, 版本 %s", job->command_id, job->version);
     return ESP_OK;
 }
 
 /**
- * 从URL下载并安装固件
+ * 解析 Content-Range: bytes start-end/total
+ */
+static bool parse_content_range(const char* value, uint32_t* start, uint32_t* end, uint32_t* total)
+{
+    unsigned long s = 0, e = 0, t = 0;
+    if (sscanf(value, "bytes %lu-%lu/%lu", &s, &e, &t) != 3 || e < s || e >= t) {
+        return false;
+    }
+    *start = (uint32_t)s;
+    *end = (uint32_t)e;
+    *total = (uint32_t)t;
+    return true;
+}
+
+/**
+ * 下载并安装一次固件（allow_resume 时有断点则用 HTTP Range 只下载剩余部分）
+ * @param restart 断点与服务器当前镜像不符、已被清除时置 true，调用方应从头重新下载
  */
-static esp_err_t download_and_install_firmware(const char* url, uint32_t expected_size)
+static esp_err_t download_firmware_once(const ota_job_t* job, bool allow_resume, bool* restart)
 {
+    const char *url = job->url;
+    const char *expected_hash = job->hash;
+    uint32_t expected_size = job->size;
+
+    *restart = false;
     ESP_LOGI(TAG, "📥 开始从URL下载固件: %s", url);
 
+    // 同一固件、同一传输格式的断点才能续传：有哈希时以哈希标识镜像，否则用URL；
+    // 压缩镜像的传输偏移与分区偏移不对应，不续传
+    bool compressed_url = strstr(url, OTA_COMPRESSED_URL_QUERY) != NULL;
+    char image_id[sizeof(job->url) + 8];
+    snprintf(image_id, sizeof(image_id), "%s|%s",
+             (expected_hash && expected_hash[0]) ? expected_hash : url, compressed_url ? "otaz" : "raw");
+    uint32_t resume_offset = (allow_resume && !compressed_url) ?
+                             ota_manager_get_resume_offset(image_id, expected_size) : 0;
+
     // 创建HTTP客户端
+    firmware_response_headers_t headers = {0};
     esp_http_client_config_t config = {
         .url = url,
         .timeout_ms = 30000,
         .buffer_size = 4096,
-        .buffer_size_tx = 1024
+        .buffer_size_tx = 1024,
+        .event_handler = firmware_event_handler,
+        .user_data = &headers
     };
 
     esp_http_client_handle_t client = esp_http_client_init(&config);
@@ -808,8 +1760,15 @@ static esp_err_t download_and_install_firmware(const char* url, uint32_t expecte
 
     esp_err_t ret = ESP_OK;
     int content_length = 0;
+    uint32_t image_size = 0;
     bool ota_started = false;
 
+    if (resume_offset > 0) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)resume_offset);
+        esp_http_client_set_header(client, "Range", range);
+    }
+
     // 发送HTTP请求
     ret = esp_http_client_open(client, 0);
     if (ret != ESP_OK) {
@@ -821,6 +1780,11 @@ static esp_err_t download_and_install_firmware(const char* url, uint32_t expecte
     content_length = esp_http_client_fetch_headers(client);
     if (content_length <= 0) {
         ESP_LOGE(TAG, "❌ 无效的内容长度: %d", content_length);
+        if (resume_offset > 0 && esp_http_client_get_status_code(client) == 416) {
+            // 断点超出服务器上的镜像范围
+            ota_manager_clear_checkpoint();
+            *restart = true;
+        }
         ret = ESP_FAIL;
         goto cleanup;
     }
@@ -829,81 +1793,134 @@ static esp_err_t download_and_install_firmware(const char* url, uint32_t expecte
 
     // 检查HTTP状态码
     int status_code = esp_http_client_get_status_code(client);
-    if (status_code != 200) {
+    if (status_code == 206 && resume_offset > 0) {
+        uint32_t range_start = 0, range_end = 0;
+        bool range_ok = parse_content_range(headers.content_range, &range_start, &range_end, &image_size) &&
+                        range_start == resume_offset && range_end + 1 == image_size &&
+                        (uint32_t)content_length == image_size - resume_offset;
+        // 服务器上的镜像已变更时断点作废
+        bool hash_ok = !expected_hash || !expected_hash[0] || !headers.firmware_hash[0] ||
+                       strcasecmp(headers.firmware_hash, expected_hash) == 0;
+        bool format_ok = strstr(headers.content_type, OTA_COMPRESSED_CONTENT_TYPE) == NULL;
+        if (!range_ok || !hash_ok || !format_ok) {
+            ESP_LOGE(TAG, "❌ 续传响应不匹配 (Content-Range: %s, Content-Type: %s)",
+                     headers.content_range, headers.content_type);
+            ota_manager_clear_checkpoint();
+            *restart = true;
+            ret = ESP_FAIL;
+            goto cleanup;
+        }
+        ESP_LOGI(TAG, "⏯️ 从断点续传: %lu/%lu bytes，剩余 %d bytes",
+                 (unsigned long)resume_offset, (unsigned long)image_size, content_length);
+    } else if (status_code == 200) {
+        if (resume_offset > 0) {
+            ESP_LOGW(TAG, "⚠️ 服务器不支持续传，从头下载");
+            resume_offset = 0;
+        }
+        image_size = (uint32_t)content_length;
+    } else {
         ESP_LOGE(TAG, "❌ HTTP错误状态码: %d", status_code);
         ret = ESP_FAIL;
         goto cleanup;
     }
 
     // 检查Content-Type
-    char *content_type = NULL;
-    esp_http_client_get_header(client, "Content-Type", &content_type);
-    if (content_type && strstr(content_type, "application/json")) {
+    const char *content_type = headers.content_type;
+    if (strstr(content_type, "application/json")) {
         ESP_LOGE(TAG, "❌ 服务器返回错误信息而非固件文件 (Content-Type: %s)", content_type);
         ret = ESP_FAIL;
         goto cleanup;
     }
 
+    // 压缩镜像的传输大小小于固件大小，解压后的大小由ota_manager按镜像头校验
+    bool compressed = strstr(content_type, OTA_COMPRESSED_CONTENT_TYPE) != NULL;
+    if (compressed) {
+        ESP_LOGI(TAG, "🗜️ 压缩固件: 传输 %d bytes, 固件 %lu bytes",
+                 content_length, (unsigned long)expected_size);
+    }
+
     // 验证文件大小
-    if (expected_size > 0 && (uint32_t)content_length != expected_size) {
-        ESP_LOGW(TAG, "⚠️ 固件大小不匹配: 期望 %lu, 实际 %d",
-                (unsigned long)expected_size, content_length);
+    if (!compressed && expected_size > 0 && image_size != expected_size) {
+        ESP_LOGW(TAG, "⚠️ 固件大小不匹配: 期望 %lu, 实际 %lu",
+                (unsigned long)expected_size, (unsigned long)image_size);
         // 如果大小差异太大，可能是错误响应
-        if (content_length < 1000) {
+        if (image_size < 1000) {
             ESP_LOGE(TAG, "❌ 固件文件太小，可能是错误响应");
             ret = ESP_FAIL;
             goto cleanup;
         }
     }
 
-    // 开始OTA更新
-    ret = ota_manager_begin((uint32_t)content_length);
+    // 开始OTA更新（续传时从断点继续写入同一分区）
+    ret = ota_manager_begin_resumable(image_size, image_id, resume_offset);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "❌ 开始OTA更新失败: %s", esp_err_to_name(ret));
+        *restart = resume_offset > 0 && ret == ESP_ERR_NOT_FOUND;
         goto cleanup;
     }
     ota_started = true;
 
-    // 下载并写入固件数据 (使用较小的缓冲区以减少内存使用)
-    char *buffer = malloc(2048);
-    if (!buffer) {
-        ESP_LOGE(TAG, "❌ 分配下载缓冲区失败");
-        ret = ESP_ERR_NO_MEM;
+    // 写入任务边写边算SHA-256，写完即与指令中的哈希比对，错误镜像不会进入 esp_ota_end
+    if (expected_hash && expected_hash[0]) {
+        if (ota_manager_set_expected_sha256(expected_hash) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 固件哈希格式无效，跳过流式校验: %s", expected_hash);
+        }
+    }
+
+    // 下载与Flash写入并行：本任务填充缓冲区，OTA写入任务擦写Flash
+    ret = ota_manager_pipeline_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 启动OTA流水线失败: %s", esp_err_to_name(ret));
         goto cleanup;
     }
 
     int total_read = 0;
+    int last_logged = 0;
     while (total_read < content_length) {
-        int data_read = esp_http_client_read(client, buffer, 2048);
-        if (data_read < 0) {
-            ESP_LOGE(TAG, "❌ 读取固件数据失败");
+        uint8_t *buffer = ota_manager_pipeline_acquire();
+        if (!buffer) {
+            ESP_LOGE(TAG, "❌ 写入OTA数据失败");
             ret = ESP_FAIL;
             break;
         }
 
-        if (data_read == 0) {
-            ESP_LOGW(TAG, "⚠️ 数据读取完成");
-            break;
+        // 尽量填满一个缓冲区再提交，写入任务每次编程整扇区
+        int filled = 0;
+        while (filled < OTA_PIPELINE_BUFFER_SIZE && total_read + filled < content_length) {
+            int data_read = esp_http_client_read(client, (char*)buffer + filled,
+                                                 OTA_PIPELINE_BUFFER_SIZE - filled);
+            if (data_read < 0) {
+                ESP_LOGE(TAG, "❌ 读取固件数据失败");
+                ret = ESP_FAIL;
+                break;
+            }
+            if (data_read == 0) {
+                ESP_LOGW(TAG, "⚠️ 数据读取完成");
+                break;
+            }
+            filled += data_read;
         }
 
-        // 写入OTA数据
-        ret = ota_manager_write(buffer, data_read);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "❌ 写入OTA数据失败: %s", esp_err_to_name(ret));
+        ota_manager_pipeline_submit(buffer, ret == ESP_OK ? filled : 0);
+        if (ret != ESP_OK || filled == 0) {
             break;
         }
-
-        total_read += data_read;
+        total_read += filled;
 
         // 每128KB打印一次进度，减少日志输出频率
-        if (total_read % (128 * 1024) == 0 || total_read == content_length) {
+        if (total_read - last_logged >= 128 * 1024 || total_read == content_length) {
+            last_logged = total_read;
             ESP_LOGI(TAG, "📥 下载进度: %d/%d bytes (%.1f%%)",
                     total_read, content_length,
                     (float)total_read * 100.0f / content_length);
         }
     }
 
-    free(buffer);
+    esp_err_t write_ret = ota_manager_pipeline_finish(ret != ESP_OK);
+    if (ret == ESP_OK && write_ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 写入OTA数据失败: %s", esp_err_to_name(write_ret));
+        ret = write_ret;
+    }
 
     if (ret == ESP_OK && total_read == content_length) {
         // 完成OTA更新
@@ -913,10 +1930,10 @@ static esp_err_t download_and_install_firmware(const char* url, uint32_t expecte
 
             // 发送OTA完成状态到云端
             ESP_LOGI(TAG, "📤 发送OTA完成状态到云端");
-            cloud_client_send_command_feedback(s_current_command_id, "completed", "OTA升级成功完成，即将重启");
+            cloud_client_send_command_feedback(job->command_id, "completed", "OTA升级成功完成，即将重启");
 
-            // 等待状态发送完成
-            vTaskDelay(pdMS_TO_TICKS(2000));
+            // 重启前同步发送，失败时有限次重试
+            flush_command_feedback_before_restart();
 
             ESP_LOGI(TAG, "🔄 系统将在3秒后重启以应用新固件");
 
@@ -942,6 +1959,20 @@ cleanup:
     return ret;
 }
 
+/**
+ * 从URL下载并安装固件，断点失效时从头重新下载一次
+ */
+static esp_err_t download_and_install_firmware(const ota_job_t* job)
+{
+    bool restart = false;
+    esp_err_t ret = download_firmware_once(job, true, &restart);
+    if (ret != ESP_OK && restart) {
+        ESP_LOGW(TAG, "⚠️ OTA断点已失效，从头重新下载");
+        ret = download_firmware_once(job, false, &restart);
+    }
+    return ret;
+}
+
 /**
  * 从云服务器获取指令
  */
@@ -949,101 +1980,174 @@ int cloud_client_get_commands(cloud_command_t* commands, int max_commands)
 {
     // 这个功能通过状态上报的响应来实现
     // 解析s_response_buffer中的指令
-    if (s_response_len == 0 || !commands || max_commands <= 0) {
+    if (s_response_len == 0) {
         return 0;
     }
+    return parse_commands(s_response_buffer, (size_t)s_response_len, commands, max_commands, NULL);
+}
 
-    cJSON *json = cJSON_Parse(s_response_buffer);
-    if (!json) {
-        return 0;
+/**
+ * 从已分词的响应中提取指令，data 以切片形式指向 body
+ */
+static int extract_commands(const char* body, const json_token_t* tokens, int token_count,
+                            cloud_command_t* commands, int max_commands, bool* long_poll_ack)
+{
+    if (long_poll_ack) {
+        int long_poll = json_tok_object_get(body, tokens, token_count, 0, "long_poll");
+        *long_poll_ack = long_poll >= 0 && json_tok_is_true(body, &tokens[long_poll]);
     }
 
-    cJSON *commands_array = cJSON_GetObjectItem(json, "commands");
-    if (!cJSON_IsArray(commands_array)) {
-        cJSON_Delete(json);
+    int array = json_tok_object_get(body, tokens, token_count, 0, "commands");
+    if (array < 0 || tokens[array].type != JSON_TOK_ARRAY) {
         return 0;
     }
 
     int count = 0;
-    int array_size = cJSON_GetArraySize(commands_array);
-
-    for (int i = 0; i < array_size && count < max_commands; i++) {
-        cJSON *cmd_obj = cJSON_GetArrayItem(commands_array, i);
-        if (!cmd_obj) continue;
-
-        cJSON *id_obj = cJSON_GetObjectItem(cmd_obj, "id");
-        cJSON *command_obj = cJSON_GetObjectItem(cmd_obj, "command");
-        cJSON *data_obj = cJSON_GetObjectItem(cmd_obj, "data");
-        cJSON *timestamp_obj = cJSON_GetObjectItem(cmd_obj, "timestamp");
-
-        if (id_obj && command_obj) {
-            // 处理指令ID（可能是字符串或数字）
-            if (cJSON_IsString(id_obj)) {
-                const char* id_str = cJSON_GetStringValue(id_obj);
-                strncpy(s_current_command_id, id_str, sizeof(s_current_command_id) - 1);
-                s_current_command_id[sizeof(s_current_command_id) - 1] = '\0';
-                commands[count].id = 0; // 设置为0，因为我们使用字符串ID
-            } else {
-                commands[count].id = (uint32_t)cJSON_GetNumberValue(id_obj);
-                snprintf(s_current_command_id, sizeof(s_current_command_id), "%lu", (unsigned long)commands[count].id);
-            }
+    int next = array + 1;
+    for (int i = 0; i < tokens[array].size && count < max_commands; i++) {
+        int cmd = next;
+        next = json_tok_skip(tokens, token_count, cmd);
+
+        int id_tok = json_tok_object_get(body, tokens, token_count, cmd, "id");
+        int command_tok = json_tok_object_get(body, tokens, token_count, cmd, "command");
+        int data_tok = json_tok_object_get(body, tokens, token_count, cmd, "data");
+        int timestamp_tok = json_tok_object_get(body, tokens, token_count, cmd, "timestamp");
+        int created_at_tok = json_tok_object_get(body, tokens, token_count, cmd, "created_at_ms");
+        int queued_tok = json_tok_object_get(body, tokens, token_count, cmd, "queued_ms");
+
+        if (id_tok < 0 || command_tok < 0) {
+            continue;
+        }
+        cloud_command_t *command = &commands[count];
+        memset(command, 0, sizeof(*command));
+
+        // 处理指令ID（可能是字符串或数字）
+        uint64_t number = 0;
+        if (tokens[id_tok].type == JSON_TOK_STRING) {
+            json_tok_copy_string(body, &tokens[id_tok], command->command_id, sizeof(command->command_id));
+            command->id = 0; // 设置为0，因为我们使用字符串ID
+        } else {
+            json_tok_get_uint64(body, &tokens[id_tok], &number);
+            command->id = (uint32_t)number;
+            snprintf(command->command_id, sizeof(command->command_id), "%lu", (unsigned long)command->id);
+        }
 
-            // 解析指令类型
-            const char* cmd_str = cJSON_GetStringValue(command_obj);
-            commands[count].command = parse_command_type(cmd_str);
-
-            // 处理指令数据
-            if (data_obj) {
-                char *data_str = cJSON_Print(data_obj);
-                if (data_str) {
-                    strncpy(commands[count].data, data_str, sizeof(commands[count].data) - 1);
-                    commands[count].data[sizeof(commands[count].data) - 1] = '\0';
-                    cJSON_free(data_str);
-                }
-            }
+        // 解析指令类型
+        char command_str[32];
+        json_tok_copy_string(body, &tokens[command_tok], command_str, sizeof(command_str));
+        command->command = parse_command_type(command_str);
 
-            if (timestamp_obj) {
-                commands[count].timestamp = (uint32_t)cJSON_GetNumberValue(timestamp_obj);
-            }
+        // 指令数据：引用响应缓冲区中的原文，不再重新序列化
+        if (data_tok >= 0) {
+            command->data = body + tokens[data_tok].start;
+            command->data_len = tokens[data_tok].end - tokens[data_tok].start;
+        }
 
-            // 立即处理OTA指令
-            if (commands[count].command == CLOUD_CMD_OTA_UPDATE) {
-#if !ENABLE_CLOUD_OTA
-                ESP_LOGW(TAG, "⚠️ 云端OTA已禁用，忽略升级指令");
-                cloud_client_send_command_feedback(s_current_command_id, "failed", "Cloud OTA disabled");
-                continue;
-#endif
-                ESP_LOGI(TAG, "🚀 收到OTA升级指令，立即处理");
-                ESP_LOGI(TAG, "📋 指令ID: %s", s_current_command_id);
+        if (timestamp_tok >= 0 && json_tok_get_uint64(body, &tokens[timestamp_tok], &number)) {
+            command->timestamp = (uint32_t)number;
+        }
+        if (created_at_tok >= 0 && json_tok_get_uint64(body, &tokens[created_at_tok], &number)) {
+            command->created_at_ms = number;
+        }
+        if (queued_tok >= 0 && json_tok_get_uint64(body, &tokens[queued_tok], &number)) {
+            command->queued_ms = (uint32_t)number;
+        }
+
+        count++;
+    }
+
+    return count;
+}
 
-                // 发送指令接收确认
-                cloud_client_send_command_feedback(s_current_command_id, "received", "OTA指令已接收，开始处理");
+/**
+ * 解析响应体中的指令数组（原地分词，token 数组在栈上，不分配堆内存）
+ * @param long_poll_ack 输出服务器是否确认长轮询，可为NULL
+ */
+static int parse_commands(const char* body, size_t body_len, cloud_command_t* commands, int max_commands, bool* long_poll_ack)
+{
+    if (long_poll_ack) {
+        *long_poll_ack = false;
+    }
+    if (!body || body_len == 0 || !commands || max_commands <= 0) {
+        return 0;
+    }
 
-                // 设置OTA进度回调
-                ota_manager_set_progress_callback(ota_progress_callback);
+    json_token_t tokens[COMMAND_JSON_MAX_TOKENS];
+    int64_t start = esp_timer_get_time();
+    int token_count = json_tokenize(body, body_len, tokens, COMMAND_JSON_MAX_TOKENS);
+    if (token_count <= 0 || tokens[0].type != JSON_TOK_OBJECT) {
+        ESP_LOGW(TAG, "⚠️ 指令响应解析失败 (%d, %u bytes)", token_count, (unsigned)body_len);
+        s_parse_stats.token_errors++;
+        return 0;
+    }
 
-                esp_err_t ota_ret = handle_ota_command(data_obj);
-                if (ota_ret != ESP_OK) {
-                    ESP_LOGE(TAG, "❌ OTA升级处理失败: %s", esp_err_to_name(ota_ret));
+    int count = extract_commands(body, tokens, token_count, commands, max_commands, long_poll_ack);
 
-                    // 发送失败反馈
-                    char error_msg[128];
-                    snprintf(error_msg, sizeof(error_msg), "OTA升级失败: %s", esp_err_to_name(ota_ret));
-                    cloud_client_send_command_feedback(s_current_command_id, "failed", error_msg);
-                } else {
-                    ESP_LOGI(TAG, "✅ OTA升级处理成功");
-                    // 成功的反馈会在重启前发送
-                }
-                // OTA指令不返回给调用者，因为它会导致重启
-                continue;
-            }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    s_parse_stats.responses++;
+    s_parse_stats.last_parse_us = elapsed;
+    if (elapsed > s_parse_stats.max_parse_us) {
+        s_parse_stats.max_parse_us = elapsed;
+    }
+    s_parse_stats.last_tokens = (uint32_t)token_count;
+    if ((uint32_t)token_count > s_parse_stats.max_tokens) {
+        s_parse_stats.max_tokens = (uint32_t)token_count;
+    }
+    return count;
+}
 
-            count++;
+/**
+ * 指令解析对比测试：同一响应分别用原地分词与 cJSON 建树 + cJSON_Print 解析（首个非空响应时执行一次）
+ */
+static void benchmark_command_parsing(const char* body, size_t body_len)
+{
+    json_token_t tokens[COMMAND_JSON_MAX_TOKENS];
+    cloud_command_t commands[MAX_COMMANDS_PER_REQUEST];
+    int token_count = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < COMMAND_PARSE_BENCH_ROUNDS; i++) {
+        token_count = json_tokenize(body, body_len, tokens, COMMAND_JSON_MAX_TOKENS);
+        if (token_count <= 0) {
+            return;
+        }
+        extract_commands(body, tokens, token_count, commands, MAX_COMMANDS_PER_REQUEST, NULL);
+    }
+    s_parse_stats.bench_token_us = (uint32_t)((esp_timer_get_time() - start) / COMMAND_PARSE_BENCH_ROUNDS);
+    s_parse_stats.bench_token_ram = (uint32_t)(token_count * sizeof(json_token_t) + sizeof(commands));
+
+    // 旧路径：建树后把每个 data 对象 cJSON_Print 成字符串；峰值按空闲堆的最低点估算
+    uint32_t heap_peak = 0;
+    start = esp_timer_get_time();
+    for (int i = 0; i < COMMAND_PARSE_BENCH_ROUNDS; i++) {
+        uint32_t free_before = esp_get_free_heap_size();
+        cJSON *json = cJSON_ParseWithLength(body, body_len);
+        if (!json) {
+            return;
+        }
+        uint32_t lowest = esp_get_free_heap_size();
+        cJSON *item = NULL;
+        cJSON_ArrayForEach(item, cJSON_GetObjectItem(json, "commands")) {
+            cJSON *data = cJSON_GetObjectItem(item, "data");
+            char *data_str = data ? cJSON_Print(data) : NULL;
+            uint32_t free_now = esp_get_free_heap_size();
+            if (free_now < lowest) {
+                lowest = free_now;
+            }
+            cJSON_free(data_str);
+        }
+        cJSON_Delete(json);
+        if (free_before > lowest && free_before - lowest > heap_peak) {
+            heap_peak = free_before - lowest;
         }
     }
+    s_parse_stats.bench_cjson_us = (uint32_t)((esp_timer_get_time() - start) / COMMAND_PARSE_BENCH_ROUNDS);
+    s_parse_stats.bench_cjson_heap_peak = heap_peak;
+    s_parse_stats.bench_bytes = (uint32_t)body_len;
 
-    cJSON_Delete(json);
-    return count;
+    ESP_LOGI(TAG, "📦 指令解析对比 (%" PRIu32 "B) - 原地分词: %" PRIu32 "us, %" PRIu32 "B栈; cJSON: %" PRIu32 "us, 堆峰值%" PRIu32 "B",
+             s_parse_stats.bench_bytes, s_parse_stats.bench_token_us, s_parse_stats.bench_token_ram,
+             s_parse_stats.bench_cjson_us, s_parse_stats.bench_cjson_heap_peak);
 }
 
 /**
@@ -1082,24 +2186,6 @@ static void set_last_error(const char* error_msg)
     }
 }
 
-/**
- * 创建HTTP客户端配置（支持HTTPS）
- */
-static esp_http_client_handle_t create_http_client(const char* url)
-{
-    esp_http_client_config_t config = {
-        .url = url,
-        .timeout_ms = 10000,
-        .buffer_size = MAX_HTTP_RESPONSE_SIZE,
-        .buffer_size_tx = 2048,
-        .event_handler = http_event_handler,
-        .user_data = s_response_buffer,
-        .skip_cert_common_name_check = true,  // 跳过证书验证（开发环境）
-    };
-
-    return esp_http_client_init(&config);
-}
-
 /**
  * 添加认证头部
  */
@@ -1126,6 +2212,98 @@ static esp_err_t add_auth_headers(esp_http_client_handle_t client)
     return ret;
 }
 
+/**
+ * 写入设备状态字段（实时上报与离线回补共用）
+ */
+static void write_status_fields(json_writer_t *w, const device_status_data_t* status_data)
+{
+    json_writer_bool(w, "sbus_connected", status_data->sbus_connected);
+    json_writer_bool(w, "can_connected", status_data->can_connected);
+    json_writer_bool(w, "wifi_connected", status_data->wifi_connected);
+    json_writer_string(w, "wifi_ip", status_data->wifi_ip);
+    json_writer_int(w, "wifi_rssi", status_data->wifi_rssi);
+    json_writer_uint(w, "free_heap", status_data->free_heap);
+    json_writer_uint(w, "total_heap", status_data->total_heap);
+    json_writer_uint(w, "uptime_seconds", status_data->uptime_seconds);
+    json_writer_int(w, "task_count", status_data->task_count);
+    json_writer_uint(w, "can_tx_count", status_data->can_tx_count);
+    json_writer_uint(w, "can_rx_count", status_data->can_rx_count);
+    json_writer_int(w, "motor_left_speed", status_data->motor_left_speed);
+    json_writer_int(w, "motor_right_speed", status_data->motor_right_speed);
+    json_writer_uint(w, "last_sbus_time", status_data->last_sbus_time);
+    json_writer_uint(w, "last_cmd_time", status_data->last_cmd_time);
+
+    // 添加SBUS通道数组
+    json_writer_begin_array(w, "sbus_channels");
+    for (int i = 0; i < 16; i++) {
+        json_writer_int(w, NULL, status_data->sbus_channels[i]);
+    }
+    json_writer_end_array(w);
+}
+
+/**
+ * 将设备状态写为紧凑JSON（写入静态缓冲区 s_status_json_buffer）
+ */
+static esp_err_t build_status_json(const device_status_data_t* status_data, size_t* json_len)
+{
+    json_writer_t w;
+    json_writer_init(&w, s_status_json_buffer, sizeof(s_status_json_buffer));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "deviceId", s_device_info.device_id);
+    write_status_fields(&w, status_data);
+    json_writer_end_object(&w);
+    return json_writer_finish(&w, json_len);
+}
+
+#if STATUS_BINARY_ENABLE
+/**
+ * 编码对比测试：同一状态样本分别编码为JSON、二进制关键帧与增量帧，记录大小与平均耗时
+ */
+static void benchmark_status_encoding(const device_status_data_t* status)
+{
+    static status_codec_ctx_t bench_ctx;
+    static device_status_data_t previous;
+    uint8_t frame[STATUS_CODEC_MAX_SIZE];
+    size_t len = 0;
+
+    // 模拟上一周期的样本作为增量基准
+    previous = *status;
+    previous.uptime_seconds = status->uptime_seconds > 30 ? status->uptime_seconds - 30 : 0;
+    previous.free_heap = status->free_heap + 512;
+    previous.can_tx_count = status->can_tx_count > 300 ? status->can_tx_count - 300 : 0;
+    previous.can_rx_count = status->can_rx_count > 300 ? status->can_rx_count - 300 : 0;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < STATUS_ENCODING_BENCH_ROUNDS; i++) {
+        build_status_json(status, &len);
+    }
+    s_report_stats.bench_json_us = (uint32_t)((esp_timer_get_time() - start) / STATUS_ENCODING_BENCH_ROUNDS);
+    s_report_stats.bench_json_bytes = (uint32_t)len;
+
+    status_codec_init(&bench_ctx);
+    start = esp_timer_get_time();
+    for (int i = 0; i < STATUS_ENCODING_BENCH_ROUNDS; i++) {
+        status_codec_encode(&bench_ctx, s_device_info.device_id, status, true, frame, sizeof(frame), &len);
+    }
+    s_report_stats.bench_keyframe_us = (uint32_t)((esp_timer_get_time() - start) / STATUS_ENCODING_BENCH_ROUNDS);
+    s_report_stats.bench_keyframe_bytes = (uint32_t)len;
+
+    status_codec_encode(&bench_ctx, s_device_info.device_id, &previous, true, frame, sizeof(frame), &len);
+    status_codec_ack(&bench_ctx);
+    start = esp_timer_get_time();
+    for (int i = 0; i < STATUS_ENCODING_BENCH_ROUNDS; i++) {
+        status_codec_encode(&bench_ctx, s_device_info.device_id, status, false, frame, sizeof(frame), &len);
+    }
+    s_report_stats.bench_delta_us = (uint32_t)((esp_timer_get_time() - start) / STATUS_ENCODING_BENCH_ROUNDS);
+    s_report_stats.bench_delta_bytes = (uint32_t)len;
+
+    ESP_LOGI(TAG, "📦 状态编码对比 - JSON: %" PRIu32 "B/%" PRIu32 "us, 关键帧: %" PRIu32 "B/%" PRIu32 "us, 增量帧: %" PRIu32 "B/%" PRIu32 "us",
+             s_report_stats.bench_json_bytes, s_report_stats.bench_json_us,
+             s_report_stats.bench_keyframe_bytes, s_report_stats.bench_keyframe_us,
+             s_report_stats.bench_delta_bytes, s_report_stats.bench_delta_us);
+}
+#endif
+
 /**
  * 发送完整设备状态到Supabase
  */
@@ -1145,72 +2323,87 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
     ESP_LOGD(TAG, "📤 开始发送设备状态到Supabase...");
     s_network_status = NETWORK_CONNECTING;
 
-    // 创建JSON数据
-    ESP_LOGD(TAG, "📝 构建状态JSON数据...");
-    cJSON *json = cJSON_CreateObject();
-    if (!json) {
-        ESP_LOGE(TAG, "❌ 创建状态JSON对象失败");
-        set_last_error("创建JSON对象失败");
-        s_network_status = NETWORK_ERROR;
-        return ESP_ERR_NO_MEM;
-    }
-
-    // 添加设备ID
-    cJSON_AddStringToObject(json, "deviceId", s_device_info.device_id);
-
-    // 添加状态数据
-    cJSON_AddBoolToObject(json, "sbus_connected", status_data->sbus_connected);
-    cJSON_AddBoolToObject(json, "can_connected", status_data->can_connected);
-    cJSON_AddBoolToObject(json, "wifi_connected", status_data->wifi_connected);
-    cJSON_AddStringToObject(json, "wifi_ip", status_data->wifi_ip);
-    cJSON_AddNumberToObject(json, "wifi_rssi", status_data->wifi_rssi);
-    cJSON_AddNumberToObject(json, "free_heap", status_data->free_heap);
-    cJSON_AddNumberToObject(json, "total_heap", status_data->total_heap);
-    cJSON_AddNumberToObject(json, "uptime_seconds", status_data->uptime_seconds);
-    cJSON_AddNumberToObject(json, "task_count", status_data->task_count);
-    cJSON_AddNumberToObject(json, "can_tx_count", status_data->can_tx_count);
-    cJSON_AddNumberToObject(json, "can_rx_count", status_data->can_rx_count);
-    cJSON_AddNumberToObject(json, "motor_left_speed", status_data->motor_left_speed);
-    cJSON_AddNumberToObject(json, "motor_right_speed", status_data->motor_right_speed);
-    cJSON_AddNumberToObject(json, "last_sbus_time", status_data->last_sbus_time);
-    cJSON_AddNumberToObject(json, "last_cmd_time", status_data->last_cmd_time);
-
     ESP_LOGD(TAG, "📊 状态数据摘要 - 堆内存: %lu/%lu, 运行时间: %lus, 任务数: %d",
              (unsigned long)status_data->free_heap, (unsigned long)status_data->total_heap,
              (unsigned long)status_data->uptime_seconds, status_data->task_count);
 
-    // 添加SBUS通道数组
-    cJSON *channels = cJSON_CreateArray();
-    if (channels) {
-        for (int i = 0; i < 16; i++) {
-            cJSON_AddItemToArray(channels, cJSON_CreateNumber(status_data->sbus_channels[i]));
+    const char *body = NULL;
+    size_t body_len = 0;
+    const char *content_type = "application/json";
+    bool binary = false;
+    multi_heap_info_t heap_before, heap_after;
+    heap_caps_get_info(&heap_before, MALLOC_CAP_DEFAULT);
+    int64_t encode_start_us = esp_timer_get_time();
+
+#if STATUS_BINARY_ENABLE
+    // 服务器已声明支持：编码为二进制帧，周期性插入关键帧
+    if (s_status_binary_supported) {
+        bool keyframe = s_frames_since_keyframe >= STATUS_BINARY_KEYFRAME_INTERVAL;
+        esp_err_t enc_ret = status_codec_encode(&s_status_codec, s_device_info.device_id, status_data,
+                                                keyframe, s_status_bin_buffer, sizeof(s_status_bin_buffer),
+                                                &body_len);
+        if (enc_ret == ESP_OK) {
+            binary = true;
+            body = (const char *)s_status_bin_buffer;
+            content_type = STATUS_CODEC_CONTENT_TYPE;
+            if (status_codec_last_was_keyframe(&s_status_codec)) {
+                s_frames_since_keyframe = 0;
+                s_report_stats.binary_keyframes++;
+            } else {
+                s_frames_since_keyframe++;
+                s_report_stats.binary_deltas++;
+            }
+        } else {
+            ESP_LOGW(TAG, "⚠️ 二进制状态编码失败，本次使用JSON: %s", esp_err_to_name(enc_ret));
         }
-        cJSON_AddItemToObject(json, "sbus_channels", channels);
-        ESP_LOGD(TAG, "📡 SBUS通道数据已添加 (16通道)");
     }
+#endif
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+    if (!binary) {
+        // 流式写入紧凑JSON到静态缓冲区，不分配堆内存
+        ESP_LOGD(TAG, "📝 构建状态JSON数据...");
+        esp_err_t write_ret = build_status_json(status_data, &body_len);
+        if (write_ret != ESP_OK) {
+            ESP_LOGE(TAG, "❌ 序列化状态JSON失败: %s", esp_err_to_name(write_ret));
+            set_last_error("序列化JSON失败");
+            s_network_status = NETWORK_ERROR;
+            return ESP_ERR_NO_MEM;
+        }
+        body = s_status_json_buffer;
+    }
 
-    if (!json_string) {
-        ESP_LOGE(TAG, "❌ 序列化状态JSON失败");
-        set_last_error("序列化JSON失败");
-        s_network_status = NETWORK_ERROR;
-        return ESP_ERR_NO_MEM;
+    uint32_t encode_us = (uint32_t)(esp_timer_get_time() - encode_start_us);
+    heap_caps_get_info(&heap_after, MALLOC_CAP_DEFAULT);
+
+    s_report_stats.reports++;
+    s_report_stats.binary_active = binary;
+    s_report_stats.last_encode_us = encode_us;
+    s_report_stats.last_encode_heap_blocks = (int32_t)(heap_after.allocated_blocks - heap_before.allocated_blocks);
+    s_report_stats.last_encode_heap_bytes = (int32_t)(heap_after.total_allocated_bytes - heap_before.total_allocated_bytes);
+    if (s_report_stats.last_encode_heap_blocks > 0) {
+        s_report_stats.encode_heap_reports++;
     }
+    s_report_stats.last_bytes = (uint32_t)body_len;
+    if (body_len > s_report_stats.max_bytes) {
+        s_report_stats.max_bytes = (uint32_t)body_len;
+    }
+    s_report_stats.total_bytes += (uint32_t)body_len;
+
+    ESP_LOGD(TAG, "📏 状态报文大小: %u字节 (%s), 编码耗时: %" PRIu32 "us, 堆块变化: %" PRId32,
+             (unsigned)body_len, binary ? STATUS_CODEC_ENCODING_NAME : "json",
+             s_report_stats.last_encode_us, s_report_stats.last_encode_heap_blocks);
+    heap_before = heap_after;
 
-    ESP_LOGD(TAG, "📏 JSON数据大小: %d字节", strlen(json_string));
 
     // 发送HTTP请求
     char url[256];
     snprintf(url, sizeof(url), "%s/device-status", CLOUD_SERVER_URL);
     ESP_LOGD(TAG, "🌐 发送POST请求到: %s", url);
 
-    esp_http_client_handle_t client = create_http_client(url);
+    esp_http_client_handle_t client = http_client_pool_acquire(url, http_event_handler);
     if (!client) {
-        cJSON_free(json_string);
-        ESP_LOGE(TAG, "❌ 创建HTTP客户端失败");
-        set_last_error("创建HTTP客户端失败");
+        ESP_LOGE(TAG, "❌ 获取HTTP客户端失败");
+        set_last_error("获取HTTP客户端失败");
         s_network_status = NETWORK_ERROR;
         return ESP_FAIL;
     }
@@ -1220,15 +2413,25 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
     // 设置请求方法和头部
     esp_http_client_set_method(client, HTTP_METHOD_POST);
     ret = add_auth_headers(client);
+    if (ret == ESP_OK) {
+        ret = esp_http_client_set_header(client, "Content-Type", content_type);
+    }
 
     if (ret == ESP_OK) {
         ESP_LOGD(TAG, "🔐 HTTP头部设置成功");
 
         // 发送请求
-        ret = esp_http_client_set_post_field(client, json_string, strlen(json_string));
+        ret = esp_http_client_set_post_field(client, body, (int)body_len);
         if (ret == ESP_OK) {
             ESP_LOGD(TAG, "📤 开始执行HTTP请求...");
-            ret = esp_http_client_perform(client);
+            s_response_len = 0;
+            memset(s_response_buffer, 0, sizeof(s_response_buffer));
+            http_client_pool_timing_t timing;
+            ret = http_client_pool_perform(client, &timing);
+            int64_t received_us = esp_timer_get_time();
+            ESP_LOGD(TAG, "⏱️ 上报耗时: 建连=%" PRIu32 "us 首字节=%" PRIu32 "us 总计=%" PRIu32 "us (%s)",
+                     timing.connect_us, timing.ttfb_us, timing.total_us,
+                     timing.reused ? "复用连接" : "新连接");
 
             if (ret == ESP_OK) {
                 int status_code = esp_http_client_get_status_code(client);
@@ -1241,19 +2444,19 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
                     s_retry_count = 0;
                     ESP_LOGD(TAG, "✅ 设备状态上报成功");
 
+#if STATUS_BINARY_ENABLE
+                    if (binary) {
+                        status_codec_ack(&s_status_codec);
+                    }
+#endif
+
                     // 处理响应中的指令
                     cloud_command_t commands[MAX_COMMANDS_PER_REQUEST];
                     int command_count = cloud_client_get_commands(commands, MAX_COMMANDS_PER_REQUEST);
 
                     if (command_count > 0) {
                         ESP_LOGI(TAG, "📤 收到 %d 个指令，开始处理", command_count);
-
-                        // 处理每个指令
-                        for (int i = 0; i < command_count; i++) {
-                            if (s_command_callback) {
-                                s_command_callback(&commands[i]);
-                            }
-                        }
+                        dispatch_commands(commands, command_count, received_us);
                     }
 
                     // 调用状态回调
@@ -1265,6 +2468,14 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
                     snprintf(s_last_error, sizeof(s_last_error), "HTTP错误: %d", status_code);
                     ESP_LOGW(TAG, "⚠️ HTTP状态码错误: %d", status_code);
                     ret = ESP_FAIL;
+
+#if STATUS_BINARY_ENABLE
+                    // 服务器不再接受二进制帧（回滚到旧版本等）：回退JSON，直到再次收到支持声明
+                    if (binary && (status_code == 400 || status_code == 415)) {
+                        s_status_binary_supported = false;
+                        ESP_LOGW(TAG, "⚠️ 服务器拒绝二进制状态帧，回退为JSON上报");
+                    }
+#endif
                 }
             } else {
                 s_network_status = NETWORK_ERROR;
@@ -1278,8 +2489,19 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
         ESP_LOGE(TAG, "❌ 设置HTTP头部失败: %s", esp_err_to_name(ret));
     }
 
-    esp_http_client_cleanup(client);
-    cJSON_free(json_string);
+    http_client_pool_release(client);
+
+    heap_caps_get_info(&heap_after, MALLOC_CAP_DEFAULT);
+    s_report_stats.last_send_heap_blocks = (int32_t)(heap_after.allocated_blocks - heap_before.allocated_blocks);
+    s_report_stats.last_send_heap_bytes = (int32_t)(heap_after.total_allocated_bytes - heap_before.total_allocated_bytes);
+
+#if STATUS_BINARY_ENABLE
+    // 无法确认服务器持有的基准（含 409 缺少基准），下一帧发送关键帧
+    if (binary && ret != ESP_OK) {
+        status_codec_reset(&s_status_codec);
+        s_frames_since_keyframe = 0;
+    }
+#endif
 
     if (ret == ESP_OK) {
         ESP_LOGD(TAG, "🎉 状态上报流程完成");
@@ -1290,6 +2512,28 @@ esp_err_t cloud_client_send_device_status(const device_status_data_t* status_dat
     return ret;
 }
 
+/**
+ * 获取状态上报序列化统计
+ */
+void cloud_client_get_report_stats(cloud_report_stats_t* stats)
+{
+    if (stats) {
+        *stats = s_report_stats;
+    }
+}
+
+/**
+ * 获取指令下发延迟统计
+ */
+void cloud_client_get_command_latency_stats(cloud_command_latency_stats_t* stats)
+{
+    if (stats) {
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        *stats = s_latency_stats;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+    }
+}
+
 /**
  * 获取网络连接状态
  */
@@ -1420,7 +2664,8 @@ __attribute__((unused)) static esp_err_t register_device_enhanced(void)
     }
 
     // 发送注册请求
-    esp_http_client_handle_t client = create_http_client(CLOUD_SERVER_URL "/register-device");
+    esp_http_client_handle_t client = http_client_pool_acquire(CLOUD_SERVER_URL "/register-device",
+                                                               http_event_handler);
     if (!client) {
         cJSON_free(json_string);
         set_last_error("创建注册HTTP客户端失败");
@@ -1435,7 +2680,7 @@ __attribute__((unused)) static esp_err_t register_device_enhanced(void)
     if (ret == ESP_OK) {
         ret = esp_http_client_set_post_field(client, json_string, strlen(json_string));
         if (ret == ESP_OK) {
-            ret = esp_http_client_perform(client);
+            ret = http_client_pool_perform(client, NULL);
 
             if (ret == ESP_OK) {
                 int status_code = esp_http_client_get_status_code(client);
@@ -1457,7 +2702,7 @@ __attribute__((unused)) static esp_err_t register_device_enhanced(void)
         }
     }
 
-    esp_http_client_cleanup(client);
+    http_client_pool_release(client);
     cJSON_free(json_string);
 
     return ret;
@@ -1567,69 +2812,128 @@ esp_err_t cloud_client_graceful_shutdown(const char* reason)
 }
 
 /**
- * OTA进度回调函数
+ * OTA进度回调函数（在OTA任务中执行，按 OTA_PROGRESS_REPORT_INTERVAL_MS 限速上报）
  */
 static void ota_progress_callback(uint8_t progress_percent, const char* status_message)
 {
-    if (strlen(s_current_command_id) > 0) {
-        cloud_client_send_ota_progress(s_current_command_id, progress_percent, status_message);
+    ota_job_t *job = s_ota_job;
+    if (!job) {
+        return;
+    }
+
+    s_ota_job_stats.progress = progress_percent;
+
+    // 首次与100%总是上报，其余按间隔限速，避免每64KB一次HTTP请求拖慢下载
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    bool due = s_ota_job_stats.progress_reports == 0 || progress_percent >= 100 ||
+               now - s_ota_last_report_ms >= OTA_PROGRESS_REPORT_INTERVAL_MS;
+    if (!due) {
+        s_ota_job_stats.progress_throttled++;
+        return;
     }
+
+    s_ota_last_report_ms = now;
+    s_ota_job_stats.progress_reports++;
+    cloud_client_send_ota_progress(job->command_id, progress_percent, status_message);
 }
 
 /**
- * 发送指令执行状态反馈
+ * 获取指令响应解析统计
  */
-esp_err_t cloud_client_send_command_feedback(const char* command_id, const char* status, const char* message)
+void cloud_client_get_command_parse_stats(cloud_command_parse_stats_t* stats)
 {
-    if (!s_client_running || !wifi_manager_is_connected()) {
-        ESP_LOGW(TAG, "无法发送指令反馈：客户端未运行或网络未连接");
-        return ESP_ERR_INVALID_STATE;
+    if (stats) {
+        *stats = s_parse_stats;
     }
+}
 
-    if (!command_id || !status) {
-        ESP_LOGE(TAG, "指令ID和状态不能为空");
-        return ESP_ERR_INVALID_ARG;
+/**
+ * 获取OTA任务状态
+ */
+void cloud_client_get_ota_job_stats(cloud_ota_job_stats_t* stats)
+{
+    if (stats) {
+        *stats = s_ota_job_stats;
     }
+}
 
-    ESP_LOGI(TAG, "📤 发送指令执行反馈: ID=%s, 状态=%s", command_id, status);
-
-    // 创建JSON数据
-    cJSON *json = cJSON_CreateObject();
-    if (!json) {
-        ESP_LOGE(TAG, "创建JSON对象失败");
-        return ESP_ERR_NO_MEM;
+/**
+ * 获取指令执行器统计
+ */
+void cloud_client_get_command_exec_stats(cloud_command_exec_stats_t* stats)
+{
+    if (!stats) {
+        return;
     }
-
-    cJSON_AddStringToObject(json, "deviceId", s_device_info.device_id);
-    cJSON_AddStringToObject(json, "commandId", command_id);
-    cJSON_AddStringToObject(json, "status", status);
-    if (message) {
-        cJSON_AddStringToObject(json, "message", message);
+    taskENTER_CRITICAL(&s_command_stats_lock);
+    *stats = s_exec_stats;
+    taskEXIT_CRITICAL(&s_command_stats_lock);
+    for (int priority = 0; priority < CLOUD_CMD_PRIORITY_COUNT; priority++) {
+        stats->pending[priority] = s_exec_queues[priority] ? uxQueueMessagesWaiting(s_exec_queues[priority]) : 0;
     }
-    cJSON_AddStringToObject(json, "timestamp", ""); // 服务器会设置时间戳
+}
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+/**
+ * 指令类型名称
+ */
+const char* cloud_client_command_type_name(cloud_command_type_t type)
+{
+    return type < CLOUD_CMD_TYPE_COUNT ? s_command_type_names[type] : "unknown";
+}
 
-    if (!json_string) {
-        ESP_LOGE(TAG, "序列化指令反馈JSON失败");
-        return ESP_ERR_NO_MEM;
+/**
+ * 发送指令执行状态反馈（加入待上报列表，由指令执行任务批量发送）
+ */
+esp_err_t cloud_client_send_command_feedback(const char* command_id, const char* status, const char* message)
+{
+    if (!command_id || !status) {
+        ESP_LOGE(TAG, "指令ID和状态不能为空");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_feedback_mutex) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // 发送HTTP POST请求
-    char url[256];
-    snprintf(url, sizeof(url), "%s/api/device-commands/feedback", CLOUD_SERVER_URL);
-
-    esp_err_t err = send_http_post(url, json_string);
-    cJSON_free(json_string);
+    ESP_LOGI(TAG, "📤 指令执行反馈: ID=%s, 状态=%s", command_id, status);
 
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "✅ 指令反馈发送成功");
+    esp_err_t ret = ESP_OK;
+    bool terminal = is_terminal_feedback(status);
+
+    xSemaphoreTake(s_feedback_mutex, portMAX_DELAY);
+    command_feedback_t *entry = find_feedback(s_feedback_pending, s_feedback_pending_count, command_id);
+    if (entry) {
+        // 同一周期内的多次更新只上报最新状态，已到终态的不被中间状态覆盖
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        s_exec_stats.feedback_coalesced++;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+        if (!terminal && is_terminal_feedback(entry->status)) {
+            entry = NULL;
+        }
+    } else if (s_feedback_pending_count < COMMAND_FEEDBACK_MAX_PENDING) {
+        entry = &s_feedback_pending[s_feedback_pending_count++];
+        snprintf(entry->command_id, sizeof(entry->command_id), "%s", command_id);
+        if (s_feedback_first_us == 0) {
+            s_feedback_first_us = esp_timer_get_time();
+        }
     } else {
-        ESP_LOGW(TAG, "⚠️ 指令反馈发送失败: %s", esp_err_to_name(err));
+        taskENTER_CRITICAL(&s_command_stats_lock);
+        s_exec_stats.feedback_dropped++;
+        taskEXIT_CRITICAL(&s_command_stats_lock);
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (entry) {
+        snprintf(entry->status, sizeof(entry->status), "%s", status);
+        snprintf(entry->message, sizeof(entry->message), "%s", message ? message : "");
     }
+    taskENTER_CRITICAL(&s_command_stats_lock);
+    s_exec_stats.feedback_updates++;
+    taskEXIT_CRITICAL(&s_command_stats_lock);
+    xSemaphoreGive(s_feedback_mutex);
 
-    return err;
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 待上报指令反馈已满，丢弃: ID=%s, 状态=%s", command_id, status);
+    }
+    return ret;
 }
 
 /**
@@ -13,7 +13,29 @@ extern "C" {
 #define CLOUD_SERVER_PORT 80
 #define CLOUD_SERVER_URL "http://www.nagaflow.top"
 #define DEVICE_STATUS_INTERVAL_MS 30000  // 30秒上报一次状态
-#define COMMAND_POLL_INTERVAL_MS 10000   // 10秒轮询一次指令
+#define COMMAND_POLL_INTERVAL_MS 10000   // 10秒轮询一次指令（长轮询不可用时的回退模式）
+#define COMMAND_LONG_POLL_ENABLE 1       // 指令下发使用长轮询（服务器有新指令时立即返回）
+#define COMMAND_LONG_POLL_WAIT_S 25      // 长轮询服务器最长挂起时间
+#define COMMAND_LONG_POLL_FAIL_LIMIT 3   // 连续失败次数达到后回退到周期轮询
+#define COMMAND_LONG_POLL_RETRY_MS 60000 // 回退后重新尝试长轮询的间隔
+#define COMMAND_LATENCY_TARGET_MS 1000   // 端到端下发延迟目标
+#define CLOUD_HTTP_DIAG_REPORTS 10       // 每成功上报10次打印一次HTTP连接池统计
+#define OTA_DOWNLOAD_MAX_ATTEMPTS 3      // 固件下载中断后的尝试次数（从NVS断点续传）
+#define OTA_DOWNLOAD_RETRY_DELAY_MS 5000 // 续传重试间隔
+#define OTA_JOB_TASK_STACK_SIZE 6144     // OTA任务栈（下载、断点回读校验在此任务中执行）
+#define OTA_JOB_TASK_PRIORITY 4          // 低于指令轮询与状态上报任务
+#define OTA_PROGRESS_REPORT_INTERVAL_MS 5000 // OTA进度上报最小间隔
+#define OTA_JOB_JSON_MAX_TOKENS 32       // OTA指令 data 分词 token 上限
+#define COMMAND_EXEC_QUEUE_DEPTH 3       // 每个优先级的待执行指令队列深度
+#define COMMAND_RECENT_ID_COUNT 16       // 记住最近下发的指令ID，丢弃重复下发
+#define COMMAND_EXEC_DATA_SIZE 512       // 入队时复制的指令 data 上限（OTA参数约450字节）
+#define COMMAND_EXEC_TASK_STACK_SIZE 4096
+#define COMMAND_EXEC_TASK_PRIORITY 5
+#define COMMAND_FEEDBACK_MAX_PENDING 12  // 待上报反馈条数（同一指令的多次更新合并为一条）
+#define COMMAND_FEEDBACK_FLUSH_MS 500    // 反馈批量上报周期
+#define COMMAND_FEEDBACK_JSON_BUF_SIZE 2560
+#define COMMAND_FEEDBACK_FINAL_ATTEMPTS 3 // 重启前上报终态反馈的最多尝试次数
+#define COMMAND_FEEDBACK_FINAL_RETRY_MS 1000 // 重启前上报失败后的重试间隔
 
 // Supabase集成配置
 #define SUPABASE_PROJECT_URL "https://hfmifzmuwcmtgyjfhxvx.supabase.co"
@@ -22,6 +44,21 @@ extern "C" {
 #define MAX_RETRY_ATTEMPTS 3
 #define RETRY_DELAY_MS 5000
 #define MAX_COMMANDS_PER_REQUEST 10
+#define COMMAND_JSON_MAX_TOKENS 256       // 指令响应分词 token 上限（栈上约 2KB）
+#define COMMAND_PARSE_BENCH_ROUNDS 10     // 首个指令响应的分词/cJSON 对比测试轮数
+#define DEVICE_STATUS_JSON_BUF_SIZE 1024  // 状态上报 JSON 缓冲区（紧凑格式约 600 字节）
+#define STATUS_BINARY_ENABLE 1            // 服务器声明支持时改用紧凑二进制状态编码（见 status_codec.h）
+#define STATUS_BINARY_KEYFRAME_INTERVAL 20 // 每发送20个增量帧插入一个关键帧
+#define STATUS_ENCODING_BENCH_ROUNDS 50   // 启动时 JSON/二进制编码对比测试的轮数
+
+// 遥测存储转发（断网/上报失败时写入 SPIFFS，恢复后批量回补）
+#define TELEMETRY_STORE_ENABLE 1
+#define TELEMETRY_SAMPLE_INTERVAL_MS 30000  // 离线时记录状态样本的间隔
+#define TELEMETRY_UPLOAD_BATCH 10           // 每批回补的样本数
+#define TELEMETRY_UPLOAD_INTERVAL_MS 2000   // 回补批次之间的间隔（限制带宽与服务器压力）
+#define TELEMETRY_UPLOAD_MAX_BATCHES 10     // 每个上报周期最多回补的批次数
+#define TELEMETRY_BACKOFF_MAX_MS 300000     // 回补失败或服务器限流时的最大退避
+#define TELEMETRY_BATCH_JSON_BUF_SIZE 8192  // 回补批次 JSON 缓冲区（每个样本约 550 字节）
 
 // 设备状态枚举
 typedef enum {
@@ -37,15 +74,28 @@ typedef enum {
     CLOUD_CMD_MOTOR_CONTROL,
     CLOUD_CMD_WIFI_CONFIG,
     CLOUD_CMD_OTA_UPDATE,
-    CLOUD_CMD_REBOOT
+    CLOUD_CMD_REBOOT,
+    CLOUD_CMD_TYPE_COUNT
 } cloud_command_type_t;
 
+// 指令执行优先级（数值小的先执行）
+typedef enum {
+    CLOUD_CMD_PRIORITY_SAFETY = 0,  // SBUS/电机控制
+    CLOUD_CMD_PRIORITY_CONFIG,      // 配置类及未知指令
+    CLOUD_CMD_PRIORITY_SYSTEM,      // 重启、OTA
+    CLOUD_CMD_PRIORITY_COUNT
+} cloud_command_priority_t;
+
 // 指令结构体
 typedef struct {
     uint32_t id;
+    char command_id[64];        // 云端指令ID（字符串形式，用于反馈）
     cloud_command_type_t command;
-    char data[512];
+    const char *data;           // 指令 data 的 JSON 原文（指向响应缓冲区，不以 '\0' 结尾，仅在回调期间有效）
+    size_t data_len;            // data 长度，0=无数据
     uint32_t timestamp;
+    uint64_t created_at_ms;     // 云端创建时刻（Unix毫秒，0=未知）
+    uint32_t queued_ms;         // 云端从创建到下发的排队时长
 } cloud_command_t;
 
 // 网络连接状态
@@ -92,6 +142,97 @@ typedef struct {
     uint32_t timestamp;
 } device_status_data_t;
 
+// 状态上报序列化统计（报文字节数、编码耗时与堆占用变化）
+// 堆变化取默认堆在前后两次 heap_caps_get_info 之间的差值，包含同期其他任务的分配，
+// 用于确认流式编码不分配堆内存（编码差值应为 0），并观察发送路径的堆占用
+typedef struct {
+    uint32_t reports;               // 已序列化的状态上报次数
+    uint32_t last_bytes;            // 最近一次报文字节数
+    uint32_t max_bytes;             // 最大报文字节数
+    uint32_t total_bytes;           // 累计报文字节数
+    int32_t last_encode_heap_blocks; // 最近一次编码前后已分配块数之差
+    int32_t last_encode_heap_bytes; // 最近一次编码前后已分配字节数之差
+    uint32_t encode_heap_reports;   // 编码前后已分配块数增加的上报次数
+    int32_t last_send_heap_blocks;  // 最近一次发送（含响应处理）前后已分配块数之差
+    int32_t last_send_heap_bytes;   // 最近一次发送前后已分配字节数之差
+    bool binary_active;             // 最近一次上报使用二进制编码
+    uint32_t binary_keyframes;      // 二进制关键帧数
+    uint32_t binary_deltas;         // 二进制增量帧数
+    uint32_t last_encode_us;        // 最近一次编码耗时
+    // 启动时编码对比测试（同一状态样本，单次平均值）
+    uint32_t bench_json_bytes;
+    uint32_t bench_json_us;
+    uint32_t bench_keyframe_bytes;
+    uint32_t bench_keyframe_us;
+    uint32_t bench_delta_bytes;
+    uint32_t bench_delta_us;
+} cloud_report_stats_t;
+
+// 指令下发延迟统计（云端创建 → 设备分发给回调）
+typedef struct {
+    uint32_t delivered;             // 已分发指令数
+    uint32_t last_ms;
+    uint32_t avg_ms;
+    uint32_t max_ms;
+    uint32_t over_target;           // 超过 COMMAND_LATENCY_TARGET_MS 的次数
+    bool long_poll_active;          // 当前是否处于长轮询模式
+    uint32_t long_poll_fallbacks;   // 回退到周期轮询的次数
+} cloud_command_latency_stats_t;
+
+// 指令响应解析统计（原地分词；bench_* 为首个非空响应上与 cJSON 的一次对比）
+typedef struct {
+    uint32_t responses;             // 已解析的响应数
+    uint32_t last_parse_us;
+    uint32_t max_parse_us;
+    uint32_t last_tokens;           // 最近一次响应的 token 数
+    uint32_t max_tokens;
+    uint32_t token_errors;          // 分词失败（非法 JSON 或 token 不足）
+    uint32_t bench_bytes;           // 对比测试响应长度，0=尚未测试
+    uint32_t bench_token_us;        // 分词 + 字段提取耗时
+    uint32_t bench_token_ram;       // 分词路径栈上占用（token + 指令数组）
+    uint32_t bench_cjson_us;        // cJSON 建树 + cJSON_Print(data) 耗时
+    uint32_t bench_cjson_heap_peak; // cJSON 路径堆占用峰值（近似）
+} cloud_command_parse_stats_t;
+
+// 单类指令的排队与执行耗时
+typedef struct {
+    uint32_t executed;
+    uint32_t last_queue_us;         // 入队到开始执行
+    uint32_t avg_queue_us;
+    uint32_t max_queue_us;
+    uint32_t last_exec_us;          // 执行耗时
+    uint32_t avg_exec_us;
+    uint32_t max_exec_us;
+} cloud_command_type_stats_t;
+
+// 指令执行器统计
+typedef struct {
+    uint32_t queued;                // 已入队指令数
+    uint32_t dropped;               // 队列满或数据过长而拒绝的指令数
+    uint32_t duplicates;            // 最近已下发过而丢弃的指令数
+    uint32_t executed;
+    uint32_t pending[CLOUD_CMD_PRIORITY_COUNT]; // 各优先级当前排队数
+    uint32_t feedback_updates;      // 提交的反馈更新
+    uint32_t feedback_coalesced;    // 合并到同一指令已有条目的更新
+    uint32_t feedback_batches;      // 成功发送的批次
+    uint32_t feedback_sent;         // 成功发送的条目
+    uint32_t feedback_failed;       // 发送失败的批次（条目保留，RETRY_DELAY_MS 后重发）
+    uint32_t feedback_dropped;      // 待上报已满而丢弃的更新
+    cloud_command_type_stats_t types[CLOUD_CMD_TYPE_COUNT];
+} cloud_command_exec_stats_t;
+
+// OTA任务状态
+typedef struct {
+    bool active;                    // OTA任务进行中
+    char command_id[64];            // 当前（或最近一次）OTA指令ID
+    uint8_t progress;               // 最近一次写入进度
+    uint32_t started;               // 已启动的OTA任务数
+    uint32_t rejected;              // 已有任务进行中而拒绝的升级指令数
+    uint32_t progress_reports;      // 本次任务已发送的进度上报
+    uint32_t progress_throttled;    // 本次任务因限速跳过的进度回调
+    esp_err_t last_result;          // 最近一次任务结果
+} cloud_ota_job_stats_t;
+
 /**
  * 初始化云客户端
  * @return ESP_OK=成功
@@ -131,12 +272,33 @@ esp_err_t cloud_client_send_status(cloud_status_t status, const char* data);
  * 从云服务器获取指令
  * @param commands 指令数组
  * @param max_commands 最大指令数量
- * @return 实际获取的指令数量，-1表示错误
+ * @return 实际获取的指令数量，-1表示错误（各指令 data 指向内部响应缓冲区，下次请求前有效）
  */
 int cloud_client_get_commands(cloud_command_t* commands, int max_commands);
 
+/**
+ * 获取指令响应解析统计
+ */
+void cloud_client_get_command_parse_stats(cloud_command_parse_stats_t* stats);
+
+/**
+ * 获取OTA任务状态
+ */
+void cloud_client_get_ota_job_stats(cloud_ota_job_stats_t* stats);
+
+/**
+ * 获取指令执行器统计
+ */
+void cloud_client_get_command_exec_stats(cloud_command_exec_stats_t* stats);
+
+/**
+ * 指令类型名称（与云端 command 字段一致）
+ */
+const char* cloud_client_command_type_name(cloud_command_type_t type);
+
 /**
  * 设置指令处理回调函数
+ * 在指令执行任务中按优先级调用（安全/电机 > 配置 > 重启/OTA），返回后上报 completed
  * @param callback 回调函数指针
  */
 void cloud_client_set_command_callback(void (*callback)(const cloud_command_t* command));
@@ -160,6 +322,18 @@ const cloud_device_info_t* cloud_client_get_device_info(void);
  */
 esp_err_t cloud_client_send_device_status(const device_status_data_t* status_data);
 
+/**
+ * 获取状态上报序列化统计
+ * @param stats 输出统计
+ */
+void cloud_client_get_report_stats(cloud_report_stats_t* stats);
+
+/**
+ * 获取指令下发延迟统计
+ * @param stats 输出统计
+ */
+void cloud_client_get_command_latency_stats(cloud_command_latency_stats_t* stats);
+
 /**
  * 获取网络连接状态
  * @return 网络状态
@@ -207,10 +381,12 @@ esp_err_t cloud_client_graceful_shutdown(const char* reason);
 
 /**
  * 发送指令执行状态反馈
+ * 加入待上报列表后立即返回；同一指令的多次更新合并为最新状态（终态不被中间状态覆盖），
+ * 由指令执行任务每个周期合并为一次批量 POST
  * @param command_id 指令ID
  * @param status 执行状态 (received/processing/completed/failed)
  * @param message 状态消息
- * @return ESP_OK=成功
+ * @return ESP_OK=已加入待上报，ESP_ERR_NO_MEM=待上报已满
  */
 esp_err_t cloud_client_send_command_feedback(const char* command_id, const char* status, const char* message);
 
@@ -0,0 +1,141 @@
+#include "device_state.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "data_integration.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "DEVICE_STATE";
+
+// 共享状态块：仅由发布任务写入
+static device_state_snapshot_t s_snapshot;
+static uint32_t s_sequence = 0;                 // 奇数=发布中
+
+static TaskHandle_t s_publisher_task = NULL;
+static device_state_stats_t s_stats = {0};
+
+/**
+ * 写入新快照（单写者）
+ */
+static void publish(const device_status_data_t *status)
+{
+    uint32_t seq = __atomic_load_n(&s_sequence, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&s_sequence, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    s_snapshot.status = *status;
+    s_snapshot.version = seq / 2 + 1;
+    s_snapshot.published_us = esp_timer_get_time();
+
+    __atomic_store_n(&s_sequence, seq + 2, __ATOMIC_RELEASE);
+    s_stats.publishes++;
+}
+
+/**
+ * 采集并发布一次
+ */
+static void collect_and_publish(void)
+{
+    device_status_data_t status;
+    int64_t start = esp_timer_get_time();
+
+    if (data_integration_collect_status(&status) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 设备状态采集失败，保留上一份快照");
+        return;
+    }
+
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    s_stats.last_collect_us = elapsed;
+    if (elapsed > s_stats.max_collect_us) {
+        s_stats.max_collect_us = elapsed;
+    }
+
+    publish(&status);
+}
+
+/**
+ * 快照发布任务
+ */
+static void publisher_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "📸 设备状态快照发布任务已启动 (周期: %dms)", DEVICE_STATE_PUBLISH_INTERVAL_MS);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        collect_and_publish();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DEVICE_STATE_PUBLISH_INTERVAL_MS));
+    }
+}
+
+esp_err_t device_state_start(void)
+{
+    if (s_publisher_task != NULL) {
+        return ESP_OK;
+    }
+
+    BaseType_t ret = xTaskCreate(publisher_task, "dev_state", DEVICE_STATE_TASK_STACK_SIZE,
+                                 NULL, DEVICE_STATE_TASK_PRIORITY, &s_publisher_task);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建快照发布任务失败");
+        s_publisher_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+uint32_t device_state_read(device_state_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return 0;
+    }
+
+    int spins = 0;
+    for (;;) {
+        uint32_t begin = __atomic_load_n(&s_sequence, __ATOMIC_ACQUIRE);
+        if (begin == 0) {
+            memset(snapshot, 0, sizeof(*snapshot));
+            return 0;
+        }
+
+        if ((begin & 1U) == 0) {
+            *snapshot = s_snapshot;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&s_sequence, __ATOMIC_RELAXED) == begin) {
+                s_stats.reads++;
+                return snapshot->version;
+            }
+        }
+
+        // 发布中：短暂重读；读者优先级高于发布任务时让出CPU，避免同核上互相等待
+        s_stats.read_retries++;
+        if (++spins > DEVICE_STATE_READ_SPIN_LIMIT) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+esp_err_t device_state_get_status(device_status_data_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    device_state_snapshot_t snapshot;
+    if (device_state_read(&snapshot) == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *status = snapshot.status;
+    return ESP_OK;
+}
+
+void device_state_get_stats(device_state_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef DEVICE_STATE_H
+#define DEVICE_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cloud_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 设备状态快照发布器
+ *
+ *   - 单一发布任务按固定频率采集 Wi-Fi / 堆内存 / 任务数 / SBUS / 电机 / CAN 状态
+ *     （经 data_integration 回调），写入带版本号的共享状态块
+ *   - 状态块由顺序锁（seqlock）保护：发布期间序号为奇数，读者发现序号变化即重读，
+ *     读取方无需加锁，也不会阻塞发布任务
+ *   - 云端上报、离线遥测与 Web 接口读取同一份快照，数值一致，且不再各自重复采集
+ */
+
+#define DEVICE_STATE_PUBLISH_INTERVAL_MS    1000    // 快照发布周期
+#define DEVICE_STATE_TASK_STACK_SIZE        3072
+#define DEVICE_STATE_TASK_PRIORITY          4       // 低于状态监控任务
+#define DEVICE_STATE_READ_SPIN_LIMIT        4       // 连续读到发布中的次数超过此值后让出CPU
+
+/**
+ * 状态快照
+ */
+typedef struct {
+    device_status_data_t status;
+    uint32_t version;               // 发布序号（0=尚未发布）
+    int64_t published_us;           // 发布时刻（esp_timer 微秒）
+} device_state_snapshot_t;
+
+/**
+ * 发布器统计
+ */
+typedef struct {
+    uint32_t publishes;
+    uint32_t reads;
+    uint32_t read_retries;          // 读到发布中的快照而重读的次数
+    uint32_t last_collect_us;       // 最近一次采集耗时
+    uint32_t max_collect_us;
+} device_state_stats_t;
+
+/**
+ * 启动快照发布任务（立即发布第一份快照，可重复调用）
+ */
+esp_err_t device_state_start(void);
+
+/**
+ * 读取最新快照（无锁）
+ * @return 快照版本号，0 表示尚未发布（snapshot 内容无效）
+ */
+uint32_t device_state_read(device_state_snapshot_t *snapshot);
+
+/**
+ * 读取最新设备状态
+ * @return ESP_OK，尚未发布返回 ESP_ERR_INVALID_STATE
+ */
+esp_err_t device_state_get_status(device_status_data_t *status);
+
+/**
+ * 获取发布器统计
+ */
+void device_state_get_stats(device_state_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEVICE_STATE_H */
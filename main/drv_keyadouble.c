@@ -1,5 +1,8 @@
 #include "drv_keyadouble.h"
 #include "main.h"
+#include "can_bus_monitor.h"
+#include "boot_profile.h"
+#include "udp_teleop.h"
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
@@ -51,8 +54,8 @@ static uint32_t last_hw_reset_time = 0;      // 上次硬复位时间
 #define CAN_HW_RESET_WINDOW_MS 60000         // 计数窗口60秒
 #define CAN_HW_RESET_COOLDOWN_MS 120000      // 硬复位过多后冷却2分钟
 
-// 注意：已移除motor_enabled标志，改为每次发送速度命令时都发送使能命令
-// 这样可以避免看门狗超时导致的驱动器失能问题
+// 注意：使能命令不再定时重发，改由心跳超时/恢复触发重新使能，
+// 并与速度帧合并在同一控制周期突发发送（见 can_send_control_burst）
 
 // TWAI (CAN) 配置 - 根据电路图SN65HVD232D CAN收发电路
 // IO16连接到SN65HVD232D的D引脚(TX)，IO17连接到R引脚(RX)
@@ -81,9 +84,7 @@ static const twai_filter_config_t f_config = {
     .single_filter = true
 };
 
-// Software TX queue and CAN task config
-#define CAN_TX_QUEUE_LEN 20  // 🔧 减少队列长度，避免旧命令堆积
-#define CAN_TX_BURST_MAX 10  // 🔧 增加单次发送数量，加快队列清空
+// CAN task config
 #define CAN_RX_BURST_MAX 10
 #define CAN_CONTROL_PERIOD_MS 50
 #define CAN_TASK_STACK_SIZE 4096
@@ -91,12 +92,33 @@ static const twai_filter_config_t f_config = {
 #define CAN_INIT_MAX_RETRIES 3
 #define CAN_INIT_RETRY_DELAY_MS 200
 #define CAN_INIT_RESET_DELAY_MS 50
+#define CAN_STARTUP_SETTLE_MS 100   // 总线启动后等待驱动器就绪再发送控制帧
 
 // 🔧 最新速度命令（覆盖式存储，只保留最新值）
 static volatile int8_t latest_speed_left = 0;
 static volatile int8_t latest_speed_right = 0;
 static volatile bool speed_cmd_pending = false;  // 标记有新的速度命令待发送
 
+// 🆕 控制帧合并发送：每个控制周期把 [A使能][B使能][A速度][B速度] 作为一个突发连续发出
+// 使能状态只在 CAN task 内维护，避免跨任务竞争
+#define KEYA_CONTROL_BURST_MAX 4
+#define ENABLE_RESEND_INTERVAL_MS 5000  // 心跳正常时每5秒重发一次使能命令（保活）
+static bool motor_a_enabled = false;
+static bool motor_b_enabled = false;
+static bool enable_a_pending = false;
+static bool enable_b_pending = false;
+static uint32_t keya_burst_count = 0;
+static uint32_t keya_enable_frame_count = 0;
+
+// 🆕 驱动器心跳监测（0x07000000 + 地址）
+static uint32_t keya_last_heartbeat_ms = 0;
+static uint32_t keya_last_reenable_ms = 0;
+static uint32_t keya_heartbeat_count = 0;
+static uint32_t keya_heartbeat_lost_count = 0;
+static uint8_t keya_last_heartbeat_data[8] = {0};
+static bool keya_heartbeat_seen = false;
+static volatile bool keya_heartbeat_alive = false;
+
 // ============================================================================
 // 🔧 CAN恢复优化配置 - 防止假死
 // ============================================================================
@@ -126,20 +148,21 @@ static volatile bool speed_cmd_pending = false;  // 标记有新的速度命令
 // 🔧 标记驱动是否已安装（用于跟踪状态）
 static bool twai_driver_installed = false;
 
-typedef struct {
-  twai_message_t message;
-} can_tx_item_t;
-
-static QueueHandle_t can_tx_queue = NULL;
 static twai_status_info_t can_last_status_info;
 static bool can_last_status_valid = false;
 static uint32_t can_last_status_time = 0;
 static volatile twai_state_t can_last_state = TWAI_STATE_STOPPED;
-static uint32_t can_tx_queue_drop_count = 0;
 
 static void can_update_status_cache(const twai_status_info_t *status_info, uint32_t now_ms);
 static void can_send_message(const twai_message_t *message);
-static void can_send_latest_speed_snapshot(void);
+static void can_send_control_burst(void);
+static void keya_fill_command_frame(twai_message_t *message, uint8_t cmd_type,
+                                    uint8_t channel, int8_t speed);
+#if ENABLE_UDP_TELEOP
+static bool keya_is_speed_frame(const twai_message_t *message);
+#endif
+static void keya_heartbeat_update(const twai_message_t *message, uint32_t now_ms);
+static void keya_heartbeat_check(uint32_t now_ms);
 static void can_task(void *pvParameters);
 static void can_mark_driver_uninstalled(void);
 static esp_err_t can_get_driver_status(twai_status_info_t *status_info);
@@ -763,6 +786,13 @@ static void can_send_message(const twai_message_t *message) {
 
   if (result == ESP_OK) {
     can_tx_success_count++;
+    can_bus_monitor_record(&tx_message, true);
+    boot_profile_mark(BOOT_PHASE_FIRST_CAN_FRAME);
+#if ENABLE_UDP_TELEOP
+    if (keya_is_speed_frame(&tx_message)) {
+      udp_teleop_mark_can_tx();
+    }
+#endif
     if (consecutive_tx_failures > 0) {
       ESP_LOGI(TAG, "✅ CAN发送恢复正常 (之前失败%lu次)", (unsigned long)consecutive_tx_failures);
       consecutive_tx_failures = 0;
@@ -839,43 +869,145 @@ static void can_send_message(const twai_message_t *message) {
   }
 }
 
-static void can_send_latest_speed_snapshot(void) {
+/**
+ * 构造单条驱动器命令帧（使能/失能/速度）
+ */
+static void keya_fill_command_frame(twai_message_t *message, uint8_t cmd_type,
+                                    uint8_t channel, int8_t speed) {
+  memset(message, 0, sizeof(*message));
+  message->extd = 1;
+  message->identifier = DRIVER_TX_ID + DRIVER_ADDRESS;
+  message->data_length_code = 8;
+  message->rtr = 0;
+
+  if (cmd_type == CMD_ENABLE) {
+    message->data[0] = 0x23;
+    message->data[1] = 0x0D;
+    message->data[2] = 0x20;
+    message->data[3] = channel;
+  } else if (cmd_type == CMD_DISABLE) {
+    message->data[0] = 0x23;
+    message->data[1] = 0x0C;
+    message->data[2] = 0x20;
+    message->data[3] = channel;
+  } else if (cmd_type == CMD_SPEED) {
+    message->data[0] = 0x23;
+    message->data[1] = 0x00;
+    message->data[2] = 0x20;
+    message->data[3] = channel;
+    int32_t sp_value = (int32_t)speed * 100;
+    message->data[4] = (sp_value >> 24) & 0xFF;
+    message->data[5] = (sp_value >> 16) & 0xFF;
+    message->data[6] = (sp_value >> 8) & 0xFF;
+    message->data[7] = sp_value & 0xFF;
+  }
+}
+
+#if ENABLE_UDP_TELEOP
+/**
+ * 是否为 CMD_SPEED 速度帧（与 keya_fill_command_frame 的布局对应）
+ */
+static bool keya_is_speed_frame(const twai_message_t *message) {
+  return message->identifier == DRIVER_TX_ID + DRIVER_ADDRESS &&
+         message->data[0] == 0x23 && message->data[1] == 0x00 &&
+         message->data[2] == 0x20;
+}
+#endif
+
+/**
+ * 发送一个控制周期的合并突发：待发使能帧在前，A/B速度帧在后
+ * 速度为0的通道标记为未使能，下次非零时重新使能
+ */
+static void can_send_control_burst(void) {
+  twai_message_t burst[KEYA_CONTROL_BURST_MAX];
+  int count = 0;
   int8_t sp_left = latest_speed_left;
   int8_t sp_right = latest_speed_right;
 
-  uint8_t speed_data_a[8] = {0x23, 0x00, 0x20, MOTOR_CHANNEL_A, 0, 0, 0, 0};
+  // CAN异常时重置使能状态，恢复后需要重新使能
+  if (can_last_status_valid && can_last_state != TWAI_STATE_RUNNING) {
+    motor_a_enabled = false;
+    motor_b_enabled = false;
+  }
+
+  if (sp_left == 0) {
+    motor_a_enabled = false;
+    enable_a_pending = false;
+  } else if (!motor_a_enabled || enable_a_pending) {
+    keya_fill_command_frame(&burst[count++], CMD_ENABLE, MOTOR_CHANNEL_A, 0);
+    motor_a_enabled = true;
+    enable_a_pending = false;
+  }
+  if (sp_right == 0) {
+    motor_b_enabled = false;
+    enable_b_pending = false;
+  } else if (!motor_b_enabled || enable_b_pending) {
+    keya_fill_command_frame(&burst[count++], CMD_ENABLE, MOTOR_CHANNEL_B, 0);
+    motor_b_enabled = true;
+    enable_b_pending = false;
+  }
+  keya_enable_frame_count += count;
+
   // Keep the periodic speed frame layout identical to CMD_SPEED so the driver
   // decodes both paths consistently.
-  int32_t sp_a = (int32_t)sp_left * 100;
-  speed_data_a[4] = (sp_a >> 24) & 0xFF;
-  speed_data_a[5] = (sp_a >> 16) & 0xFF;
-  speed_data_a[6] = (sp_a >> 8) & 0xFF;
-  speed_data_a[7] = sp_a & 0xFF;
-
-  twai_message_t speed_msg_a = {
-    .extd = 1,
-    .identifier = DRIVER_TX_ID + DRIVER_ADDRESS,
-    .data_length_code = 8,
-    .rtr = 0
-  };
-  memcpy(speed_msg_a.data, speed_data_a, 8);
-  can_send_message(&speed_msg_a);
-
-  uint8_t speed_data_b[8] = {0x23, 0x00, 0x20, MOTOR_CHANNEL_B, 0, 0, 0, 0};
-  int32_t sp_b = (int32_t)sp_right * 100;
-  speed_data_b[4] = (sp_b >> 24) & 0xFF;
-  speed_data_b[5] = (sp_b >> 16) & 0xFF;
-  speed_data_b[6] = (sp_b >> 8) & 0xFF;
-  speed_data_b[7] = sp_b & 0xFF;
-
-  twai_message_t speed_msg_b = {
-    .extd = 1,
-    .identifier = DRIVER_TX_ID + DRIVER_ADDRESS,
-    .data_length_code = 8,
-    .rtr = 0
-  };
-  memcpy(speed_msg_b.data, speed_data_b, 8);
-  can_send_message(&speed_msg_b);
+  keya_fill_command_frame(&burst[count++], CMD_SPEED, MOTOR_CHANNEL_A, sp_left);
+  keya_fill_command_frame(&burst[count++], CMD_SPEED, MOTOR_CHANNEL_B, sp_right);
+
+  for (int i = 0; i < count; i++) {
+    can_send_message(&burst[i]);
+  }
+  keya_burst_count++;
+}
+
+/**
+ * 记录驱动器心跳帧
+ */
+static void keya_heartbeat_update(const twai_message_t *message, uint32_t now_ms) {
+  if (message->extd == 0 ||
+      message->identifier != (DRIVER_HEARTBEAT_ID + DRIVER_ADDRESS)) {
+    return;
+  }
+
+  keya_last_heartbeat_ms = now_ms;
+  keya_heartbeat_count++;
+  keya_heartbeat_seen = true;
+  memcpy(keya_last_heartbeat_data, message->data, sizeof(keya_last_heartbeat_data));
+}
+
+/**
+ * 心跳超时检测：
+ * - 在线→超时：计数并告警，运动中的通道请求重新使能
+ * - 超时期间：每个超时窗口最多重发一次使能（兼作无心跳驱动器的保活）
+ * - 超时→恢复：驱动器可能已重启，重新使能运动中的通道
+ * - 心跳正常：每 ENABLE_RESEND_INTERVAL_MS 低频重发一次使能，防止驱动器
+ *   自行失能（如欠压、过流保护后）而心跳仍在时电机停转
+ */
+static void keya_heartbeat_check(uint32_t now_ms) {
+  bool alive = keya_heartbeat_seen &&
+               (now_ms - keya_last_heartbeat_ms) <= KEYA_HEARTBEAT_TIMEOUT_MS;
+
+  if (keya_heartbeat_alive && !alive) {
+    keya_heartbeat_lost_count++;
+    ESP_LOGW(TAG, "⚠️ 驱动器心跳超时(>%dms)，请求重新使能 (累计%lu次)",
+             KEYA_HEARTBEAT_TIMEOUT_MS, (unsigned long)keya_heartbeat_lost_count);
+    enable_a_pending = true;
+    enable_b_pending = true;
+    keya_last_reenable_ms = now_ms;
+  } else if (!keya_heartbeat_alive && alive) {
+    ESP_LOGI(TAG, "✅ 驱动器心跳恢复，重新使能电机");
+    enable_a_pending = true;
+    enable_b_pending = true;
+    keya_last_reenable_ms = now_ms;
+  } else if (!alive && (now_ms - keya_last_reenable_ms) >= KEYA_HEARTBEAT_TIMEOUT_MS) {
+    enable_a_pending = true;
+    enable_b_pending = true;
+    keya_last_reenable_ms = now_ms;
+  } else if (alive && (now_ms - keya_last_reenable_ms) >= ENABLE_RESEND_INTERVAL_MS) {
+    enable_a_pending = true;
+    enable_b_pending = true;
+    keya_last_reenable_ms = now_ms;
+  }
+  keya_heartbeat_alive = alive;
 }
 
 /**
@@ -885,7 +1017,6 @@ static void can_send_latest_speed_snapshot(void) {
  */
 static void can_task(void *pvParameters) {
   twai_message_t rx_message;
-  can_tx_item_t tx_item;
   uint32_t rx_count = 0;
   uint32_t batch_count = 0;
   uint32_t consecutive_empty_loops = 0;
@@ -909,6 +1040,10 @@ static void can_task(void *pvParameters) {
     can_update_status_cache(&init_status, init_time);
   }
 
+  // 等待驱动器就绪，期间只更新速度快照（不阻塞启动流程）
+  vTaskDelay(pdMS_TO_TICKS(CAN_STARTUP_SETTLE_MS));
+  boot_profile_mark(BOOT_PHASE_CAN_UNLOCKED);
+
   while (1) {
     // 🐕 定期喂狗 - 每500次循环喂狗一次（约5秒，因为每次循环2-10ms）
     wdt_feed_counter++;
@@ -928,19 +1063,12 @@ static void can_task(void *pvParameters) {
       }
     }
 
-    for (int i = 0; i < CAN_TX_BURST_MAX; i++) {
-      if (xQueueReceive(can_tx_queue, &tx_item, 0) != pdTRUE) {
-        break;
-      }
-      did_work = true;
-      can_send_message(&tx_item.message);
-    }
-
     // 固定20Hz发送最新速度快照，兼顾跟手性和总线负载
     if (last_control_send_ms == 0 ||
         (now_ms - last_control_send_ms) >= CAN_CONTROL_PERIOD_MS) {
       speed_cmd_pending = false;
-      can_send_latest_speed_snapshot();
+      keya_heartbeat_check(now_ms);
+      can_send_control_burst();
       last_control_send_ms = now_ms;
       did_work = true;
     }
@@ -952,6 +1080,8 @@ static void can_task(void *pvParameters) {
         rx_count++;
         batch_count++;
         did_work = true;
+        can_bus_monitor_record(&rx_message, false);
+        keya_heartbeat_update(&rx_message, now_ms);
         ESP_LOGD(TAG, "CAN RX #%lu: ID=0x%08" PRIX32 "...",
                  (unsigned long)rx_count, rx_message.identifier);
       } else if (ret == ESP_ERR_TIMEOUT) {
@@ -962,6 +1092,8 @@ static void can_task(void *pvParameters) {
       }
     }
 
+    can_bus_monitor_update(now_ms);
+
     if (batch_count > 0) {
       vTaskDelay(RTOS_DELAY_TICKS(2));
       consecutive_empty_loops = 0;
@@ -978,73 +1110,6 @@ static void can_task(void *pvParameters) {
   }
 }
 
-/**
- * Enqueue CAN frame for CAN task.
- */
-static void keya_send_data(uint32_t id, uint8_t *data) {
-  static uint32_t last_queue_drop_log_time = 0;
-  uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-  if (can_tx_queue == NULL) {
-    if (now_ms - last_queue_drop_log_time > 1000) {
-      last_queue_drop_log_time = now_ms;
-      ESP_LOGW(TAG, "CAN TX queue not ready, drop msg");
-    }
-    return;
-  }
-
-  can_tx_item_t item;
-  memset(&item, 0, sizeof(item));
-  item.message.extd = 1;
-  item.message.identifier = id;
-  item.message.data_length_code = 8;
-  item.message.rtr = 0;
-  for (int i = 0; i < 8; i++) {
-    item.message.data[i] = data[i];
-  }
-
-  if (xQueueSend(can_tx_queue, &item, 0) != pdTRUE) {
-    can_tx_queue_drop_count++;
-    if (now_ms - last_queue_drop_log_time > 1000) {
-      last_queue_drop_log_time = now_ms;
-      ESP_LOGW(TAG, "CAN TX queue full, drop msg (drop=%lu)",
-               (unsigned long)can_tx_queue_drop_count);
-    }
-  }
-}
-
-/**
- * 电机控制
- */
-static void motor_control(uint8_t cmd_type, uint8_t channel, int8_t speed) {
-  uint8_t tx_data[8] = {0};
-  uint32_t tx_id = DRIVER_TX_ID + DRIVER_ADDRESS;
-
-  if (cmd_type == CMD_ENABLE) {
-    tx_data[0] = 0x23;
-    tx_data[1] = 0x0D;
-    tx_data[2] = 0x20;
-    tx_data[3] = channel;
-  } else if (cmd_type == CMD_DISABLE) {
-    tx_data[0] = 0x23;
-    tx_data[1] = 0x0C;
-    tx_data[2] = 0x20;
-    tx_data[3] = channel;
-  } else if (cmd_type == CMD_SPEED) {
-    tx_data[0] = 0x23;
-    tx_data[1] = 0x00;
-    tx_data[2] = 0x20;
-    tx_data[3] = channel;
-    int32_t sp_value = (int32_t)speed * 100;
-    tx_data[4] = (sp_value >> 24) & 0xFF;
-    tx_data[5] = (sp_value >> 16) & 0xFF;
-    tx_data[6] = (sp_value >> 8) & 0xFF;
-    tx_data[7] = sp_value & 0xFF;
-  }
-
-  keya_send_data(tx_id, tx_data);
-}
-
 /**
  * 初始化电机驱动
  */
@@ -1103,20 +1168,11 @@ esp_err_t drv_keyadouble_init(void) {
     return ret;
   }
 
-  vTaskDelay(pdMS_TO_TICKS(100));
+  can_bus_monitor_init();
 
-  can_tx_queue = xQueueCreate(CAN_TX_QUEUE_LEN, sizeof(can_tx_item_t));
-  if (can_tx_queue == NULL) {
-    ESP_LOGE(TAG, "Failed to create CAN TX queue");
-    (void)can_try_uninstall_driver(50);
-    return ESP_ERR_NO_MEM;
-  }
-
-  if (xTaskCreate(can_task, "can_task", CAN_TASK_STACK_SIZE, NULL,
-                  CAN_TASK_PRIORITY, &can_task_handle) != pdPASS) {
+  if (xTaskCreatePinnedToCore(can_task, "can_task", CAN_TASK_STACK_SIZE, NULL,
+                              CAN_TASK_PRIORITY, &can_task_handle, CONTROL_TASK_CORE) != pdPASS) {
     ESP_LOGE(TAG, "Failed to create CAN task");
-    vQueueDelete(can_tx_queue);
-    can_tx_queue = NULL;
     (void)can_try_uninstall_driver(50);
     return ESP_ERR_NO_MEM;
   }
@@ -1128,7 +1184,6 @@ esp_err_t drv_keyadouble_init(void) {
   can_tx_timeout_count = 0;
   can_tx_error_count = 0;
   last_status_print_time = 0;
-  can_tx_queue_drop_count = 0;
   can_last_status_valid = false;
   can_last_status_time = 0;
   can_last_state = TWAI_STATE_STOPPED;
@@ -1141,8 +1196,8 @@ esp_err_t drv_keyadouble_init(void) {
 #endif
   ESP_LOGI(TAG, "Motor driver initialized (%s, CAN task prio %d)",
            mode_str, CAN_TASK_PRIORITY);
-  ESP_LOGI(TAG, "CAN config: TX_Q=%d, RX_Q=%d, SW_TX_Q=%d, 500kbps, GPIO16/17",
-           g_config.tx_queue_len, g_config.rx_queue_len, CAN_TX_QUEUE_LEN);
+  ESP_LOGI(TAG, "CAN config: TX_Q=%d, RX_Q=%d, 500kbps, GPIO16/17",
+           g_config.tx_queue_len, g_config.rx_queue_len);
   return ESP_OK;
 }
 
@@ -1181,22 +1236,44 @@ void drv_keyadouble_print_diag(void) {
            (unsigned long)can_tx_success_count,
            (unsigned long)can_tx_timeout_count,
            (unsigned long)can_tx_error_count);
-  ESP_LOGI(TAG, "TX queue drops: %lu", (unsigned long)can_tx_queue_drop_count);
   ESP_LOGI(TAG, "恢复次数: %lu", (unsigned long)can_recovery_count);
+  can_bus_monitor_print_diag();
+  ESP_LOGI(TAG, "───────────────────────────────────────────");
+  ESP_LOGI(TAG, "控制突发: %lu次, 使能帧=%lu, 使能状态 A=%d B=%d",
+           (unsigned long)keya_burst_count,
+           (unsigned long)keya_enable_frame_count,
+           motor_a_enabled, motor_b_enabled);
+  if (!keya_heartbeat_seen) {
+    ESP_LOGW(TAG, "驱动器心跳: 尚未收到 0x%08lX 心跳帧",
+             (unsigned long)(DRIVER_HEARTBEAT_ID + DRIVER_ADDRESS));
+  } else {
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    ESP_LOGI(TAG, "驱动器心跳: %s count=%lu lost=%lu age=%lums DATA=%02X %02X %02X %02X %02X %02X %02X %02X",
+             keya_heartbeat_alive ? "在线" : "超时",
+             (unsigned long)keya_heartbeat_count,
+             (unsigned long)keya_heartbeat_lost_count,
+             (unsigned long)(now_ms - keya_last_heartbeat_ms),
+             keya_last_heartbeat_data[0], keya_last_heartbeat_data[1],
+             keya_last_heartbeat_data[2], keya_last_heartbeat_data[3],
+             keya_last_heartbeat_data[4], keya_last_heartbeat_data[5],
+             keya_last_heartbeat_data[6], keya_last_heartbeat_data[7]);
+  }
   ESP_LOGI(TAG, "═══════════════════════════════════════════");
 }
 
-// 🔧 电机使能状态跟踪（用于减少CAN消息数量）
-static bool motor_a_enabled = false;
-static bool motor_b_enabled = false;
+/**
+ * 驱动器心跳是否在线
+ */
+bool drv_keyadouble_is_alive(void) {
+  return keya_heartbeat_alive;
+}
+
 static int8_t last_speed_left = 0;
 static int8_t last_speed_right = 0;
-static uint32_t last_enable_time = 0;
-#define ENABLE_RESEND_INTERVAL_MS 5000  // 每5秒重发一次使能命令（保活）
 
 /**
  * 设置左右电机速度实现运动
- * 🔧 优化：只在首次/状态变化/定时保活时发送使能命令，减少CAN流量
+ * 只更新最新速度值；使能帧与速度帧由 CAN task 按控制周期合并发送
  */
 uint8_t intf_move_keyadouble(int8_t speed_left, int8_t speed_right) {
   if ((abs(speed_left) > 100) || (abs(speed_right) > 100))
@@ -1205,40 +1282,15 @@ uint8_t intf_move_keyadouble(int8_t speed_left, int8_t speed_right) {
   bk_flag_left = (speed_left != 0) ? 1 : 0;
   bk_flag_right = (speed_right != 0) ? 1 : 0;
 
-  // 🔧 仅记录非RUNNING状态，恢复交给发送逻辑处理
+  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  // 🔧 仅记录非RUNNING状态，恢复与重新使能交给 CAN task 处理
   if (can_last_status_valid && can_last_state != TWAI_STATE_RUNNING) {
     static uint32_t last_non_running_warn = 0;
-    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    if (now - last_non_running_warn > 1000) {
+    if (current_time - last_non_running_warn > 1000) {
       ESP_LOGW(TAG, "⚠️ CAN状态异常: State=%d", (int)can_last_state);
-      last_non_running_warn = now;
+      last_non_running_warn = current_time;
     }
-    // CAN异常时重置使能状态，下次恢复后需要重新使能
-    motor_a_enabled = false;
-    motor_b_enabled = false;
-  }
-
-  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-  
-  // 🔧 检查是否需要发送使能命令
-  bool need_enable_a = false;
-  bool need_enable_b = false;
-  
-  // 条件1：首次使能（电机从停止到运动）
-  if (speed_left != 0 && !motor_a_enabled) {
-    need_enable_a = true;
-  }
-  if (speed_right != 0 && !motor_b_enabled) {
-    need_enable_b = true;
-  }
-  
-  // 条件2：定时保活（每5秒重发使能命令，防止驱动器看门狗超时）
-  if (current_time - last_enable_time > ENABLE_RESEND_INTERVAL_MS) {
-    if (speed_left != 0 || speed_right != 0) {
-      need_enable_a = true;
-      need_enable_b = true;
-    }
-    last_enable_time = current_time;
   }
 
   // 速度日志节流：启停/明显变化立即打印，小幅连续变化最多每秒一条。
@@ -1265,27 +1317,5 @@ uint8_t intf_move_keyadouble(int8_t speed_left, int8_t speed_right) {
   latest_speed_right = speed_right;
   speed_cmd_pending = true;
 
-  // 🔧 条件发送使能命令（通过队列，优先级较低）
-  if (need_enable_a) {
-    motor_control(CMD_ENABLE, MOTOR_CHANNEL_A, 0);
-    motor_a_enabled = true;
-    ESP_LOGD(TAG, "📤 发送A路使能命令");
-  }
-  if (need_enable_b) {
-    motor_control(CMD_ENABLE, MOTOR_CHANNEL_B, 0);
-    motor_b_enabled = true;
-    ESP_LOGD(TAG, "📤 发送B路使能命令");
-  }
-
-  // 🔧 注意：速度命令不再这里发送，改由 CAN task 周期性发送最新值
-
-  // 更新使能状态（速度为0时标记为未使能，下次非零时重新使能）
-  if (speed_left == 0) {
-    motor_a_enabled = false;
-  }
-  if (speed_right == 0) {
-    motor_b_enabled = false;
-  }
-
   return 0;
 }
@@ -1,6 +1,7 @@
 #ifndef DRV_KEYADOUBLE_H
 #define DRV_KEYADOUBLE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "esp_err.h"
 
@@ -24,4 +25,10 @@ esp_err_t drv_keyadouble_init(void);
  */
 void drv_keyadouble_print_diag(void);
 
+/**
+ * 驱动器心跳是否在线
+ * @return true=心跳在 KEYA_HEARTBEAT_TIMEOUT_MS 内
+ */
+bool drv_keyadouble_is_alive(void);
+
 #endif /* DRV_KEYADOUBLE_H */
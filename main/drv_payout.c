@@ -2,6 +2,7 @@
 
 #include "main.h"
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,34 +12,37 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "modbus_master.h"
+#include "rs485_scheduler.h"
 
 static const char *TAG = "DRV_PAYOUT";
 
 #if ENABLE_PAYOUT_DEVICE
 
-static bool s_initialized = false;
-static int16_t s_last_target_pwm = 0;
+_Static_assert(PAYOUT_DRUM_COUNT >= 1 && PAYOUT_DRUM_COUNT <= PAYOUT_MAX_DRUMS,
+               "PAYOUT_DRUM_COUNT out of range");
 
 /**
- * Modbus RTU CRC16 计算（多项式 0xA001）。
- * 移植自 fangxianqi 参考工程 main.c:Modbus_CRC16。
+ * 单个放线滚筒（一个 Modbus 从站）
  */
-static uint16_t payout_modbus_crc16(const uint8_t *data, uint16_t len)
-{
-    uint16_t crc = 0xFFFF;
-    while (len--) {
-        crc ^= (uint16_t)(*data++);
-        for (int i = 0; i < 8; i++) {
-            if (crc & 0x0001) {
-                crc >>= 1;
-                crc ^= 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    return crc;
-}
+typedef struct {
+    int write_job;                  // 目标写入作业（控制写）
+    int poll_job;                   // 速度/故障轮询作业
+    drv_payout_drum_status_t status;
+} payout_drum_t;
+
+static bool s_initialized = false;
+static int16_t s_last_target_pwm = 0;
+
+// 目标邮箱：控制路径只写最新值并触发调度器，写作业发送前再取值
+static int16_t s_pending_target_pwm = 0;
+static portMUX_TYPE s_target_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static payout_drum_t s_drums[PAYOUT_DRUM_COUNT];
+static uint16_t s_tension_raw = 0;
+static bool s_tension_valid = false;
+static uint32_t s_tension_last_ms = 0;
+static portMUX_TYPE s_status_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /**
  * 将输入夹紧到 [min,max]，并在接近中位时吸附到 mid（死区）。
@@ -72,14 +76,245 @@ static int16_t channel_to_target_pwm(int16_t channel_pwm)
     return (int16_t)tmp;
 }
 
-#if PAYOUT_RS485_DE_PIN != GPIO_NUM_NC
-static inline void rs485_set_tx_mode(bool tx_enable)
+/**
+ * 记录一次事务结果，维护滚筒在线状态（连续失败 PAYOUT_OFFLINE_THRESHOLD 次判定离线）
+ * 调用方须持有 s_status_lock
+ */
+static void payout_update_link_state_locked(drv_payout_drum_status_t *drum, esp_err_t ret,
+                                            uint32_t now, bool *came_online, bool *went_offline)
+{
+    if (ret == ESP_OK) {
+        *came_online = !drum->online;
+        drum->online = true;
+        drum->consecutive_failures = 0;
+        drum->last_response_ms = now;
+    } else {
+        drum->consecutive_failures++;
+        if (drum->online && drum->consecutive_failures >= PAYOUT_OFFLINE_THRESHOLD) {
+            drum->online = false;
+            *went_offline = true;
+        }
+    }
+}
+
+static void payout_log_link_change(const drv_payout_drum_status_t *drum, esp_err_t ret,
+                                   bool came_online, bool went_offline)
+{
+    if (came_online) {
+        ESP_LOGI(TAG, "✅ Payout drum 0x%02X online", drum->slave);
+    } else if (went_offline) {
+        ESP_LOGW(TAG, "⚠️ Payout drum 0x%02X offline (%d consecutive failures, last: %s)",
+                 drum->slave, PAYOUT_OFFLINE_THRESHOLD, esp_err_to_name(ret));
+    }
+}
+
+/**
+ * 写作业发送前取最新目标（所有滚筒同一目标）
+ */
+static void payout_prepare_write(uint16_t *values, uint16_t count, void *ctx)
+{
+    (void)count;
+    (void)ctx;
+    taskENTER_CRITICAL(&s_target_lock);
+    values[0] = (uint16_t)s_pending_target_pwm;
+    taskEXIT_CRITICAL(&s_target_lock);
+}
+
+/**
+ * 目标写入完成（功能码 0x06，应答为请求回显）
+ */
+static void payout_write_complete(esp_err_t ret, const uint16_t *values, uint16_t count,
+                                  uint32_t now_ms, void *ctx)
+{
+    (void)count;
+    payout_drum_t *drum = (payout_drum_t *)ctx;
+    bool came_online = false;
+    bool went_offline = false;
+
+    taskENTER_CRITICAL(&s_status_lock);
+    if (ret == ESP_OK) {
+        drum->status.write_ok++;
+        drum->status.applied_pwm = (int16_t)values[0];
+    } else {
+        drum->status.write_fail++;
+    }
+    payout_update_link_state_locked(&drum->status, ret, now_ms, &came_online, &went_offline);
+    taskEXIT_CRITICAL(&s_status_lock);
+
+    payout_log_link_change(&drum->status, ret, came_online, went_offline);
+}
+
+/**
+ * 速度/故障寄存器轮询完成（功能码 0x03）
+ */
+static void payout_poll_complete(esp_err_t ret, const uint16_t *values, uint16_t count,
+                                 uint32_t now_ms, void *ctx)
 {
-    gpio_set_level(PAYOUT_RS485_DE_PIN, tx_enable ? 1 : 0);
+    (void)count;
+    payout_drum_t *drum = (payout_drum_t *)ctx;
+    bool came_online = false;
+    bool went_offline = false;
+    uint16_t previous_fault;
+
+    taskENTER_CRITICAL(&s_status_lock);
+    previous_fault = drum->status.fault_code;
+    if (ret == ESP_OK) {
+        drum->status.poll_ok++;
+        drum->status.feedback_speed = (int16_t)values[PAYOUT_POLL_SPEED_OFFSET];
+        drum->status.fault_code = values[PAYOUT_POLL_FAULT_OFFSET];
+        drum->status.last_poll_ms = now_ms;
+    } else {
+        drum->status.poll_fail++;
+    }
+    payout_update_link_state_locked(&drum->status, ret, now_ms, &came_online, &went_offline);
+    taskEXIT_CRITICAL(&s_status_lock);
+
+    payout_log_link_change(&drum->status, ret, came_online, went_offline);
+    if (ret == ESP_OK && values[PAYOUT_POLL_FAULT_OFFSET] != previous_fault) {
+        if (values[PAYOUT_POLL_FAULT_OFFSET] != 0) {
+            ESP_LOGW(TAG, "⚠️ Payout drum 0x%02X fault: 0x%04X",
+                     drum->status.slave, values[PAYOUT_POLL_FAULT_OFFSET]);
+        } else {
+            ESP_LOGI(TAG, "✅ Payout drum 0x%02X fault cleared (was 0x%04X)",
+                     drum->status.slave, previous_fault);
+        }
+    }
 }
-#else
-static inline void rs485_set_tx_mode(bool tx_enable) { (void)tx_enable; }
+
+#if PAYOUT_TENSION_SENSOR_ENABLE
+/**
+ * 张力传感器读数完成
+ */
+static void payout_tension_complete(esp_err_t ret, const uint16_t *values, uint16_t count,
+                                    uint32_t now_ms, void *ctx)
+{
+    (void)count;
+    (void)ctx;
+    if (ret != ESP_OK) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_status_lock);
+    s_tension_raw = values[0];
+    s_tension_valid = true;
+    s_tension_last_ms = now_ms;
+    taskEXIT_CRITICAL(&s_status_lock);
+}
+#endif
+
+/**
+ * 按滚筒数与时间片规划目标写入（modbus_master 初始化后调用）：
+ *   - 发送间隔：全部滚筒的写入时间片之和不超过 RS485_SCHED_MAX_UTILIZATION，
+ *     PAYOUT_SEND_INTERVAL_MS 不够时自动放宽
+ *   - 截止时间：事务不可抢占，最坏情况下触发时恰好开始一个轮询时间片，
+ *     之后依次完成全部滚筒的写入，PAYOUT_CONTROL_DEADLINE_MS 不够时自动放宽
+ */
+static void payout_plan_writes(uint32_t *interval_ms, uint32_t *deadline_ms)
+{
+    uint32_t writes_us = rs485_scheduler_slot_us(MODBUS_FC_WRITE_SINGLE, 1) * PAYOUT_DRUM_COUNT;
+    uint32_t blocking_us = 0;
+#if PAYOUT_POLL_ENABLE
+    blocking_us = rs485_scheduler_slot_us(MODBUS_FC_READ_HOLDING, PAYOUT_POLL_REG_COUNT);
 #endif
+#if PAYOUT_TENSION_SENSOR_ENABLE
+    uint32_t tension_us = rs485_scheduler_slot_us(MODBUS_FC_READ_HOLDING, 1);
+    if (tension_us > blocking_us) {
+        blocking_us = tension_us;
+    }
+#endif
+
+    uint32_t min_interval_ms = (writes_us * 100U / RS485_SCHED_MAX_UTILIZATION + 999U) / 1000U;
+    uint32_t worst_response_ms = (blocking_us + writes_us + 999U) / 1000U;
+    *interval_ms = PAYOUT_SEND_INTERVAL_MS;
+    *deadline_ms = PAYOUT_CONTROL_DEADLINE_MS;
+
+    if (min_interval_ms > *interval_ms) {
+        ESP_LOGW(TAG, "⚠️ %d drums need %" PRIu32 "ms between target writes, PAYOUT_SEND_INTERVAL_MS=%d raised",
+                 PAYOUT_DRUM_COUNT, min_interval_ms, PAYOUT_SEND_INTERVAL_MS);
+        *interval_ms = min_interval_ms;
+    }
+    if (worst_response_ms > *deadline_ms) {
+        ESP_LOGW(TAG, "⚠️ Worst-case target write completes after %" PRIu32 "ms, PAYOUT_CONTROL_DEADLINE_MS=%d raised",
+                 worst_response_ms, PAYOUT_CONTROL_DEADLINE_MS);
+        *deadline_ms = worst_response_ms;
+    }
+}
+
+/**
+ * 向 RS485 调度器注册全部作业：每个滚筒一个控制写 + 一个轮询，可选张力传感器
+ */
+static esp_err_t payout_register_jobs(void)
+{
+    static const uint8_t drum_slaves[PAYOUT_DRUM_COUNT] = PAYOUT_DRUM_SLAVES;
+    uint32_t send_interval_ms;
+    uint32_t control_deadline_ms;
+    payout_plan_writes(&send_interval_ms, &control_deadline_ms);
+
+    for (int i = 0; i < PAYOUT_DRUM_COUNT; i++) {
+        payout_drum_t *drum = &s_drums[i];
+        memset(drum, 0, sizeof(*drum));
+        drum->status.slave = drum_slaves[i];
+        drum->poll_job = -1;
+
+        rs485_job_config_t write_job = {
+            .name = "payout_write",
+            .slave = drum_slaves[i],
+            .function = MODBUS_FC_WRITE_SINGLE,
+            .reg = PAYOUT_MODBUS_REG,
+            .count = 1,
+            .period_ms = PAYOUT_KEEPALIVE_MS,
+            .min_interval_ms = send_interval_ms,
+            .deadline_ms = control_deadline_ms,
+            .control = true,
+            .prepare = payout_prepare_write,
+            .complete = payout_write_complete,
+            .ctx = drum,
+        };
+        drum->write_job = rs485_scheduler_add_job(&write_job);
+        if (drum->write_job < 0) {
+            ESP_LOGE(TAG, "❌ Failed to add write job for drum 0x%02X", drum_slaves[i]);
+            return ESP_ERR_NO_MEM;
+        }
+
+#if PAYOUT_POLL_ENABLE
+        rs485_job_config_t poll_job = {
+            .name = "payout_poll",
+            .slave = drum_slaves[i],
+            .function = MODBUS_FC_READ_HOLDING,
+            .reg = PAYOUT_POLL_REG_START,
+            .count = PAYOUT_POLL_REG_COUNT,
+            .period_ms = PAYOUT_POLL_INTERVAL_MS,
+            .control = false,
+            .complete = payout_poll_complete,
+            .ctx = drum,
+        };
+        drum->poll_job = rs485_scheduler_add_job(&poll_job);
+        if (drum->poll_job < 0) {
+            ESP_LOGE(TAG, "❌ Failed to add poll job for drum 0x%02X", drum_slaves[i]);
+            return ESP_ERR_NO_MEM;
+        }
+#endif
+    }
+
+#if PAYOUT_TENSION_SENSOR_ENABLE
+    rs485_job_config_t tension_job = {
+        .name = "tension",
+        .slave = PAYOUT_TENSION_SLAVE,
+        .function = MODBUS_FC_READ_HOLDING,
+        .reg = PAYOUT_TENSION_REG,
+        .count = 1,
+        .period_ms = PAYOUT_TENSION_POLL_MS,
+        .control = false,
+        .complete = payout_tension_complete,
+        .ctx = NULL,
+    };
+    if (rs485_scheduler_add_job(&tension_job) < 0) {
+        ESP_LOGE(TAG, "❌ Failed to add tension sensor job");
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    return ESP_OK;
+}
 
 esp_err_t drv_payout_init(void)
 {
@@ -105,7 +340,7 @@ esp_err_t drv_payout_init(void)
     ret = uart_param_config(PAYOUT_UART, &uart_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "❌ uart_param_config failed: %s", esp_err_to_name(ret));
-        return ret;
+        goto fail;
     }
 
     ret = uart_set_pin(PAYOUT_UART,
@@ -115,7 +350,7 @@ esp_err_t drv_payout_init(void)
                        UART_PIN_NO_CHANGE);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "❌ uart_set_pin failed: %s", esp_err_to_name(ret));
-        return ret;
+        goto fail;
     }
 
 #if PAYOUT_RS485_DE_PIN != GPIO_NUM_NC
@@ -127,44 +362,63 @@ esp_err_t drv_payout_init(void)
         .intr_type = GPIO_INTR_DISABLE,
     };
     gpio_config(&de_cfg);
-    rs485_set_tx_mode(false);
+    gpio_set_level(PAYOUT_RS485_DE_PIN, 0);
 #endif
 
-    s_initialized = true;
+    modbus_master_config_t modbus_config = {
+        .uart = PAYOUT_UART,
+        .baud_rate = PAYOUT_BAUD_RATE,
+        .parity_enabled = true,
+        .de_pin = PAYOUT_RS485_DE_PIN,
+        .response_timeout_ms = PAYOUT_MODBUS_RESPONSE_TIMEOUT_MS,
+        .retries = PAYOUT_MODBUS_RETRIES,
+    };
+    ret = modbus_master_init(&modbus_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ modbus_master_init failed: %s", esp_err_to_name(ret));
+        goto fail;
+    }
+
+    s_pending_target_pwm = 0;
     s_last_target_pwm = 0;
-    ESP_LOGI(TAG, "✅ Payout RS485 init OK (UART%d TX=GPIO%d RX=%d %d bps, 8E1, slave=0x%02X reg=0x%04X)",
+
+    ret = payout_register_jobs();
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    ret = rs485_scheduler_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ rs485_scheduler_start failed: %s", esp_err_to_name(ret));
+        goto fail;
+    }
+    s_initialized = true;
+
+    // 上电先向所有滚筒下发一次停止
+    for (int i = 0; i < PAYOUT_DRUM_COUNT; i++) {
+        rs485_scheduler_request(s_drums[i].write_job);
+    }
+
+    ESP_LOGI(TAG, "✅ Payout RS485 init OK (UART%d TX=GPIO%d RX=%d %d bps, 8E1, drums=%d reg=0x%04X)",
              PAYOUT_UART, PAYOUT_UART_TX_PIN, PAYOUT_UART_RX_PIN, PAYOUT_BAUD_RATE,
-             PAYOUT_MODBUS_SLAVE, PAYOUT_MODBUS_REG);
+             PAYOUT_DRUM_COUNT, PAYOUT_MODBUS_REG);
     return ESP_OK;
+
+fail:
+    // 调度任务尚未创建，没有任务再使用 UART，释放驱动以便重新初始化
+    uart_driver_delete(PAYOUT_UART);
+    return ret;
 }
 
-/**
- * 打包并下发一次 Modbus RTU 写单寄存器（功能码 0x06）。
- * 帧结构：[slave][0x06][reg_h][reg_l][val_h][val_l][crc_l][crc_h]
- */
-static void send_modbus_write_single(int16_t target_pwm)
+static void payout_set_target(int16_t target_pwm)
 {
-    uint8_t frame[8];
-    frame[0] = PAYOUT_MODBUS_SLAVE;
-    frame[1] = 0x06;
-    frame[2] = (PAYOUT_MODBUS_REG >> 8) & 0xFF;
-    frame[3] = PAYOUT_MODBUS_REG & 0xFF;
-    frame[4] = (uint8_t)((target_pwm >> 8) & 0xFF);
-    frame[5] = (uint8_t)(target_pwm & 0xFF);
-
-    uint16_t crc = payout_modbus_crc16(frame, 6);
-    frame[6] = (uint8_t)(crc & 0xFF);
-    frame[7] = (uint8_t)((crc >> 8) & 0xFF);
+    taskENTER_CRITICAL(&s_target_lock);
+    s_pending_target_pwm = target_pwm;
+    taskEXIT_CRITICAL(&s_target_lock);
 
-    rs485_set_tx_mode(true);
-    uart_write_bytes(PAYOUT_UART, (const char *)frame, sizeof(frame));
-    uart_wait_tx_done(PAYOUT_UART, pdMS_TO_TICKS(20));
-    rs485_set_tx_mode(false);
-
-    ESP_LOGD(TAG, "UART%d Modbus TX pwm=%d frame=%02X %02X %02X %02X %02X %02X %02X %02X",
-             PAYOUT_UART,
-             target_pwm, frame[0], frame[1], frame[2], frame[3],
-             frame[4], frame[5], frame[6], frame[7]);
+    for (int i = 0; i < PAYOUT_DRUM_COUNT; i++) {
+        rs485_scheduler_request(s_drums[i].write_job);
+    }
 }
 
 void drv_payout_send_channel_pwm(uint16_t channel_value)
@@ -186,7 +440,29 @@ void drv_payout_send_channel_pwm(uint16_t channel_value)
     }
     s_last_target_pwm = target_pwm;
 
-    send_modbus_write_single(target_pwm);
+    payout_set_target(target_pwm);
+}
+
+void drv_payout_set_target_pwm(int16_t target_pwm)
+{
+    if (!s_initialized) {
+        return;
+    }
+
+    if (target_pwm > PAYOUT_PWM_LIMIT) {
+        target_pwm = PAYOUT_PWM_LIMIT;
+    } else if (target_pwm < -PAYOUT_PWM_LIMIT) {
+        target_pwm = -PAYOUT_PWM_LIMIT;
+    }
+
+    // 目标每个控制周期都在变化，只在启停/换向时打印
+    if ((target_pwm > 0) != (s_last_target_pwm > 0) ||
+        (target_pwm < 0) != (s_last_target_pwm < 0)) {
+        ESP_LOGI(TAG, "🪢 Payout pwm: %d → %d (sync)", s_last_target_pwm, target_pwm);
+    }
+    s_last_target_pwm = target_pwm;
+
+    payout_set_target(target_pwm);
 }
 
 void drv_payout_stop(void)
@@ -198,7 +474,7 @@ void drv_payout_stop(void)
         ESP_LOGI(TAG, "🛑 Payout STOP (last pwm=%d)", s_last_target_pwm);
     }
     s_last_target_pwm = 0;
-    send_modbus_write_single(0);
+    payout_set_target(0);
 }
 
 int16_t drv_payout_get_last_pwm(void)
@@ -206,11 +482,70 @@ int16_t drv_payout_get_last_pwm(void)
     return s_last_target_pwm;
 }
 
+esp_err_t drv_payout_get_status(drv_payout_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(status, 0, sizeof(*status));
+    status->target_pwm = s_last_target_pwm;
+    status->drum_count = PAYOUT_DRUM_COUNT;
+    status->online = true;
+
+    taskENTER_CRITICAL(&s_status_lock);
+    for (int i = 0; i < PAYOUT_DRUM_COUNT; i++) {
+        status->drums[i] = s_drums[i].status;
+        if (!s_drums[i].status.online) {
+            status->online = false;
+        }
+    }
+    status->tension_valid = s_tension_valid;
+    status->tension_raw = s_tension_raw;
+    status->tension_last_ms = s_tension_last_ms;
+    taskEXIT_CRITICAL(&s_status_lock);
+    return ESP_OK;
+}
+
+void drv_payout_print_diag(void)
+{
+    drv_payout_status_t status;
+    if (drv_payout_get_status(&status) != ESP_OK) {
+        ESP_LOGI(TAG, "Payout device not initialized");
+        return;
+    }
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    ESP_LOGI(TAG, "📊 Payout: %s target=%d drums=%u",
+             status.online ? "online" : "OFFLINE", status.target_pwm, (unsigned)status.drum_count);
+    for (int i = 0; i < status.drum_count; i++) {
+        const drv_payout_drum_status_t *drum = &status.drums[i];
+        ESP_LOGI(TAG, "📊   drum 0x%02X %s applied=%d speed=%d fault=0x%04X last_rsp=%" PRIu32 "ms ago",
+                 drum->slave, drum->online ? "online" : "OFFLINE", drum->applied_pwm,
+                 drum->feedback_speed, drum->fault_code,
+                 drum->last_response_ms ? now - drum->last_response_ms : 0);
+        ESP_LOGI(TAG, "📊   drum 0x%02X writes ok=%" PRIu32 " fail=%" PRIu32 ", polls ok=%" PRIu32 " fail=%" PRIu32,
+                 drum->slave, drum->write_ok, drum->write_fail, drum->poll_ok, drum->poll_fail);
+    }
+#if PAYOUT_TENSION_SENSOR_ENABLE
+    ESP_LOGI(TAG, "📊 Tension: %s raw=%u", status.tension_valid ? "valid" : "n/a",
+             (unsigned)status.tension_raw);
+#endif
+    rs485_scheduler_print_diag();
+    modbus_master_print_diag();
+}
+
 #else /* ENABLE_PAYOUT_DEVICE == 0 */
 
 esp_err_t drv_payout_init(void) { return ESP_OK; }
 void drv_payout_send_channel_pwm(uint16_t channel_value) { (void)channel_value; }
+void drv_payout_set_target_pwm(int16_t target_pwm) { (void)target_pwm; }
 void drv_payout_stop(void) {}
 int16_t drv_payout_get_last_pwm(void) { return 0; }
+esp_err_t drv_payout_get_status(drv_payout_status_t *status) { (void)status; return ESP_ERR_NOT_SUPPORTED; }
+void drv_payout_print_diag(void) {}
 
 #endif /* ENABLE_PAYOUT_DEVICE */
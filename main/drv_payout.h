@@ -13,27 +13,70 @@ extern "C" {
  * 放线设备驱动（RS485 / Modbus RTU）
  *
  * 移植自 esp32controlboard_fangxianqi_esp32 工程：
- *   - 透过 UART1 外接 RS485 收发器
+ *   - 透过 UART1 外接 RS485 收发器，由 modbus_master 完成请求/应答事务
+ *   - 总线上可挂多个放线滚筒与张力传感器，由 rs485_scheduler 按时间片调度
  *   - Modbus RTU 功能码 0x06（写单寄存器）
  *   - 写入目标寄存器 PAYOUT_MODBUS_REG（默认 0x0042），值 = int16 PWM
  *   - PWM 换算：SBUS 通道 1050~1950 → -1000 ~ +1000
+ *   - 功能码 0x03 周期轮询速度/故障寄存器，连续失败判定离线
+ *
+ * 总线收发在调度任务中完成，控制路径只更新目标值，不阻塞在 RS485 上。
  *
  * 与履带车电机驱动解耦：共用 SBUS 输入，独占 UART1，不影响 CAN 总线。
  */
 
+#define PAYOUT_MAX_DRUMS    4   // 同一 RS485 总线上放线滚筒数量上限
+
+/**
+ * 单个放线滚筒链路与反馈状态
+ */
+typedef struct {
+    uint8_t slave;                  // Modbus 从站地址
+    bool online;                    // 最近事务是否有应答（连续失败达到阈值判定离线）
+    int16_t applied_pwm;            // 最近一次被从站确认的 PWM
+    int16_t feedback_speed;         // 轮询到的实际速度
+    uint16_t fault_code;            // 轮询到的故障码（0=无故障）
+    uint32_t last_response_ms;      // 最近一次成功应答时间
+    uint32_t last_poll_ms;          // 最近一次成功轮询时间
+    uint32_t consecutive_failures;
+    uint32_t write_ok;
+    uint32_t write_fail;
+    uint32_t poll_ok;
+    uint32_t poll_fail;
+} drv_payout_drum_status_t;
+
 /**
- * 初始化 UART1 + RS485 + DE 引脚（如有）
+ * 放线设备整体状态（所有滚筒共用同一目标）
+ */
+typedef struct {
+    bool online;                    // 所有滚筒均在线
+    int16_t target_pwm;             // 当前目标 PWM
+    uint8_t drum_count;
+    drv_payout_drum_status_t drums[PAYOUT_MAX_DRUMS];
+    bool tension_valid;             // 张力传感器是否已有读数
+    uint16_t tension_raw;           // 张力原始值
+    uint32_t tension_last_ms;
+} drv_payout_status_t;
+
+/**
+ * 初始化 UART1 + RS485 + DE 引脚（如有），注册总线作业并启动调度
  */
 esp_err_t drv_payout_init(void);
 
 /**
  * 按 SBUS 原始通道值下发放线速度。
- * 内部做：中位死区夹紧 → 按 PAYOUT_PWM_SCALE 换算 → Modbus CRC → UART 发送。
+ * 内部做：中位死区夹紧 → 按 PAYOUT_PWM_SCALE 换算 → 投递给 RS485 任务写入。
  *
  * @param channel_value SBUS 通道原始值（1050 ~ 1950，1500=停）
  */
 void drv_payout_send_channel_pwm(uint16_t channel_value);
 
+/**
+ * 直接设置目标 PWM（-1000~+1000），用于同步放线等按控制周期计算目标的场景。
+ * 与 drv_payout_send_channel_pwm 共用同一目标邮箱，总线侧按调度限频。
+ */
+void drv_payout_set_target_pwm(int16_t target_pwm);
+
 /**
  * 立即下发"停止"命令（中位 1500）。
  * 失能、失步、CH6 关闭时调用。
@@ -45,6 +88,17 @@ void drv_payout_stop(void);
  */
 int16_t drv_payout_get_last_pwm(void);
 
+/**
+ * 获取放线设备链路/反馈状态快照
+ * @return ESP_OK=成功，ESP_ERR_INVALID_STATE=未初始化
+ */
+esp_err_t drv_payout_get_status(drv_payout_status_t *status);
+
+/**
+ * 打印放线设备状态、总线调度与 Modbus 事务统计
+ */
+void drv_payout_print_diag(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,8 @@
 #include "drv_sanside.h"
 #include "main.h"
+#include "can_bus_monitor.h"
+#include "boot_profile.h"
+#include "udp_teleop.h"
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,18 +12,12 @@
 static const char *TAG = "DRV_SANSIDE";
 
 // 电机驱动CAN ID定义
-#define WEST_DRIVER_DEVICE_ID              0x01U
-#define WEST_DRIVER_TARGET_ADDRESS         0xFFU
 #define WEST_DRIVER_CAN_BASE_ID            0x0DEE0000UL
-#define WEST_DRIVER_CONTROL_ID             (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)WEST_DRIVER_TARGET_ADDRESS << 8) | 0x00U)
-#define WEST_DRIVER_SPEED_FEEDBACK_ID      (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)WEST_DRIVER_DEVICE_ID << 8) | 0x01U)
-#define WEST_DRIVER_CURRENT_FEEDBACK_ID    (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)WEST_DRIVER_DEVICE_ID << 8) | 0x02U)
-#define WEST_DRIVER_STATUS_FEEDBACK_ID     (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)WEST_DRIVER_DEVICE_ID << 8) | 0x03U)
-#define WEST_DRIVER_POSITION_FEEDBACK_ID   (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)WEST_DRIVER_DEVICE_ID << 8) | 0x04U)
+#define WEST_DRIVER_CONTROL_ID(target)     (WEST_DRIVER_CAN_BASE_ID | ((uint32_t)(target) << 8) | 0x00U)
 #define WEST_DRIVER_UNLOCK_FRAME_COUNT     10U
 #define WEST_DRIVER_UNLOCK_INTERVAL_MS     10U
 #define WEST_DRIVER_OPEN_LOOP_FULL_SCALE   1100
-#define WEST_DRIVER_FEEDBACK_TIMEOUT_MS    1000U
+#define WEST_DRIVER_FEEDBACK_TIMEOUT_MS    WEST_DRIVER_NODE_TIMEOUT_MS
 #define WEST_DRIVER_BASE_MASK              0xFFFF0000UL
 #define WEST_DRIVER_BASE_PREFIX            0x0DEE0000UL
 
@@ -57,6 +54,30 @@ typedef struct {
   bool valid;
 } west_position_feedback_t;
 
+// 单台驱动器节点：地址、控制帧目标、最新速度命令与各类反馈
+typedef struct {
+  uint8_t address;                      // 驱动器地址（反馈帧中的设备地址）
+  uint8_t target;                       // 控制帧目标地址（0xFF=广播）
+  volatile int8_t speed_left;           // 最新左电机命令（覆盖式）
+  volatile int8_t speed_right;          // 最新右电机命令（覆盖式）
+  uint32_t last_feedback_time_ms;
+  uint32_t feedback_frame_count;
+  uint32_t offline_count;               // 健康→超时的跳变次数
+  bool feedback_seen;
+  bool healthy;
+  west_speed_feedback_t speed;
+  west_current_feedback_t current;
+  west_status_feedback_t status;
+  west_position_feedback_t position;
+} west_node_t;
+
+_Static_assert(WEST_DRIVER_NODE_COUNT >= 1 && WEST_DRIVER_NODE_COUNT <= 8,
+               "WEST_DRIVER_NODE_COUNT must be 1..8");
+
+static const uint8_t west_node_addresses[WEST_DRIVER_NODE_COUNT] = WEST_DRIVER_NODE_ADDRESSES;
+static const uint8_t west_node_targets[WEST_DRIVER_NODE_COUNT] = WEST_DRIVER_NODE_TARGETS;
+static west_node_t west_nodes[WEST_DRIVER_NODE_COUNT];
+
 // CAN task handle (TX/RX/recovery in one task)
 static TaskHandle_t can_task_handle = NULL;
 
@@ -105,10 +126,9 @@ static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 #define CAN_INIT_MAX_RETRIES 3
 #define CAN_INIT_RETRY_DELAY_MS 200
 #define CAN_INIT_RESET_DELAY_MS 50
+#define CAN_STARTUP_SETTLE_MS 100   // 总线启动后等待驱动器就绪再发送解锁帧
 
-// 🔧 最新速度命令（覆盖式存储，只保留最新值）
-static volatile int8_t latest_speed_left = 0;
-static volatile int8_t latest_speed_right = 0;
+// 🔧 最新速度命令按节点覆盖式存储在 west_nodes[] 中，只保留最新值
 static volatile bool speed_cmd_pending = false;  // 标记有新的速度命令待发送
 
 // ============================================================================
@@ -150,13 +170,8 @@ static bool can_last_status_valid = false;
 static uint32_t can_last_status_time = 0;
 static volatile twai_state_t can_last_state = TWAI_STATE_STOPPED;
 static uint32_t can_tx_queue_drop_count = 0;
-static uint8_t west_last_feedback_device_id = 0;
-static uint32_t west_last_feedback_time_ms = 0;
-static bool west_feedback_seen = false;
-static west_speed_feedback_t west_speed_feedback = {0};
-static west_current_feedback_t west_current_feedback = {0};
-static west_status_feedback_t west_status_feedback = {0};
-static west_position_feedback_t west_position_feedback = {0};
+static uint8_t west_last_unknown_device_id = 0;  // 最近一次未登记地址的反馈
+static uint32_t west_unknown_feedback_count = 0;
 
 static void can_update_status_cache(const twai_status_info_t *status_info, uint32_t now_ms);
 static void can_send_message(const twai_message_t *message);
@@ -167,8 +182,11 @@ static const char *motor_driver_protocol_name(void);
 static bool motor_driver_is_periodic_speed_frame(const twai_message_t *message);
 static void motor_driver_send_startup_frames(void);
 static int32_t west_driver_scale_speed(int8_t speed);
-static void west_driver_fill_speed_frame(twai_message_t *message, int8_t speed_left,
-                                         int8_t speed_right);
+static void west_driver_fill_speed_frame(twai_message_t *message, uint8_t target,
+                                         int8_t speed_left, int8_t speed_right);
+static void west_nodes_init(void);
+static west_node_t *west_node_find(uint8_t address);
+static void west_nodes_update_health(uint32_t now_ms);
 static int16_t west_driver_read_be16(const uint8_t *data);
 static int32_t west_driver_read_be32(const uint8_t *data);
 static uint8_t west_driver_extract_feedback_device_id(uint32_t identifier);
@@ -216,7 +234,49 @@ static bool motor_driver_is_periodic_speed_frame(const twai_message_t *message)
     return false;
   }
 
-  return message->identifier == WEST_DRIVER_CONTROL_ID;
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    if (message->identifier == WEST_DRIVER_CONTROL_ID(west_nodes[i].target)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void west_nodes_init(void) {
+  memset(west_nodes, 0, sizeof(west_nodes));
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    west_nodes[i].address = west_node_addresses[i];
+    west_nodes[i].target = west_node_targets[i];
+  }
+}
+
+static west_node_t *west_node_find(uint8_t address) {
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    if (west_nodes[i].address == address) {
+      return &west_nodes[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * 根据反馈时间刷新各节点健康状态，节点离线时打印一次告警
+ */
+static void west_nodes_update_health(uint32_t now_ms) {
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    west_node_t *node = &west_nodes[i];
+    bool healthy = node->feedback_seen &&
+                   (now_ms - node->last_feedback_time_ms) <= WEST_DRIVER_FEEDBACK_TIMEOUT_MS;
+    if (node->healthy && !healthy) {
+      node->offline_count++;
+      ESP_LOGW(TAG, "⚠️ 三思德节点0x%02X反馈超时(>%ums)，判定离线 (累计%lu次)",
+               node->address, WEST_DRIVER_FEEDBACK_TIMEOUT_MS,
+               (unsigned long)node->offline_count);
+    } else if (!node->healthy && healthy) {
+      ESP_LOGI(TAG, "✅ 三思德节点0x%02X反馈恢复", node->address);
+    }
+    node->healthy = healthy;
+  }
 }
 
 static bool west_driver_is_feedback_frame(const twai_message_t *message) {
@@ -232,6 +292,7 @@ static bool west_driver_is_feedback_frame(const twai_message_t *message) {
 }
 
 static void west_driver_parse_feedback(const twai_message_t *message, uint32_t now_ms) {
+  west_node_t *node;
   uint8_t device_id;
   uint8_t fn;
 
@@ -241,39 +302,45 @@ static void west_driver_parse_feedback(const twai_message_t *message, uint32_t n
 
   device_id = west_driver_extract_feedback_device_id(message->identifier);
   fn = west_driver_extract_function_code(message->identifier);
-  west_last_feedback_device_id = device_id;
-  west_last_feedback_time_ms = now_ms;
-  west_feedback_seen = true;
+  node = west_node_find(device_id);
+  if (node == NULL) {
+    west_last_unknown_device_id = device_id;
+    west_unknown_feedback_count++;
+    return;
+  }
+  node->last_feedback_time_ms = now_ms;
+  node->feedback_frame_count++;
+  node->feedback_seen = true;
 
   switch (fn) {
     case 0x01:
-      west_speed_feedback.motor1_speed = west_driver_read_be32(&message->data[0]);
-      west_speed_feedback.motor2_speed = west_driver_read_be32(&message->data[4]);
-      west_speed_feedback.timestamp_ms = now_ms;
-      west_speed_feedback.valid = true;
+      node->speed.motor1_speed = west_driver_read_be32(&message->data[0]);
+      node->speed.motor2_speed = west_driver_read_be32(&message->data[4]);
+      node->speed.timestamp_ms = now_ms;
+      node->speed.valid = true;
       break;
     case 0x02:
-      west_current_feedback.motor1_current_raw = west_driver_read_be16(&message->data[0]);
-      west_current_feedback.motor2_current_raw = west_driver_read_be16(&message->data[2]);
-      west_current_feedback.bus_voltage_raw = west_driver_read_be16(&message->data[4]);
-      west_current_feedback.fb_channel_raw = message->data[6];
-      west_current_feedback.lr_channel_raw = message->data[7];
-      west_current_feedback.timestamp_ms = now_ms;
-      west_current_feedback.valid = true;
+      node->current.motor1_current_raw = west_driver_read_be16(&message->data[0]);
+      node->current.motor2_current_raw = west_driver_read_be16(&message->data[2]);
+      node->current.bus_voltage_raw = west_driver_read_be16(&message->data[4]);
+      node->current.fb_channel_raw = message->data[6];
+      node->current.lr_channel_raw = message->data[7];
+      node->current.timestamp_ms = now_ms;
+      node->current.valid = true;
       break;
     case 0x03:
-      west_status_feedback.temp1_raw = west_driver_read_be16(&message->data[0]);
-      west_status_feedback.temp2_raw = west_driver_read_be16(&message->data[2]);
-      west_status_feedback.fault1_bits = (uint16_t)west_driver_read_be16(&message->data[4]);
-      west_status_feedback.fault2_bits = (uint16_t)west_driver_read_be16(&message->data[6]);
-      west_status_feedback.timestamp_ms = now_ms;
-      west_status_feedback.valid = true;
+      node->status.temp1_raw = west_driver_read_be16(&message->data[0]);
+      node->status.temp2_raw = west_driver_read_be16(&message->data[2]);
+      node->status.fault1_bits = (uint16_t)west_driver_read_be16(&message->data[4]);
+      node->status.fault2_bits = (uint16_t)west_driver_read_be16(&message->data[6]);
+      node->status.timestamp_ms = now_ms;
+      node->status.valid = true;
       break;
     case 0x04:
-      west_position_feedback.motor1_position = west_driver_read_be32(&message->data[0]);
-      west_position_feedback.motor2_position = west_driver_read_be32(&message->data[4]);
-      west_position_feedback.timestamp_ms = now_ms;
-      west_position_feedback.valid = true;
+      node->position.motor1_position = west_driver_read_be32(&message->data[0]);
+      node->position.motor2_position = west_driver_read_be32(&message->data[4]);
+      node->position.timestamp_ms = now_ms;
+      node->position.valid = true;
       break;
     default:
       break;
@@ -304,8 +371,8 @@ static int32_t west_driver_scale_speed(int8_t speed) {
   return scaled;
 }
 
-static void west_driver_fill_speed_frame(twai_message_t *message, int8_t speed_left,
-                                         int8_t speed_right) {
+static void west_driver_fill_speed_frame(twai_message_t *message, uint8_t target,
+                                         int8_t speed_left, int8_t speed_right) {
 #if WEST_CAN_INVERT_LEFT_MOTOR
   speed_left = -speed_left;
 #endif
@@ -317,7 +384,7 @@ static void west_driver_fill_speed_frame(twai_message_t *message, int8_t speed_l
 
   memset(message, 0, sizeof(*message));
   message->extd = 1;
-  message->identifier = WEST_DRIVER_CONTROL_ID;
+  message->identifier = WEST_DRIVER_CONTROL_ID(target);
   message->data_length_code = 8;
   message->rtr = 0;
   message->data[0] = (left >> 24) & 0xFF;
@@ -333,14 +400,16 @@ static void west_driver_fill_speed_frame(twai_message_t *message, int8_t speed_l
 static void motor_driver_send_startup_frames(void) {
   twai_message_t zero_frame;
 
-  west_driver_fill_speed_frame(&zero_frame, 0, 0);
   for (uint32_t i = 0; i < WEST_DRIVER_UNLOCK_FRAME_COUNT; ++i) {
-    esp_err_t ret = twai_transmit(&zero_frame, 0);
-    if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
-      ESP_LOGW(TAG, "三思德驱动零速解锁帧发送失败(%lu/%u): %s",
-               (unsigned long)(i + 1), WEST_DRIVER_UNLOCK_FRAME_COUNT,
-               esp_err_to_name(ret));
-      break;
+    for (int n = 0; n < WEST_DRIVER_NODE_COUNT; n++) {
+      west_driver_fill_speed_frame(&zero_frame, west_nodes[n].target, 0, 0);
+      esp_err_t ret = twai_transmit(&zero_frame, 0);
+      if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "三思德驱动零速解锁帧发送失败(node=0x%02X, %lu/%u): %s",
+                 west_nodes[n].address, (unsigned long)(i + 1),
+                 WEST_DRIVER_UNLOCK_FRAME_COUNT, esp_err_to_name(ret));
+        return;
+      }
     }
     vTaskDelay(pdMS_TO_TICKS(WEST_DRIVER_UNLOCK_INTERVAL_MS));
   }
@@ -963,6 +1032,13 @@ static void can_send_message(const twai_message_t *message) {
 
   if (result == ESP_OK) {
     can_tx_success_count++;
+    can_bus_monitor_record(&tx_message, true);
+    boot_profile_mark(BOOT_PHASE_FIRST_CAN_FRAME);
+#if ENABLE_UDP_TELEOP
+    if (motor_driver_is_periodic_speed_frame(&tx_message)) {
+      udp_teleop_mark_can_tx();
+    }
+#endif
     if (consecutive_tx_failures > 0) {
       ESP_LOGI(TAG, "✅ CAN发送恢复正常 (之前失败%lu次)", (unsigned long)consecutive_tx_failures);
       consecutive_tx_failures = 0;
@@ -1037,13 +1113,19 @@ static void can_send_message(const twai_message_t *message) {
   }
 }
 
+/**
+ * 同一发送周期内依次发出所有节点的最新速度快照
+ */
 static void can_send_latest_speed_snapshot(void) {
-  int8_t sp_left = latest_speed_left;
-  int8_t sp_right = latest_speed_right;
-
   twai_message_t speed_msg;
-  west_driver_fill_speed_frame(&speed_msg, sp_left, sp_right);
-  can_send_message(&speed_msg);
+
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    int8_t sp_left = west_nodes[i].speed_left;
+    int8_t sp_right = west_nodes[i].speed_right;
+
+    west_driver_fill_speed_frame(&speed_msg, west_nodes[i].target, sp_left, sp_right);
+    can_send_message(&speed_msg);
+  }
 }
 
 /**
@@ -1077,6 +1159,11 @@ static void can_task(void *pvParameters) {
     can_update_status_cache(&init_status, init_time);
   }
 
+  // 解锁完成前控制帧留在发送队列中，保证驱动器先收到零速帧
+  vTaskDelay(pdMS_TO_TICKS(CAN_STARTUP_SETTLE_MS));
+  motor_driver_send_startup_frames();
+  boot_profile_mark(BOOT_PHASE_CAN_UNLOCKED);
+
   while (1) {
     // 🐕 定期喂狗 - 每500次循环喂狗一次（约5秒，因为每次循环2-10ms）
     wdt_feed_counter++;
@@ -1120,17 +1207,17 @@ static void can_task(void *pvParameters) {
         rx_count++;
         batch_count++;
         did_work = true;
+        can_bus_monitor_record(&rx_message, false);
         west_driver_parse_feedback(&rx_message, now_ms);
 #if ENABLE_CAN_DEBUG
         if (west_driver_is_feedback_frame(&rx_message) &&
-            west_driver_extract_feedback_device_id(rx_message.identifier) !=
-                WEST_DRIVER_DEVICE_ID) {
+            west_node_find(west_driver_extract_feedback_device_id(rx_message.identifier)) ==
+                NULL) {
           static uint32_t last_addr_warn_ms = 0;
           if (now_ms - last_addr_warn_ms > 2000) {
             last_addr_warn_ms = now_ms;
-            ESP_LOGW(TAG, "⚠️ 收到三思德反馈但设备地址不是期望值: got=0x%02X expect=0x%02X",
-                     west_driver_extract_feedback_device_id(rx_message.identifier),
-                     WEST_DRIVER_DEVICE_ID);
+            ESP_LOGW(TAG, "⚠️ 收到三思德反馈但设备地址未在节点表中: got=0x%02X",
+                     west_driver_extract_feedback_device_id(rx_message.identifier));
           }
         }
 #endif
@@ -1144,6 +1231,10 @@ static void can_task(void *pvParameters) {
       }
     }
 
+    west_nodes_update_health(now_ms);
+
+    can_bus_monitor_update(now_ms);
+
     if (batch_count > 0) {
       vTaskDelay(RTOS_DELAY_TICKS(2));
       consecutive_empty_loops = 0;
@@ -1263,9 +1354,10 @@ esp_err_t drv_sanside_init(void) {
     return ret;
   }
 
-  vTaskDelay(pdMS_TO_TICKS(100));
-  motor_driver_send_startup_frames();
+  // 零速解锁帧由CAN任务发送，不阻塞启动流程
+  west_nodes_init();
 
+  can_bus_monitor_init();
   can_tx_queue = xQueueCreate(CAN_TX_QUEUE_LEN, sizeof(can_tx_item_t));
   if (can_tx_queue == NULL) {
     ESP_LOGE(TAG, "Failed to create CAN TX queue");
@@ -1273,8 +1365,8 @@ esp_err_t drv_sanside_init(void) {
     return ESP_ERR_NO_MEM;
   }
 
-  if (xTaskCreate(can_task, "can_task", CAN_TASK_STACK_SIZE, NULL,
-                  CAN_TASK_PRIORITY, &can_task_handle) != pdPASS) {
+  if (xTaskCreatePinnedToCore(can_task, "can_task", CAN_TASK_STACK_SIZE, NULL,
+                              CAN_TASK_PRIORITY, &can_task_handle, CONTROL_TASK_CORE) != pdPASS) {
     ESP_LOGE(TAG, "Failed to create CAN task");
     vQueueDelete(can_tx_queue);
     can_tx_queue = NULL;
@@ -1302,7 +1394,8 @@ esp_err_t drv_sanside_init(void) {
 #endif
   ESP_LOGI(TAG, "Motor driver initialized (%s, CAN task prio %d)",
            mode_str, CAN_TASK_PRIORITY);
-  ESP_LOGI(TAG, "Driver protocol: %s", motor_driver_protocol_name());
+  ESP_LOGI(TAG, "Driver protocol: %s, nodes=%d", motor_driver_protocol_name(),
+           WEST_DRIVER_NODE_COUNT);
   ESP_LOGI(TAG, "CAN config: TX_Q=%d, RX_Q=%d, SW_TX_Q=%d, 500kbps, GPIO16/17",
            g_config.tx_queue_len, g_config.rx_queue_len, CAN_TX_QUEUE_LEN);
   return ESP_OK;
@@ -1347,49 +1440,62 @@ void drv_sanside_print_diag(void) {
            (unsigned long)can_tx_error_count);
   ESP_LOGI(TAG, "TX queue drops: %lu", (unsigned long)can_tx_queue_drop_count);
   ESP_LOGI(TAG, "恢复次数: %lu", (unsigned long)can_recovery_count);
-  if (!west_feedback_seen) {
-    ESP_LOGW(TAG, "三思德反馈: 尚未收到 01/02/03/04 返回帧，可能是地址不匹配或驱动未按协议回传");
-  } else {
-    uint32_t age_ms = now_ms - west_last_feedback_time_ms;
-    ESP_LOGI(TAG, "三思德反馈: device_id=0x%02X age=%lums %s",
-             west_last_feedback_device_id,
-             (unsigned long)age_ms,
-             west_last_feedback_device_id == WEST_DRIVER_DEVICE_ID ? "(address ok)" : "(address mismatch?)");
+  can_bus_monitor_print_diag();
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    const west_node_t *node = &west_nodes[i];
+
+    ESP_LOGI(TAG, "───────────────────────────────────────────");
+    ESP_LOGI(TAG, "节点[%d] addr=0x%02X target=0x%02X cmd L=%d R=%d",
+             i, node->address, node->target, node->speed_left, node->speed_right);
+    if (!node->feedback_seen) {
+      ESP_LOGW(TAG, "三思德反馈: 尚未收到 01/02/03/04 返回帧，可能是地址不匹配或驱动未按协议回传");
+      continue;
+    }
+    uint32_t age_ms = now_ms - node->last_feedback_time_ms;
+    ESP_LOGI(TAG, "三思德反馈: %s frames=%lu offline=%lu age=%lums",
+             node->healthy ? "在线" : "离线",
+             (unsigned long)node->feedback_frame_count,
+             (unsigned long)node->offline_count,
+             (unsigned long)age_ms);
     if (age_ms > WEST_DRIVER_FEEDBACK_TIMEOUT_MS) {
       ESP_LOGW(TAG, "三思德反馈超时: 超过%ums未收到新反馈", WEST_DRIVER_FEEDBACK_TIMEOUT_MS);
     }
-  }
 
-  if (west_speed_feedback.valid) {
-    ESP_LOGI(TAG, "反馈01 速度: M1=%" PRId32 " M2=%" PRId32 " age=%lums",
-             west_speed_feedback.motor1_speed,
-             west_speed_feedback.motor2_speed,
-             (unsigned long)(now_ms - west_speed_feedback.timestamp_ms));
-  }
-  if (west_current_feedback.valid) {
-    ESP_LOGI(TAG, "反馈02 电流/电压: I1=%.1f I2=%.1f Vbus=%.1f FB=%u LR=%u age=%lums",
-             west_current_feedback.motor1_current_raw / 10.0f,
-             west_current_feedback.motor2_current_raw / 10.0f,
-             west_current_feedback.bus_voltage_raw / 10.0f,
-             west_current_feedback.fb_channel_raw,
-             west_current_feedback.lr_channel_raw,
-             (unsigned long)(now_ms - west_current_feedback.timestamp_ms));
-  }
-  if (west_status_feedback.valid) {
-    ESP_LOGI(TAG, "反馈03 温度/故障: T1=%.1f T2=%.1f F1=0x%04X(%s) F2=0x%04X(%s) age=%lums",
-             west_status_feedback.temp1_raw / 10.0f,
-             west_status_feedback.temp2_raw / 10.0f,
-             west_status_feedback.fault1_bits,
-             west_driver_fault_summary(west_status_feedback.fault1_bits),
-             west_status_feedback.fault2_bits,
-             west_driver_fault_summary(west_status_feedback.fault2_bits),
-             (unsigned long)(now_ms - west_status_feedback.timestamp_ms));
-  }
-  if (west_position_feedback.valid) {
-    ESP_LOGI(TAG, "反馈04 位置: M1=%" PRId32 " M2=%" PRId32 " age=%lums",
-             west_position_feedback.motor1_position,
-             west_position_feedback.motor2_position,
-             (unsigned long)(now_ms - west_position_feedback.timestamp_ms));
+    if (node->speed.valid) {
+      ESP_LOGI(TAG, "反馈01 速度: M1=%" PRId32 " M2=%" PRId32 " age=%lums",
+               node->speed.motor1_speed,
+               node->speed.motor2_speed,
+               (unsigned long)(now_ms - node->speed.timestamp_ms));
+    }
+    if (node->current.valid) {
+      ESP_LOGI(TAG, "反馈02 电流/电压: I1=%.1f I2=%.1f Vbus=%.1f FB=%u LR=%u age=%lums",
+               node->current.motor1_current_raw / 10.0f,
+               node->current.motor2_current_raw / 10.0f,
+               node->current.bus_voltage_raw / 10.0f,
+               node->current.fb_channel_raw,
+               node->current.lr_channel_raw,
+               (unsigned long)(now_ms - node->current.timestamp_ms));
+    }
+    if (node->status.valid) {
+      ESP_LOGI(TAG, "反馈03 温度/故障: T1=%.1f T2=%.1f F1=0x%04X(%s) F2=0x%04X(%s) age=%lums",
+               node->status.temp1_raw / 10.0f,
+               node->status.temp2_raw / 10.0f,
+               node->status.fault1_bits,
+               west_driver_fault_summary(node->status.fault1_bits),
+               node->status.fault2_bits,
+               west_driver_fault_summary(node->status.fault2_bits),
+               (unsigned long)(now_ms - node->status.timestamp_ms));
+    }
+    if (node->position.valid) {
+      ESP_LOGI(TAG, "反馈04 位置: M1=%" PRId32 " M2=%" PRId32 " age=%lums",
+               node->position.motor1_position,
+               node->position.motor2_position,
+               (unsigned long)(now_ms - node->position.timestamp_ms));
+    }
+  }
+  if (west_unknown_feedback_count > 0) {
+    ESP_LOGW(TAG, "未登记地址反馈: %lu帧, 最近地址=0x%02X (address mismatch?)",
+             (unsigned long)west_unknown_feedback_count, west_last_unknown_device_id);
   }
   ESP_LOGI(TAG, "═══════════════════════════════════════════");
 }
@@ -1434,9 +1540,110 @@ uint8_t intf_move_sanside(int8_t speed_left, int8_t speed_right) {
     }
   }
 
-  latest_speed_left = speed_left;
-  latest_speed_right = speed_right;
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    west_nodes[i].speed_left = speed_left;
+    west_nodes[i].speed_right = speed_right;
+  }
   speed_cmd_pending = true;
 
   return 0;
 }
+
+/**
+ * 单独设置某个节点的速度命令（下一个CAN发送周期生效）
+ */
+esp_err_t drv_sanside_set_node_speed(uint8_t node_index, int8_t speed_left,
+                                     int8_t speed_right) {
+  if (node_index >= WEST_DRIVER_NODE_COUNT ||
+      abs(speed_left) > 100 || abs(speed_right) > 100) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  west_nodes[node_index].speed_left = speed_left;
+  west_nodes[node_index].speed_right = speed_right;
+  speed_cmd_pending = true;
+  return ESP_OK;
+}
+
+uint8_t drv_sanside_get_node_count(void) {
+  return WEST_DRIVER_NODE_COUNT;
+}
+
+esp_err_t drv_sanside_get_node_status(uint8_t node_index, drv_sanside_node_status_t *status) {
+  if (node_index >= WEST_DRIVER_NODE_COUNT || status == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const west_node_t *node = &west_nodes[node_index];
+  uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  memset(status, 0, sizeof(*status));
+  status->address = node->address;
+  status->healthy = node->healthy;
+  status->feedback_seen = node->feedback_seen;
+  status->feedback_age_ms = node->feedback_seen ? (now_ms - node->last_feedback_time_ms) : 0;
+  status->offline_count = node->offline_count;
+  status->speed_valid = node->speed.valid;
+  status->motor1_speed = node->speed.motor1_speed;
+  status->motor2_speed = node->speed.motor2_speed;
+  status->fault1_bits = node->status.valid ? node->status.fault1_bits : 0;
+  status->fault2_bits = node->status.valid ? node->status.fault2_bits : 0;
+  return ESP_OK;
+}
+
+/**
+ * 所有节点反馈都在超时窗口内时返回 true
+ */
+bool drv_sanside_all_nodes_healthy(void) {
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    if (!west_nodes[i].healthy) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * 由速度反馈估算履带前进速度：各在线节点左右电机平均转速，
+ * 按命令方向约定（前进为正）校正极性后按额定转速换算为满量程千分比
+ */
+esp_err_t drv_sanside_get_track_speed(int16_t *speed_permille) {
+  if (speed_permille == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  int64_t sum = 0;
+  int samples = 0;
+
+  for (int i = 0; i < WEST_DRIVER_NODE_COUNT; i++) {
+    const west_node_t *node = &west_nodes[i];
+    if (!node->healthy || !node->speed.valid ||
+        (now_ms - node->speed.timestamp_ms) > WEST_DRIVER_FEEDBACK_TIMEOUT_MS) {
+      continue;
+    }
+    int32_t left = node->speed.motor1_speed;
+    int32_t right = node->speed.motor2_speed;
+#if WEST_CAN_INVERT_LEFT_MOTOR
+    left = -left;
+#endif
+#if WEST_CAN_INVERT_RIGHT_MOTOR
+    right = -right;
+#endif
+    sum += (int64_t)left + right;
+    samples += 2;
+  }
+
+  if (samples == 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  int32_t permille = (int32_t)(sum * 1000 / ((int64_t)samples * WEST_DRIVER_FEEDBACK_FULL_SCALE_RPM));
+  if (permille > 1000) {
+    permille = 1000;
+  } else if (permille < -1000) {
+    permille = -1000;
+  }
+  *speed_permille = (int16_t)permille;
+  return ESP_OK;
+}
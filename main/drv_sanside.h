@@ -1,11 +1,62 @@
 #ifndef DRV_SANSIDE_H
 #define DRV_SANSIDE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "esp_err.h"
 
+/**
+ * 三思德驱动节点状态快照（供失控保护与诊断查询）
+ */
+typedef struct {
+  uint8_t address;            // 驱动器地址
+  bool healthy;               // 反馈在超时窗口内
+  bool feedback_seen;         // 是否收到过反馈
+  uint32_t feedback_age_ms;   // 距最近一次反馈的时间
+  uint32_t offline_count;     // 离线跳变次数
+  bool speed_valid;
+  int32_t motor1_speed;
+  int32_t motor2_speed;
+  uint16_t fault1_bits;
+  uint16_t fault2_bits;
+} drv_sanside_node_status_t;
+
 uint8_t intf_move_sanside(int8_t speed_left, int8_t speed_right);
 esp_err_t drv_sanside_init(void);
 void drv_sanside_print_diag(void);
 
+/**
+ * 单独设置某个节点的左右电机速度（-100~100）
+ * @param node_index 节点下标（0 ~ WEST_DRIVER_NODE_COUNT-1）
+ * @return ESP_OK=成功，ESP_ERR_INVALID_ARG=下标或速度越界
+ */
+esp_err_t drv_sanside_set_node_speed(uint8_t node_index, int8_t speed_left,
+                                     int8_t speed_right);
+
+/**
+ * 获取节点数量
+ */
+uint8_t drv_sanside_get_node_count(void);
+
+/**
+ * 获取节点状态快照
+ * @param node_index 节点下标
+ * @param status 输出状态
+ * @return ESP_OK=成功
+ */
+esp_err_t drv_sanside_get_node_status(uint8_t node_index, drv_sanside_node_status_t *status);
+
+/**
+ * 所有节点是否在线（反馈未超时）
+ * @return true=全部在线
+ */
+bool drv_sanside_all_nodes_healthy(void);
+
+/**
+ * 由速度反馈估算履带前进速度（左右平均，前进为正）
+ * @param speed_permille 输出速度，满量程千分比（-1000~1000）
+ * @return ESP_OK=成功，ESP_ERR_INVALID_STATE=无有效反馈
+ */
+esp_err_t drv_sanside_get_track_speed(int16_t *speed_permille);
+
 #endif /* DRV_SANSIDE_H */
@@ -0,0 +1,424 @@
+#include "http_client_pool.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "HTTP_POOL";
+
+typedef struct {
+    esp_http_client_handle_t client;        // NULL=未创建（下次获取时建立连接）
+    bool in_use;
+    bool dedicated;                         // 专用槽位，不计入 s_free_slots
+    bool warm;                              // 上次请求成功，连接可能仍保持
+    esp_err_t last_err;                     // 最近一次请求的传输结果
+    char origin[HTTP_POOL_ORIGIN_MAX_LEN];
+    http_event_handle_cb user_handler;
+    uint32_t last_used_ms;
+    int64_t connected_us;                   // 本次请求中建连完成时刻（0=复用连接）
+    bool request_sent;                      // 本次请求的请求头已写出（对端可能已收到请求）
+    int64_t first_header_us;                // 本次请求首个响应头时刻
+} http_pool_slot_t;
+
+static http_pool_slot_t s_slots[HTTP_POOL_MAX_CLIENTS];
+static SemaphoreHandle_t s_table_mutex = NULL;     // 保护槽位分配
+static SemaphoreHandle_t s_free_slots = NULL;      // 空闲共享槽位计数
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static http_client_pool_stats_t s_stats = {0};
+static uint64_t s_connect_sum_us = 0;
+static uint64_t s_ttfb_sum_us = 0;
+static uint32_t s_ttfb_samples = 0;
+
+/**
+ * 提取源站（scheme://host[:port]），同一源站的请求可复用连接
+ */
+static void url_origin(const char *url, char *origin, size_t size)
+{
+    const char *host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    const char *end = strchr(host, '/');
+    size_t len = end ? (size_t)(end - url) : strlen(url);
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(origin, url, len);
+    origin[len] = '\0';
+}
+
+/**
+ * 池内事件回调：记录建连/首字节时刻后转发给调用方回调
+ */
+static esp_err_t pool_event_handler(esp_http_client_event_t *evt)
+{
+    http_pool_slot_t *slot = (http_pool_slot_t *)evt->user_data;
+
+    if (slot != NULL) {
+        switch (evt->event_id) {
+            case HTTP_EVENT_ON_CONNECTED:
+                slot->connected_us = esp_timer_get_time();
+                break;
+            case HTTP_EVENT_HEADERS_SENT:
+                slot->request_sent = true;
+                break;
+            case HTTP_EVENT_ON_HEADER:
+                if (slot->first_header_us == 0) {
+                    slot->first_header_us = esp_timer_get_time();
+                }
+                break;
+            default:
+                break;
+        }
+        if (slot->user_handler != NULL) {
+            return slot->user_handler(evt);
+        }
+    }
+    return ESP_OK;
+}
+
+static http_pool_slot_t *find_slot(esp_http_client_handle_t client)
+{
+    for (int i = 0; i < HTTP_POOL_MAX_CLIENTS; i++) {
+        if (s_slots[i].client == client && s_slots[i].in_use) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void destroy_client(http_pool_slot_t *slot)
+{
+    if (slot->client != NULL) {
+        esp_http_client_cleanup(slot->client);
+        slot->client = NULL;
+    }
+    slot->warm = false;
+    slot->origin[0] = '\0';
+}
+
+esp_err_t http_client_pool_init(void)
+{
+    if (s_table_mutex != NULL) {
+        return ESP_OK;
+    }
+
+    s_table_mutex = xSemaphoreCreateMutex();
+    s_free_slots = xSemaphoreCreateCounting(HTTP_POOL_SHARED_CLIENTS, HTTP_POOL_SHARED_CLIENTS);
+    if (s_table_mutex == NULL || s_free_slots == NULL) {
+        ESP_LOGE(TAG, "❌ Failed to create pool semaphores");
+        return ESP_ERR_NO_MEM;
+    }
+    memset(s_slots, 0, sizeof(s_slots));
+    for (int i = HTTP_POOL_SHARED_CLIENTS; i < HTTP_POOL_MAX_CLIENTS; i++) {
+        s_slots[i].dedicated = true;
+    }
+
+    ESP_LOGI(TAG, "✅ HTTP client pool ready (%d shared + %d dedicated keep-alive clients)",
+             HTTP_POOL_SHARED_CLIENTS, HTTP_POOL_DEDICATED_CLIENTS);
+    return ESP_OK;
+}
+
+/**
+ * 归还未能建立客户端的槽位
+ */
+static void abandon_slot(http_pool_slot_t *slot)
+{
+    xSemaphoreTake(s_table_mutex, portMAX_DELAY);
+    slot->in_use = false;
+    xSemaphoreGive(s_table_mutex);
+    if (!slot->dedicated) {
+        xSemaphoreGive(s_free_slots);
+    }
+}
+
+/**
+ * 为已占用的槽位准备客户端：复用同源连接或新建连接
+ */
+static esp_http_client_handle_t prepare_slot(http_pool_slot_t *slot, const char *url,
+                                             const char *origin, http_event_handle_cb handler)
+{
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    if (slot->client != NULL && strcmp(slot->origin, origin) != 0) {
+        destroy_client(slot);
+    }
+
+    if (slot->client != NULL) {
+        // 服务器多半已关闭过久的空闲连接，主动断开避免一次必然失败的请求
+        if (now - slot->last_used_ms > HTTP_POOL_IDLE_CLOSE_MS) {
+            esp_http_client_close(slot->client);
+            slot->warm = false;
+            taskENTER_CRITICAL(&s_stats_lock);
+            s_stats.idle_closes++;
+            taskEXIT_CRITICAL(&s_stats_lock);
+        }
+        if (esp_http_client_set_url(slot->client, url) != ESP_OK) {
+            destroy_client(slot);
+        } else {
+            esp_http_client_set_method(slot->client, HTTP_METHOD_GET);
+            esp_http_client_set_post_field(slot->client, NULL, 0);
+            esp_http_client_set_timeout_ms(slot->client, HTTP_POOL_TIMEOUT_MS);
+        }
+    }
+
+    if (slot->client == NULL) {
+        esp_http_client_config_t config = {
+            .url = url,
+            .timeout_ms = HTTP_POOL_TIMEOUT_MS,
+            .buffer_size = HTTP_POOL_RX_BUFFER_SIZE,
+            .buffer_size_tx = HTTP_POOL_TX_BUFFER_SIZE,
+            .event_handler = pool_event_handler,
+            .user_data = slot,
+            .keep_alive_enable = true,              // TCP keep-alive，及早发现断开的连接
+            .skip_cert_common_name_check = true,    // 跳过证书验证（开发环境）
+        };
+        slot->client = esp_http_client_init(&config);
+        if (slot->client == NULL) {
+            ESP_LOGE(TAG, "❌ Failed to create HTTP client for %s", origin);
+            abandon_slot(slot);
+            return NULL;
+        }
+        strncpy(slot->origin, origin, sizeof(slot->origin) - 1);
+        slot->origin[sizeof(slot->origin) - 1] = '\0';
+    }
+
+    slot->user_handler = handler;
+    slot->last_err = ESP_OK;
+    return slot->client;
+}
+
+esp_http_client_handle_t http_client_pool_acquire(const char *url, http_event_handle_cb handler)
+{
+    if (url == NULL || http_client_pool_init() != ESP_OK) {
+        return NULL;
+    }
+
+    if (xSemaphoreTake(s_free_slots, pdMS_TO_TICKS(HTTP_POOL_ACQUIRE_TIMEOUT_MS)) != pdTRUE) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.acquire_timeouts++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGW(TAG, "⚠️ No idle HTTP client within %dms", HTTP_POOL_ACQUIRE_TIMEOUT_MS);
+        return NULL;
+    }
+
+    char origin[HTTP_POOL_ORIGIN_MAX_LEN];
+    url_origin(url, origin, sizeof(origin));
+
+    // 选择槽位：同源空闲连接 > 未创建槽位 > 最久未用的其它源站连接
+    xSemaphoreTake(s_table_mutex, portMAX_DELAY);
+    http_pool_slot_t *slot = NULL;
+    for (int i = 0; i < HTTP_POOL_SHARED_CLIENTS && slot == NULL; i++) {
+        if (!s_slots[i].in_use && s_slots[i].client != NULL &&
+            strcmp(s_slots[i].origin, origin) == 0) {
+            slot = &s_slots[i];
+        }
+    }
+    for (int i = 0; i < HTTP_POOL_SHARED_CLIENTS && slot == NULL; i++) {
+        if (!s_slots[i].in_use && s_slots[i].client == NULL) {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot == NULL) {
+        // 空闲槽位都连着其它源站：淘汰最久未用的一个
+        for (int i = 0; i < HTTP_POOL_SHARED_CLIENTS; i++) {
+            if (!s_slots[i].in_use &&
+                (slot == NULL || s_slots[i].last_used_ms < slot->last_used_ms)) {
+                slot = &s_slots[i];
+            }
+        }
+    }
+    slot->in_use = true;
+    xSemaphoreGive(s_table_mutex);
+
+    return prepare_slot(slot, url, origin, handler);
+}
+
+esp_http_client_handle_t http_client_pool_acquire_dedicated(const char *url, http_event_handle_cb handler)
+{
+    if (url == NULL || http_client_pool_init() != ESP_OK) {
+        return NULL;
+    }
+
+    char origin[HTTP_POOL_ORIGIN_MAX_LEN];
+    url_origin(url, origin, sizeof(origin));
+
+    // 选择专用槽位：同源空闲连接优先
+    xSemaphoreTake(s_table_mutex, portMAX_DELAY);
+    http_pool_slot_t *slot = NULL;
+    for (int i = HTTP_POOL_SHARED_CLIENTS; i < HTTP_POOL_MAX_CLIENTS; i++) {
+        if (s_slots[i].in_use) {
+            continue;
+        }
+        if (slot == NULL ||
+            (s_slots[i].client != NULL && strcmp(s_slots[i].origin, origin) == 0)) {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot != NULL) {
+        slot->in_use = true;
+    }
+    xSemaphoreGive(s_table_mutex);
+
+    if (slot == NULL) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.acquire_timeouts++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGW(TAG, "⚠️ No idle dedicated HTTP client");
+        return NULL;
+    }
+
+    return prepare_slot(slot, url, origin, handler);
+}
+
+esp_err_t http_client_pool_perform(esp_http_client_handle_t client, http_client_pool_timing_t *timing)
+{
+    http_pool_slot_t *slot = find_slot(client);
+    if (slot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    slot->connected_us = 0;
+    slot->first_header_us = 0;
+    slot->request_sent = false;
+    int64_t start_us = esp_timer_get_time();
+
+    esp_err_t ret = esp_http_client_perform(client);
+    bool stale_retry = false;
+    if (ret != ESP_OK && slot->warm && slot->connected_us == 0 && !slot->request_sent) {
+        // 复用的连接已被对端关闭、请求一个字节也没写出：断开后重新建连重试一次。
+        // 请求头已写出时对端可能已处理（如 POST），重发会造成重复提交，直接返回失败
+        stale_retry = true;
+        esp_http_client_close(client);
+        slot->first_header_us = 0;
+        ret = esp_http_client_perform(client);
+    }
+    int64_t end_us = esp_timer_get_time();
+
+    slot->last_err = ret;
+    slot->warm = (ret == ESP_OK);
+
+    http_client_pool_timing_t t = {
+        .reused = (ret == ESP_OK && slot->connected_us == 0),
+        .connect_us = slot->connected_us ? (uint32_t)(slot->connected_us - start_us) : 0,
+        .ttfb_us = slot->first_header_us ? (uint32_t)(slot->first_header_us - start_us) : 0,
+        .total_us = (uint32_t)(end_us - start_us),
+    };
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.requests++;
+    if (ret != ESP_OK) {
+        s_stats.failures++;
+    }
+    if (stale_retry) {
+        s_stats.stale_retries++;
+    }
+    if (t.reused) {
+        s_stats.reused_connections++;
+    } else if (slot->connected_us != 0) {
+        s_stats.new_connections++;
+        s_connect_sum_us += t.connect_us;
+        s_stats.avg_connect_us = (uint32_t)(s_connect_sum_us / s_stats.new_connections);
+    }
+    if (t.ttfb_us > 0) {
+        s_ttfb_samples++;
+        s_ttfb_sum_us += t.ttfb_us;
+        s_stats.avg_ttfb_us = (uint32_t)(s_ttfb_sum_us / s_ttfb_samples);
+    }
+    s_stats.last_connect_us = t.connect_us;
+    s_stats.last_ttfb_us = t.ttfb_us;
+    s_stats.last_total_us = t.total_us;
+    s_stats.busy_us += t.total_us;
+    s_stats.avg_total_us = (uint32_t)(s_stats.busy_us / s_stats.requests);
+    if (t.total_us > s_stats.max_total_us) {
+        s_stats.max_total_us = t.total_us;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    ESP_LOGD(TAG, "⏱️ %s %s connect=%" PRIu32 "us ttfb=%" PRIu32 "us total=%" PRIu32 "us%s",
+             slot->origin, t.reused ? "reused" : "new", t.connect_us, t.ttfb_us, t.total_us,
+             ret == ESP_OK ? "" : " (failed)");
+
+    if (timing != NULL) {
+        *timing = t;
+    }
+    return ret;
+}
+
+void http_client_pool_release(esp_http_client_handle_t client)
+{
+    if (client == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_table_mutex, portMAX_DELAY);
+    http_pool_slot_t *slot = find_slot(client);
+    if (slot == NULL) {
+        xSemaphoreGive(s_table_mutex);
+        ESP_LOGW(TAG, "⚠️ Releasing unknown HTTP client");
+        return;
+    }
+
+    if (slot->last_err != ESP_OK) {
+        // 传输失败后连接状态不可信，下次获取时重新建立
+        destroy_client(slot);
+    }
+    slot->user_handler = NULL;
+    slot->last_used_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    bool dedicated = slot->dedicated;
+    slot->in_use = false;
+    xSemaphoreGive(s_table_mutex);
+    if (!dedicated) {
+        xSemaphoreGive(s_free_slots);
+    }
+}
+
+void http_client_pool_close_idle(void)
+{
+    if (s_table_mutex == NULL) {
+        return;
+    }
+
+    int closed = 0;
+    xSemaphoreTake(s_table_mutex, portMAX_DELAY);
+    for (int i = 0; i < HTTP_POOL_MAX_CLIENTS; i++) {
+        if (!s_slots[i].in_use && s_slots[i].client != NULL) {
+            destroy_client(&s_slots[i]);
+            closed++;
+        }
+    }
+    xSemaphoreGive(s_table_mutex);
+
+    if (closed > 0) {
+        ESP_LOGI(TAG, "🔌 Closed %d idle HTTP connection(s)", closed);
+    }
+}
+
+void http_client_pool_get_stats(http_client_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void http_client_pool_print_diag(void)
+{
+    http_client_pool_stats_t stats;
+    http_client_pool_get_stats(&stats);
+
+    float reuse_rate = stats.requests > 0 ?
+                       (float)stats.reused_connections * 100.0f / (float)stats.requests : 0.0f;
+    ESP_LOGI(TAG, "📊 HTTP pool: req=%" PRIu32 " fail=%" PRIu32 " new=%" PRIu32 " reused=%" PRIu32 " (%.1f%%) stale=%" PRIu32 " idle_close=%" PRIu32,
+             stats.requests, stats.failures, stats.new_connections, stats.reused_connections,
+             reuse_rate, stats.stale_retries, stats.idle_closes);
+    ESP_LOGI(TAG, "📊 HTTP timing: connect avg=%" PRIu32 "us ttfb avg=%" PRIu32 "us total avg=%" PRIu32 "us max=%" PRIu32 "us busy=%" PRIu32 "ms",
+             stats.avg_connect_us, stats.avg_ttfb_us, stats.avg_total_us, stats.max_total_us,
+             (uint32_t)(stats.busy_us / 1000));
+}
@@ -0,0 +1,125 @@
+#ifndef HTTP_CLIENT_POOL_H
+#define HTTP_CLIENT_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 持久化 HTTP 客户端池（云端流量）
+ *
+ *   - 按源站（scheme://host:port）复用 esp_http_client 句柄，保持 HTTP/1.1 长连接，
+ *     避免每次轮询/上报都重新做 DNS + TCP（+ TLS）握手
+ *   - 复用连接失效（服务器已关闭空闲连接）且请求尚未写出时自动重连重试一次；
+ *     请求已写出后失败不重发，避免重复提交 POST
+ *   - 传输失败后销毁句柄，下次获取时重新建立连接
+ *   - 统计每次请求的建连 / 首字节 / 总耗时
+ *
+ * 用法：
+ *   client = http_client_pool_acquire(url, handler);
+ *   esp_http_client_set_method / set_header / set_post_field ...
+ *   ret = http_client_pool_perform(client, NULL);
+ *   ... esp_http_client_get_status_code(client) ...
+ *   http_client_pool_release(client);
+ *
+ * 句柄在获取期间归调用方独占；请求头在复用时保留，请求方法、POST 数据与超时在获取时复位。
+ * 指令长轮询每次挂起约 25s，使用 http_client_pool_acquire_dedicated() 获取专用客户端，
+ * 不占用共享槽位。
+ */
+
+#define HTTP_POOL_SHARED_CLIENTS        3       // 共享客户端数量（状态上报/指令反馈/OTA 进度并发）
+#define HTTP_POOL_DEDICATED_CLIENTS     1       // 专用客户端数量（指令长轮询）
+#define HTTP_POOL_MAX_CLIENTS           (HTTP_POOL_SHARED_CLIENTS + HTTP_POOL_DEDICATED_CLIENTS)
+#define HTTP_POOL_ORIGIN_MAX_LEN        64      // 源站字符串最大长度
+#define HTTP_POOL_ACQUIRE_TIMEOUT_MS    15000   // 等待空闲客户端超时
+#define HTTP_POOL_IDLE_CLOSE_MS         45000   // 空闲超过此时长先主动断开（服务器通常 60s 关闭空闲连接）
+#define HTTP_POOL_TIMEOUT_MS            10000   // 单次请求网络超时
+#define HTTP_POOL_RX_BUFFER_SIZE        4096
+#define HTTP_POOL_TX_BUFFER_SIZE        2048
+
+/**
+ * 单次请求耗时（微秒）
+ */
+typedef struct {
+    bool reused;                    // 复用了已有连接
+    uint32_t connect_us;            // 建连耗时（复用时为 0）
+    uint32_t ttfb_us;               // 发起请求到收到首个响应头
+    uint32_t total_us;              // 发起请求到响应读取完毕
+} http_client_pool_timing_t;
+
+/**
+ * 池统计
+ */
+typedef struct {
+    uint32_t requests;
+    uint32_t failures;              // 传输层失败（不含 HTTP 4xx/5xx）
+    uint32_t new_connections;       // 新建连接次数
+    uint32_t reused_connections;    // 复用连接次数
+    uint32_t stale_retries;         // 复用连接失效后的重连重试次数
+    uint32_t idle_closes;           // 因空闲过久主动断开次数
+    uint32_t acquire_timeouts;      // 等待空闲客户端超时次数
+    uint32_t last_connect_us;
+    uint32_t last_ttfb_us;
+    uint32_t last_total_us;
+    uint32_t avg_connect_us;        // 仅统计新建连接
+    uint32_t avg_ttfb_us;
+    uint32_t avg_total_us;
+    uint32_t max_total_us;
+    uint64_t busy_us;               // 请求累计耗时（近似射频占用时间）
+} http_client_pool_stats_t;
+
+/**
+ * 初始化客户端池（可重复调用）
+ */
+esp_err_t http_client_pool_init(void);
+
+/**
+ * 获取指定 URL 的客户端；优先复用同一源站的空闲长连接
+ * @param handler HTTP 事件回调（可为 NULL）
+ * @return 客户端句柄，NULL 表示超时或创建失败
+ */
+esp_http_client_handle_t http_client_pool_acquire(const char *url, http_event_handle_cb handler);
+
+/**
+ * 获取专用客户端（长时间挂起的请求，如指令长轮询），不与共享槽位竞争
+ * @param handler HTTP 事件回调（可为 NULL）
+ * @return 客户端句柄，NULL 表示专用客户端均被占用或创建失败
+ */
+esp_http_client_handle_t http_client_pool_acquire_dedicated(const char *url, http_event_handle_cb handler);
+
+/**
+ * 执行请求并记录耗时；复用连接失效时自动重连重试一次
+ * @param timing 本次请求耗时，可为 NULL
+ */
+esp_err_t http_client_pool_perform(esp_http_client_handle_t client, http_client_pool_timing_t *timing);
+
+/**
+ * 归还客户端；最近一次请求传输失败时销毁句柄，下次获取时重新连接
+ */
+void http_client_pool_release(esp_http_client_handle_t client);
+
+/**
+ * 断开全部空闲连接（Wi-Fi 断开或云客户端停止时调用）
+ */
+void http_client_pool_close_idle(void);
+
+/**
+ * 获取统计快照
+ */
+void http_client_pool_get_stats(http_client_pool_stats_t *stats);
+
+/**
+ * 打印连接复用率与耗时统计
+ */
+void http_client_pool_print_diag(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_CLIENT_POOL_H */
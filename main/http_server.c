@@ -2,11 +2,27 @@
 #include "ota_manager.h"
 #include "wifi_manager.h"
 #include "main.h"
+#include "can_bus_monitor.h"
+#include "drv_payout.h"
+#include "modbus_master.h"
+#include "rs485_scheduler.h"
+#include "json_writer.h"
+#include "http_client_pool.h"
+#include "cloud_client.h"
+#if ENABLE_SUPABASE_INTEGRATION
+#include "supabase_integration.h"
+#endif
+#include "telemetry_store.h"
+#include "telemetry_stream.h"
+#include "udp_teleop.h"
+#include "motion_arbiter.h"
+#include "device_state.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_chip_info.h"
 #include "esp_flash.h"
 #include "esp_app_desc.h"
+#include "esp_timer.h"
 #include "cJSON.h"
 #include <string.h>
 #include <inttypes.h>
@@ -17,22 +33,19 @@ static const char *TAG = "HTTP_SRV";
 // HTTP服务器句柄
 static httpd_handle_t s_server = NULL;
 
-// 回调函数指针
-static bool (*s_sbus_callback)(uint16_t* channels) = NULL;
-static bool (*s_motor_callback)(int8_t* left, int8_t* right) = NULL;
+_Static_assert(HTTP_SERVER_MAX_OPEN_SOCKETS + HTTP_SERVER_INTERNAL_SOCKETS + HTTP_POOL_MAX_CLIENTS +
+               HTTP_OTA_DOWNLOAD_SOCKETS + HTTP_UDP_TELEOP_SOCKETS <= CONFIG_LWIP_MAX_SOCKETS,
+               "socket budget exceeds CONFIG_LWIP_MAX_SOCKETS (see http_server.h)");
+
+// JSON 响应缓冲区：所有 URI 处理函数都在 httpd 单任务中执行，可安全复用
+#define HTTP_JSON_RESPONSE_BUF_SIZE 10240
+static char s_json_response_buf[HTTP_JSON_RESPONSE_BUF_SIZE];
 
 /**
- * 发送JSON响应
+ * 设置JSON响应头与状态码
  */
-static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_code)
+static void set_json_response_headers(httpd_req_t *req, int status_code)
 {
-    char *json_string = cJSON_Print(json);
-    if (json_string == NULL) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-
-    // 设置响应头
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
@@ -51,11 +64,51 @@ static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_co
     } else {
         httpd_resp_set_status(req, "200 OK");  // 默认状态
     }
+}
+
+/**
+ * 发送流式写入器生成的JSON响应
+ */
+static esp_err_t send_json_writer_response(httpd_req_t *req, json_writer_t *writer, int status_code)
+{
+    size_t len = 0;
+    esp_err_t ret = json_writer_finish(writer, &len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ JSON响应生成失败: %s (%u字节)", esp_err_to_name(ret), (unsigned)len);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    set_json_response_headers(req, status_code);
+    return httpd_resp_send(req, writer->buf, len);
+}
+
+/**
+ * 发送JSON响应（cJSON 树，紧凑格式序列化到静态缓冲区）
+ */
+static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_code)
+{
+    char *json_string = s_json_response_buf;
+    bool allocated = false;
+
+    if (!cJSON_PrintPreallocated(json, s_json_response_buf, sizeof(s_json_response_buf), false)) {
+        // 超出静态缓冲区时退回堆分配
+        json_string = cJSON_PrintUnformatted(json);
+        if (json_string == NULL) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        allocated = true;
+    }
+
+    set_json_response_headers(req, status_code);
 
     // 发送响应
     esp_err_t ret = httpd_resp_send(req, json_string, strlen(json_string));
 
-    free(json_string);
+    if (allocated) {
+        cJSON_free(json_string);
+    }
     return ret;
 }
 
@@ -100,24 +153,23 @@ static esp_err_t device_info_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateObject();
-
-    cJSON_AddStringToObject(data, "device_name", device_info.device_name);
-    cJSON_AddStringToObject(data, "firmware_version", device_info.firmware_version);
-    cJSON_AddStringToObject(data, "hardware_version", device_info.hardware_version);
-    cJSON_AddStringToObject(data, "chip_model", device_info.chip_model);
-    cJSON_AddNumberToObject(data, "flash_size", device_info.flash_size);
-    cJSON_AddNumberToObject(data, "free_heap", device_info.free_heap);
-    cJSON_AddNumberToObject(data, "uptime_seconds", device_info.uptime_seconds);
-    cJSON_AddStringToObject(data, "mac_address", device_info.mac_address);
-
-    cJSON_AddStringToObject(json, "status", "success");
-    cJSON_AddItemToObject(json, "data", data);
-
-    esp_err_t ret = send_json_response(req, json, 200);
-    cJSON_Delete(json);
-    return ret;
+    json_writer_t w;
+    json_writer_init(&w, s_json_response_buf, sizeof(s_json_response_buf));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "status", "success");
+    json_writer_begin_object(&w, "data");
+    json_writer_string(&w, "device_name", device_info.device_name);
+    json_writer_string(&w, "firmware_version", device_info.firmware_version);
+    json_writer_string(&w, "hardware_version", device_info.hardware_version);
+    json_writer_string(&w, "chip_model", device_info.chip_model);
+    json_writer_uint(&w, "flash_size", device_info.flash_size);
+    json_writer_uint(&w, "free_heap", device_info.free_heap);
+    json_writer_uint(&w, "uptime_seconds", device_info.uptime_seconds);
+    json_writer_string(&w, "mac_address", device_info.mac_address);
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
+
+    return send_json_writer_response(req, &w, 200);
 }
 
 /**
@@ -129,18 +181,17 @@ static esp_err_t device_uptime_handler(httpd_req_t *req)
 
     uint32_t uptime_seconds = xTaskGetTickCount() / configTICK_RATE_HZ;
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateObject();
-
-    cJSON_AddNumberToObject(data, "uptime_seconds", uptime_seconds);
-    cJSON_AddNumberToObject(data, "timestamp", uptime_seconds); // 为兼容性保留
-
-    cJSON_AddStringToObject(json, "status", "success");
-    cJSON_AddItemToObject(json, "data", data);
-
-    esp_err_t ret = send_json_response(req, json, 200);
-    cJSON_Delete(json);
-    return ret;
+    json_writer_t w;
+    json_writer_init(&w, s_json_response_buf, sizeof(s_json_response_buf));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "status", "success");
+    json_writer_begin_object(&w, "data");
+    json_writer_uint(&w, "uptime_seconds", uptime_seconds);
+    json_writer_uint(&w, "timestamp", uptime_seconds); // 为兼容性保留
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
+
+    return send_json_writer_response(req, &w, 200);
 }
 
 /**
@@ -156,32 +207,31 @@ static esp_err_t device_status_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateObject();
-
-    cJSON_AddBoolToObject(data, "sbus_connected", status.sbus_connected);
-    cJSON_AddBoolToObject(data, "can_connected", status.can_connected);
-    cJSON_AddBoolToObject(data, "wifi_connected", status.wifi_connected);
-    cJSON_AddStringToObject(data, "wifi_ip", status.wifi_ip);
-    cJSON_AddNumberToObject(data, "wifi_rssi", status.wifi_rssi);
-    cJSON_AddNumberToObject(data, "motor_left_speed", status.motor_left_speed);
-    cJSON_AddNumberToObject(data, "motor_right_speed", status.motor_right_speed);
-    cJSON_AddNumberToObject(data, "last_sbus_time", status.last_sbus_time);
-    cJSON_AddNumberToObject(data, "last_cmd_time", status.last_cmd_time);
+    json_writer_t w;
+    json_writer_init(&w, s_json_response_buf, sizeof(s_json_response_buf));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "status", "success");
+    json_writer_begin_object(&w, "data");
+    json_writer_bool(&w, "sbus_connected", status.sbus_connected);
+    json_writer_bool(&w, "can_connected", status.can_connected);
+    json_writer_bool(&w, "wifi_connected", status.wifi_connected);
+    json_writer_string(&w, "wifi_ip", status.wifi_ip);
+    json_writer_int(&w, "wifi_rssi", status.wifi_rssi);
+    json_writer_int(&w, "motor_left_speed", status.motor_left_speed);
+    json_writer_int(&w, "motor_right_speed", status.motor_right_speed);
+    json_writer_uint(&w, "last_sbus_time", status.last_sbus_time);
+    json_writer_uint(&w, "last_cmd_time", status.last_cmd_time);
 
     // 添加SBUS通道数组
-    cJSON *channels = cJSON_CreateArray();
+    json_writer_begin_array(&w, "sbus_channels");
     for (int i = 0; i < 16; i++) {
-        cJSON_AddItemToArray(channels, cJSON_CreateNumber(status.sbus_channels[i]));
+        json_writer_int(&w, NULL, status.sbus_channels[i]);
     }
-    cJSON_AddItemToObject(data, "sbus_channels", channels);
-
-    cJSON_AddStringToObject(json, "status", "success");
-    cJSON_AddItemToObject(json, "data", data);
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
 
-    esp_err_t ret = send_json_response(req, json, 200);
-    cJSON_Delete(json);
-    return ret;
+    return send_json_writer_response(req, &w, 200);
 }
 
 /**
@@ -197,19 +247,398 @@ static esp_err_t device_health_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateObject();
+    json_writer_t w;
+    json_writer_init(&w, s_json_response_buf, sizeof(s_json_response_buf));
+    json_writer_begin_object(&w, NULL);
+    json_writer_string(&w, "status", "success");
+    json_writer_begin_object(&w, "data");
+    json_writer_uint(&w, "uptime_seconds", health.uptime_seconds);
+    json_writer_uint(&w, "free_heap", health.free_heap);
+    json_writer_uint(&w, "min_free_heap", health.min_free_heap);
+    json_writer_uint(&w, "cpu_usage_percent", health.cpu_usage_percent);
+    json_writer_double(&w, "cpu_temperature", health.cpu_temperature);
+    json_writer_bool(&w, "watchdog_triggered", health.watchdog_triggered);
+    json_writer_uint(&w, "task_count", health.task_count);
+    json_writer_bool(&w, "wifi_healthy", health.wifi_healthy);
+    json_writer_bool(&w, "sbus_healthy", health.sbus_healthy);
+    json_writer_bool(&w, "motor_healthy", health.motor_healthy);
+
+    // CAN总线负载与各ID帧率/抖动（上一统计窗口）
+    can_bus_stats_t can_stats;
+    if (can_bus_monitor_get_stats(&can_stats) == ESP_OK) {
+        json_writer_begin_object(&w, "can_bus");
+        json_writer_double(&w, "load_percent", can_stats.load_percent);
+        json_writer_double(&w, "peak_load_percent", can_stats.peak_load_percent);
+        json_writer_uint(&w, "bits_per_sec", can_stats.bits_per_sec);
+        json_writer_uint(&w, "tx_frames_per_sec", can_stats.tx_frames_per_sec);
+        json_writer_uint(&w, "rx_frames_per_sec", can_stats.rx_frames_per_sec);
+        json_writer_uint(&w, "tx_error_counter", can_stats.tx_error_counter);
+        json_writer_uint(&w, "rx_error_counter", can_stats.rx_error_counter);
+        json_writer_uint(&w, "bus_errors_per_sec", can_stats.bus_error_delta);
+        json_writer_uint(&w, "arb_lost_per_sec", can_stats.arb_lost_delta);
+        json_writer_uint(&w, "tx_failed_per_sec", can_stats.tx_failed_delta);
+        json_writer_uint(&w, "rx_missed_per_sec", can_stats.rx_missed_delta);
+
+        json_writer_begin_array(&w, "ids");
+        for (int i = 0; i < can_stats.id_count; i++) {
+            const can_bus_id_stats_t *id_stats = &can_stats.ids[i];
+            char id_str[12];
+            snprintf(id_str, sizeof(id_str), "0x%08" PRIX32, id_stats->identifier);
+
+            json_writer_begin_object(&w, NULL);
+            json_writer_string(&w, "id", id_str);
+            json_writer_string(&w, "dir", id_stats->tx ? "tx" : "rx");
+            json_writer_uint(&w, "rate_hz", id_stats->frames_per_sec);
+            json_writer_uint(&w, "mean_interval_us", id_stats->mean_interval_us);
+            json_writer_uint(&w, "jitter_us", id_stats->jitter_us);
+            json_writer_uint(&w, "max_interval_us", id_stats->max_interval_us);
+            json_writer_uint(&w, "frames_total", id_stats->frames_total);
+            json_writer_end_object(&w);
+        }
+        json_writer_end_array(&w);
+        json_writer_end_object(&w);
+    }
+
+    // 放线设备 RS485 链路状态与 Modbus 事务统计
+    drv_payout_status_t payout_status;
+    if (drv_payout_get_status(&payout_status) == ESP_OK) {
+        modbus_master_stats_t modbus_stats;
+        modbus_master_get_stats(&modbus_stats);
+
+        json_writer_begin_object(&w, "payout");
+        json_writer_bool(&w, "online", payout_status.online);
+        json_writer_int(&w, "target_pwm", payout_status.target_pwm);
+        json_writer_begin_array(&w, "drums");
+        for (int i = 0; i < payout_status.drum_count; i++) {
+            const drv_payout_drum_status_t *drum = &payout_status.drums[i];
+            json_writer_begin_object(&w, NULL);
+            json_writer_uint(&w, "slave", drum->slave);
+            json_writer_bool(&w, "online", drum->online);
+            json_writer_int(&w, "applied_pwm", drum->applied_pwm);
+            json_writer_int(&w, "feedback_speed", drum->feedback_speed);
+            json_writer_uint(&w, "fault_code", drum->fault_code);
+            json_writer_end_object(&w);
+        }
+        json_writer_end_array(&w);
+        if (payout_status.tension_valid) {
+            json_writer_uint(&w, "tension_raw", payout_status.tension_raw);
+        }
+        json_writer_uint(&w, "requests", modbus_stats.requests);
+        json_writer_uint(&w, "failures", modbus_stats.failures);
+        json_writer_double(&w, "error_rate_percent", modbus_stats.requests > 0 ?
+                           (double)modbus_stats.failures * 100.0 / modbus_stats.requests : 0.0);
+        json_writer_uint(&w, "timeouts", modbus_stats.timeouts);
+        json_writer_uint(&w, "crc_errors", modbus_stats.crc_errors);
+        json_writer_uint(&w, "exceptions", modbus_stats.exceptions);
+        json_writer_uint(&w, "retries", modbus_stats.retries);
+        json_writer_uint(&w, "avg_latency_us", modbus_stats.avg_latency_us);
+        json_writer_uint(&w, "max_latency_us", modbus_stats.max_latency_us);
+
+        rs485_scheduler_stats_t sched_stats;
+        rs485_scheduler_get_stats(&sched_stats);
+        json_writer_double(&w, "bus_occupancy_percent", sched_stats.bus_occupancy_percent);
+        json_writer_double(&w, "bus_planned_percent", sched_stats.planned_utilization_percent);
+        json_writer_uint(&w, "missed_deadlines", sched_stats.missed_deadlines);
+        json_writer_uint(&w, "overruns", sched_stats.overruns);
+        json_writer_end_object(&w);
+    }
+
+    // 云端HTTP连接池：连接复用率与请求耗时
+    http_client_pool_stats_t pool_stats;
+    http_client_pool_get_stats(&pool_stats);
+    if (pool_stats.requests > 0) {
+        json_writer_begin_object(&w, "cloud_http");
+        json_writer_uint(&w, "requests", pool_stats.requests);
+        json_writer_uint(&w, "failures", pool_stats.failures);
+        json_writer_uint(&w, "new_connections", pool_stats.new_connections);
+        json_writer_uint(&w, "reused_connections", pool_stats.reused_connections);
+        json_writer_uint(&w, "stale_retries", pool_stats.stale_retries);
+        json_writer_uint(&w, "avg_connect_us", pool_stats.avg_connect_us);
+        json_writer_uint(&w, "avg_ttfb_us", pool_stats.avg_ttfb_us);
+        json_writer_uint(&w, "avg_total_us", pool_stats.avg_total_us);
+        json_writer_uint(&w, "max_total_us", pool_stats.max_total_us);
+        json_writer_uint(&w, "last_total_us", pool_stats.last_total_us);
+        json_writer_uint(&w, "busy_ms", pool_stats.busy_us / 1000);
+        json_writer_end_object(&w);
+    }
 
-    cJSON_AddNumberToObject(data, "uptime_seconds", health.uptime_seconds);
-    cJSON_AddNumberToObject(data, "free_heap", health.free_heap);
-    cJSON_AddNumberToObject(data, "min_free_heap", health.min_free_heap);
-    cJSON_AddNumberToObject(data, "cpu_usage_percent", health.cpu_usage_percent);
-    cJSON_AddNumberToObject(data, "cpu_temperature", health.cpu_temperature);
-    cJSON_AddBoolToObject(data, "watchdog_triggered", health.watchdog_triggered);
-    cJSON_AddNumberToObject(data, "task_count", health.task_count);
-    cJSON_AddBoolToObject(data, "wifi_healthy", health.wifi_healthy);
-    cJSON_AddBoolToObject(data, "sbus_healthy", health.sbus_healthy);
-    cJSON_AddBoolToObject(data, "motor_healthy", health.motor_healthy);
+    // Wi-Fi断线重连耗时
+    wifi_reconnect_stats_t reconnect_stats;
+    wifi_manager_get_reconnect_stats(&reconnect_stats);
+    json_writer_begin_object(&w, "wifi_reconnect");
+    json_writer_bool(&w, "reconnecting", wifi_manager_is_reconnecting());
+    json_writer_uint(&w, "disconnects", reconnect_stats.disconnects);
+    json_writer_uint(&w, "attempts", reconnect_stats.attempts);
+    json_writer_uint(&w, "recoveries", reconnect_stats.recoveries);
+    json_writer_uint(&w, "fast_recoveries", reconnect_stats.fast_recoveries);
+    json_writer_uint(&w, "last_ms", reconnect_stats.last_ms);
+    json_writer_uint(&w, "min_ms", reconnect_stats.min_ms);
+    json_writer_uint(&w, "max_ms", reconnect_stats.max_ms);
+    json_writer_begin_array(&w, "histogram");
+    for (int i = 0; i < WIFI_RECONNECT_HIST_BUCKETS; i++) {
+        json_writer_uint(&w, NULL, reconnect_stats.histogram[i]);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+
+    // OTA下载/写入流水线（最近一次）
+    ota_pipeline_stats_t ota_stats;
+    ota_manager_get_pipeline_stats(&ota_stats);
+    if (ota_stats.bytes > 0) {
+        json_writer_begin_object(&w, "ota_pipeline");
+        json_writer_bool(&w, "active", ota_stats.active);
+        json_writer_uint(&w, "bytes", ota_stats.bytes);
+        json_writer_uint(&w, "transfer_bytes", ota_stats.transfer_bytes);
+        json_writer_uint(&w, "resume_offset", ota_stats.resume_offset);
+        json_writer_bool(&w, "compressed", ota_stats.compressed);
+        json_writer_uint(&w, "elapsed_ms", ota_stats.elapsed_ms);
+        json_writer_uint(&w, "throughput_kbps", ota_stats.throughput_kbps);
+        json_writer_uint(&w, "recv_stall_ms", ota_stats.recv_stall_ms);
+        json_writer_uint(&w, "write_stall_ms", ota_stats.write_stall_ms);
+        json_writer_uint(&w, "erase_ms", ota_stats.erase_ms);
+        json_writer_uint(&w, "flash_write_ms", ota_stats.flash_write_ms);
+        json_writer_uint(&w, "inflate_ms", ota_stats.inflate_ms);
+        json_writer_uint(&w, "hash_ms", ota_stats.hash_ms);
+        json_writer_bool(&w, "hash_verified", ota_stats.hash_verified);
+        json_writer_end_object(&w);
+    }
+
+    // 云端OTA任务
+    cloud_ota_job_stats_t ota_job;
+    cloud_client_get_ota_job_stats(&ota_job);
+    if (ota_job.started > 0 || ota_job.rejected > 0) {
+        json_writer_begin_object(&w, "ota_job");
+        json_writer_bool(&w, "active", ota_job.active);
+        json_writer_string(&w, "command_id", ota_job.command_id);
+        json_writer_uint(&w, "progress", ota_job.progress);
+        json_writer_uint(&w, "started", ota_job.started);
+        json_writer_uint(&w, "rejected", ota_job.rejected);
+        json_writer_uint(&w, "progress_reports", ota_job.progress_reports);
+        json_writer_uint(&w, "progress_throttled", ota_job.progress_throttled);
+        json_writer_string(&w, "last_result", esp_err_to_name(ota_job.last_result));
+        json_writer_end_object(&w);
+    }
+
+    // 共享状态快照
+    device_state_snapshot_t state_snapshot;
+    device_state_stats_t state_stats;
+    uint32_t state_version = device_state_read(&state_snapshot);
+    device_state_get_stats(&state_stats);
+    json_writer_begin_object(&w, "device_state");
+    json_writer_uint(&w, "version", state_version);
+    json_writer_int(&w, "age_ms", state_version ? (esp_timer_get_time() - state_snapshot.published_us) / 1000 : -1);
+    json_writer_uint(&w, "publishes", state_stats.publishes);
+    json_writer_uint(&w, "read_retries", state_stats.read_retries);
+    json_writer_uint(&w, "last_collect_us", state_stats.last_collect_us);
+    json_writer_uint(&w, "max_collect_us", state_stats.max_collect_us);
+    json_writer_end_object(&w);
+
+    // 状态上报编码
+    cloud_report_stats_t report_stats;
+    cloud_client_get_report_stats(&report_stats);
+    json_writer_begin_object(&w, "cloud_report");
+    json_writer_string(&w, "encoding", report_stats.binary_active ? "binary" : "json");
+    json_writer_uint(&w, "reports", report_stats.reports);
+    json_writer_uint(&w, "last_bytes", report_stats.last_bytes);
+    json_writer_int(&w, "last_encode_heap_blocks", report_stats.last_encode_heap_blocks);
+    json_writer_int(&w, "last_encode_heap_bytes", report_stats.last_encode_heap_bytes);
+    json_writer_uint(&w, "encode_heap_reports", report_stats.encode_heap_reports);
+    json_writer_int(&w, "last_send_heap_blocks", report_stats.last_send_heap_blocks);
+    json_writer_int(&w, "last_send_heap_bytes", report_stats.last_send_heap_bytes);
+    json_writer_uint(&w, "total_bytes", report_stats.total_bytes);
+    json_writer_uint(&w, "last_encode_us", report_stats.last_encode_us);
+    json_writer_uint(&w, "binary_keyframes", report_stats.binary_keyframes);
+    json_writer_uint(&w, "binary_deltas", report_stats.binary_deltas);
+    json_writer_begin_object(&w, "benchmark");
+    json_writer_uint(&w, "json_bytes", report_stats.bench_json_bytes);
+    json_writer_uint(&w, "json_us", report_stats.bench_json_us);
+    json_writer_uint(&w, "keyframe_bytes", report_stats.bench_keyframe_bytes);
+    json_writer_uint(&w, "keyframe_us", report_stats.bench_keyframe_us);
+    json_writer_uint(&w, "delta_bytes", report_stats.bench_delta_bytes);
+    json_writer_uint(&w, "delta_us", report_stats.bench_delta_us);
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
+
+    // 云端指令下发延迟
+    cloud_command_latency_stats_t latency_stats;
+    cloud_client_get_command_latency_stats(&latency_stats);
+    cloud_command_parse_stats_t parse_stats;
+    cloud_client_get_command_parse_stats(&parse_stats);
+    json_writer_begin_object(&w, "cloud_commands");
+    json_writer_bool(&w, "long_poll_active", latency_stats.long_poll_active);
+    json_writer_uint(&w, "long_poll_fallbacks", latency_stats.long_poll_fallbacks);
+    json_writer_uint(&w, "delivered", latency_stats.delivered);
+    json_writer_uint(&w, "last_latency_ms", latency_stats.last_ms);
+    json_writer_uint(&w, "avg_latency_ms", latency_stats.avg_ms);
+    json_writer_uint(&w, "max_latency_ms", latency_stats.max_ms);
+    json_writer_uint(&w, "over_target", latency_stats.over_target);
+    json_writer_begin_object(&w, "parse");
+    json_writer_uint(&w, "responses", parse_stats.responses);
+    json_writer_uint(&w, "last_us", parse_stats.last_parse_us);
+    json_writer_uint(&w, "max_us", parse_stats.max_parse_us);
+    json_writer_uint(&w, "last_tokens", parse_stats.last_tokens);
+    json_writer_uint(&w, "max_tokens", parse_stats.max_tokens);
+    json_writer_uint(&w, "token_errors", parse_stats.token_errors);
+    if (parse_stats.bench_bytes > 0) {
+        json_writer_begin_object(&w, "bench");
+        json_writer_uint(&w, "bytes", parse_stats.bench_bytes);
+        json_writer_uint(&w, "tokenizer_us", parse_stats.bench_token_us);
+        json_writer_uint(&w, "tokenizer_stack_bytes", parse_stats.bench_token_ram);
+        json_writer_uint(&w, "cjson_us", parse_stats.bench_cjson_us);
+        json_writer_uint(&w, "cjson_heap_peak", parse_stats.bench_cjson_heap_peak);
+        json_writer_end_object(&w);
+    }
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
+
+    // 云端指令执行器
+    cloud_command_exec_stats_t exec_stats;
+    cloud_client_get_command_exec_stats(&exec_stats);
+    json_writer_begin_object(&w, "command_exec");
+    json_writer_uint(&w, "queued", exec_stats.queued);
+    json_writer_uint(&w, "dropped", exec_stats.dropped);
+    json_writer_uint(&w, "duplicates", exec_stats.duplicates);
+    json_writer_uint(&w, "executed", exec_stats.executed);
+    json_writer_uint(&w, "pending_safety", exec_stats.pending[CLOUD_CMD_PRIORITY_SAFETY]);
+    json_writer_uint(&w, "pending_config", exec_stats.pending[CLOUD_CMD_PRIORITY_CONFIG]);
+    json_writer_uint(&w, "pending_system", exec_stats.pending[CLOUD_CMD_PRIORITY_SYSTEM]);
+    json_writer_begin_object(&w, "feedback");
+    json_writer_uint(&w, "updates", exec_stats.feedback_updates);
+    json_writer_uint(&w, "coalesced", exec_stats.feedback_coalesced);
+    json_writer_uint(&w, "batches", exec_stats.feedback_batches);
+    json_writer_uint(&w, "sent", exec_stats.feedback_sent);
+    json_writer_uint(&w, "failed", exec_stats.feedback_failed);
+    json_writer_uint(&w, "dropped", exec_stats.feedback_dropped);
+    json_writer_end_object(&w);
+    json_writer_begin_array(&w, "types");
+    for (int type = 0; type < CLOUD_CMD_TYPE_COUNT; type++) {
+        const cloud_command_type_stats_t *type_stats = &exec_stats.types[type];
+        if (type_stats->executed == 0) {
+            continue;
+        }
+        json_writer_begin_object(&w, NULL);
+        json_writer_string(&w, "type", cloud_client_command_type_name((cloud_command_type_t)type));
+        json_writer_uint(&w, "executed", type_stats->executed);
+        json_writer_uint(&w, "avg_queue_us", type_stats->avg_queue_us);
+        json_writer_uint(&w, "max_queue_us", type_stats->max_queue_us);
+        json_writer_uint(&w, "avg_exec_us", type_stats->avg_exec_us);
+        json_writer_uint(&w, "max_exec_us", type_stats->max_exec_us);
+        json_writer_end_object(&w);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+
+    // 实时遥测推送
+    telemetry_stream_stats_t stream_stats;
+    telemetry_stream_get_stats(&stream_stats);
+    json_writer_begin_object(&w, "telemetry_stream");
+    json_writer_uint(&w, "clients", stream_stats.clients);
+    json_writer_uint(&w, "subscribed", stream_stats.subscribed);
+    json_writer_uint(&w, "rejected", stream_stats.rejected);
+    json_writer_uint(&w, "frames_built", stream_stats.frames_built);
+    json_writer_uint(&w, "frames_queued", stream_stats.frames_queued);
+    json_writer_uint(&w, "frames_dropped", stream_stats.frames_dropped);
+    json_writer_uint(&w, "send_errors", stream_stats.send_errors);
+    json_writer_uint(&w, "bytes_sent", stream_stats.bytes_sent);
+    json_writer_uint(&w, "last_build_us", stream_stats.last_build_us);
+    json_writer_uint(&w, "max_build_us", stream_stats.max_build_us);
+    json_writer_end_object(&w);
+
+    // 运动输入源仲裁
+    motion_arbiter_stats_t arbiter_stats;
+    motion_arbiter_get_stats(&arbiter_stats);
+    json_writer_begin_object(&w, "motion_arbiter");
+    if (arbiter_stats.active >= 0) {
+        json_writer_string(&w, "active", arbiter_stats.sources[arbiter_stats.active].name);
+    } else {
+        json_writer_null(&w, "active");
+    }
+    json_writer_uint(&w, "handovers", arbiter_stats.handovers);
+    json_writer_uint(&w, "stale_stops", arbiter_stats.stale_stops);
+    json_writer_uint(&w, "steps", arbiter_stats.steps);
+    json_writer_uint(&w, "last_step_us", arbiter_stats.last_step_us);
+    json_writer_uint(&w, "max_step_us", arbiter_stats.max_step_us);
+    json_writer_begin_array(&w, "sources");
+    for (uint32_t i = 0; i < arbiter_stats.source_count; i++) {
+        const motion_source_stats_t *src = &arbiter_stats.sources[i];
+        json_writer_begin_object(&w, NULL);
+        json_writer_string(&w, "name", src->name);
+        json_writer_uint(&w, "priority", src->priority);
+        json_writer_bool(&w, "enabled", src->enabled);
+        json_writer_bool(&w, "fresh", src->fresh);
+        json_writer_uint(&w, "inputs", src->inputs);
+        json_writer_uint(&w, "applied", src->applied);
+        json_writer_uint(&w, "acquired", src->acquired);
+        json_writer_uint(&w, "lost", src->lost);
+        if (src->age_ms != UINT32_MAX) {
+            json_writer_uint(&w, "age_ms", src->age_ms);
+        } else {
+            json_writer_null(&w, "age_ms");
+        }
+        json_writer_end_object(&w);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+
+#if ENABLE_SUPABASE_INTEGRATION
+    // Supabase定时上报与定时器服务延迟
+    supabase_upload_stats_t upload_stats;
+    supabase_integration_get_upload_stats(&upload_stats);
+    json_writer_begin_object(&w, "supabase_upload");
+    json_writer_uint(&w, "posted", upload_stats.posted);
+    json_writer_uint(&w, "coalesced", upload_stats.coalesced);
+    json_writer_uint(&w, "dropped", upload_stats.dropped);
+    json_writer_uint(&w, "uploads", upload_stats.uploads);
+    json_writer_uint(&w, "upload_failures", upload_stats.upload_failures);
+    json_writer_uint(&w, "upload_last_ms", upload_stats.upload_last_ms);
+    json_writer_uint(&w, "upload_max_ms", upload_stats.upload_max_ms);
+    json_writer_uint(&w, "callback_max_us", upload_stats.callback_max_us);
+    json_writer_uint(&w, "timer_lateness_last_us", upload_stats.timer_lateness_last_us);
+    json_writer_uint(&w, "timer_lateness_max_us", upload_stats.timer_lateness_max_us);
+    json_writer_end_object(&w);
+#endif
+
+#if ENABLE_UDP_TELEOP
+    // 局域网UDP遥控
+    udp_teleop_stats_t teleop_stats;
+    udp_teleop_get_stats(&teleop_stats);
+    json_writer_begin_object(&w, "udp_teleop");
+    json_writer_bool(&w, "active", teleop_stats.active);
+    json_writer_uint(&w, "session", teleop_stats.session);
+    json_writer_uint(&w, "last_seq", teleop_stats.last_seq);
+    json_writer_uint(&w, "rx_packets", teleop_stats.rx_packets);
+    json_writer_uint(&w, "accepted", teleop_stats.accepted);
+    json_writer_uint(&w, "bad_format", teleop_stats.bad_format);
+    json_writer_uint(&w, "bad_auth", teleop_stats.bad_auth);
+    json_writer_uint(&w, "out_of_order", teleop_stats.out_of_order);
+    json_writer_uint(&w, "session_rejected", teleop_stats.session_rejected);
+    json_writer_uint(&w, "session_changes", teleop_stats.session_changes);
+    json_writer_uint(&w, "challenges", teleop_stats.challenges);
+    json_writer_uint(&w, "coalesced", teleop_stats.coalesced);
+    json_writer_uint(&w, "deadman_trips", teleop_stats.deadman_trips);
+    json_writer_uint(&w, "apply_last_us", teleop_stats.apply_last_us);
+    json_writer_uint(&w, "apply_max_us", teleop_stats.apply_max_us);
+    json_writer_uint(&w, "can_last_us", teleop_stats.can_last_us);
+    json_writer_uint(&w, "can_avg_us", teleop_stats.can_avg_us);
+    json_writer_uint(&w, "can_max_us", teleop_stats.can_max_us);
+    json_writer_uint(&w, "can_samples", teleop_stats.can_samples);
+    json_writer_end_object(&w);
+#endif
+
+    // 离线遥测存储
+    telemetry_store_stats_t store_stats;
+    telemetry_store_get_stats(&store_stats);
+    json_writer_begin_object(&w, "telemetry_store");
+    json_writer_bool(&w, "mounted", store_stats.mounted);
+    json_writer_uint(&w, "pending", store_stats.pending_records);
+    json_writer_uint(&w, "appended", store_stats.appended);
+    json_writer_uint(&w, "uploaded", store_stats.committed);
+    json_writer_uint(&w, "evicted", store_stats.evicted);
+    json_writer_uint(&w, "corrupt", store_stats.corrupt);
+    json_writer_uint(&w, "write_errors", store_stats.write_errors);
+    json_writer_uint(&w, "bytes_used", store_stats.bytes_used);
+    json_writer_uint(&w, "segments", store_stats.segments);
+    json_writer_end_object(&w);
 
     // 计算整体健康评分
     int health_score = 100;
@@ -219,18 +648,15 @@ static esp_err_t device_health_handler(httpd_req_t *req)
     if (health.free_heap < 50000) health_score -= 10;  // 内存不足
     if (health.cpu_usage_percent > 80) health_score -= 10;  // CPU使用率过高
 
-    cJSON_AddNumberToObject(data, "health_score", health_score);
-    cJSON_AddStringToObject(data, "health_status", 
-                          health_score >= 80 ? "excellent" :
-                          health_score >= 60 ? "good" :
-                          health_score >= 40 ? "warning" : "critical");
-
-    cJSON_AddStringToObject(json, "status", "success");
-    cJSON_AddItemToObject(json, "data", data);
+    json_writer_int(&w, "health_score", health_score);
+    json_writer_string(&w, "health_status",
+                       health_score >= 80 ? "excellent" :
+                       health_score >= 60 ? "good" :
+                       health_score >= 40 ? "warning" : "critical");
+    json_writer_end_object(&w);
+    json_writer_end_object(&w);
 
-    esp_err_t ret = send_json_response(req, json, 200);
-    cJSON_Delete(json);
-    return ret;
+    return send_json_writer_response(req, &w, 200);
 }
 
 /**
@@ -263,40 +689,51 @@ static esp_err_t ota_upload_handler(httpd_req_t *req)
         return ret;
     }
 
-    // 接收并写入固件数据
-    char *buffer = malloc(HTTP_UPLOAD_CHUNK_SIZE);
-    if (buffer == NULL) {
+    // 接收与Flash写入并行：本任务接收数据，OTA写入任务擦写Flash
+    if (ota_manager_pipeline_start() != ESP_OK) {
         ota_manager_abort();
         httpd_resp_send_500(req);
         return ESP_FAIL;
     }
 
     int remaining = req->content_len;
-    while (remaining > 0) {
-        int recv_len = httpd_req_recv(req, buffer,
-                                     remaining > HTTP_UPLOAD_CHUNK_SIZE ?
-                                     HTTP_UPLOAD_CHUNK_SIZE : remaining);
-        if (recv_len <= 0) {
-            if (recv_len == HTTPD_SOCK_ERR_TIMEOUT) {
-                continue;
-            }
-            ESP_LOGE(TAG, "❌ Failed to receive OTA data");
+    bool recv_failed = false;
+    while (remaining > 0 && !recv_failed) {
+        uint8_t *buffer = ota_manager_pipeline_acquire();
+        if (buffer == NULL) {
+            ESP_LOGE(TAG, "❌ Failed to write OTA data");
+            ota_ret = ESP_FAIL;
             break;
         }
 
-        // 写入OTA数据
-        ota_ret = ota_manager_write(buffer, recv_len);
-        if (ota_ret != ESP_OK) {
-            ESP_LOGE(TAG, "❌ Failed to write OTA data");
-            break;
+        int filled = 0;
+        while (filled < OTA_PIPELINE_BUFFER_SIZE && filled < remaining) {
+            int want = remaining - filled;
+            if (want > OTA_PIPELINE_BUFFER_SIZE - filled) {
+                want = OTA_PIPELINE_BUFFER_SIZE - filled;
+            }
+            int recv_len = httpd_req_recv(req, (char *)buffer + filled, want);
+            if (recv_len <= 0) {
+                if (recv_len == HTTPD_SOCK_ERR_TIMEOUT) {
+                    continue;
+                }
+                ESP_LOGE(TAG, "❌ Failed to receive OTA data");
+                recv_failed = true;
+                break;
+            }
+            filled += recv_len;
         }
 
-        remaining -= recv_len;
-        ESP_LOGI(TAG, "📥 OTA progress: %d/%d bytes",
-                req->content_len - remaining, req->content_len);
+        ota_manager_pipeline_submit(buffer, recv_failed ? 0 : filled);
+        if (!recv_failed) {
+            remaining -= filled;
+        }
     }
 
-    free(buffer);
+    esp_err_t write_ret = ota_manager_pipeline_finish(recv_failed || ota_ret != ESP_OK);
+    if (ota_ret == ESP_OK) {
+        ota_ret = write_ret;
+    }
 
     // 完成OTA更新
     if (remaining == 0 && ota_ret == ESP_OK) {
@@ -685,6 +1122,15 @@ static esp_err_t register_handlers(httpd_handle_t server)
     };
     httpd_register_uri_handler(server, &device_status_uri);
 
+    // 实时遥测推送（SSE）
+    httpd_uri_t device_stream_uri = {
+        .uri = API_DEVICE_STREAM,
+        .method = HTTP_GET,
+        .handler = telemetry_stream_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &device_stream_uri);
+
     // 系统健康检查API
     httpd_uri_t device_health_uri = {
         .uri = API_DEVICE_HEALTH,
@@ -802,7 +1248,8 @@ esp_err_t http_server_start(void)
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_SERVER_PORT;
-    config.max_uri_handlers = 13;  // 增加到13个以支持所有OTA接口
+    config.max_open_sockets = HTTP_SERVER_MAX_OPEN_SOCKETS;
+    config.max_uri_handlers = 14;  // OTA接口与实时遥测推送
     config.max_resp_headers = 8;
     config.stack_size = 8192;
 
@@ -814,6 +1261,9 @@ esp_err_t http_server_start(void)
 
     // 注册处理函数
     ret = register_handlers(s_server);
+    if (ret == ESP_OK) {
+        ret = telemetry_stream_start(s_server);
+    }
     if (ret != ESP_OK) {
         httpd_stop(s_server);
         s_server = NULL;
@@ -835,6 +1285,7 @@ esp_err_t http_server_stop(void)
     }
 
     ESP_LOGI(TAG, "🛑 Stopping HTTP Server...");
+    telemetry_stream_stop();
     esp_err_t ret = httpd_stop(s_server);
     s_server = NULL;
 
@@ -922,35 +1373,26 @@ esp_err_t http_server_get_device_status(device_status_t* status)
 
     memset(status, 0, sizeof(device_status_t));
 
-    // 获取Wi-Fi状态
-    wifi_status_t wifi_status;
-    if (wifi_manager_get_status(&wifi_status) == ESP_OK) {
-        status->wifi_connected = (wifi_status.state == WIFI_STATE_CONNECTED);
-        strncpy(status->wifi_ip, wifi_status.ip_address, sizeof(status->wifi_ip) - 1);
-        status->wifi_ip[sizeof(status->wifi_ip) - 1] = '\0';  // 确保字符串结束
-        status->wifi_rssi = wifi_status.rssi;
-    }
-
-    // 获取SBUS状态（通过回调函数）
-    if (s_sbus_callback != NULL) {
-        status->sbus_connected = s_sbus_callback(status->sbus_channels);
+    // 读取共享状态快照，与云端上报保持一致
+    device_status_data_t snapshot;
+    esp_err_t ret = device_state_get_status(&snapshot);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    // 获取电机状态（通过回调函数）
-    if (s_motor_callback != NULL) {
-        // 注意：这里获取的是电机状态，不是CAN状态
-        bool motor_active = s_motor_callback(&status->motor_left_speed, &status->motor_right_speed);
-        // 电机状态不等于CAN状态，这里不设置can_connected
-        (void)motor_active; // 避免未使用变量警告
+    status->sbus_connected = snapshot.sbus_connected;
+    status->can_connected = snapshot.can_connected;
+    status->wifi_connected = snapshot.wifi_connected;
+    memcpy(status->wifi_ip, snapshot.wifi_ip, sizeof(status->wifi_ip));
+    status->wifi_ip[sizeof(status->wifi_ip) - 1] = '\0';  // 确保字符串结束
+    status->wifi_rssi = (int8_t)snapshot.wifi_rssi;
+    for (int i = 0; i < 16; i++) {
+        status->sbus_channels[i] = (uint16_t)snapshot.sbus_channels[i];
     }
-
-    // CAN状态检测 - 目前没有实际CAN硬件，设置为未连接
-    // TODO: 当有实际CAN硬件时，在此处添加真实的CAN状态检测
-    status->can_connected = false;
-
-    // 设置时间戳 - 将系统滴答计数转换为毫秒
-    status->last_sbus_time = g_last_sbus_update * portTICK_PERIOD_MS;
-    status->last_cmd_time = g_last_motor_update * portTICK_PERIOD_MS;
+    status->motor_left_speed = (int8_t)snapshot.motor_left_speed;
+    status->motor_right_speed = (int8_t)snapshot.motor_right_speed;
+    status->last_sbus_time = snapshot.last_sbus_time;
+    status->last_cmd_time = snapshot.last_cmd_time;
 
     return ESP_OK;
 }
@@ -1016,19 +1458,3 @@ esp_err_t http_server_get_system_health(system_health_t* health)
 
     return ESP_OK;
 }
-
-/**
- * 设置SBUS状态回调函数
- */
-void http_server_set_sbus_callback(bool (*callback)(uint16_t* channels))
-{
-    s_sbus_callback = callback;
-}
-
-/**
- * 设置电机状态回调函数
- */
-void http_server_set_motor_callback(bool (*callback)(int8_t* left, int8_t* right))
-{
-    s_motor_callback = callback;
-}
@@ -12,9 +12,23 @@
 #define HTTP_MAX_RESP_LEN       4096
 #define HTTP_UPLOAD_CHUNK_SIZE  4096
 
+/**
+ * lwIP 套接字预算（sdkconfig CONFIG_LWIP_MAX_SOCKETS=16）
+ *   httpd       HTTP_SERVER_MAX_OPEN_SOCKETS 个会话（含遥测订阅）+ 3 个内部保留（监听/控制等）= 10
+ *   云端客户端  HTTP_POOL_MAX_CLIENTS 个长连接（3 共享 + 1 指令长轮询专用）= 4
+ *   OTA 下载    1（独立的 esp_http_client）
+ *   UDP 遥控    1
+ *   合计 16，无余量；增加常驻套接字时同步调整 sdkconfig，http_server.c 编译期校验
+ */
+#define HTTP_SERVER_MAX_OPEN_SOCKETS    7
+#define HTTP_SERVER_INTERNAL_SOCKETS    3       // httpd 要求 max_open_sockets <= LWIP_MAX_SOCKETS - 3
+#define HTTP_OTA_DOWNLOAD_SOCKETS       1
+#define HTTP_UDP_TELEOP_SOCKETS         1
+
 // API端点定义
 #define API_DEVICE_INFO         "/api/device/info"
 #define API_DEVICE_STATUS       "/api/device/status"
+#define API_DEVICE_STREAM       "/api/device/stream"
 #define API_DEVICE_HEALTH       "/api/device/health"
 #define API_DEVICE_UPTIME       "/api/device/uptime"
 #define API_OTA_UPLOAD          "/api/ota/upload"
@@ -129,16 +143,4 @@ esp_err_t http_server_get_system_health(system_health_t* health);
  */
 esp_err_t http_server_get_ota_progress(ota_progress_t* progress);
 
-/**
- * 设置SBUS状态回调函数
- * @param callback 回调函数指针
- */
-void http_server_set_sbus_callback(bool (*callback)(uint16_t* channels));
-
-/**
- * 设置电机状态回调函数
- * @param callback 回调函数指针
- */
-void http_server_set_motor_callback(bool (*callback)(int8_t* left, int8_t* right));
-
 #endif /* HTTP_SERVER_H */
@@ -0,0 +1,446 @@
+#include "json_tokenizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_TOK_NUMBER_MAX_LEN     32  // 数字原文最大长度（转换时复制到栈上）
+
+// 下一个允许出现的语法单元
+typedef enum {
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_END,            // 数组开头：值或 ']'
+    EXPECT_KEY,
+    EXPECT_KEY_OR_END,              // 对象开头：键或 '}'
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_END,
+    EXPECT_NOTHING,                 // 根值已结束，只允许空白
+} expect_t;
+
+static inline expect_t after_value(int depth)
+{
+    return depth > 0 ? EXPECT_COMMA_OR_END : EXPECT_NOTHING;
+}
+
+static int new_token(json_token_t *tokens, int *count, int max_tokens, int super,
+                     json_tok_type_t type, size_t start, size_t end)
+{
+    if (*count >= max_tokens) {
+        return JSON_TOK_ERROR_NOMEM;
+    }
+    int index = (*count)++;
+    tokens[index].type = (uint8_t)type;
+    tokens[index].start = (uint16_t)start;
+    tokens[index].end = (uint16_t)end;
+    tokens[index].size = 0;
+    if (super >= 0) {
+        tokens[super].size++;
+    }
+    return index;
+}
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * 扫描字符串，pos 指向开头的引号，返回时指向结尾的引号
+ */
+static int scan_string(const char *js, size_t len, size_t *pos)
+{
+    for (size_t p = *pos + 1; p < len; p++) {
+        unsigned char c = (unsigned char)js[p];
+        if (c == '"') {
+            *pos = p;
+            return 0;
+        }
+        if (c < 0x20) {
+            return JSON_TOK_ERROR_INVAL;
+        }
+        if (c != '\\') {
+            continue;
+        }
+        if (++p >= len) {
+            return JSON_TOK_ERROR_PART;
+        }
+        switch (js[p]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                break;
+            case 'u':
+                for (int i = 0; i < 4; i++) {
+                    if (++p >= len) {
+                        return JSON_TOK_ERROR_PART;
+                    }
+                    if (hex_value(js[p]) < 0) {
+                        return JSON_TOK_ERROR_INVAL;
+                    }
+                }
+                break;
+            default:
+                return JSON_TOK_ERROR_INVAL;
+        }
+    }
+    return JSON_TOK_ERROR_PART;
+}
+
+/**
+ * 扫描基本类型，返回其结束偏移（不含）
+ */
+static int scan_primitive(const char *js, size_t len, size_t start, size_t *end)
+{
+    size_t p = start;
+    for (; p < len; p++) {
+        char c = js[p];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ']' || c == '}' || c == ':') {
+            break;
+        }
+        if ((unsigned char)c < 0x20 || (unsigned char)c >= 0x7f) {
+            return JSON_TOK_ERROR_INVAL;
+        }
+    }
+
+    size_t n = p - start;
+    char first = js[start];
+    if (first == 't') {
+        if (n != 4 || memcmp(js + start, "true", 4) != 0) {
+            return JSON_TOK_ERROR_INVAL;
+        }
+    } else if (first == 'f') {
+        if (n != 5 || memcmp(js + start, "false", 5) != 0) {
+            return JSON_TOK_ERROR_INVAL;
+        }
+    } else if (first == 'n') {
+        if (n != 4 || memcmp(js + start, "null", 4) != 0) {
+            return JSON_TOK_ERROR_INVAL;
+        }
+    } else if (first == '-' || (first >= '0' && first <= '9')) {
+        for (size_t i = start; i < p; i++) {
+            char c = js[i];
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+                return JSON_TOK_ERROR_INVAL;
+            }
+        }
+    } else {
+        return JSON_TOK_ERROR_INVAL;
+    }
+
+    *end = p;
+    return 0;
+}
+
+int json_tokenize(const char *js, size_t len, json_token_t *tokens, int max_tokens)
+{
+    if (js == NULL || tokens == NULL || len > JSON_TOK_MAX_INPUT) {
+        return JSON_TOK_ERROR_INVAL;
+    }
+
+    int stack[JSON_TOK_MAX_DEPTH];      // 未闭合容器的 token 下标
+    int depth = 0;
+    int count = 0;
+    int super = -1;                     // 新 token 挂在其下：容器，或 ':' 之后等待取值的键
+    expect_t expect = EXPECT_VALUE;
+
+    for (size_t pos = 0; pos < len; pos++) {
+        char c = js[pos];
+        int index;
+
+        switch (c) {
+            case ' ': case '\t': case '\r': case '\n':
+                break;
+
+            case '{': case '[':
+                if (expect != EXPECT_VALUE && expect != EXPECT_VALUE_OR_END) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                if (depth >= JSON_TOK_MAX_DEPTH) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                index = new_token(tokens, &count, max_tokens, super,
+                                  c == '{' ? JSON_TOK_OBJECT : JSON_TOK_ARRAY, pos, pos);
+                if (index < 0) {
+                    return index;
+                }
+                stack[depth++] = index;
+                super = index;
+                expect = c == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+                break;
+
+            case '}': case ']': {
+                if (depth == 0) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                index = stack[depth - 1];
+                bool object = c == '}';
+                if (tokens[index].type != (object ? JSON_TOK_OBJECT : JSON_TOK_ARRAY) ||
+                    (expect != EXPECT_COMMA_OR_END &&
+                     expect != (object ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END))) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                tokens[index].end = (uint16_t)(pos + 1);
+                depth--;
+                super = depth > 0 ? stack[depth - 1] : -1;
+                expect = after_value(depth);
+                break;
+            }
+
+            case '"': {
+                bool key = expect == EXPECT_KEY || expect == EXPECT_KEY_OR_END;
+                if (!key && expect != EXPECT_VALUE && expect != EXPECT_VALUE_OR_END) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                size_t start = pos + 1;
+                int ret = scan_string(js, len, &pos);
+                if (ret < 0) {
+                    return ret;
+                }
+                index = new_token(tokens, &count, max_tokens, super, JSON_TOK_STRING, start, pos);
+                if (index < 0) {
+                    return index;
+                }
+                expect = key ? EXPECT_COLON : after_value(depth);
+                break;
+            }
+
+            case ':':
+                if (expect != EXPECT_COLON) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                super = count - 1;
+                expect = EXPECT_VALUE;
+                break;
+
+            case ',':
+                if (expect != EXPECT_COMMA_OR_END) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                super = stack[depth - 1];
+                expect = tokens[super].type == JSON_TOK_OBJECT ? EXPECT_KEY : EXPECT_VALUE;
+                break;
+
+            default: {
+                if (expect != EXPECT_VALUE && expect != EXPECT_VALUE_OR_END) {
+                    return JSON_TOK_ERROR_INVAL;
+                }
+                size_t end = pos;
+                int ret = scan_primitive(js, len, pos, &end);
+                if (ret < 0) {
+                    return ret;
+                }
+                index = new_token(tokens, &count, max_tokens, super, JSON_TOK_PRIMITIVE, pos, end);
+                if (index < 0) {
+                    return index;
+                }
+                pos = end - 1;
+                expect = after_value(depth);
+                break;
+            }
+        }
+    }
+
+    return expect == EXPECT_NOTHING ? count : JSON_TOK_ERROR_PART;
+}
+
+int json_tok_skip(const json_token_t *tokens, int count, int index)
+{
+    // 每个 token 消耗自身并引入 size 个子 token（键的 size 为 1，即其值）
+    int pending = 1;
+    while (pending > 0 && index < count) {
+        pending += tokens[index].size - 1;
+        index++;
+    }
+    return index;
+}
+
+int json_tok_object_get(const char *js, const json_token_t *tokens, int count, int object, const char *key)
+{
+    if (object < 0 || object >= count || tokens[object].type != JSON_TOK_OBJECT) {
+        return -1;
+    }
+
+    int index = object + 1;
+    for (int n = 0; n < tokens[object].size && index + 1 < count; n++) {
+        if (json_tok_eq(js, &tokens[index], key)) {
+            return index + 1;
+        }
+        index = json_tok_skip(tokens, count, index + 1);
+    }
+    return -1;
+}
+
+int json_tok_array_get(const json_token_t *tokens, int count, int array, int n)
+{
+    if (array < 0 || array >= count || tokens[array].type != JSON_TOK_ARRAY ||
+        n < 0 || n >= tokens[array].size) {
+        return -1;
+    }
+
+    int index = array + 1;
+    for (int i = 0; i < n && index < count; i++) {
+        index = json_tok_skip(tokens, count, index);
+    }
+    return index < count ? index : -1;
+}
+
+bool json_tok_eq(const char *js, const json_token_t *tok, const char *str)
+{
+    size_t n = strlen(str);
+    return tok->type == JSON_TOK_STRING && (size_t)(tok->end - tok->start) == n &&
+           memcmp(js + tok->start, str, n) == 0;
+}
+
+bool json_tok_is_true(const char *js, const json_token_t *tok)
+{
+    return tok->type == JSON_TOK_PRIMITIVE && js[tok->start] == 't';
+}
+
+bool json_tok_is_number(const char *js, const json_token_t *tok)
+{
+    char c = js[tok->start];
+    return tok->type == JSON_TOK_PRIMITIVE && (c == '-' || (c >= '0' && c <= '9'));
+}
+
+/**
+ * 复制数字原文到以 '\0' 结尾的缓冲区
+ */
+static bool number_text(const char *js, const json_token_t *tok, char *buf)
+{
+    size_t n = tok->end - tok->start;
+    if (!json_tok_is_number(js, tok) || n >= JSON_TOK_NUMBER_MAX_LEN) {
+        return false;
+    }
+    memcpy(buf, js + tok->start, n);
+    buf[n] = '\0';
+    return true;
+}
+
+bool json_tok_get_double(const char *js, const json_token_t *tok, double *out)
+{
+    char buf[JSON_TOK_NUMBER_MAX_LEN];
+    if (!number_text(js, tok, buf)) {
+        return false;
+    }
+    char *end = NULL;
+    double value = strtod(buf, &end);
+    if (*end != '\0') {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+bool json_tok_get_uint64(const char *js, const json_token_t *tok, uint64_t *out)
+{
+    char buf[JSON_TOK_NUMBER_MAX_LEN];
+    if (!number_text(js, tok, buf) || buf[0] == '-') {
+        return false;
+    }
+
+    // 整数直接转换，避免 double 丢失毫秒时间戳精度；含小数或指数时按 double 截断
+    char *end = NULL;
+    uint64_t value = strtoull(buf, &end, 10);
+    if (*end != '\0') {
+        double d = strtod(buf, &end);
+        if (*end != '\0' || d < 0) {
+            return false;
+        }
+        value = (uint64_t)d;
+    }
+    *out = value;
+    return true;
+}
+
+/**
+ * 写入一个 UTF-8 编码的码点
+ */
+static size_t put_utf8(uint32_t cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+static uint32_t read_hex4(const char *p)
+{
+    return (uint32_t)(hex_value(p[0]) << 12 | hex_value(p[1]) << 8 | hex_value(p[2]) << 4 | hex_value(p[3]));
+}
+
+bool json_tok_copy_string(const char *js, const json_token_t *tok, char *out, size_t out_size)
+{
+    if (out == NULL || out_size == 0) {
+        return false;
+    }
+    out[0] = '\0';
+    if (tok->type != JSON_TOK_STRING) {
+        return false;
+    }
+
+    // 分词时已校验转义格式
+    size_t n = 0;
+    for (size_t p = tok->start; p < tok->end; p++) {
+        char utf8[4];
+        size_t len = 1;
+        utf8[0] = js[p];
+
+        if (js[p] == '\\') {
+            char e = js[++p];
+            switch (e) {
+                case 'b': utf8[0] = '\b'; break;
+                case 'f': utf8[0] = '\f'; break;
+                case 'n': utf8[0] = '\n'; break;
+                case 'r': utf8[0] = '\r'; break;
+                case 't': utf8[0] = '\t'; break;
+                case 'u': {
+                    uint32_t cp = read_hex4(js + p + 1);
+                    p += 4;
+                    // 代理对合成一个码点
+                    if (cp >= 0xD800 && cp <= 0xDBFF && p + 6 < tok->end &&
+                        js[p + 1] == '\\' && js[p + 2] == 'u') {
+                        uint32_t low = read_hex4(js + p + 3);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+                    len = put_utf8(cp, utf8);
+                    break;
+                }
+                default: utf8[0] = e; break;   // \" \\ \/
+            }
+        }
+
+        if (n + len >= out_size) {
+            out[n] = '\0';
+            return false;
+        }
+        memcpy(out + n, utf8, len);
+        n += len;
+    }
+    out[n] = '\0';
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef JSON_TOKENIZER_H
+#define JSON_TOKENIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 原地 JSON 分词器（jsmn 风格）
+ *
+ * 只扫描一遍输入，把对象/数组/字符串/基本类型记录为 token（类型 + 在原文中的起止偏移），
+ * 不分配堆内存、不复制字符串，token 数组由调用方提供（通常在栈上）。
+ * 取值时直接引用原文片段，字符串需要解码转义时再复制到调用方缓冲区。
+ * 用于解析云端指令响应，替代 cJSON 建树 + cJSON_Print 重新序列化。
+ *
+ * 用法：
+ *   json_token_t tokens[64];
+ *   int count = json_tokenize(body, len, tokens, 64);
+ *   int cmds = json_tok_object_get(body, tokens, count, 0, "commands");
+ */
+
+#define JSON_TOK_MAX_DEPTH      16      // 最大嵌套层数
+#define JSON_TOK_MAX_INPUT      65535   // token 偏移为 16 位
+
+// json_tokenize 错误码
+#define JSON_TOK_ERROR_NOMEM    (-1)    // token 数组不足
+#define JSON_TOK_ERROR_INVAL    (-2)    // 非法 JSON
+#define JSON_TOK_ERROR_PART     (-3)    // 输入不完整
+
+typedef enum {
+    JSON_TOK_UNDEFINED = 0,
+    JSON_TOK_OBJECT,
+    JSON_TOK_ARRAY,
+    JSON_TOK_STRING,
+    JSON_TOK_PRIMITIVE,                 // 数字、true、false、null
+} json_tok_type_t;
+
+typedef struct {
+    uint8_t type;                       // json_tok_type_t
+    uint16_t start;                     // 起始偏移（字符串不含引号）
+    uint16_t end;                       // 结束偏移（不含）
+    uint16_t size;                      // 对象为键数，数组为元素数，键为 1
+} json_token_t;
+
+/**
+ * 分词
+ * @param js 输入（不要求以 '\0' 结尾）
+ * @param len 输入长度
+ * @param tokens token 数组
+ * @param max_tokens 数组容量
+ * @return token 数量，负数为 JSON_TOK_ERROR_*
+ */
+int json_tokenize(const char *js, size_t len, json_token_t *tokens, int max_tokens);
+
+/**
+ * 跳过 index 处的 token 及其全部子 token
+ * @return 下一个兄弟 token 的下标
+ */
+int json_tok_skip(const json_token_t *tokens, int count, int index);
+
+/**
+ * 在对象中查找键
+ * @param object 对象 token 下标
+ * @return 值 token 下标，未找到或不是对象返回 -1
+ */
+int json_tok_object_get(const char *js, const json_token_t *tokens, int count, int object, const char *key);
+
+/**
+ * 数组第 n 个元素
+ * @return 元素 token 下标，越界或不是数组返回 -1
+ */
+int json_tok_array_get(const json_token_t *tokens, int count, int array, int n);
+
+/**
+ * 字符串 token 是否等于 str（按原文比较，不解码转义）
+ */
+bool json_tok_eq(const char *js, const json_token_t *tok, const char *str);
+
+/**
+ * 基本类型判断
+ */
+bool json_tok_is_true(const char *js, const json_token_t *tok);
+bool json_tok_is_number(const char *js, const json_token_t *tok);
+
+/**
+ * 读取数字（不是数字时返回 false，out 不变）
+ */
+bool json_tok_get_double(const char *js, const json_token_t *tok, double *out);
+bool json_tok_get_uint64(const char *js, const json_token_t *tok, uint64_t *out);
+
+/**
+ * 复制字符串 token 并解码转义（\uXXXX 转为 UTF-8）
+ * @return true=成功，false=不是字符串或缓冲区不足（仍以 '\0' 结尾）
+ */
+bool json_tok_copy_string(const char *js, const json_token_t *tok, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSON_TOKENIZER_H */
@@ -0,0 +1,212 @@
+#include "json_writer.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define JSON_WRITER_DOUBLE_PRECISION    10  // 浮点有效位数（float 统计量足够，避免 %.17g 噪声）
+
+static void put_bytes(json_writer_t *w, const char *data, size_t n)
+{
+    if (w->overflow) {
+        return;
+    }
+    // 始终为结尾 '\0' 预留一个字节
+    if (w->len + n >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+    w->buf[w->len] = '\0';
+}
+
+static inline void put_char(json_writer_t *w, char c)
+{
+    put_bytes(w, &c, 1);
+}
+
+static void put_escaped(json_writer_t *w, const char *s)
+{
+    put_char(w, '"');
+    if (s != NULL) {
+        const char *run = s;
+        for (; *s != '\0'; s++) {
+            unsigned char c = (unsigned char)*s;
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            // 先整段写出无需转义的部分
+            put_bytes(w, run, (size_t)(s - run));
+            run = s + 1;
+            switch (c) {
+                case '"':  put_bytes(w, "\\\"", 2); break;
+                case '\\': put_bytes(w, "\\\\", 2); break;
+                case '\b': put_bytes(w, "\\b", 2); break;
+                case '\f': put_bytes(w, "\\f", 2); break;
+                case '\n': put_bytes(w, "\\n", 2); break;
+                case '\r': put_bytes(w, "\\r", 2); break;
+                case '\t': put_bytes(w, "\\t", 2); break;
+                default: {
+                    char esc[7];
+                    snprintf(esc, sizeof(esc), "\\u%04x", c);
+                    put_bytes(w, esc, 6);
+                    break;
+                }
+            }
+        }
+        put_bytes(w, run, (size_t)(s - run));
+    }
+    put_char(w, '"');
+}
+
+/**
+ * 写成员前缀：必要的逗号与 "key":
+ */
+static void begin_value(json_writer_t *w, const char *key)
+{
+    if (w->depth > 0) {
+        if (!w->first[w->depth - 1]) {
+            put_char(w, ',');
+        }
+        w->first[w->depth - 1] = false;
+    }
+    if (key != NULL) {
+        put_escaped(w, key);
+        put_char(w, ':');
+    }
+}
+
+static void open_container(json_writer_t *w, const char *key, char open)
+{
+    begin_value(w, key);
+    put_char(w, open);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+    w->first[w->depth] = true;
+    w->depth++;
+}
+
+static void close_container(json_writer_t *w, char close)
+{
+    if (w->depth == 0) {
+        w->overflow = true;
+        return;
+    }
+    w->depth--;
+    put_char(w, close);
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->size = size;
+    if (buf != NULL && size > 0) {
+        buf[0] = '\0';
+    } else {
+        w->overflow = true;
+    }
+}
+
+void json_writer_begin_object(json_writer_t *w, const char *key)
+{
+    open_container(w, key, '{');
+}
+
+void json_writer_end_object(json_writer_t *w)
+{
+    close_container(w, '}');
+}
+
+void json_writer_begin_array(json_writer_t *w, const char *key)
+{
+    open_container(w, key, '[');
+}
+
+void json_writer_end_array(json_writer_t *w)
+{
+    close_container(w, ']');
+}
+
+void json_writer_string(json_writer_t *w, const char *key, const char *value)
+{
+    begin_value(w, key);
+    if (value == NULL) {
+        put_bytes(w, "null", 4);
+        return;
+    }
+    put_escaped(w, value);
+}
+
+void json_writer_int(json_writer_t *w, const char *key, int64_t value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%" PRId64, value);
+    begin_value(w, key);
+    put_bytes(w, num, (size_t)n);
+}
+
+void json_writer_uint(json_writer_t *w, const char *key, uint64_t value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%" PRIu64, value);
+    begin_value(w, key);
+    put_bytes(w, num, (size_t)n);
+}
+
+void json_writer_double(json_writer_t *w, const char *key, double value)
+{
+    begin_value(w, key);
+    // JSON 不支持 NaN/Inf，与 cJSON 一致输出 null
+    if (isnan(value) || isinf(value)) {
+        put_bytes(w, "null", 4);
+        return;
+    }
+    char num[32];
+    int n = snprintf(num, sizeof(num), "%.*g", JSON_WRITER_DOUBLE_PRECISION, value);
+    put_bytes(w, num, (size_t)n);
+}
+
+void json_writer_bool(json_writer_t *w, const char *key, bool value)
+{
+    begin_value(w, key);
+    if (value) {
+        put_bytes(w, "true", 4);
+    } else {
+        put_bytes(w, "false", 5);
+    }
+}
+
+void json_writer_null(json_writer_t *w, const char *key)
+{
+    begin_value(w, key);
+    put_bytes(w, "null", 4);
+}
+
+void json_writer_raw(json_writer_t *w, const char *key, const char *json)
+{
+    begin_value(w, key);
+    if (json == NULL || json[0] == '\0') {
+        put_bytes(w, "null", 4);
+        return;
+    }
+    put_bytes(w, json, strlen(json));
+}
+
+esp_err_t json_writer_finish(json_writer_t *w, size_t *out_len)
+{
+    if (out_len != NULL) {
+        *out_len = w->len;
+    }
+    if (w->overflow) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (w->depth != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,76 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 流式 JSON 写入器
+ *
+ * 直接把紧凑格式 JSON 写入调用方提供的缓冲区，不分配堆内存，
+ * 用于周期性状态上报与 HTTP API 响应，替代 cJSON 建树 + cJSON_Print。
+ * 缓冲区不足时置溢出标志并停止写入，由 json_writer_finish 统一报告。
+ *
+ * 用法：
+ *   json_writer_t w;
+ *   json_writer_init(&w, buf, sizeof(buf));
+ *   json_writer_begin_object(&w, NULL);
+ *   json_writer_string(&w, "status", "success");
+ *   json_writer_end_object(&w);
+ *   json_writer_finish(&w, &len);
+ */
+
+#define JSON_WRITER_MAX_DEPTH   8   // 最大嵌套层数
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+    uint8_t depth;
+    bool first[JSON_WRITER_MAX_DEPTH];  // 各层是否尚未写入成员（决定是否补逗号）
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+/**
+ * 容器：key 为 NULL 表示根节点或数组元素
+ */
+void json_writer_begin_object(json_writer_t *w, const char *key);
+void json_writer_end_object(json_writer_t *w);
+void json_writer_begin_array(json_writer_t *w, const char *key);
+void json_writer_end_array(json_writer_t *w);
+
+/**
+ * 标量：key 为 NULL 表示数组元素
+ */
+void json_writer_string(json_writer_t *w, const char *key, const char *value);
+void json_writer_int(json_writer_t *w, const char *key, int64_t value);
+void json_writer_uint(json_writer_t *w, const char *key, uint64_t value);
+void json_writer_double(json_writer_t *w, const char *key, double value);
+void json_writer_bool(json_writer_t *w, const char *key, bool value);
+void json_writer_null(json_writer_t *w, const char *key);
+
+/**
+ * 写入已序列化的 JSON 片段（调用方保证其合法）
+ */
+void json_writer_raw(json_writer_t *w, const char *key, const char *json);
+
+/**
+ * 结束写入
+ * @param out_len 输出长度（不含结尾 '\0'），可为 NULL
+ * @return ESP_OK / ESP_ERR_NO_MEM（缓冲区不足）/ ESP_ERR_INVALID_STATE（容器未闭合）
+ */
+esp_err_t json_writer_finish(json_writer_t *w, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSON_WRITER_H */
@@ -1,6 +1,7 @@
 #include "main.h"
 #include "channel_parse.h"
 #include "motor_driver.h"
+#include "can_bus_monitor.h"
 #include "sbus.h"
 #include "t12d_receiver.h"
 #include "drv_payout.h"
@@ -9,6 +10,14 @@
 #include "ota_manager.h"
 #include "cloud_client.h"
 #include "data_integration.h"
+#if ENABLE_SUPABASE_INTEGRATION
+#include "supabase_integration.h"
+#endif
+#include "device_state.h"
+#include "boot_profile.h"
+#include "udp_teleop.h"
+#include "motion_arbiter.h"
+#include "json_tokenizer.h"
 #include "log_config.h"
 #include <string.h>
 #include <inttypes.h>
@@ -23,6 +32,17 @@
 #define TASK_WDT_TIMEOUT_S      30      // 看门狗超时时间（秒）
 #define TASK_WDT_PANIC_ENABLE   true    // 超时时触发panic重启
 
+// ============================================================================
+// 运动输入源仲裁配置（优先级数值大者优先）
+// ============================================================================
+#define MOTION_PRIORITY_UDP_TELEOP  40
+#define MOTION_PRIORITY_CMD_VEL     30
+#define MOTION_PRIORITY_SBUS        20
+#define MOTION_PRIORITY_CLOUD       10
+#define SBUS_INPUT_TIMEOUT_MS       200     // SBUS失控保护
+#define CMD_VEL_INPUT_TIMEOUT_MS    1000
+#define CLOUD_MOTION_TIMEOUT_MS     1000    // 每条云端运动指令的保持时间
+
 static const char *TAG = "MAIN";
 
 static void gpio_add_to_mask_if_enabled(uint64_t *mask, gpio_num_t pin)
@@ -99,6 +119,20 @@ static StaticQueue_t cmd_queue_static_buffer;
 static uint8_t cmd_queue_static_storage[20 * sizeof(motor_cmd_t)];
 #endif
 
+// UDP遥控输入队列（长度1，接收任务覆盖写入，只保留最新命令）
+#if ENABLE_UDP_TELEOP
+static QueueHandle_t teleop_queue = NULL;
+static StaticQueue_t teleop_queue_static_buffer;
+static uint8_t teleop_queue_static_storage[1 * sizeof(udp_teleop_cmd_t)];
+#endif
+
+// 云端运动指令输入队列（长度1，指令执行任务覆盖写入）
+#if ENABLE_CLOUD_CLIENT
+static QueueHandle_t cloud_motion_queue = NULL;
+static StaticQueue_t cloud_motion_queue_static_buffer;
+static uint8_t cloud_motion_queue_static_storage[1 * sizeof(motor_cmd_t)];
+#endif
+
 // 全局状态变量（用于Web接口）
 uint16_t g_last_sbus_channels[16] = {1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500};
 int8_t g_last_motor_left = 0;
@@ -135,44 +169,6 @@ static void init_global_variables(void)
     ESP_LOGI(TAG, "✅ 全局变量初始化完成");
 }
 
-#if ENABLE_HTTP_SERVER
-/**
- * 获取SBUS状态回调函数
- * 用于HTTP服务器获取当前SBUS状态
- */
-static bool get_sbus_status(uint16_t* channels)
-{
-    if (channels == NULL) {
-        return false;
-    }
-
-    // 复制最新的SBUS通道值
-    memcpy(channels, g_last_sbus_channels, sizeof(g_last_sbus_channels));
-
-    // 检查数据是否新鲜（5秒内更新过）
-    uint32_t current_time = xTaskGetTickCount();
-    return (current_time - g_last_sbus_update) < pdMS_TO_TICKS(5000);
-}
-
-/**
- * 获取电机状态回调函数
- * 用于HTTP服务器获取当前电机状态
- */
-static bool get_motor_status(int8_t* left, int8_t* right)
-{
-    if (left == NULL || right == NULL) {
-        return false;
-    }
-
-    *left = g_last_motor_left;
-    *right = g_last_motor_right;
-
-    // 检查数据是否新鲜（5秒内更新过）
-    uint32_t current_time = xTaskGetTickCount();
-    return (current_time - g_last_motor_update) < pdMS_TO_TICKS(5000);
-}
-#endif // ENABLE_HTTP_SERVER
-
 #if ENABLE_DATA_INTEGRATION
 /**
  * 数据集成回调函数 - 获取SBUS状态
@@ -189,35 +185,16 @@ static esp_err_t data_integration_get_sbus_status_callback(bool* connected, uint
         init_global_variables();
     }
 
-    // 检查数据是否新鲜（5秒内更新过）
+    // 检查数据是否新鲜（5秒内更新过），从未收到过SBUS帧时视为未连接
     uint32_t current_time = xTaskGetTickCount();
     uint32_t time_diff = current_time - g_last_sbus_update;
-    bool has_recent_data = time_diff < pdMS_TO_TICKS(5000);
-
-    // 如果没有实际SBUS数据，模拟连接状态用于测试
-    if (!has_recent_data && g_last_sbus_update == 0) {
-        // 首次运行或没有SBUS硬件时，模拟连接状态
-        static uint32_t sbus_sim_counter = 0;
-        sbus_sim_counter++;
+    *connected = g_last_sbus_update != 0 && time_diff < pdMS_TO_TICKS(5000);
 
-        // 模拟SBUS连接状态：每8次调用中有6次显示连接
-        *connected = (sbus_sim_counter % 8) < 6;
-
-        // 模拟通道数据
-        for (int i = 0; i < 16; i++) {
-            channels[i] = 1500 + (i * 10) - 80; // 模拟不同通道的值
-        }
-        *last_time = current_time;
-    } else {
-        // 使用实际SBUS数据
-        *connected = has_recent_data;
-
-        // 复制通道数据
-        for (int i = 0; i < 16; i++) {
-            channels[i] = g_last_sbus_channels[i];
-        }
-        *last_time = g_last_sbus_update;
+    // 复制通道数据（未收到数据时为中位值）
+    for (int i = 0; i < 16; i++) {
+        channels[i] = g_last_sbus_channels[i];
     }
+    *last_time = g_last_sbus_update;
 
     ESP_LOGD(TAG, "🎮 SBUS状态回调 - 连接: %s, 数据年龄: %lums",
              *connected ? "是" : "否", (unsigned long)(time_diff * portTICK_PERIOD_MS));
@@ -263,17 +240,16 @@ static esp_err_t data_integration_get_can_status_callback(bool* connected, uint3
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 真实CAN状态检测 - 检测实际CAN硬件连接状态
-    // 目前没有实际CAN硬件连接，返回未连接状态
-    *connected = false;
-    *tx_count = 0;
-    *rx_count = 0;
-
-    // TODO: 当有实际CAN硬件时，在此处添加真实的CAN状态检测逻辑
-    // 例如：检查CAN控制器状态、错误计数器等
-    // *connected = can_driver_is_connected();
-    // *tx_count = can_driver_get_tx_count();
-    // *rx_count = can_driver_get_rx_count();
+    // 连接状态取驱动器链路健康（反馈在超时窗口内），收发计数取总线监测的累计值
+    *connected = motor_driver_is_healthy();
+    can_bus_stats_t bus;
+    if (can_bus_monitor_get_stats(&bus) == ESP_OK) {
+        *tx_count = bus.tx_frames_total;
+        *rx_count = bus.rx_frames_total;
+    } else {
+        *tx_count = 0;
+        *rx_count = 0;
+    }
 
     ESP_LOGD(TAG, "🚌 CAN状态回调 - 连接: %s, TX: %lu, RX: %lu",
              *connected ? "是" : "否", (unsigned long)*tx_count, (unsigned long)*rx_count);
@@ -321,6 +297,7 @@ static void sbus_process_task(void *pvParameters)
             if (!sbus_get_data(sbus_raw_data)) {
                 continue;
             }
+            boot_profile_mark(BOOT_PHASE_FIRST_SBUS_FRAME);
             // 解析SBUS数据
             parse_sbus_msg(sbus_raw_data, ch_val);
 
@@ -422,22 +399,200 @@ static void cmd_uart_task(void *pvParameters)
 }
 #endif // ENABLE_CMD_VEL
 
+// ============================================================================
+// 运动输入源（由 motion_arbiter 按优先级仲裁）
+// ============================================================================
+
+static sbus_data_t s_sbus_input;
+
+static bool sbus_source_poll(void *ctx)
+{
+    (void)ctx;
+    bool received = false;
+    while (xQueueReceive(sbus_queue, &s_sbus_input, 0) == pdPASS) {
+        received = true;
+    }
+    return received;
+}
+
+static void sbus_source_apply(void *ctx)
+{
+    (void)ctx;
+    parse_chan_val(s_sbus_input.channel);
+}
+
+/**
+ * 差速类输入源（CMD_VEL / UDP遥控 / 云端）共用：下发左右速度并更新Web接口状态
+ */
+static void apply_track_speed(int8_t speed_left, int8_t speed_right)
+{
+    parse_cmd_vel(speed_left, speed_right);
+    g_last_motor_left = speed_left;
+    g_last_motor_right = speed_right;
+    g_last_motor_update = xTaskGetTickCount();
+}
+
+#if ENABLE_CMD_VEL
+static motor_cmd_t s_cmd_vel_input;
+
+static bool cmd_vel_source_poll(void *ctx)
+{
+    (void)ctx;
+    bool received = false;
+    while (xQueueReceive(cmd_queue, &s_cmd_vel_input, 0) == pdPASS) {
+        received = true;
+    }
+    return received;
+}
+
+static void cmd_vel_source_apply(void *ctx)
+{
+    (void)ctx;
+    apply_track_speed(s_cmd_vel_input.speed_left, s_cmd_vel_input.speed_right);
+}
+#endif
+
+#if ENABLE_UDP_TELEOP
+static udp_teleop_cmd_t s_teleop_input;
+
+static bool teleop_source_poll(void *ctx)
+{
+    (void)ctx;
+    return xQueueReceive(teleop_queue, &s_teleop_input, 0) == pdPASS;
+}
+
+static void teleop_source_apply(void *ctx)
+{
+    (void)ctx;
+    apply_track_speed(s_teleop_input.speed_left, s_teleop_input.speed_right);
+    udp_teleop_mark_applied(&s_teleop_input);
+}
+
+static void teleop_source_lost(void *ctx)
+{
+    (void)ctx;
+    udp_teleop_mark_deadman();
+}
+#endif
+
+#if ENABLE_CLOUD_CLIENT
+static motor_cmd_t s_cloud_motion_input;
+
+static bool cloud_motion_source_enabled(void *ctx)
+{
+    (void)ctx;
+    return cloud_client_is_connected();
+}
+
+static bool cloud_motion_source_poll(void *ctx)
+{
+    (void)ctx;
+    return xQueueReceive(cloud_motion_queue, &s_cloud_motion_input, 0) == pdPASS;
+}
+
+static void cloud_motion_source_apply(void *ctx)
+{
+    (void)ctx;
+    apply_track_speed(s_cloud_motion_input.speed_left, s_cloud_motion_input.speed_right);
+}
+
+/**
+ * 云端指令回调（指令执行任务中调用）
+ * motor_control 指令数据: {"left_speed": -100~100, "right_speed": -100~100}，
+ * 写入云端运动输入队列，每条指令保持 CLOUD_MOTION_TIMEOUT_MS
+ */
+static void cloud_command_handler(const cloud_command_t *command)
+{
+    if (command->command != CLOUD_CMD_MOTOR_CONTROL) {
+        ESP_LOGW(TAG, "⚠️ 未处理的云端指令: %s", cloud_client_command_type_name(command->command));
+        return;
+    }
+
+    json_token_t tokens[8];
+    double left = 0;
+    double right = 0;
+    int count = json_tokenize(command->data, command->data_len, tokens, 8);
+    int left_tok = count > 0 ? json_tok_object_get(command->data, tokens, count, 0, "left_speed") : -1;
+    int right_tok = count > 0 ? json_tok_object_get(command->data, tokens, count, 0, "right_speed") : -1;
+    if (left_tok < 0 || right_tok < 0 ||
+        !json_tok_get_double(command->data, &tokens[left_tok], &left) ||
+        !json_tok_get_double(command->data, &tokens[right_tok], &right) ||
+        left < -100 || left > 100 || right < -100 || right > 100) {
+        ESP_LOGW(TAG, "⚠️ 云端运动指令 %s 数据无效", command->command_id);
+        return;
+    }
+
+    motor_cmd_t motion = {
+        .speed_left = (int8_t)left,
+        .speed_right = (int8_t)right,
+    };
+    xQueueOverwrite(cloud_motion_queue, &motion);
+}
+#endif
+
+static void motion_stop(const char *reason)
+{
+    channel_parse_force_stop(reason);
+    g_last_motor_left = 0;
+    g_last_motor_right = 0;
+    g_last_motor_update = xTaskGetTickCount();
+}
+
+/**
+ * 注册运动输入源（在控制任务创建前调用）
+ */
+static void motion_sources_register(void)
+{
+    motion_arbiter_init(motion_stop);
+
+#if ENABLE_UDP_TELEOP
+    motion_arbiter_register(&(motion_source_t){
+        .name = "UDP teleop",
+        .priority = MOTION_PRIORITY_UDP_TELEOP,
+        .timeout_ms = UDP_TELEOP_DEADMAN_MS,
+        .poll = teleop_source_poll,
+        .apply = teleop_source_apply,
+        .on_lost = teleop_source_lost,
+    });
+#endif
+#if ENABLE_CMD_VEL
+    motion_arbiter_register(&(motion_source_t){
+        .name = "CMD_VEL",
+        .priority = MOTION_PRIORITY_CMD_VEL,
+        .timeout_ms = CMD_VEL_INPUT_TIMEOUT_MS,
+        .poll = cmd_vel_source_poll,
+        .apply = cmd_vel_source_apply,
+    });
+#endif
+    motion_arbiter_register(&(motion_source_t){
+        .name = "SBUS",
+        .priority = MOTION_PRIORITY_SBUS,
+        .timeout_ms = SBUS_INPUT_TIMEOUT_MS,
+        .poll = sbus_source_poll,
+        .apply = sbus_source_apply,
+    });
+#if ENABLE_CLOUD_CLIENT
+    motion_arbiter_register(&(motion_source_t){
+        .name = "cloud",
+        .priority = MOTION_PRIORITY_CLOUD,
+        .timeout_ms = CLOUD_MOTION_TIMEOUT_MS,
+        .enabled = cloud_motion_source_enabled,
+        .poll = cloud_motion_source_poll,
+        .apply = cloud_motion_source_apply,
+    });
+#endif
+}
+
 /**
  * 电机控制任务
- * 接收来自SBUS（和CMD_VEL，如果启用）的命令，控制电机
+ * 每个周期由 motion_arbiter 选出优先级最高且未超时的输入源并下发，
+ * 当前输入源失效且无其他可用源时停车
  * 🐕 已添加任务看门狗监控
  */
 static void motor_control_task(void *pvParameters)
 {
-    sbus_data_t sbus_data;
     const TickType_t control_loop_delay = RTOS_DELAY_TICKS(1);
-    const TickType_t sbus_failsafe_timeout = pdMS_TO_TICKS(200);
-    bool sbus_failsafe_active = false;
-#if ENABLE_CMD_VEL
-    motor_cmd_t motor_cmd;
-    uint32_t cmd_last_time = 0;  // 🔧 修复：使用时间戳而非超时值，避免溢出问题
-    bool sbus_control = false;
-#endif
+    bool driver_failsafe_active = false;
 
     ESP_LOGI(TAG, "电机控制任务已启动");
 
@@ -453,77 +608,24 @@ static void motor_control_task(void *pvParameters)
         // 🐕 喂狗 - 表示任务正常运行
         esp_task_wdt_reset();
 
-#if ENABLE_CMD_VEL
-        // 检查是否有CMD_VEL命令
-        if (xQueueReceive(cmd_queue, &motor_cmd, 0) == pdPASS) {
-            motor_cmd_t latest_cmd;
-            while (xQueueReceive(cmd_queue, &latest_cmd, 0) == pdPASS) {
-                motor_cmd = latest_cmd;
-            }
-
-            // 收到CMD_VEL命令，优先处理
-            parse_cmd_vel(motor_cmd.speed_left, motor_cmd.speed_right);
-            cmd_last_time = xTaskGetTickCount();  // 🔧 修复：记录接收时间戳
-            sbus_control = false;
-            sbus_failsafe_active = false;
-
-            // 保存电机状态用于Web接口
-            g_last_motor_left = motor_cmd.speed_left;
-            g_last_motor_right = motor_cmd.speed_right;
-            g_last_motor_update = xTaskGetTickCount();
-        }
-        // 检查是否有SBUS数据
-        else if (xQueueReceive(sbus_queue, &sbus_data, 0) == pdPASS) {
-            sbus_data_t latest_sbus_data;
-            while (xQueueReceive(sbus_queue, &latest_sbus_data, 0) == pdPASS) {
-                sbus_data = latest_sbus_data;
-            }
-
-            // 如果没有活跃的CMD_VEL命令或CMD_VEL已超时，则处理SBUS
-            // 🔧 修复：使用差值比较避免时间戳溢出问题
-            uint32_t time_since_cmd = xTaskGetTickCount() - cmd_last_time;
-            if (sbus_control || time_since_cmd > pdMS_TO_TICKS(1000)) {
-                parse_chan_val(sbus_data.channel);
-                sbus_control = true;
-                sbus_failsafe_active = false;
-            }
-        }
-
-        TickType_t now = xTaskGetTickCount();
-        bool cmd_vel_active = (cmd_last_time != 0) &&
-                              ((now - cmd_last_time) <= pdMS_TO_TICKS(1000));
-        if (!cmd_vel_active && g_last_sbus_update != 0 &&
-            (now - g_last_sbus_update) > sbus_failsafe_timeout &&
-            !sbus_failsafe_active) {
-            channel_parse_force_stop("SBUS timeout");
-            g_last_motor_left = 0;
-            g_last_motor_right = 0;
-            g_last_motor_update = now;
-            sbus_failsafe_active = true;
-            sbus_control = true;
-        }
+#if MOTOR_DRIVER_HEALTH_FAILSAFE
+        // 驱动节点离线时不再下发新的运动命令
+        bool driver_healthy = motor_driver_is_healthy();
 #else
-        // CMD_VEL已禁用，直接处理SBUS数据
-        if (xQueueReceive(sbus_queue, &sbus_data, 0) == pdPASS) {
-            sbus_data_t latest_sbus_data;
-            while (xQueueReceive(sbus_queue, &latest_sbus_data, 0) == pdPASS) {
-                sbus_data = latest_sbus_data;
-            }
-            parse_chan_val(sbus_data.channel);
-            sbus_failsafe_active = false;
-        }
+        bool driver_healthy = true;
+#endif
+
+        motion_arbiter_step(driver_healthy);
+        channel_parse_payout_sync_step();
 
-        TickType_t now = xTaskGetTickCount();
-        if (g_last_sbus_update != 0 &&
-            (now - g_last_sbus_update) > sbus_failsafe_timeout &&
-            !sbus_failsafe_active) {
-            channel_parse_force_stop("SBUS timeout");
-            g_last_motor_left = 0;
-            g_last_motor_right = 0;
-            g_last_motor_update = now;
-            sbus_failsafe_active = true;
+        // 驱动节点离线保护：进入时停车一次，节点恢复后由下一帧输入重新驱动
+        if (!driver_healthy && !driver_failsafe_active) {
+            motion_stop("motor driver node offline");
+            driver_failsafe_active = true;
+        } else if (driver_healthy && driver_failsafe_active) {
+            ESP_LOGI(TAG, "✅ 驱动节点恢复在线，解除停车保护");
+            driver_failsafe_active = false;
         }
-#endif
 
         // 高频轮询最新输入，尽快把最新SBUS值传到CAN层
         vTaskDelay(control_loop_delay);
@@ -548,6 +650,14 @@ static void wifi_management_task(void *pvParameters)
     // 等待Wi-Fi管理器完全初始化
     vTaskDelay(pdMS_TO_TICKS(1000));
 
+#if ENABLE_UDP_TELEOP
+    // UDP遥控绑定 INADDR_ANY，获取IP前即可启动（NVS 已由 wifi_manager_init 初始化）
+    // 设备密钥未配置时不启动，遥控输入源保持失效
+    if (udp_teleop_start(teleop_queue) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ UDP teleop disabled");
+    }
+#endif
+
     // 尝试连接到默认Wi-Fi网络
     ESP_LOGI(TAG, "🔗 Attempting to connect to Wi-Fi: %s", DEFAULT_WIFI_SSID);
 
@@ -629,6 +739,7 @@ static void wifi_management_task(void *pvParameters)
         ESP_LOGI(TAG, "🌐 初始化云客户端...");
         if (cloud_client_init() == ESP_OK) {
             ESP_LOGI(TAG, "✅ 云客户端初始化成功");
+            cloud_client_set_command_callback(cloud_command_handler);
 
             // 设置设备认证（可选）
             // ESP_LOGI(TAG, "🔐 设置设备认证...");
@@ -668,6 +779,15 @@ static void wifi_management_task(void *pvParameters)
                     ESP_LOGE(TAG, "❌ 云客户端后台重试服务启动失败");
                 }
             }
+
+#if ENABLE_SUPABASE_INTEGRATION
+            // 定时上报层：定时器回调只投递请求，网络I/O在上传工作任务中执行
+            if (supabase_integration_init() == ESP_OK && supabase_integration_start() == ESP_OK) {
+                ESP_LOGI(TAG, "✅ Supabase定时上报已启动");
+            } else {
+                ESP_LOGE(TAG, "❌ Supabase定时上报启动失败");
+            }
+#endif
         } else {
             ESP_LOGE(TAG, "❌ 云客户端初始化失败");
         }
@@ -710,7 +830,11 @@ static void wifi_management_task(void *pvParameters)
 
                 // 只有在足够的时间间隔后才尝试重连，避免频繁重连
                 static uint32_t last_reconnect_time = 0;
-                if (current_time - last_reconnect_time >= MIN_RECONNECT_INTERVAL_TICKS) {
+                if (wifi_manager_is_reconnecting()) {
+                    // 驱动层后台重连进行中，不打断其退避节奏
+                    ESP_LOGD(TAG, "⏳ Background Wi-Fi reconnect in progress");
+                    cloud_client_initialized = false;
+                } else if (current_time - last_reconnect_time >= MIN_RECONNECT_INTERVAL_TICKS) {
                     ESP_LOGI(TAG, "🔄 Attempting Wi-Fi reconnection...");
                     last_reconnect_time = current_time;
 
@@ -761,6 +885,7 @@ static void wifi_management_task(void *pvParameters)
             // 初始化云客户端
             if (cloud_client_init() == ESP_OK) {
                 ESP_LOGI(TAG, "✅ 云客户端初始化成功");
+                cloud_client_set_command_callback(cloud_command_handler);
 
                 const cloud_device_info_t* device_info = cloud_client_get_device_info();
                 esp_err_t reg_ret = cloud_client_register_device(
@@ -815,10 +940,6 @@ static void http_server_task(void *pvParameters)
         return;
     }
 
-    // 设置回调函数
-    http_server_set_sbus_callback(get_sbus_status);
-    http_server_set_motor_callback(get_motor_status);
-
     while (1) {
         // HTTP服务器状态监控
         if (wifi_manager_is_connected() && !http_server_is_running()) {
@@ -832,6 +953,8 @@ static void http_server_task(void *pvParameters)
 }
 #endif // ENABLE_HTTP_SERVER
 
+static void led_power_on_blink(void);
+
 /**
  * 状态监控任务
  * 监控系统状态并控制LED红灯闪烁指示系统运行状态
@@ -849,6 +972,9 @@ static void status_monitor_task(void *pvParameters)
         ESP_LOGW(TAG, "⚠️ 状态监控任务加入看门狗失败: %s", esp_err_to_name(wdt_ret));
     }
 
+    // 上电LED闪烁指示（约1.2秒，放在此处不阻塞控制链路启动）
+    led_power_on_blink();
+
     // LED红灯闪烁控制变量
     static bool red_led_state = false;  // false=熄灭, true=点亮
     static uint32_t led_tick_count = 0;
@@ -877,6 +1003,12 @@ static void status_monitor_task(void *pvParameters)
             gpio_set_level_if_enabled(LED2_RED_PIN, red_led_state ? 0 : 1);
         }
 
+        // 首个SBUS帧与CAN控制帧到达后输出一次启动耗时
+        static bool boot_reported = false;
+        if (!boot_reported) {
+            boot_reported = boot_profile_report_if_ready();
+        }
+
         // 系统状态监控 - 减少日志频率，每30秒输出一次系统状态
         static uint32_t status_count = 0;
         status_count++;
@@ -1017,9 +1149,6 @@ static void gpio_init(void)
     gpio_set_level_if_enabled(LED2_RED_PIN, 1);
     gpio_set_level_if_enabled(LED2_GREEN_PIN, 1);
     gpio_set_level_if_enabled(LED2_BLUE_PIN, 1);
-    
-    // 执行上电LED闪烁指示
-    led_power_on_blink();
 }
 
 /**
@@ -1051,13 +1180,14 @@ static void uart_init(void)
     ESP_ERROR_CHECK(uart_set_pin(UART_CMD, UART_PIN_NO_CHANGE, GPIO_NUM_21, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
 
     // 创建CMD_VEL接收任务
-    BaseType_t xReturned = xTaskCreate(
+    BaseType_t xReturned = xTaskCreatePinnedToCore(
         cmd_uart_task,
         "cmd_uart_task",
         2048,
         NULL,
         12,
-        &cmd_task_handle);
+        &cmd_task_handle,
+        CONTROL_TASK_CORE);
 
     if (xReturned != pdPASS) {
         ESP_LOGE(TAG, "Failed to create CMD UART task");
@@ -1092,6 +1222,8 @@ static const char* get_reset_reason_str(esp_reset_reason_t reason)
 
 void app_main(void)
 {
+    boot_profile_mark(BOOT_PHASE_APP_MAIN);
+
     // ====================================================================
     // 系统初始化 - 增加调试信息
     // ====================================================================
@@ -1100,32 +1232,10 @@ void app_main(void)
     printf("Free heap at start: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
 
     // ====================================================================
-    // 🔍 重启原因诊断 - 帮助定位重启问题
+    // 启动顺序：先让 SBUS → 电机控制 → CAN 控制链路运行，
+    // 诊断输出、放线设备、OTA、Wi-Fi、HTTP 等非关键初始化放在其后
+    // （上电LED指示由状态监控任务执行，不阻塞启动）
     // ====================================================================
-    esp_reset_reason_t reset_reason = esp_reset_reason();
-    printf("\n");
-    printf("========================================\n");
-    printf("🔍 重启原因诊断\n");
-    printf("========================================\n");
-    printf("   复位原因代码: %d\n", (int)reset_reason);
-    printf("   复位原因描述: %s\n", get_reset_reason_str(reset_reason));
-    
-    // 特殊原因警告
-    if (reset_reason == ESP_RST_BROWNOUT) {
-        printf("   ⚠️ 警告: 检测到电源欠压复位!\n");
-        printf("   ⚠️ 可能原因: 电源供电不足、CAN总线负载过大、外设复位导致电流尖峰\n");
-        printf("   ⚠️ 建议: 检查电源容量，确保稳定的5V/3.3V供电\n");
-    } else if (reset_reason == ESP_RST_PANIC) {
-        printf("   ⚠️ 警告: 检测到异常/panic复位!\n");
-        printf("   ⚠️ 可能原因: 代码异常、栈溢出、非法内存访问\n");
-    } else if (reset_reason == ESP_RST_TASK_WDT) {
-        printf("   ⚠️ 警告: 检测到任务看门狗超时复位!\n");
-        printf("   ⚠️ 可能原因: 某个任务长时间阻塞，无法喂狗\n");
-    } else if (reset_reason == ESP_RST_INT_WDT) {
-        printf("   ⚠️ 警告: 检测到中断看门狗超时复位!\n");
-        printf("   ⚠️ 可能原因: 中断处理时间过长或死锁\n");
-    }
-    printf("========================================\n\n");
 
     // ====================================================================
     // 任务看门狗初始化 - 防止系统假死
@@ -1173,6 +1283,177 @@ void app_main(void)
     ESP_LOGI(TAG, "🎮 SBUS调试模式已启用");
 #endif
 
+    // 初始化GPIO
+    printf("Initializing GPIO...\n");
+    gpio_init();
+    printf("GPIO initialized OK\n");
+    printf("Free heap after GPIO: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
+    boot_profile_mark(BOOT_PHASE_GPIO_READY);
+
+    // ========================================================================
+    // 创建FreeRTOS队列（静态分配 - 优先级A优化）
+    // ========================================================================
+    printf("Creating FreeRTOS queues (static allocation)...\n");
+
+    // ⚡ 性能优化：使用静态分配，消除堆碎片，提高可靠性
+    // 队列大小：20，足够缓冲突发数据，确保控制命令不会因为队列满而被丢弃
+
+    // 创建SBUS队列（静态分配）
+    sbus_queue = xQueueCreateStatic(
+        20,                              // 队列长度
+        sizeof(sbus_data_t),            // 元素大小
+        sbus_queue_static_storage,      // 静态存储区
+        &sbus_queue_static_buffer       // 静态控制块
+    );
+
+    if (sbus_queue == NULL) {
+        printf("ERROR: Failed to create SBUS queue (static)!\n");
+        ESP_LOGE(TAG, "❌ Failed to create SBUS queue (static allocation)");
+        abort();  // 静态分配失败说明配置错误，应立即停止
+    }
+
+#if ENABLE_CMD_VEL
+    // 创建CMD_VEL队列（静态分配）
+    cmd_queue = xQueueCreateStatic(
+        20,
+        sizeof(motor_cmd_t),
+        cmd_queue_static_storage,
+        &cmd_queue_static_buffer
+    );
+
+    if (cmd_queue == NULL) {
+        printf("ERROR: Failed to create CMD queue (static)!\n");
+        ESP_LOGE(TAG, "❌ Failed to create CMD queue (static allocation)");
+        abort();
+    }
+    printf("✅ Queues created successfully (SBUS + CMD_VEL)\n");
+    printf("   SBUS queue: %u bytes (static)\n", (unsigned int)sizeof(sbus_queue_static_storage));
+    printf("   CMD queue:  %u bytes (static)\n", (unsigned int)sizeof(cmd_queue_static_storage));
+#else
+    printf("✅ Queue created successfully (SBUS only, CMD_VEL disabled)\n");
+    printf("   SBUS queue: %u bytes (static)\n", (unsigned int)sizeof(sbus_queue_static_storage));
+#endif
+#if ENABLE_UDP_TELEOP
+    teleop_queue = xQueueCreateStatic(
+        1,
+        sizeof(udp_teleop_cmd_t),
+        teleop_queue_static_storage,
+        &teleop_queue_static_buffer
+    );
+
+    if (teleop_queue == NULL) {
+        printf("ERROR: Failed to create teleop queue (static)!\n");
+        ESP_LOGE(TAG, "❌ Failed to create teleop queue (static allocation)");
+        abort();
+    }
+    printf("   Teleop queue: %u bytes (static)\n", (unsigned int)sizeof(teleop_queue_static_storage));
+#endif
+#if ENABLE_CLOUD_CLIENT
+    cloud_motion_queue = xQueueCreateStatic(
+        1,
+        sizeof(motor_cmd_t),
+        cloud_motion_queue_static_storage,
+        &cloud_motion_queue_static_buffer
+    );
+
+    if (cloud_motion_queue == NULL) {
+        printf("ERROR: Failed to create cloud motion queue (static)!\n");
+        ESP_LOGE(TAG, "❌ Failed to create cloud motion queue (static allocation)");
+        abort();
+    }
+#endif
+    printf("💾 Free heap after static queues: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
+
+    // 初始化UART（会启动CMD_VEL接收任务，须在其输入队列创建之后）
+    printf("Initializing UART...\n");
+    uart_init();
+    printf("UART initialized OK\n");
+    printf("Free heap after UART: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
+    boot_profile_mark(BOOT_PHASE_UART_READY);
+
+    // 初始化SBUS
+    printf("Initializing SBUS...\n");
+    sbus_init();
+    printf("SBUS initialized OK\n");
+    printf("Free heap after SBUS: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
+    boot_profile_mark(BOOT_PHASE_SBUS_READY);
+
+    // 初始化电机驱动
+    printf("Initializing motor driver...\n");
+    motor_driver_init();
+    printf("Motor driver initialized OK\n");
+    printf("Free heap after motor: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
+    boot_profile_mark(BOOT_PHASE_CAN_READY);
+
+    // 创建FreeRTOS任务
+    BaseType_t xReturned;
+
+    // SBUS处理任务 - 高优先级
+    xReturned = xTaskCreatePinnedToCore(
+        sbus_process_task,
+        "sbus_task",
+        4096,
+        NULL,
+        12,  // 高优先级
+        &sbus_task_handle,
+        CONTROL_TASK_CORE);
+    if (xReturned != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create SBUS task");
+    }
+
+#if ENABLE_CMD_VEL
+    // CMD_VEL处理任务已在UART初始化中创建
+#endif
+
+    // 电机控制任务 - 中优先级
+    motion_sources_register();
+    xReturned = xTaskCreatePinnedToCore(
+        motor_control_task,
+        "motor_task",
+        4096,
+        NULL,
+        10,  // 中优先级
+        &control_task_handle,
+        CONTROL_TASK_CORE);
+    if (xReturned != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create motor control task");
+    }
+    boot_profile_mark(BOOT_PHASE_CONTROL_TASKS);
+    printf("⏱️ Control path live at %lu ms\n",
+           (unsigned long)(boot_profile_get_us(BOOT_PHASE_CONTROL_TASKS) / 1000));
+
+    // ====================================================================
+    // 控制链路已运行，以下为非关键初始化
+    // ====================================================================
+
+    // ====================================================================
+    // 🔍 重启原因诊断 - 帮助定位重启问题
+    // ====================================================================
+    esp_reset_reason_t reset_reason = esp_reset_reason();
+    printf("\n");
+    printf("========================================\n");
+    printf("🔍 重启原因诊断\n");
+    printf("========================================\n");
+    printf("   复位原因代码: %d\n", (int)reset_reason);
+    printf("   复位原因描述: %s\n", get_reset_reason_str(reset_reason));
+    
+    // 特殊原因警告
+    if (reset_reason == ESP_RST_BROWNOUT) {
+        printf("   ⚠️ 警告: 检测到电源欠压复位!\n");
+        printf("   ⚠️ 可能原因: 电源供电不足、CAN总线负载过大、外设复位导致电流尖峰\n");
+        printf("   ⚠️ 建议: 检查电源容量，确保稳定的5V/3.3V供电\n");
+    } else if (reset_reason == ESP_RST_PANIC) {
+        printf("   ⚠️ 警告: 检测到异常/panic复位!\n");
+        printf("   ⚠️ 可能原因: 代码异常、栈溢出、非法内存访问\n");
+    } else if (reset_reason == ESP_RST_TASK_WDT) {
+        printf("   ⚠️ 警告: 检测到任务看门狗超时复位!\n");
+        printf("   ⚠️ 可能原因: 某个任务长时间阻塞，无法喂狗\n");
+    } else if (reset_reason == ESP_RST_INT_WDT) {
+        printf("   ⚠️ 警告: 检测到中断看门狗超时复位!\n");
+        printf("   ⚠️ 可能原因: 中断处理时间过长或死锁\n");
+    }
+    printf("========================================\n\n");
+
     // 打印系统信息
     printf("Printing system info...\n");
     print_system_info();
@@ -1231,30 +1512,6 @@ void app_main(void)
     ESP_LOGI(TAG, "====================================");
     ESP_LOGI(TAG, "");
 
-    // 初始化GPIO
-    printf("Initializing GPIO...\n");
-    gpio_init();
-    printf("GPIO initialized OK\n");
-    printf("Free heap after GPIO: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
-
-    // 初始化UART
-    printf("Initializing UART...\n");
-    uart_init();
-    printf("UART initialized OK\n");
-    printf("Free heap after UART: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
-
-    // 初始化SBUS
-    printf("Initializing SBUS...\n");
-    sbus_init();
-    printf("SBUS initialized OK\n");
-    printf("Free heap after SBUS: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
-
-    // 初始化电机驱动
-    printf("Initializing motor driver...\n");
-    motor_driver_init();
-    printf("Motor driver initialized OK\n");
-    printf("Free heap after motor: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
-
 #if ENABLE_PAYOUT_DEVICE
     // 初始化放线设备（UART1 + RS485 Modbus RTU）
     printf("Initializing payout device (RS485)...\n");
@@ -1289,51 +1546,6 @@ void app_main(void)
 
     ESP_LOGI(TAG, "System initialized");
 
-    // ========================================================================
-    // 创建FreeRTOS队列（静态分配 - 优先级A优化）
-    // ========================================================================
-    printf("Creating FreeRTOS queues (static allocation)...\n");
-
-    // ⚡ 性能优化：使用静态分配，消除堆碎片，提高可靠性
-    // 队列大小：20，足够缓冲突发数据，确保控制命令不会因为队列满而被丢弃
-
-    // 创建SBUS队列（静态分配）
-    sbus_queue = xQueueCreateStatic(
-        20,                              // 队列长度
-        sizeof(sbus_data_t),            // 元素大小
-        sbus_queue_static_storage,      // 静态存储区
-        &sbus_queue_static_buffer       // 静态控制块
-    );
-
-    if (sbus_queue == NULL) {
-        printf("ERROR: Failed to create SBUS queue (static)!\n");
-        ESP_LOGE(TAG, "❌ Failed to create SBUS queue (static allocation)");
-        abort();  // 静态分配失败说明配置错误，应立即停止
-    }
-
-#if ENABLE_CMD_VEL
-    // 创建CMD_VEL队列（静态分配）
-    cmd_queue = xQueueCreateStatic(
-        20,
-        sizeof(motor_cmd_t),
-        cmd_queue_static_storage,
-        &cmd_queue_static_buffer
-    );
-
-    if (cmd_queue == NULL) {
-        printf("ERROR: Failed to create CMD queue (static)!\n");
-        ESP_LOGE(TAG, "❌ Failed to create CMD queue (static allocation)");
-        abort();
-    }
-    printf("✅ Queues created successfully (SBUS + CMD_VEL)\n");
-    printf("   SBUS queue: %u bytes (static)\n", (unsigned int)sizeof(sbus_queue_static_storage));
-    printf("   CMD queue:  %u bytes (static)\n", (unsigned int)sizeof(cmd_queue_static_storage));
-#else
-    printf("✅ Queue created successfully (SBUS only, CMD_VEL disabled)\n");
-    printf("   SBUS queue: %u bytes (static)\n", (unsigned int)sizeof(sbus_queue_static_storage));
-#endif
-    printf("💾 Free heap after static queues: %lu bytes\n", (unsigned long)esp_get_free_heap_size());
-
     // 输出静态内存分配统计
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "========================================");
@@ -1359,37 +1571,6 @@ void app_main(void)
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "");
 
-    // 创建FreeRTOS任务
-    BaseType_t xReturned;
-
-    // SBUS处理任务 - 高优先级
-    xReturned = xTaskCreate(
-        sbus_process_task,
-        "sbus_task",
-        4096,
-        NULL,
-        12,  // 高优先级
-        &sbus_task_handle);
-    if (xReturned != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create SBUS task");
-    }
-
-#if ENABLE_CMD_VEL
-    // CMD_VEL处理任务已在UART初始化中创建
-#endif
-
-    // 电机控制任务 - 中优先级
-    xReturned = xTaskCreate(
-        motor_control_task,
-        "motor_task",
-        4096,
-        NULL,
-        10,  // 中优先级
-        &control_task_handle);
-    if (xReturned != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create motor control task");
-    }
-
     // 状态监控任务 - 低优先级
     xReturned = xTaskCreate(
         status_monitor_task,
@@ -1436,6 +1617,15 @@ void app_main(void)
     ESP_LOGI(TAG, "🛡️ 核心功能模式：HTTP服务器任务已禁用");
 #endif
 
+#if ENABLE_DATA_INTEGRATION
+    // 设备状态快照发布任务 - 低优先级（云端上报与Web接口读取同一份快照）
+    if (device_state_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start device state publisher");
+    }
+#endif
+
+    boot_profile_mark(BOOT_PHASE_SERVICES_STARTED);
+
 #if CORE_FUNCTION_MODE
     ESP_LOGI(TAG, "🎯 核心功能模式：关键FreeRTOS任务已创建");
 #if ENABLE_CMD_VEL
@@ -62,6 +62,35 @@
 #define WEST_CAN_INVERT_LEFT_MOTOR       1
 #define WEST_CAN_INVERT_RIGHT_MOTOR      0
 
+// 三思德驱动速度反馈（0x0DEE<addr>01）为电机转速 rpm，与开环命令量纲不同；
+// 换算履带速度千分比时以额定转速为满量程（按现场电机铭牌/实测满速标定）
+#define WEST_DRIVER_FEEDBACK_FULL_SCALE_RPM  3000
+
+// 三思德驱动多节点配置：同一CAN总线挂多台双路驱动（如前后桥四驱）
+// NODE_ADDRESSES: 各驱动器拨码地址，反馈帧 0x0DEE<addr>01~04 按地址分发到对应节点
+// NODE_TARGETS:   各节点控制帧目标地址，单节点时保留 0xFF 广播；多节点必须改为各自地址
+// 所有节点的控制帧在同一个CAN发送周期内连续发出
+#define WEST_DRIVER_NODE_COUNT           1
+#define WEST_DRIVER_NODE_ADDRESSES       { 0x01 }
+#define WEST_DRIVER_NODE_TARGETS         { 0xFF }
+#define WEST_DRIVER_NODE_TIMEOUT_MS      1000   // 节点反馈超时，超过即判定节点离线
+// 1: 任一节点反馈超时（或从未收到反馈）即触发电机失控保护停车
+// 0: 节点健康仅用于诊断（驱动未开启反馈回传时保持0）
+#define WEST_DRIVER_NODE_HEALTH_FAILSAFE 0
+
+// 历史双路驱动(KEYA)心跳监测：驱动器周期发送 0x07000000+地址 心跳帧
+// 超时后重新使能电机；KEYA_HEARTBEAT_FAILSAFE=1 时同时触发停车保护
+#define KEYA_HEARTBEAT_TIMEOUT_MS        1000
+#define KEYA_HEARTBEAT_FAILSAFE          0
+
+// 驱动链路健康失控保护总开关（由当前协议对应的开关推导，勿直接修改）
+#if (MOTOR_DRIVER_PROTOCOL == MOTOR_DRIVER_PROTOCOL_WEST_CAN && WEST_DRIVER_NODE_HEALTH_FAILSAFE) || \
+    (MOTOR_DRIVER_PROTOCOL == MOTOR_DRIVER_PROTOCOL_KEYA_SDO && KEYA_HEARTBEAT_FAILSAFE)
+#define MOTOR_DRIVER_HEALTH_FAILSAFE     1
+#else
+#define MOTOR_DRIVER_HEALTH_FAILSAFE     0
+#endif
+
 // ====================================================================
 // 放线设备 (RS485 / Modbus RTU) 功能开关
 // ====================================================================
@@ -70,11 +99,10 @@
 #define ENABLE_PAYOUT_DEVICE       1
 
 // 放线设备 UART / GPIO 映射
-// 使用 UART1，TX 复用通用 UART1 TX 引脚，只发不收，无需绑定 RX
-// 如果后续需要读驱动板回复，把 PAYOUT_UART_RX_PIN 改成空闲 GPIO 即可
+// 使用 UART1，TX/RX 复用通用 UART1 引脚，接收驱动板应答与轮询数据
 #define PAYOUT_UART                UART_NUM_1
 #define PAYOUT_UART_TX_PIN         UART_TX_PIN
-#define PAYOUT_UART_RX_PIN         UART_PIN_NO_CHANGE
+#define PAYOUT_UART_RX_PIN         UART_RX_PIN
 #define PAYOUT_RS485_DE_PIN        GPIO_NUM_NC   // 自动流控 RS485 模块填 GPIO_NUM_NC
 
 // 放线设备 Modbus / 速度换算参数
@@ -96,12 +124,51 @@
 #define PAYOUT_DIRECTION_CHANNEL_IDX  6U
 #define PAYOUT_SPEED_CHANNEL_IDX      9U
 
-// 发送限频：避免以 SBUS 14ms 节奏狂发 Modbus 帧压爆 RS485
+// 发送限频：避免以 SBUS 14ms 节奏狂发 Modbus 帧压爆 RS485（下限，多滚筒时自动放宽）
 #define PAYOUT_SEND_INTERVAL_MS    50
 
+// 同步放线模式（随地速放线）：CH9 高档启用
+// 目标 PWM = 履带前进速度(‰) × 滚筒比 × (1 + CH10 微调)，CH7 仍决定方向/停止
+#define PAYOUT_SYNC_MODE_ENABLE          1
+#define PAYOUT_SYNC_SWITCH_CHANNEL_IDX   8U      // CH9(ch_val[8])，高档=同步模式
+#define PAYOUT_SYNC_DRUM_RATIO_PERMILLE  1000    // 履带满速对应的放线 PWM（‰，1000=满量程）
+#define PAYOUT_SYNC_TRIM_PERCENT         20      // CH10 微调范围 ±20%（中位=不微调）
+#define PAYOUT_SYNC_USE_FEEDBACK         1       // 1=优先用驱动器速度反馈，无反馈时退回命令速度
+
+// Modbus RTU 主站参数（9600bps 下 8 字节请求+8 字节应答约 18ms）
+#define PAYOUT_MODBUS_RESPONSE_TIMEOUT_MS  100   // 发送完成到应答首字节的超时
+#define PAYOUT_MODBUS_RETRIES              2     // 超时/CRC错误重试次数
+#define PAYOUT_OFFLINE_THRESHOLD           3     // 连续失败事务数达到即判定离线
+#define PAYOUT_KEEPALIVE_MS                500   // 无新目标时重发当前目标的周期
+#define PAYOUT_CONTROL_DEADLINE_MS         60    // 目标写入从触发到完成的截止时间：事务不可抢占，最坏先等一个轮询时间片（约30ms）再写入（约30ms）；多滚筒时初始化自动放宽
+
+// 同一 RS485 总线上的放线滚筒（所有滚筒写入同一目标，地址互不相同）
+// 9600bps 下每个滚筒的目标写入时间片约 30ms；drv_payout_init 按滚筒数放宽 PAYOUT_SEND_INTERVAL_MS，
+// 使全部目标写入的占用率不超过 RS485_SCHED_MAX_UTILIZATION（2 个滚筒约 70ms）
+#define PAYOUT_DRUM_COUNT                  1
+#define PAYOUT_DRUM_SLAVES                 { PAYOUT_MODBUS_SLAVE }
+
+// 张力传感器（同总线从站，功能码 0x03 周期读取）
+#define PAYOUT_TENSION_SENSOR_ENABLE       0
+#define PAYOUT_TENSION_SLAVE               0x03
+#define PAYOUT_TENSION_REG                 0x0000
+#define PAYOUT_TENSION_POLL_MS             100
+
+// 速度/故障寄存器轮询（功能码 0x03，寄存器地址按驱动板手册调整）
+#define PAYOUT_POLL_ENABLE                 1
+#define PAYOUT_POLL_INTERVAL_MS            200
+#define PAYOUT_POLL_REG_START              0x0043
+#define PAYOUT_POLL_REG_COUNT              2
+#define PAYOUT_POLL_SPEED_OFFSET           0     // 实际速度（int16）
+#define PAYOUT_POLL_FAULT_OFFSET           1     // 故障码（0=无故障）
+
 // CMD_VEL功能开关 - 设置为0禁用UART1 CMD_VEL接收
 #define ENABLE_CMD_VEL          0   // 禁用CMD_VEL功能（节省UART1资源）
 
+#if ENABLE_PAYOUT_DEVICE && ENABLE_CMD_VEL
+#error "ENABLE_PAYOUT_DEVICE 与 ENABLE_CMD_VEL 都占用 UART1，不能同时启用"
+#endif
+
 // 功能模块开关（当CORE_FUNCTION_MODE=1时，以下功能将被禁用）
 #if CORE_FUNCTION_MODE
     #define ENABLE_HTTP_SERVER      0   // 禁用HTTP服务器
@@ -121,6 +188,21 @@
 #define ENABLE_CLOUD_OTA       0   // 云端OTA
 #define ENABLE_HTTP_OTA        0   // HTTP OTA
 
+// 局域网UDP遥控（依赖Wi-Fi，见 udp_teleop.h）
+#define ENABLE_UDP_TELEOP      ENABLE_WIFI
+
+// Supabase定时上报层（见 supabase_integration.h）：在云客户端之上用软件定时器投递状态/心跳上报，
+// 并运行定时器服务延迟探针；云客户端的 cloud_status 任务已周期上报，默认关闭以免重复上报
+#define ENABLE_SUPABASE_INTEGRATION 0
+
+#if ENABLE_SUPABASE_INTEGRATION && !ENABLE_CLOUD_CLIENT
+#error "ENABLE_SUPABASE_INTEGRATION 依赖 ENABLE_CLOUD_CLIENT"
+#endif
+
+// 控制路径任务（SBUS/CMD_VEL 接收、电机控制、CAN 收发）固定在 APP_CPU，
+// 不与 PRO_CPU 上的 Wi-Fi/lwIP 协议栈和 OTA 写入任务（擦写/解压/SHA-256）争用
+#define CONTROL_TASK_CORE      1
+
 // 定义GPIO引脚
 // 按键引脚
 #define KEY1_PIN                GPIO_NUM_0   // 按键1
@@ -0,0 +1,432 @@
+#include "modbus_master.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "MODBUS";
+
+#define MODBUS_HIGH_BAUD_T35_US     1750U   // 波特率>19200时规范规定的固定 t3.5
+#define MODBUS_HIGH_BAUD_THRESHOLD  19200U
+#define MODBUS_RX_TOUT_SYMBOLS      4       // UART RX 超时（字符数），t3.5 向上取整
+#define MODBUS_BUS_LOCK_TIMEOUT_MS  1000    // 等待总线互斥锁的最长时间
+#define MODBUS_ERROR_LOG_INTERVAL_MS 1000   // 错误日志限频
+
+#define MODBUS_TX_BUF_SIZE          (9 + MODBUS_MAX_WRITE_REGS * 2)
+#define MODBUS_RX_BUF_SIZE          (5 + MODBUS_MAX_READ_REGS * 2)
+
+/**
+ * CRC16 查找表（多项式 0xA001 反射形式），替代逐位计算
+ */
+static const uint16_t s_crc_table[256] = {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+
+static modbus_master_config_t s_config;
+static bool s_initialized = false;
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static uint32_t s_char_time_us = 0;          // 单字符时长
+static uint32_t s_t35_us = 0;                // 帧间静默时间 t3.5
+static int64_t s_last_bus_activity_us = 0;   // 最近一次总线收/发结束时间
+
+static modbus_master_stats_t s_stats;
+static uint64_t s_latency_sum_us = 0;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+uint16_t modbus_master_crc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc = (crc >> 8) ^ s_crc_table[(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+uint32_t modbus_master_frame_time_us(uint16_t bytes)
+{
+    return (uint32_t)bytes * s_char_time_us;
+}
+
+uint32_t modbus_master_inter_frame_us(void)
+{
+    return s_t35_us;
+}
+
+static inline void rs485_set_tx_mode(bool tx_enable)
+{
+    if (s_config.de_pin != GPIO_NUM_NC) {
+        gpio_set_level(s_config.de_pin, tx_enable ? 1 : 0);
+    }
+}
+
+static inline void append_crc(uint8_t *frame, uint16_t len)
+{
+    uint16_t crc = modbus_master_crc16(frame, len);
+    frame[len] = (uint8_t)(crc & 0xFF);
+    frame[len + 1] = (uint8_t)((crc >> 8) & 0xFF);
+}
+
+/**
+ * 保证距上一次总线活动至少间隔 t3.5，避免从站把两帧拼成一帧
+ */
+static void wait_inter_frame_gap(void)
+{
+    int64_t elapsed = esp_timer_get_time() - s_last_bus_activity_us;
+    if (elapsed >= 0 && elapsed < (int64_t)s_t35_us) {
+        esp_rom_delay_us((uint32_t)(s_t35_us - elapsed));
+    }
+}
+
+static inline TickType_t ms_to_ticks_min1(uint32_t ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    return ticks + 1;  // 向上取整，避免短超时被截断为0
+}
+
+/**
+ * 单次尝试：发送请求 → 接收应答 → 校验
+ * @param request 含CRC的请求帧
+ * @param expected_len 正常应答的完整长度（含CRC）
+ */
+static esp_err_t modbus_attempt(const uint8_t *request, uint16_t req_len,
+                                uint8_t *response, uint16_t expected_len)
+{
+    const uint8_t slave = request[0];
+    const uint8_t function = request[1];
+
+    wait_inter_frame_gap();
+    uart_flush_input(s_config.uart);
+
+    rs485_set_tx_mode(true);
+    uart_write_bytes(s_config.uart, (const char *)request, req_len);
+    uart_wait_tx_done(s_config.uart, ms_to_ticks_min1(modbus_master_frame_time_us(req_len) / 1000 + 20));
+    rs485_set_tx_mode(false);
+    s_last_bus_activity_us = esp_timer_get_time();
+
+    if (slave == MODBUS_BROADCAST_ADDR) {
+        return ESP_OK;
+    }
+
+    // 等待应答头（地址 + 功能码）
+    int received = uart_read_bytes(s_config.uart, response, 2,
+                                   ms_to_ticks_min1(s_config.response_timeout_ms));
+    if (received < 2) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (response[0] != slave) {
+        s_last_bus_activity_us = esp_timer_get_time();
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    bool is_exception = (response[1] == (function | 0x80));
+    if (!is_exception && response[1] != function) {
+        s_last_bus_activity_us = esp_timer_get_time();
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    // 按功能码接收剩余字节，超时 = 剩余字节时长 + t3.5 余量
+    uint16_t total_len = is_exception ? 5 : expected_len;
+    uint16_t remaining = total_len - 2;
+    uint32_t rx_window_ms = (modbus_master_frame_time_us(remaining) + s_t35_us) / 1000 + 2;
+    received = uart_read_bytes(s_config.uart, response + 2, remaining, ms_to_ticks_min1(rx_window_ms));
+    s_last_bus_activity_us = esp_timer_get_time();
+    if (received < (int)remaining) {
+        return ESP_ERR_INVALID_RESPONSE;  // 帧被截断
+    }
+
+    uint16_t crc = modbus_master_crc16(response, total_len - 2);
+    if (response[total_len - 2] != (uint8_t)(crc & 0xFF) ||
+        response[total_len - 1] != (uint8_t)((crc >> 8) & 0xFF)) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    if (is_exception) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.last_exception_code = response[2];
+        taskEXIT_CRITICAL(&s_stats_lock);
+        return ESP_FAIL;
+    }
+
+    switch (function) {
+        case MODBUS_FC_READ_HOLDING:
+            if (response[2] != (uint8_t)(expected_len - 5)) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
+        case MODBUS_FC_WRITE_SINGLE:
+            // 写单寄存器应答为请求原样回显
+            if (memcmp(response, request, 6) != 0) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE:
+            // 回显起始地址与寄存器数量
+            if (memcmp(response + 2, request + 2, 4) != 0) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+static void record_attempt_result(esp_err_t ret)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    switch (ret) {
+        case ESP_ERR_TIMEOUT:
+            s_stats.timeouts++;
+            break;
+        case ESP_ERR_INVALID_CRC:
+            s_stats.crc_errors++;
+            break;
+        case ESP_ERR_INVALID_RESPONSE:
+            s_stats.frame_errors++;
+            break;
+        case ESP_FAIL:
+            s_stats.exceptions++;
+            break;
+        default:
+            break;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * 完整事务：加CRC → 串行化占用总线 → 尝试（含重试）→ 统计
+ */
+static esp_err_t modbus_transaction(uint8_t *request, uint16_t payload_len,
+                                    uint8_t *response, uint16_t expected_len)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    append_crc(request, payload_len);
+    uint16_t req_len = payload_len + 2;
+
+    if (xSemaphoreTake(s_bus_mutex, pdMS_TO_TICKS(MODBUS_BUS_LOCK_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = ESP_FAIL;
+    for (uint8_t attempt = 0; attempt <= s_config.retries; attempt++) {
+        if (attempt > 0) {
+            taskENTER_CRITICAL(&s_stats_lock);
+            s_stats.retries++;
+            taskEXIT_CRITICAL(&s_stats_lock);
+        }
+        ret = modbus_attempt(request, req_len, response, expected_len);
+        record_attempt_result(ret);
+        // 成功或从站明确拒绝（异常应答）都不再重试
+        if (ret == ESP_OK || ret == ESP_FAIL) {
+            break;
+        }
+    }
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    xSemaphoreGive(s_bus_mutex);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.requests++;
+    if (ret == ESP_OK) {
+        s_stats.success++;
+        s_stats.last_latency_us = latency_us;
+        if (latency_us > s_stats.max_latency_us) {
+            s_stats.max_latency_us = latency_us;
+        }
+        s_latency_sum_us += latency_us;
+        s_stats.avg_latency_us = (uint32_t)(s_latency_sum_us / s_stats.success);
+    } else {
+        s_stats.failures++;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (ret != ESP_OK) {
+        static uint32_t last_error_log_time = 0;
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        if (now - last_error_log_time > MODBUS_ERROR_LOG_INTERVAL_MS) {
+            ESP_LOGW(TAG, "⚠️ Modbus slave=0x%02X fc=0x%02X failed after %u tries: %s (exc=0x%02X)",
+                     request[0], request[1], (unsigned)(s_config.retries + 1),
+                     esp_err_to_name(ret), s_stats.last_exception_code);
+            last_error_log_time = now;
+        }
+    }
+    return ret;
+}
+
+esp_err_t modbus_master_read_holding(uint8_t slave, uint16_t reg, uint16_t count, uint16_t *values)
+{
+    if (values == NULL || count == 0 || count > MODBUS_MAX_READ_REGS ||
+        slave == MODBUS_BROADCAST_ADDR) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t request[8];
+    uint8_t response[MODBUS_RX_BUF_SIZE];
+    request[0] = slave;
+    request[1] = MODBUS_FC_READ_HOLDING;
+    request[2] = (uint8_t)(reg >> 8);
+    request[3] = (uint8_t)(reg & 0xFF);
+    request[4] = (uint8_t)(count >> 8);
+    request[5] = (uint8_t)(count & 0xFF);
+
+    esp_err_t ret = modbus_transaction(request, 6, response, 5 + count * 2);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        values[i] = ((uint16_t)response[3 + i * 2] << 8) | response[4 + i * 2];
+    }
+    return ESP_OK;
+}
+
+esp_err_t modbus_master_write_single(uint8_t slave, uint16_t reg, uint16_t value)
+{
+    uint8_t request[8];
+    uint8_t response[8];
+    request[0] = slave;
+    request[1] = MODBUS_FC_WRITE_SINGLE;
+    request[2] = (uint8_t)(reg >> 8);
+    request[3] = (uint8_t)(reg & 0xFF);
+    request[4] = (uint8_t)(value >> 8);
+    request[5] = (uint8_t)(value & 0xFF);
+
+    return modbus_transaction(request, 6, response, 8);
+}
+
+esp_err_t modbus_master_write_multiple(uint8_t slave, uint16_t reg, uint16_t count, const uint16_t *values)
+{
+    if (values == NULL || count == 0 || count > MODBUS_MAX_WRITE_REGS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t request[MODBUS_TX_BUF_SIZE];
+    uint8_t response[8];
+    request[0] = slave;
+    request[1] = MODBUS_FC_WRITE_MULTIPLE;
+    request[2] = (uint8_t)(reg >> 8);
+    request[3] = (uint8_t)(reg & 0xFF);
+    request[4] = (uint8_t)(count >> 8);
+    request[5] = (uint8_t)(count & 0xFF);
+    request[6] = (uint8_t)(count * 2);
+    for (uint16_t i = 0; i < count; i++) {
+        request[7 + i * 2] = (uint8_t)(values[i] >> 8);
+        request[8 + i * 2] = (uint8_t)(values[i] & 0xFF);
+    }
+
+    return modbus_transaction(request, 7 + count * 2, response, 8);
+}
+
+esp_err_t modbus_master_init(const modbus_master_config_t *config)
+{
+    if (config == NULL || config->baud_rate == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    s_bus_mutex = xSemaphoreCreateMutex();
+    if (s_bus_mutex == NULL) {
+        ESP_LOGE(TAG, "❌ Failed to create Modbus bus mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_config = *config;
+
+    // 1起始位 + 8数据位 + 校验位 + 1停止位
+    uint32_t bits_per_char = config->parity_enabled ? 11 : 10;
+    s_char_time_us = (bits_per_char * 1000000U + config->baud_rate - 1) / config->baud_rate;
+    s_t35_us = (config->baud_rate > MODBUS_HIGH_BAUD_THRESHOLD) ?
+               MODBUS_HIGH_BAUD_T35_US : (s_char_time_us * 7 + 1) / 2;
+
+    // 缩短 UART 硬件 RX 超时，帧尾尽快交给驱动缓冲区
+    esp_err_t ret = uart_set_rx_timeout(config->uart, MODBUS_RX_TOUT_SYMBOLS);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ uart_set_rx_timeout failed: %s", esp_err_to_name(ret));
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_latency_sum_us = 0;
+    s_last_bus_activity_us = esp_timer_get_time();
+    s_initialized = true;
+
+    ESP_LOGI(TAG, "✅ Modbus RTU master ready (UART%d %" PRIu32 " bps, char=%" PRIu32 "us t3.5=%" PRIu32 "us, timeout=%" PRIu32 "ms, retries=%u)",
+             config->uart, config->baud_rate, s_char_time_us, s_t35_us,
+             config->response_timeout_ms, (unsigned)config->retries);
+    return ESP_OK;
+}
+
+void modbus_master_get_stats(modbus_master_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void modbus_master_reset_stats(void)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_latency_sum_us = 0;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void modbus_master_print_diag(void)
+{
+    modbus_master_stats_t stats;
+    modbus_master_get_stats(&stats);
+
+    float error_rate = stats.requests > 0 ?
+                       (float)stats.failures * 100.0f / (float)stats.requests : 0.0f;
+    ESP_LOGI(TAG, "📊 Modbus: req=%" PRIu32 " ok=%" PRIu32 " fail=%" PRIu32 " (%.2f%%) retry=%" PRIu32,
+             stats.requests, stats.success, stats.failures, error_rate, stats.retries);
+    ESP_LOGI(TAG, "📊 Modbus errors: timeout=%" PRIu32 " crc=%" PRIu32 " frame=%" PRIu32 " exception=%" PRIu32 " (last=0x%02X)",
+             stats.timeouts, stats.crc_errors, stats.frame_errors, stats.exceptions,
+             stats.last_exception_code);
+    ESP_LOGI(TAG, "📊 Modbus latency: last=%" PRIu32 "us avg=%" PRIu32 "us max=%" PRIu32 "us",
+             stats.last_latency_us, stats.avg_latency_us, stats.max_latency_us);
+}
@@ -0,0 +1,116 @@
+#ifndef MODBUS_MASTER_H
+#define MODBUS_MASTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Modbus RTU 主站（半双工 RS485）
+ *
+ *   - 请求/应答状态机：空闲等待 t3.5 → 发送 → 等待应答头 → 按功能码接收剩余字节 → 校验
+ *   - 支持功能码 0x03（读保持寄存器）/ 0x06（写单寄存器）/ 0x10（写多寄存器）
+ *   - 应答超时、CRC 错误、帧错误自动重试；异常应答（功能码|0x80）不重试
+ *   - 查表法 CRC16（多项式 0xA001）
+ *   - 所有事务经互斥锁串行化，可被多个任务调用
+ *
+ * UART 驱动由调用方安装并配置（波特率/校验/引脚），本模块只负责事务收发。
+ */
+
+#define MODBUS_FC_READ_HOLDING      0x03
+#define MODBUS_FC_WRITE_SINGLE      0x06
+#define MODBUS_FC_WRITE_MULTIPLE    0x10
+
+#define MODBUS_MAX_READ_REGS        32      // 单次读寄存器上限（协议上限125，此处按缓冲区裁剪）
+#define MODBUS_MAX_WRITE_REGS       16      // 单次写多寄存器上限
+#define MODBUS_BROADCAST_ADDR       0x00    // 广播地址：不等待应答
+
+/**
+ * 主站配置
+ */
+typedef struct {
+    uart_port_t uart;               // 已安装驱动的 UART 端口
+    uint32_t baud_rate;             // 波特率（用于计算 t3.5 与帧时长）
+    bool parity_enabled;            // 是否有校验位（8E1/8O1=11位/字符，8N1=10位/字符）
+    gpio_num_t de_pin;              // RS485 DE/RE 引脚，自动流控模块填 GPIO_NUM_NC
+    uint32_t response_timeout_ms;   // 发送完成到收到应答首字节的超时
+    uint8_t retries;                // 失败后的重试次数（不含首次）
+} modbus_master_config_t;
+
+/**
+ * 事务统计
+ */
+typedef struct {
+    uint32_t requests;              // 事务总数（不含重试）
+    uint32_t success;               // 成功事务数
+    uint32_t failures;              // 重试耗尽后仍失败的事务数
+    uint32_t timeouts;              // 应答超时次数（每次尝试计一次）
+    uint32_t crc_errors;            // CRC 错误次数
+    uint32_t frame_errors;          // 地址/功能码/长度不符次数
+    uint32_t exceptions;            // 从站异常应答次数
+    uint32_t retries;               // 重试次数
+    uint8_t last_exception_code;    // 最近一次异常码
+    uint32_t last_latency_us;       // 最近一次成功事务耗时（含重试）
+    uint32_t avg_latency_us;        // 成功事务平均耗时
+    uint32_t max_latency_us;        // 成功事务最大耗时
+} modbus_master_stats_t;
+
+/**
+ * 初始化主站（UART 须已由调用方安装）
+ */
+esp_err_t modbus_master_init(const modbus_master_config_t *config);
+
+/**
+ * 读保持寄存器（0x03）
+ * @return ESP_OK / ESP_ERR_TIMEOUT / ESP_ERR_INVALID_CRC / ESP_ERR_INVALID_RESPONSE /
+ *         ESP_FAIL（从站异常应答，异常码见统计 last_exception_code）
+ */
+esp_err_t modbus_master_read_holding(uint8_t slave, uint16_t reg, uint16_t count, uint16_t *values);
+
+/**
+ * 写单寄存器（0x06）
+ */
+esp_err_t modbus_master_write_single(uint8_t slave, uint16_t reg, uint16_t value);
+
+/**
+ * 写多寄存器（0x10）
+ */
+esp_err_t modbus_master_write_multiple(uint8_t slave, uint16_t reg, uint16_t count, const uint16_t *values);
+
+/**
+ * 查表法 Modbus CRC16（多项式 0xA001，初值 0xFFFF）
+ */
+uint16_t modbus_master_crc16(const uint8_t *data, uint16_t len);
+
+/**
+ * 按当前波特率估算 bytes 个字符在总线上的时长（微秒）
+ */
+uint32_t modbus_master_frame_time_us(uint16_t bytes);
+
+/**
+ * 帧间静默时间 t3.5（微秒）
+ */
+uint32_t modbus_master_inter_frame_us(void);
+
+/**
+ * 获取/清零事务统计
+ */
+void modbus_master_get_stats(modbus_master_stats_t *stats);
+void modbus_master_reset_stats(void);
+
+/**
+ * 打印事务统计与错误率
+ */
+void modbus_master_print_diag(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODBUS_MASTER_H */
@@ -0,0 +1,187 @@
+#include "motion_arbiter.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "MOTION_ARB";
+
+/**
+ * 输入源运行状态，仅在控制任务中读写
+ */
+typedef struct {
+    motion_source_t source;
+    int64_t last_input_us;              // 0 表示没有可用输入
+    bool pending;                       // 有尚未下发的输入
+    bool enabled;
+    bool fresh;
+    uint32_t inputs;
+    uint32_t applied;
+    uint32_t acquired;
+    uint32_t lost;
+} source_slot_t;
+
+static source_slot_t s_slots[MOTION_ARBITER_MAX_SOURCES];
+static int s_slot_count = 0;
+static int s_active = -1;
+static void (*s_stop)(const char *reason) = NULL;
+
+static uint32_t s_handovers = 0;
+static uint32_t s_stale_stops = 0;
+static uint32_t s_steps = 0;
+static uint32_t s_max_step_us = 0;
+
+// 对外发布的快照，由自旋锁保护（HTTP任务读取）
+static motion_arbiter_stats_t s_published = { .active = -1 };
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void motion_arbiter_init(void (*stop)(const char *reason))
+{
+    s_stop = stop;
+}
+
+esp_err_t motion_arbiter_register(const motion_source_t *source)
+{
+    if (source == NULL || source->name == NULL || source->poll == NULL ||
+        source->apply == NULL || source->timeout_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_slot_count >= MOTION_ARBITER_MAX_SOURCES) {
+        ESP_LOGE(TAG, "❌ 输入源已满，无法注册 %s", source->name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    source_slot_t *slot = &s_slots[s_slot_count++];
+    memset(slot, 0, sizeof(*slot));
+    slot->source = *source;
+    ESP_LOGI(TAG, "🎛️ 注册输入源 %s (优先级 %u, 超时 %" PRIu32 "ms)",
+             source->name, source->priority, source->timeout_ms);
+    return ESP_OK;
+}
+
+/**
+ * 控制权切换：记录计数，切到新源时标记立即下发，无可用源时停车
+ */
+static void hand_over(int winner)
+{
+    const char *from = s_active >= 0 ? s_slots[s_active].source.name : "none";
+
+    if (s_active >= 0 && !s_slots[s_active].fresh) {
+        source_slot_t *lost = &s_slots[s_active];
+        lost->lost++;
+        if (lost->source.on_lost != NULL) {
+            lost->source.on_lost(lost->source.ctx);
+        }
+    }
+
+    if (winner >= 0) {
+        source_slot_t *slot = &s_slots[winner];
+        slot->acquired++;
+        slot->pending = true;
+        ESP_LOGI(TAG, "🔀 控制权切换: %s -> %s", from, slot->source.name);
+    } else {
+        char reason[48];
+        bool disabled = s_active >= 0 && !s_slots[s_active].enabled;
+        snprintf(reason, sizeof(reason), "%s %s", from, disabled ? "disabled" : "timeout");
+        ESP_LOGW(TAG, "🔀 控制权切换: %s -> none", from);
+        if (s_stop != NULL) {
+            s_stop(reason);
+        }
+        s_stale_stops++;
+    }
+
+    s_handovers++;
+    s_active = winner;
+}
+
+static void publish_stats(int64_t now_us, uint32_t step_us)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_published.source_count = (uint32_t)s_slot_count;
+    s_published.active = s_active;
+    s_published.handovers = s_handovers;
+    s_published.stale_stops = s_stale_stops;
+    s_published.steps = s_steps;
+    s_published.last_step_us = step_us;
+    s_published.max_step_us = s_max_step_us;
+    for (int i = 0; i < s_slot_count; i++) {
+        const source_slot_t *slot = &s_slots[i];
+        motion_source_stats_t *out = &s_published.sources[i];
+        out->name = slot->source.name;
+        out->priority = slot->source.priority;
+        out->enabled = slot->enabled;
+        out->fresh = slot->fresh;
+        out->inputs = slot->inputs;
+        out->applied = slot->applied;
+        out->acquired = slot->acquired;
+        out->lost = slot->lost;
+        out->age_ms = slot->last_input_us != 0 ? (uint32_t)((now_us - slot->last_input_us) / 1000) : UINT32_MAX;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void motion_arbiter_step(bool output_enabled)
+{
+    int64_t now_us = esp_timer_get_time();
+    int winner = -1;
+
+    for (int i = 0; i < s_slot_count; i++) {
+        source_slot_t *slot = &s_slots[i];
+        const motion_source_t *src = &slot->source;
+
+        // 禁用的源也要取走输入，避免重新启用时下发过期命令
+        bool has_input = src->poll(src->ctx);
+        slot->enabled = src->enabled == NULL || src->enabled(src->ctx);
+        if (!slot->enabled) {
+            slot->last_input_us = 0;
+            slot->pending = false;
+        } else if (has_input) {
+            slot->last_input_us = now_us;
+            slot->pending = true;
+            slot->inputs++;
+        }
+
+        slot->fresh = slot->last_input_us != 0 &&
+                      now_us - slot->last_input_us <= (int64_t)src->timeout_ms * 1000;
+        if (slot->fresh && (winner < 0 || src->priority > s_slots[winner].source.priority)) {
+            winner = i;
+        }
+    }
+
+    if (winner != s_active) {
+        hand_over(winner);
+    }
+
+    // 非当前源的输入只用于新鲜度判断，获得控制权时再下发其最近输入
+    if (s_active >= 0 && s_slots[s_active].pending) {
+        source_slot_t *slot = &s_slots[s_active];
+        if (output_enabled) {
+            slot->source.apply(slot->source.ctx);
+            slot->applied++;
+        }
+        slot->pending = false;
+    }
+
+    uint32_t step_us = (uint32_t)(esp_timer_get_time() - now_us);
+    if (step_us > s_max_step_us) {
+        s_max_step_us = step_us;
+    }
+    s_steps++;
+    publish_stats(now_us, step_us);
+}
+
+void motion_arbiter_get_stats(motion_arbiter_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_published;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,97 @@
+#ifndef MOTION_ARBITER_H
+#define MOTION_ARBITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 运动输入源仲裁
+ *
+ * 每个输入源（SBUS、CMD_VEL、局域网遥控、云端指令……）注册优先级、新鲜度超时和启用条件，
+ * 控制任务每个周期调用一次 motion_arbiter_step()：
+ *   - 依次轮询全部输入源（O(输入源数)），取出各自最新输入
+ *   - 启用且在超时内收到过输入的源中，优先级最高者获得控制权，有新输入时下发
+ *   - 控制权切换时记录计数并立即下发新源的最近输入；
+ *     当前源失效且没有其他可用源时调用停车回调
+ * 新增输入源只需注册，不需要修改控制循环。
+ * 注册须在控制任务启动前完成；回调均在控制任务中执行。
+ */
+
+#define MOTION_ARBITER_MAX_SOURCES      6
+
+/**
+ * 输入源描述
+ */
+typedef struct {
+    const char *name;
+    uint8_t priority;                   // 数值大者优先，相同优先级先注册者优先
+    uint32_t timeout_ms;                // 超过该时间没有新输入即视为失效
+    bool (*enabled)(void *ctx);         // 启用条件，NULL 表示始终启用；禁用时丢弃已有输入
+    bool (*poll)(void *ctx);            // 非阻塞取出最新输入（多条时合并），有新输入返回 true
+    void (*apply)(void *ctx);           // 下发最近一次输入
+    void (*on_lost)(void *ctx);         // 作为当前控制源失效时调用，可为 NULL
+    void *ctx;
+} motion_source_t;
+
+/**
+ * 单个输入源统计
+ */
+typedef struct {
+    const char *name;
+    uint8_t priority;
+    bool enabled;
+    bool fresh;
+    uint32_t inputs;                    // 收到新输入的周期数
+    uint32_t applied;                   // 下发次数
+    uint32_t acquired;                  // 获得控制权次数
+    uint32_t lost;                      // 作为当前控制源失效的次数
+    uint32_t age_ms;                    // 距最近一次输入，从未收到为 UINT32_MAX
+} motion_source_stats_t;
+
+/**
+ * 仲裁统计
+ */
+typedef struct {
+    uint32_t source_count;
+    int32_t active;                     // 当前控制源下标，-1 表示无
+    uint32_t handovers;                 // 控制权切换次数（含切换到无源）
+    uint32_t stale_stops;               // 当前源失效且无其他可用源而停车的次数
+    uint32_t steps;
+    uint32_t last_step_us;              // 单周期仲裁耗时（含下发）
+    uint32_t max_step_us;
+    motion_source_stats_t sources[MOTION_ARBITER_MAX_SOURCES];
+} motion_arbiter_stats_t;
+
+/**
+ * 初始化
+ * @param stop 停车回调（参数为原因）
+ */
+void motion_arbiter_init(void (*stop)(const char *reason));
+
+/**
+ * 注册输入源（描述内容被复制）
+ * @return ESP_OK / ESP_ERR_INVALID_ARG / ESP_ERR_NO_MEM（超过 MOTION_ARBITER_MAX_SOURCES）
+ */
+esp_err_t motion_arbiter_register(const motion_source_t *source);
+
+/**
+ * 执行一个仲裁周期（控制任务调用）
+ * @param output_enabled false 时照常轮询与切换，但不下发（如驱动节点离线）
+ */
+void motion_arbiter_step(bool output_enabled);
+
+/**
+ * 获取仲裁统计
+ */
+void motion_arbiter_get_stats(motion_arbiter_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOTION_ARBITER_H */
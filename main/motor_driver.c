@@ -30,3 +30,26 @@ void motor_driver_print_diag(void) {
   drv_keyadouble_print_diag();
 #endif
 }
+
+/**
+ * 驱动器链路健康状态，用于失控保护
+ */
+bool motor_driver_is_healthy(void) {
+#if MOTOR_DRIVER_PROTOCOL == MOTOR_DRIVER_PROTOCOL_WEST_CAN
+  return drv_sanside_all_nodes_healthy();
+#else
+  return drv_keyadouble_is_alive();
+#endif
+}
+
+/**
+ * 履带实测前进速度（满量程千分比），驱动器无速度反馈时返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t motor_driver_get_track_speed(int16_t *speed_permille) {
+#if MOTOR_DRIVER_PROTOCOL == MOTOR_DRIVER_PROTOCOL_WEST_CAN
+  return drv_sanside_get_track_speed(speed_permille);
+#else
+  (void)speed_permille;
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
@@ -6,14 +6,25 @@
 #include "esp_app_format.h"
 #include "esp_app_desc.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp32/rom/miniz.h"
+#include "mbedtls/sha256.h"
+#include "nvs.h"
+#include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 
 static const char *TAG = "OTA_MGR";
 
 // OTA状态变量
+// 流水线运行时写入任务（写入/出错）与接收方任务（进度上报）都会更新，由 s_state_lock 保护
 static ota_state_t s_ota_state = OTA_STATE_IDLE;
 static ota_progress_t s_ota_progress = {0};
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
 static ota_config_t s_ota_config = {0};
 
 // OTA操作句柄
@@ -25,14 +36,93 @@ static const esp_partition_t *s_running_partition = NULL;
 static uint32_t s_firmware_size = 0;
 static uint32_t s_written_size = 0;
 
+// Flash擦除进度（分区内偏移，此前的区域已擦除）
+#define OTA_FLASH_SECTOR_SIZE   4096
+#define OTA_PROGRESS_STEP       (64 * 1024)
+static uint32_t s_erased_size = 0;
+static uint32_t s_reported_size = 0;
+
+// 压缩镜像解压状态
+static uint32_t s_transfer_size = 0;        // ota_manager_begin 传入的传输大小
+static uint32_t s_received_size = 0;
+static bool s_format_known = false;
+static bool s_compressed = false;
+static uint8_t s_header_buf[sizeof(ota_compressed_header_t)];
+static size_t s_header_len = 0;
+static tinfl_decompressor *s_inflator = NULL;
+static uint8_t *s_inflate_window = NULL;    // TINFL_LZ_DICT_SIZE 环形输出窗口
+static size_t s_window_pos = 0;
+static bool s_inflate_done = false;
+static int64_t s_inflate_us = 0;
+
+// 断点续传
+#define OTA_CHECKPOINT_NVS_KEY      "checkpoint"
+#define OTA_CHECKPOINT_VERSION      1
+
+typedef struct {
+    uint32_t version;
+    uint32_t partition_address;
+    uint32_t image_size;
+    uint32_t offset;                // 已写入的字节数（扇区对齐）
+    uint8_t image_id[32];           // 镜像标识的SHA-256
+    uint8_t prefix_sha256[32];      // 分区 [0, offset) 内容的SHA-256
+} ota_checkpoint_t;
+
+static bool s_checkpoint_enabled = false;
+static uint8_t s_image_id[32];
+static uint32_t s_checkpoint_offset = 0;
+static uint32_t s_resume_offset = 0;
+static mbedtls_sha256_context s_image_sha;      // 已写入镜像内容（压缩镜像为解压后）的累计哈希，在写入任务中计算
+static bool s_image_sha_active = false;
+static int64_t s_hash_us = 0;
+
+// 云端下发的固件SHA-256，写完最后一个字节时比对
+static uint8_t s_expected_sha256[32];
+static bool s_expected_sha256_set = false;
+static bool s_sha256_verified = false;
+
+// ota_manager_get_resume_offset 校验通过的断点，s_image_sha 此时为 [0, offset) 的哈希
+static uint32_t s_verified_offset = 0;
+static uint32_t s_verified_size = 0;
+static uint8_t s_verified_id[32];
+
+// 写入流水线
+typedef struct {
+    uint8_t *data;                  // NULL=结束标记
+    size_t len;
+} ota_chunk_t;
+
+static QueueHandle_t s_free_queue = NULL;
+static QueueHandle_t s_full_queue = NULL;
+static SemaphoreHandle_t s_writer_done = NULL;
+static uint8_t *s_pipeline_buffers[OTA_PIPELINE_BUFFER_COUNT] = {0};
+static volatile esp_err_t s_pipeline_err = ESP_OK;
+static volatile bool s_pipeline_discard = false;
+static bool s_pipeline_active = false;
+static int64_t s_pipeline_start_us = 0;
+static int64_t s_recv_stall_us = 0;
+static int64_t s_write_stall_us = 0;
+static int64_t s_erase_us = 0;
+static int64_t s_flash_write_us = 0;
+static uint32_t s_pipeline_chunks = 0;
+static ota_pipeline_stats_t s_last_pipeline_stats = {0};
+
 // 进度回调函数
 static ota_progress_callback_t s_progress_callback = NULL;
 
 /**
- * 更新OTA进度信息
+ * 更新OTA进度信息（已失败时不会被改回进行中状态）
  */
 static void update_progress(ota_state_t state, const char* message)
 {
+    ota_progress_t snapshot;
+
+    taskENTER_CRITICAL(&s_state_lock);
+    if (s_ota_state == OTA_STATE_FAILED && state == OTA_STATE_WRITING) {
+        taskEXIT_CRITICAL(&s_state_lock);
+        return;
+    }
+
     s_ota_state = state;
     s_ota_progress.in_progress = (state != OTA_STATE_IDLE && state != OTA_STATE_COMPLETED && state != OTA_STATE_FAILED);
 
@@ -49,22 +139,27 @@ static void update_progress(ota_state_t state, const char* message)
     }
 
     s_ota_progress.success = (state == OTA_STATE_COMPLETED);
+    snapshot = s_ota_progress;
+    taskEXIT_CRITICAL(&s_state_lock);
 
     ESP_LOGI(TAG, "📊 OTA Progress: %d%% (%" PRIu32 "/%" PRIu32 ") bytes - %s",
-             s_ota_progress.progress_percent, s_written_size, s_firmware_size,
-             s_ota_progress.status_message);
+             snapshot.progress_percent, snapshot.written_size, snapshot.total_size,
+             snapshot.status_message);
 
-    // 向云端报告进度（如果有回调函数）
+    // 向云端报告进度（如果有回调函数），在锁外调用
     if (s_progress_callback) {
-        s_progress_callback(s_ota_progress.progress_percent, s_ota_progress.status_message);
+        s_progress_callback(snapshot.progress_percent, snapshot.status_message);
     }
 }
 
 /**
- * 设置错误信息
+ * 设置错误信息（写入任务与接收方任务均可调用）
  */
 static void set_error(const char* error_message)
 {
+    char logged[sizeof(s_ota_progress.error_message)];
+
+    taskENTER_CRITICAL(&s_state_lock);
     s_ota_state = OTA_STATE_FAILED;
     s_ota_progress.in_progress = false;
     s_ota_progress.success = false;
@@ -74,8 +169,512 @@ static void set_error(const char* error_message)
         s_ota_progress.error_message[sizeof(s_ota_progress.error_message) - 1] = '\0';
         strncpy(s_ota_progress.status_message, "Failed", sizeof(s_ota_progress.status_message) - 1);
     }
+    memcpy(logged, s_ota_progress.error_message, sizeof(logged));
+    taskEXIT_CRITICAL(&s_state_lock);
+
+    ESP_LOGE(TAG, "❌ OTA Error: %s", logged);
+}
+
+/**
+ * 读取已写入字节数（流水线运行时由写入任务更新）
+ */
+static uint32_t written_size_get(void)
+{
+    taskENTER_CRITICAL(&s_state_lock);
+    uint32_t written = s_written_size;
+    taskEXIT_CRITICAL(&s_state_lock);
+    return written;
+}
+
+/**
+ * 擦除分区直到 target 偏移（按扇区对齐，不超过固件大小）
+ */
+static esp_err_t erase_until(uint32_t target)
+{
+    uint32_t limit = (s_firmware_size + OTA_FLASH_SECTOR_SIZE - 1) & ~(OTA_FLASH_SECTOR_SIZE - 1);
+    if (limit > s_update_partition->size) {
+        limit = s_update_partition->size;
+    }
+    if (target > limit) {
+        target = limit;
+    }
+    if (target <= s_erased_size) {
+        return ESP_OK;
+    }
+
+    uint32_t end = (target + OTA_FLASH_SECTOR_SIZE - 1) & ~(OTA_FLASH_SECTOR_SIZE - 1);
+    if (end > limit) {
+        end = limit;
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = esp_partition_erase_range(s_update_partition, s_erased_size, end - s_erased_size);
+    s_erase_us += esp_timer_get_time() - start;
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    s_erased_size = end;
+    return ESP_OK;
+}
+
+/**
+ * 开始/结束已写入内容的累计哈希
+ */
+static void image_sha_start(void)
+{
+    if (s_image_sha_active) {
+        mbedtls_sha256_free(&s_image_sha);
+    }
+    mbedtls_sha256_init(&s_image_sha);
+    mbedtls_sha256_starts(&s_image_sha, 0);
+    s_image_sha_active = true;
+}
+
+static void image_sha_stop(void)
+{
+    if (s_image_sha_active) {
+        mbedtls_sha256_free(&s_image_sha);
+        s_image_sha_active = false;
+    }
+}
+
+/**
+ * 镜像标识摘要（固件哈希或URL可能较长，断点中只存其SHA-256）
+ */
+static void image_id_digest(const char* image_id, uint8_t digest[32])
+{
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, (const unsigned char*)image_id, strlen(image_id));
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+}
+
+static esp_err_t checkpoint_load(ota_checkpoint_t* checkpoint)
+{
+    nvs_handle_t nvs;
+    size_t size = sizeof(*checkpoint);
+
+    if (nvs_open(OTA_CHECKPOINT_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = nvs_get_blob(nvs, OTA_CHECKPOINT_NVS_KEY, checkpoint, &size);
+    nvs_close(nvs);
+    if (ret == ESP_OK && (size != sizeof(*checkpoint) || checkpoint->version != OTA_CHECKPOINT_VERSION)) {
+        ret = ESP_ERR_INVALID_VERSION;
+    }
+    return ret;
+}
+
+static void checkpoint_clear(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(OTA_CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_key(nvs, OTA_CHECKPOINT_NVS_KEY) == ESP_OK) {
+        nvs_commit(nvs);
+        ESP_LOGI(TAG, "🧹 OTA断点已清除");
+    }
+    nvs_close(nvs);
+}
+
+/**
+ * 保存当前写入位置为断点（s_written_size 须扇区对齐）
+ */
+static void checkpoint_save(void)
+{
+    ota_checkpoint_t checkpoint = {
+        .version = OTA_CHECKPOINT_VERSION,
+        .partition_address = (uint32_t)s_update_partition->address,
+        .image_size = s_firmware_size,
+        .offset = s_written_size,
+    };
+    memcpy(checkpoint.image_id, s_image_id, sizeof(checkpoint.image_id));
+
+    // 复制一份上下文求摘要，累计哈希继续使用
+    mbedtls_sha256_context prefix;
+    mbedtls_sha256_init(&prefix);
+    mbedtls_sha256_clone(&prefix, &s_image_sha);
+    mbedtls_sha256_finish(&prefix, checkpoint.prefix_sha256);
+    mbedtls_sha256_free(&prefix);
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(OTA_CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, OTA_CHECKPOINT_NVS_KEY, &checkpoint, sizeof(checkpoint));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 保存OTA断点失败: %s", esp_err_to_name(ret));
+        return;
+    }
+    s_checkpoint_offset = s_written_size;
+    ESP_LOGD(TAG, "💾 OTA断点: %" PRIu32 "/%" PRIu32 " bytes", s_written_size, s_firmware_size);
+}
+
+/**
+ * 镜像写完后比对期望的SHA-256（在 esp_ota_end 回读校验之前拒绝错误镜像）
+ */
+static esp_err_t verify_image_hash(void)
+{
+    uint8_t digest[32];
+    mbedtls_sha256_context final;
+    mbedtls_sha256_init(&final);
+    mbedtls_sha256_clone(&final, &s_image_sha);
+    mbedtls_sha256_finish(&final, digest);
+    mbedtls_sha256_free(&final);
+
+    if (memcmp(digest, s_expected_sha256, sizeof(digest)) != 0) {
+        // 已写内容与期望镜像不符，断点也不可信
+        if (s_checkpoint_enabled) {
+            s_checkpoint_enabled = false;
+            checkpoint_clear();
+        }
+        set_error("Firmware SHA-256 mismatch");
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    s_sha256_verified = true;
+    ESP_LOGI(TAG, "✅ 固件SHA-256校验通过 (流式计算 %" PRIu32 " ms)", (uint32_t)(s_hash_us / 1000));
+    return ESP_OK;
+}
+
+/**
+ * 写入Flash：确保目标区域已擦除后按偏移编程
+ */
+static esp_err_t flash_write(const void* data, size_t size)
+{
+    if (s_written_size + size > s_firmware_size) {
+        set_error("Data size exceeds firmware size");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 按偏移写入不会检查镜像头，这里补上与 esp_ota_write 相同的检查
+    if (s_written_size == 0 && ((const uint8_t*)data)[0] != ESP_IMAGE_HEADER_MAGIC) {
+        set_error("Invalid firmware image header");
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+
+    esp_err_t ret = erase_until(s_written_size + size);
+    if (ret == ESP_OK) {
+        int64_t start = esp_timer_get_time();
+        ret = esp_ota_write_with_offset(s_ota_handle, data, size, s_written_size);
+        s_flash_write_us += esp_timer_get_time() - start;
+    }
+    if (ret != ESP_OK) {
+        char error_msg[128];
+        snprintf(error_msg, sizeof(error_msg), "Failed to write OTA data: %s", esp_err_to_name(ret));
+        set_error(error_msg);
+        ESP_LOGE(TAG, "❌ OTA写入失败: %s (写入大小: %zu, 已写入: %" PRIu32 "/%" PRIu32 ")",
+                esp_err_to_name(ret), size, s_written_size, s_firmware_size);
+        return ret;
+    }
+
+    taskENTER_CRITICAL(&s_state_lock);
+    s_written_size += size;
+    taskEXIT_CRITICAL(&s_state_lock);
+
+    if (s_image_sha_active) {
+        int64_t start = esp_timer_get_time();
+        mbedtls_sha256_update(&s_image_sha, data, size);
+        s_hash_us += esp_timer_get_time() - start;
+    }
+
+    if (s_checkpoint_enabled &&
+        (s_written_size & (OTA_FLASH_SECTOR_SIZE - 1)) == 0 &&
+        s_written_size - s_checkpoint_offset >= OTA_CHECKPOINT_INTERVAL &&
+        s_written_size < s_firmware_size) {
+        checkpoint_save();
+    }
+
+    if (s_written_size == s_firmware_size && s_expected_sha256_set && s_image_sha_active) {
+        return verify_image_hash();
+    }
+    return ESP_OK;
+}
+
+/**
+ * 更新写入进度（每写入64KB或完成时更新一次，会调用进度回调）
+ */
+static void report_write_progress(void)
+{
+    // 写入任务已出错时不再上报进度，失败状态由写入任务发布
+    if (s_pipeline_active && s_pipeline_err != ESP_OK) {
+        return;
+    }
+
+    uint32_t written = written_size_get();
+    if (written - s_reported_size < OTA_PROGRESS_STEP && written != s_firmware_size) {
+        return;
+    }
+    if (written == s_reported_size) {
+        return;
+    }
+    s_reported_size = written;
+
+    char progress_msg[64];
+    snprintf(progress_msg, sizeof(progress_msg), "Writing firmware: %u%%",
+            (unsigned int)(((uint64_t)written * 100) / s_firmware_size));
+    update_progress(OTA_STATE_WRITING, progress_msg);
+}
+
+/**
+ * 释放解压缓冲区
+ */
+static void inflate_release(void)
+{
+    free(s_inflator);
+    s_inflator = NULL;
+    free(s_inflate_window);
+    s_inflate_window = NULL;
+}
+
+/**
+ * 重置输入格式检测与解压状态
+ */
+static void input_reset(uint32_t transfer_size)
+{
+    inflate_release();
+    s_transfer_size = transfer_size;
+    s_received_size = 0;
+    s_format_known = false;
+    s_compressed = false;
+    s_header_len = 0;
+    s_window_pos = 0;
+    s_inflate_done = false;
+    s_inflate_us = 0;
+}
+
+/**
+ * 解析压缩头，分配解压器与滑动窗口
+ */
+static esp_err_t start_inflate(void)
+{
+    ota_compressed_header_t header;
+    memcpy(&header, s_header_buf, sizeof(header));
+
+    if (header.version != OTA_COMPRESSED_VERSION || header.algorithm != OTA_COMPRESSED_ALGO_DEFLATE) {
+        set_error("Unsupported compressed image format");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (header.raw_size == 0 || header.raw_size > s_update_partition->size) {
+        set_error("Compressed image too large for partition");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (header.compressed_size + sizeof(header) != s_transfer_size) {
+        set_error("Compressed image size mismatch");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_inflator = malloc(sizeof(tinfl_decompressor));
+    s_inflate_window = malloc(TINFL_LZ_DICT_SIZE);
+    if (s_inflator == NULL || s_inflate_window == NULL) {
+        inflate_release();
+        set_error("Out of memory for decompression");
+        return ESP_ERR_NO_MEM;
+    }
+    tinfl_init(s_inflator);
+
+    // 之后的进度、擦除范围与完整性检查都以解压后大小为准
+    s_firmware_size = header.raw_size;
+    s_compressed = true;
+
+    // 解压器状态无法从断点恢复，压缩镜像中断后从头下载（解压输出仍参与SHA-256校验）
+    if (s_checkpoint_enabled) {
+        s_checkpoint_enabled = false;
+        ESP_LOGI(TAG, "压缩镜像不保存续传断点");
+    }
+    ESP_LOGI(TAG, "🗜️ 压缩固件: %" PRIu32 " -> %" PRIu32 " bytes (%.1f%%)",
+             header.compressed_size, header.raw_size,
+             (float)header.compressed_size * 100.0f / header.raw_size);
+    return ESP_OK;
+}
+
+/**
+ * 解压一段输入并写入Flash（输出经环形窗口分段写出）
+ */
+static esp_err_t inflate_write(const uint8_t* data, size_t size)
+{
+    while (!s_inflate_done) {
+        size_t in_bytes = size;
+        size_t out_bytes = TINFL_LZ_DICT_SIZE - s_window_pos;
+        uint32_t flags = s_received_size < s_transfer_size ? TINFL_FLAG_HAS_MORE_INPUT : 0;
+
+        int64_t start = esp_timer_get_time();
+        tinfl_status status = tinfl_decompress(s_inflator, data, &in_bytes,
+                                               s_inflate_window, s_inflate_window + s_window_pos,
+                                               &out_bytes, flags);
+        s_inflate_us += esp_timer_get_time() - start;
+
+        data += in_bytes;
+        size -= in_bytes;
+
+        if (out_bytes > 0) {
+            esp_err_t ret = flash_write(s_inflate_window + s_window_pos, out_bytes);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            s_window_pos = (s_window_pos + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+
+        if (status == TINFL_STATUS_DONE) {
+            s_inflate_done = true;
+            inflate_release();
+        } else if (status < TINFL_STATUS_DONE) {
+            set_error("Corrupt compressed image");
+            return ESP_ERR_INVALID_CRC;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && size == 0) {
+            return ESP_OK;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT：窗口已写满，继续解压
+    }
+
+    if (size > 0) {
+        set_error("Trailing data after compressed image");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+/**
+ * 写入路径入口：识别原始/压缩镜像，压缩镜像边解压边写入
+ */
+static esp_err_t ingest_data(const uint8_t* data, size_t size)
+{
+    s_received_size += size;
+
+    // 原始镜像以 0xE9 开头，首字节即可判定，不必逐字节缓存
+    if (!s_format_known && s_header_len == 0 && size > 0 && data[0] != OTA_COMPRESSED_MAGIC[0]) {
+        s_format_known = true;
+    }
+
+    if (!s_format_known) {
+        const size_t magic_len = sizeof(OTA_COMPRESSED_MAGIC) - 1;
+        while (size > 0 && s_header_len < sizeof(s_header_buf)) {
+            s_header_buf[s_header_len++] = *data++;
+            size--;
+            if (s_header_len <= magic_len &&
+                memcmp(s_header_buf, OTA_COMPRESSED_MAGIC, s_header_len) != 0) {
+                // 不是压缩头：已缓存的字节按原始镜像写入
+                s_format_known = true;
+                esp_err_t ret = flash_write(s_header_buf, s_header_len);
+                return ret == ESP_OK && size > 0 ? flash_write(data, size) : ret;
+            }
+        }
+        if (s_header_len < sizeof(s_header_buf)) {
+            return ESP_OK;
+        }
+
+        s_format_known = true;
+        esp_err_t ret = start_inflate();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    if (!s_compressed) {
+        return flash_write(data, size);
+    }
+    return inflate_write(data, size);
+}
+
+/**
+ * 汇总流水线统计
+ */
+static void fill_pipeline_stats(ota_pipeline_stats_t* stats)
+{
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - s_pipeline_start_us) / 1000);
+
+    stats->active = s_pipeline_active;
+    stats->bytes = written_size_get();
+    stats->transfer_bytes = s_received_size;
+    stats->compressed = s_compressed;
+    stats->resume_offset = s_resume_offset;
+    stats->chunks = s_pipeline_chunks;
+    stats->elapsed_ms = elapsed_ms;
+    stats->throughput_kbps = elapsed_ms > 0 ? (uint32_t)((uint64_t)stats->bytes * 1000 / 1024 / elapsed_ms) : 0;
+    stats->recv_stall_ms = (uint32_t)(s_recv_stall_us / 1000);
+    stats->write_stall_ms = (uint32_t)(s_write_stall_us / 1000);
+    stats->erase_ms = (uint32_t)(s_erase_us / 1000);
+    stats->flash_write_ms = (uint32_t)(s_flash_write_us / 1000);
+    stats->inflate_ms = (uint32_t)(s_inflate_us / 1000);
+    stats->hash_ms = (uint32_t)(s_hash_us / 1000);
+    stats->hash_verified = s_sha256_verified;
+}
+
+/**
+ * 流水线写入任务：取已填充的缓冲区写入Flash，空闲时预擦除后续扇区
+ */
+static void ota_writer_task(void* pvParameters)
+{
+    ota_chunk_t chunk;
+
+    while (1) {
+        if (xQueueReceive(s_full_queue, &chunk, 0) != pdTRUE) {
+            // 没有待写数据：先把写指针之后的扇区擦掉，写入时只剩编程
+            bool can_erase = s_pipeline_err == ESP_OK && !s_pipeline_discard &&
+                             s_erased_size < s_written_size + OTA_PIPELINE_ERASE_AHEAD;
+            if (can_erase) {
+                uint32_t erased_before = s_erased_size;
+                esp_err_t ret = erase_until(s_erased_size + OTA_FLASH_SECTOR_SIZE);
+                if (ret != ESP_OK) {
+                    s_pipeline_err = ret;
+                }
+                if (s_erased_size != erased_before) {
+                    continue;
+                }
+            }
+
+            int64_t wait_start = esp_timer_get_time();
+            xQueueReceive(s_full_queue, &chunk, portMAX_DELAY);
+            s_write_stall_us += esp_timer_get_time() - wait_start;
+        }
+
+        if (chunk.data == NULL) {
+            break;
+        }
+
+        if (chunk.len > 0 && s_pipeline_err == ESP_OK && !s_pipeline_discard) {
+            esp_err_t ret = ingest_data(chunk.data, chunk.len);
+            if (ret != ESP_OK) {
+                s_pipeline_err = ret;
+            }
+            s_pipeline_chunks++;
+        }
+        xQueueSend(s_free_queue, &chunk.data, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(s_writer_done);
+    vTaskDelete(NULL);
+}
 
-    ESP_LOGE(TAG, "❌ OTA Error: %s", s_ota_progress.error_message);
+/**
+ * 释放流水线资源
+ */
+static void pipeline_release(void)
+{
+    for (int i = 0; i < OTA_PIPELINE_BUFFER_COUNT; i++) {
+        free(s_pipeline_buffers[i]);
+        s_pipeline_buffers[i] = NULL;
+    }
+    if (s_free_queue) {
+        vQueueDelete(s_free_queue);
+        s_free_queue = NULL;
+    }
+    if (s_full_queue) {
+        vQueueDelete(s_full_queue);
+        s_full_queue = NULL;
+    }
+    if (s_writer_done) {
+        vSemaphoreDelete(s_writer_done);
+        s_writer_done = NULL;
+    }
+    s_pipeline_active = false;
 }
 
 /**
@@ -115,9 +714,9 @@ esp_err_t ota_manager_init(const ota_config_t* config)
 }
 
 /**
- * 开始OTA更新
+ * 打开更新分区并初始化写入状态（resume_offset>0 时从该偏移继续写入原始镜像）
  */
-esp_err_t ota_manager_begin(uint32_t firmware_size)
+static esp_err_t begin_update(uint32_t firmware_size, uint32_t resume_offset)
 {
     if (s_ota_state != OTA_STATE_IDLE) {
         set_error("OTA already in progress");
@@ -142,8 +741,9 @@ esp_err_t ota_manager_begin(uint32_t firmware_size)
     ESP_LOGI(TAG, "Update partition: %s (offset: 0x%08" PRIx32 ", size: %" PRIu32 ")",
              s_update_partition->label, (uint32_t)s_update_partition->address, (uint32_t)s_update_partition->size);
 
-    // 开始OTA操作
-    esp_err_t ret = esp_ota_begin(s_update_partition, firmware_size, &s_ota_handle);
+    // 开始OTA操作：不在此处整片擦除，由写入路径按扇区擦除（可提前预擦除）
+    // 续传时断点之前的内容保留，之后的扇区在写入前重新擦除
+    esp_err_t ret = esp_ota_begin(s_update_partition, OTA_WITH_SEQUENTIAL_WRITES, &s_ota_handle);
     if (ret != ESP_OK) {
         set_error("Failed to begin OTA update");
         return ret;
@@ -151,13 +751,190 @@ esp_err_t ota_manager_begin(uint32_t firmware_size)
 
     // 初始化状态
     s_firmware_size = firmware_size;
-    s_written_size = 0;
+    s_written_size = resume_offset;
+    s_erased_size = resume_offset;
+    s_reported_size = resume_offset;
+    s_resume_offset = resume_offset;
+    input_reset(firmware_size);
+    if (resume_offset > 0) {
+        // 只有原始镜像会保存断点
+        s_format_known = true;
+    } else {
+        // 续传时沿用回读校验得到的前缀哈希
+        image_sha_start();
+    }
+    s_hash_us = 0;
+    s_expected_sha256_set = false;
+    s_sha256_verified = false;
 
-    update_progress(OTA_STATE_WRITING, "Ready to receive firmware data");
+    update_progress(OTA_STATE_WRITING, resume_offset > 0 ? "Resuming firmware download" : "Ready to receive firmware data");
     ESP_LOGI(TAG, "✅ OTA update started successfully");
     return ESP_OK;
 }
 
+/**
+ * 开始OTA更新
+ */
+esp_err_t ota_manager_begin(uint32_t firmware_size)
+{
+    esp_err_t ret = begin_update(firmware_size, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 分区内容将被覆盖，之前的断点失效
+    s_checkpoint_enabled = false;
+    s_verified_offset = 0;
+    checkpoint_clear();
+    return ESP_OK;
+}
+
+/**
+ * 查询可续传的断点
+ */
+uint32_t ota_manager_get_resume_offset(const char* image_id, uint32_t image_size)
+{
+    s_verified_offset = 0;
+    if (image_id == NULL || s_ota_state == OTA_STATE_PREPARING || s_ota_state == OTA_STATE_WRITING ||
+        s_ota_state == OTA_STATE_VALIDATING) {
+        return 0;
+    }
+
+    ota_checkpoint_t checkpoint;
+    if (checkpoint_load(&checkpoint) != ESP_OK) {
+        return 0;
+    }
+
+    uint8_t id[32];
+    image_id_digest(image_id, id);
+    const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+    if (partition == NULL || checkpoint.partition_address != (uint32_t)partition->address ||
+        memcmp(checkpoint.image_id, id, sizeof(id)) != 0 ||
+        checkpoint.offset == 0 || checkpoint.offset >= checkpoint.image_size ||
+        checkpoint.image_size > partition->size ||
+        (image_size > 0 && checkpoint.image_size != image_size) ||
+        (checkpoint.offset & (OTA_FLASH_SECTOR_SIZE - 1)) != 0) {
+        ESP_LOGI(TAG, "OTA断点与本次镜像不符，从头下载");
+        checkpoint_clear();
+        return 0;
+    }
+
+    // 回读已写部分，确认与断点记录一致后才续传
+    uint8_t *buffer = malloc(OTA_FLASH_SECTOR_SIZE);
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    image_sha_start();
+    for (uint32_t pos = 0; pos < checkpoint.offset && ret == ESP_OK; pos += OTA_FLASH_SECTOR_SIZE) {
+        ret = esp_partition_read(partition, pos, buffer, OTA_FLASH_SECTOR_SIZE);
+        if (ret == ESP_OK) {
+            mbedtls_sha256_update(&s_image_sha, buffer, OTA_FLASH_SECTOR_SIZE);
+        }
+    }
+    free(buffer);
+
+    uint8_t digest[32];
+    if (ret == ESP_OK) {
+        mbedtls_sha256_context prefix;
+        mbedtls_sha256_init(&prefix);
+        mbedtls_sha256_clone(&prefix, &s_image_sha);
+        mbedtls_sha256_finish(&prefix, digest);
+        mbedtls_sha256_free(&prefix);
+    }
+    uint32_t verify_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+    if (ret != ESP_OK || memcmp(digest, checkpoint.prefix_sha256, sizeof(digest)) != 0) {
+        ESP_LOGW(TAG, "⚠️ 已写入部分校验失败 (%" PRIu32 " bytes)，从头下载", checkpoint.offset);
+        image_sha_stop();
+        checkpoint_clear();
+        return 0;
+    }
+
+    s_verified_offset = checkpoint.offset;
+    s_verified_size = checkpoint.image_size;
+    memcpy(s_verified_id, id, sizeof(id));
+    ESP_LOGI(TAG, "⏯️ 可从断点续传: %" PRIu32 "/%" PRIu32 " bytes (回读校验 %" PRIu32 " ms)",
+             checkpoint.offset, checkpoint.image_size, verify_ms);
+    return checkpoint.offset;
+}
+
+/**
+ * 开始可续传的OTA更新
+ */
+esp_err_t ota_manager_begin_resumable(uint32_t firmware_size, const char* image_id, uint32_t resume_offset)
+{
+    if (image_id == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t id[32];
+    image_id_digest(image_id, id);
+    if (resume_offset > 0 &&
+        (resume_offset != s_verified_offset || firmware_size != s_verified_size ||
+         memcmp(id, s_verified_id, sizeof(id)) != 0)) {
+        // 不进入失败状态：丢弃断点，由调用方从头下载
+        ESP_LOGW(TAG, "⚠️ 续传偏移未经校验或镜像已变更 (%" PRIu32 "/%" PRIu32 ")，丢弃断点",
+                 resume_offset, firmware_size);
+        s_verified_offset = 0;
+        image_sha_stop();
+        checkpoint_clear();
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = begin_update(firmware_size, resume_offset);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (resume_offset == 0) {
+        checkpoint_clear();
+    }
+    memcpy(s_image_id, id, sizeof(id));
+    s_checkpoint_offset = resume_offset;
+    s_checkpoint_enabled = true;
+    s_verified_offset = 0;
+    return ESP_OK;
+}
+
+/**
+ * 设置期望的固件SHA-256
+ */
+esp_err_t ota_manager_set_expected_sha256(const char* sha256_hex)
+{
+    if (s_ota_state != OTA_STATE_WRITING || !s_image_sha_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sha256_hex == NULL || strlen(sha256_hex) != 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t digest[32];
+    for (int i = 0; i < 32; i++) {
+        char byte_hex[3] = { sha256_hex[i * 2], sha256_hex[i * 2 + 1], '\0' };
+        char *end = NULL;
+        digest[i] = (uint8_t)strtoul(byte_hex, &end, 16);
+        if (end != byte_hex + 2) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    memcpy(s_expected_sha256, digest, sizeof(digest));
+    s_expected_sha256_set = true;
+    return ESP_OK;
+}
+
+/**
+ * 丢弃OTA断点
+ */
+void ota_manager_clear_checkpoint(void)
+{
+    s_verified_offset = 0;
+    checkpoint_clear();
+}
+
 /**
  * 写入固件数据
  */
@@ -173,35 +950,174 @@ esp_err_t ota_manager_write(const void* data, size_t size)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (s_written_size + size > s_firmware_size) {
-        set_error("Data size exceeds firmware size");
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    // 写入数据到OTA分区
-    esp_err_t ret = esp_ota_write(s_ota_handle, data, size);
+    esp_err_t ret = ingest_data(data, size);
     if (ret != ESP_OK) {
-        char error_msg[128];
-        snprintf(error_msg, sizeof(error_msg), "Failed to write OTA data: %s", esp_err_to_name(ret));
-        set_error(error_msg);
-        ESP_LOGE(TAG, "❌ OTA写入失败: %s (写入大小: %zu, 已写入: %" PRIu32 "/%" PRIu32 ")",
-                esp_err_to_name(ret), size, s_written_size, s_firmware_size);
         return ret;
     }
 
-    s_written_size += size;
+    report_write_progress();
+    return ESP_OK;
+}
+
+/**
+ * 启动OTA写入流水线
+ */
+esp_err_t ota_manager_pipeline_start(void)
+{
+    if (s_ota_state != OTA_STATE_WRITING) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_pipeline_active) {
+        return ESP_OK;
+    }
 
-    // 更新进度（每写入64KB或完成时更新一次）
-    if (s_written_size % (64 * 1024) == 0 || s_written_size == s_firmware_size) {
-        char progress_msg[64];
-        snprintf(progress_msg, sizeof(progress_msg), "Writing firmware: %u%%",
-                (unsigned int)((s_written_size * 100) / s_firmware_size));
-        update_progress(OTA_STATE_WRITING, progress_msg);
+    s_free_queue = xQueueCreate(OTA_PIPELINE_BUFFER_COUNT, sizeof(uint8_t*));
+    s_full_queue = xQueueCreate(OTA_PIPELINE_BUFFER_COUNT + 1, sizeof(ota_chunk_t));
+    s_writer_done = xSemaphoreCreateBinary();
+    if (s_free_queue == NULL || s_full_queue == NULL || s_writer_done == NULL) {
+        pipeline_release();
+        return ESP_ERR_NO_MEM;
     }
 
+    for (int i = 0; i < OTA_PIPELINE_BUFFER_COUNT; i++) {
+        s_pipeline_buffers[i] = malloc(OTA_PIPELINE_BUFFER_SIZE);
+        if (s_pipeline_buffers[i] == NULL) {
+            pipeline_release();
+            return ESP_ERR_NO_MEM;
+        }
+        xQueueSend(s_free_queue, &s_pipeline_buffers[i], 0);
+    }
+
+    s_pipeline_err = ESP_OK;
+    s_pipeline_discard = false;
+    s_pipeline_start_us = esp_timer_get_time();
+    s_recv_stall_us = 0;
+    s_write_stall_us = 0;
+    s_erase_us = 0;
+    s_flash_write_us = 0;
+    s_pipeline_chunks = 0;
+    s_pipeline_active = true;
+
+    if (xTaskCreatePinnedToCore(ota_writer_task, "ota_writer", OTA_WRITER_TASK_STACK_SIZE, NULL,
+                                OTA_WRITER_TASK_PRIORITY, NULL, OTA_WRITER_TASK_CORE) != pdPASS) {
+        pipeline_release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "🚚 OTA流水线已启动 (%d x %d bytes, 预擦除 %d KB)",
+             OTA_PIPELINE_BUFFER_COUNT, OTA_PIPELINE_BUFFER_SIZE, OTA_PIPELINE_ERASE_AHEAD / 1024);
     return ESP_OK;
 }
 
+/**
+ * 获取空闲缓冲区
+ */
+uint8_t* ota_manager_pipeline_acquire(void)
+{
+    if (!s_pipeline_active || s_pipeline_err != ESP_OK) {
+        return NULL;
+    }
+
+    // 进度回调可能有网络操作，在接收方任务中执行，不占用写入任务
+    report_write_progress();
+
+    uint8_t *buffer = NULL;
+    int64_t wait_start = esp_timer_get_time();
+    if (xQueueReceive(s_free_queue, &buffer, pdMS_TO_TICKS(OTA_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "❌ 等待OTA缓冲区超时");
+        return NULL;
+    }
+    s_recv_stall_us += esp_timer_get_time() - wait_start;
+
+    if (s_pipeline_err != ESP_OK) {
+        xQueueSend(s_free_queue, &buffer, 0);
+        return NULL;
+    }
+    return buffer;
+}
+
+/**
+ * 提交已填充的缓冲区
+ */
+esp_err_t ota_manager_pipeline_submit(uint8_t* buffer, size_t len)
+{
+    if (!s_pipeline_active || buffer == NULL || len > OTA_PIPELINE_BUFFER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ota_chunk_t chunk = { .data = buffer, .len = len };
+    xQueueSend(s_full_queue, &chunk, portMAX_DELAY);
+    return s_pipeline_err;
+}
+
+/**
+ * 结束流水线
+ */
+esp_err_t ota_manager_pipeline_finish(bool abort)
+{
+    if (!s_pipeline_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_pipeline_discard = abort;
+    ota_chunk_t end_marker = { .data = NULL, .len = 0 };
+    xQueueSend(s_full_queue, &end_marker, portMAX_DELAY);
+
+    esp_err_t ret = ESP_OK;
+    if (xSemaphoreTake(s_writer_done, pdMS_TO_TICKS(OTA_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+        // 写入任务卡在Flash操作中：让它丢弃剩余数据，等它退出后才能释放队列或中止OTA句柄
+        // （结束标记已入队，写入任务的每次擦写都有限时，必然会退出）
+        ESP_LOGE(TAG, "❌ 等待OTA写入任务结束超时，停止写入");
+        s_pipeline_discard = true;
+        xSemaphoreTake(s_writer_done, portMAX_DELAY);
+        ret = ESP_ERR_TIMEOUT;
+    }
+
+    if (ret == ESP_OK) {
+        ret = s_pipeline_err;
+    }
+    s_pipeline_active = false;
+    fill_pipeline_stats(&s_last_pipeline_stats);
+    pipeline_release();
+
+    if (ret == ESP_OK && !abort) {
+        report_write_progress();
+    }
+
+    const ota_pipeline_stats_t *st = &s_last_pipeline_stats;
+    ESP_LOGI(TAG, "📊 OTA流水线: %" PRIu32 " bytes / %" PRIu32 " ms = %" PRIu32 " KB/s",
+             st->bytes, st->elapsed_ms, st->throughput_kbps);
+    ESP_LOGI(TAG, "   接收等待缓冲区 %" PRIu32 " ms, 写入等待数据 %" PRIu32 " ms, 擦除 %" PRIu32 " ms, 编程 %" PRIu32 " ms",
+             st->recv_stall_ms, st->write_stall_ms, st->erase_ms, st->flash_write_ms);
+    ESP_LOGI(TAG, "   SHA-256 %" PRIu32 " ms%s", st->hash_ms, st->hash_verified ? "，与云端哈希一致" : "");
+    if (st->resume_offset > 0) {
+        ESP_LOGI(TAG, "   断点续传: 从 %" PRIu32 " bytes 继续，本次传输 %" PRIu32 " bytes",
+                 st->resume_offset, st->transfer_bytes);
+    }
+    if (st->compressed) {
+        ESP_LOGI(TAG, "   压缩传输 %" PRIu32 " bytes (原始 %" PRIu32 " bytes, 节省 %.1f%%), 解压 %" PRIu32 " ms",
+                 st->transfer_bytes, st->bytes,
+                 st->bytes > 0 ? 100.0f - (float)st->transfer_bytes * 100.0f / st->bytes : 0.0f,
+                 st->inflate_ms);
+    }
+    return ret;
+}
+
+/**
+ * 获取流水线统计
+ */
+void ota_manager_get_pipeline_stats(ota_pipeline_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_pipeline_active) {
+        fill_pipeline_stats(stats);
+    } else {
+        *stats = s_last_pipeline_stats;
+    }
+}
+
 /**
  * 完成OTA更新
  */
@@ -212,16 +1128,27 @@ esp_err_t ota_manager_end(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (s_written_size != s_firmware_size) {
+    if (s_written_size != s_firmware_size || (s_compressed && !s_inflate_done)) {
         set_error("Incomplete firmware data");
         return ESP_ERR_INVALID_SIZE;
     }
 
+    if (s_expected_sha256_set && !s_sha256_verified) {
+        set_error("Firmware SHA-256 not verified");
+        return ESP_ERR_INVALID_CRC;
+    }
+
     ESP_LOGI(TAG, "🔍 Validating firmware...");
     update_progress(OTA_STATE_VALIDATING, "Validating firmware");
 
-    // 结束OTA写入
+    // 结束OTA写入；镜像校验失败说明已写内容有误，断点一并作废
     esp_err_t ret = esp_ota_end(s_ota_handle);
+    s_ota_handle = 0;
+    image_sha_stop();
+    if (s_checkpoint_enabled) {
+        s_checkpoint_enabled = false;
+        checkpoint_clear();
+    }
     if (ret != ESP_OK) {
         set_error("Failed to end OTA update");
         return ret;
@@ -252,19 +1179,43 @@ esp_err_t ota_manager_abort(void)
 
     ESP_LOGW(TAG, "⚠️ Aborting OTA update...");
 
+    // 写入任务可能仍在调用 esp_ota_write，先停止流水线并等其退出再中止句柄
+    if (s_pipeline_active) {
+        ota_manager_pipeline_finish(true);
+    }
+
+    // 中断前写到扇区边界的数据补存一次断点（写入任务已结束，可以访问累计哈希）
+    if (s_checkpoint_enabled) {
+        if (s_ota_state == OTA_STATE_WRITING &&
+            (s_written_size & (OTA_FLASH_SECTOR_SIZE - 1)) == 0 &&
+            s_written_size > s_checkpoint_offset && s_written_size < s_firmware_size) {
+            checkpoint_save();
+        }
+        if (s_checkpoint_offset > 0) {
+            ESP_LOGI(TAG, "💾 保留OTA断点: %" PRIu32 "/%" PRIu32 " bytes", s_checkpoint_offset, s_firmware_size);
+        }
+        s_checkpoint_enabled = false;
+    }
+    image_sha_stop();
+
     if (s_ota_handle != 0) {
         esp_ota_abort(s_ota_handle);
         s_ota_handle = 0;
     }
 
     // 重置状态
+    taskENTER_CRITICAL(&s_state_lock);
     s_ota_state = OTA_STATE_IDLE;
     s_firmware_size = 0;
     s_written_size = 0;
-    s_update_partition = NULL;
-
     memset(&s_ota_progress, 0, sizeof(ota_progress_t));
     strcpy(s_ota_progress.status_message, "Aborted");
+    taskEXIT_CRITICAL(&s_state_lock);
+
+    s_erased_size = 0;
+    s_reported_size = 0;
+    s_update_partition = NULL;
+    input_reset(0);
 
     ESP_LOGI(TAG, "✅ OTA update aborted");
     return ESP_OK;
@@ -279,7 +1230,9 @@ esp_err_t ota_manager_get_progress(ota_progress_t* progress)
         return ESP_ERR_INVALID_ARG;
     }
 
+    taskENTER_CRITICAL(&s_state_lock);
     memcpy(progress, &s_ota_progress, sizeof(ota_progress_t));
+    taskEXIT_CRITICAL(&s_state_lock);
     return ESP_OK;
 }
 
@@ -7,6 +7,39 @@
 #include "esp_ota_ops.h"
 #include "http_server.h"
 
+// OTA流水线配置：接收方填充缓冲区，写入任务擦写Flash，两者并行
+#define OTA_PIPELINE_BUFFER_COUNT       3           // 三缓冲
+#define OTA_PIPELINE_BUFFER_SIZE        4096        // 与Flash扇区大小一致
+#define OTA_PIPELINE_ERASE_AHEAD        (64 * 1024) // 写入任务空闲时预擦除到写指针之前的距离
+#define OTA_PIPELINE_TIMEOUT_MS         30000       // 等待空闲缓冲区/写入任务结束的超时
+#define OTA_WRITER_TASK_STACK_SIZE      4096
+#define OTA_WRITER_TASK_PRIORITY        5
+// 写入任务（擦写、解压、SHA-256）固定在 PRO_CPU，与Wi-Fi协议栈同核；
+// 控制路径任务固定在 APP_CPU（main.h CONTROL_TASK_CORE），不与哈希计算争用
+#define OTA_WRITER_TASK_CORE            0
+
+// 压缩固件：16字节头 + raw deflate 流，写入路径边收边解压（32KB滑动窗口）
+// 以 OTA_COMPRESSED_MAGIC 开头的数据按压缩格式处理，否则按原始镜像写入
+#define OTA_COMPRESSED_MAGIC            "OTAZ"
+#define OTA_COMPRESSED_VERSION          1
+#define OTA_COMPRESSED_ALGO_DEFLATE     1
+#define OTA_COMPRESSED_CONTENT_TYPE     "application/x-esp32-ota-z"
+#define OTA_COMPRESSED_URL_QUERY        "format=otaz"   // 云端下载地址请求压缩镜像的查询参数
+
+// 断点续传：原始镜像每写入 OTA_CHECKPOINT_INTERVAL 字节把写入偏移与已写内容的SHA-256存入NVS，
+// 重试时回读分区校验已写部分，再用 HTTP Range 从断点继续下载（压缩镜像不保存断点）
+#define OTA_CHECKPOINT_INTERVAL         (64 * 1024)
+#define OTA_CHECKPOINT_NVS_NAMESPACE    "ota_resume"
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint8_t version;
+    uint8_t algorithm;
+    uint16_t reserved;
+    uint32_t raw_size;              // 解压后固件大小（小端）
+    uint32_t compressed_size;       // 头之后的压缩数据长度（小端）
+} ota_compressed_header_t;
+
 // OTA状态枚举
 typedef enum {
     OTA_STATE_IDLE = 0,
@@ -25,6 +58,25 @@ typedef struct {
     uint32_t rollback_timeout_ms;
 } ota_config_t;
 
+// OTA流水线统计
+typedef struct {
+    bool active;
+    uint32_t bytes;                 // 已写入Flash的字节数
+    uint32_t transfer_bytes;        // 已接收的字节数（压缩镜像为压缩后大小）
+    bool compressed;
+    uint32_t resume_offset;         // 续传起点（0=从头下载）
+    uint32_t chunks;
+    uint32_t elapsed_ms;
+    uint32_t throughput_kbps;       // KB/s
+    uint32_t recv_stall_ms;         // 接收方等待空闲缓冲区（Flash跟不上网络）
+    uint32_t write_stall_ms;        // 写入任务等待数据（网络跟不上Flash）
+    uint32_t erase_ms;              // 扇区擦除耗时
+    uint32_t flash_write_ms;        // 编程耗时
+    uint32_t inflate_ms;            // 解压耗时
+    uint32_t hash_ms;               // 流式SHA-256耗时（硬件加速）
+    bool hash_verified;             // 已与期望的SHA-256比对一致
+} ota_pipeline_stats_t;
+
 // OTA进度回调函数类型
 typedef void (*ota_progress_callback_t)(uint8_t progress_percent, const char* status_message);
 
@@ -37,11 +89,43 @@ esp_err_t ota_manager_init(const ota_config_t* config);
 
 /**
  * 开始OTA更新
- * @param firmware_size 固件大小
+ * @param firmware_size 传输大小（压缩镜像为含头的压缩文件大小）
  * @return ESP_OK=成功
  */
 esp_err_t ota_manager_begin(uint32_t firmware_size);
 
+/**
+ * 查询可续传的断点：镜像标识、大小与目标分区一致时回读分区校验已写部分
+ * @param image_id 镜像标识（固件哈希或下载URL，含传输格式），同一镜像必须相同
+ * @param image_size 服务器当前的镜像大小，0=未知（不比较）
+ * @return 续传偏移，0 表示需从头下载（无断点、不匹配或校验失败时断点已清除）
+ */
+uint32_t ota_manager_get_resume_offset(const char* image_id, uint32_t image_size);
+
+/**
+ * 开始可续传的OTA更新，写入原始镜像时定期保存断点
+ * @param firmware_size 固件总大小（续传时为完整镜像大小，不是剩余长度）
+ * @param image_id 镜像标识
+ * @param resume_offset ota_manager_get_resume_offset 的返回值，0=从头开始
+ * @return ESP_OK=成功，ESP_ERR_NOT_FOUND=续传偏移与校验过的断点不符（断点已清除，
+ *         OTA状态不变，调用方应以 resume_offset=0 重新下载）
+ */
+esp_err_t ota_manager_begin_resumable(uint32_t firmware_size, const char* image_id, uint32_t resume_offset);
+
+/**
+ * 设置期望的固件SHA-256（在 begin 之后、写入数据之前调用）
+ * 写入任务边写边计算镜像（压缩镜像为解压后内容）的SHA-256，写完最后一个字节时比对，
+ * 不一致则写入失败，ota_manager_end 拒绝结束
+ * @param sha256_hex 64位十六进制字符串
+ * @return ESP_OK=成功，ESP_ERR_INVALID_ARG=格式错误
+ */
+esp_err_t ota_manager_set_expected_sha256(const char* sha256_hex);
+
+/**
+ * 丢弃OTA断点（服务器拒绝续传范围或镜像已变更时调用）
+ */
+void ota_manager_clear_checkpoint(void);
+
 /**
  * 写入固件数据
  * @param data 固件数据
@@ -50,6 +134,39 @@ esp_err_t ota_manager_begin(uint32_t firmware_size);
  */
 esp_err_t ota_manager_write(const void* data, size_t size);
 
+/**
+ * 启动OTA写入流水线（在 ota_manager_begin 之后调用）
+ * 创建写入任务与 OTA_PIPELINE_BUFFER_COUNT 个缓冲区
+ * @return ESP_OK=成功
+ */
+esp_err_t ota_manager_pipeline_start(void);
+
+/**
+ * 获取一个空闲缓冲区（大小 OTA_PIPELINE_BUFFER_SIZE），Flash写入跟不上时阻塞
+ * 进度回调在调用方任务中执行
+ * @return 缓冲区指针，写入失败或超时返回NULL
+ */
+uint8_t* ota_manager_pipeline_acquire(void);
+
+/**
+ * 提交已填充的缓冲区，由写入任务写入Flash（len=0 仅归还缓冲区）
+ * @return ESP_OK=成功
+ */
+esp_err_t ota_manager_pipeline_submit(uint8_t* buffer, size_t len);
+
+/**
+ * 等待写入任务写完所有缓冲区并释放流水线资源
+ * @param abort true=丢弃未写入的数据
+ * @return 写入结果，ESP_OK=全部写入成功；ESP_ERR_TIMEOUT=写入任务超时未结束，
+ *         已让其丢弃剩余数据并等到退出（返回时写入任务总已结束）
+ */
+esp_err_t ota_manager_pipeline_finish(bool abort);
+
+/**
+ * 获取流水线统计（进行中为实时值，结束后为最近一次）
+ */
+void ota_manager_get_pipeline_stats(ota_pipeline_stats_t* stats);
+
 /**
  * 完成OTA更新
  * @return ESP_OK=成功
@@ -57,7 +174,8 @@ esp_err_t ota_manager_write(const void* data, size_t size);
 esp_err_t ota_manager_end(void);
 
 /**
- * 中止OTA更新
+ * 中止OTA更新（可续传的更新保留断点，供下次重试继续）
+ * 流水线仍在运行时先停止写入任务并等其退出，再中止OTA句柄
  * @return ESP_OK=成功
  */
 esp_err_t ota_manager_abort(void);
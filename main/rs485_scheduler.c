@@ -0,0 +1,487 @@
+#include "rs485_scheduler.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "RS485_SCHED";
+
+#define RS485_SCHED_TASK_STACK_SIZE     3072
+#define RS485_SCHED_TASK_PRIORITY       7
+#define RS485_SCHED_IDLE_MAX_MS         20      // 空闲时最长等待（通知可提前唤醒）
+#define RS485_SCHED_DEFAULT_DEADLINE_MS 100
+#define RS485_SCHED_DIAG_INTERVAL_MS    30000   // 周期性打印调度与 Modbus 统计
+
+typedef struct {
+    rs485_job_config_t config;
+    uint32_t slot_us;
+    uint32_t deadline_ms;
+    uint32_t next_release_ms;       // 下一次周期释放时刻
+    uint32_t release_ms;            // 当前释放时刻
+    uint32_t last_run_ms;
+    bool pending;                   // 已释放待执行
+    bool requested;                 // 按需触发标志（跨任务写入，受 s_lock 保护）
+    bool deferred;                  // 本次释放已因让路被推迟过
+    uint16_t values[MODBUS_MAX_READ_REGS];
+    rs485_job_stats_t stats;
+} rs485_job_t;
+
+static rs485_job_t s_jobs[RS485_SCHED_MAX_JOBS];
+static uint8_t s_job_count = 0;
+static bool s_started = false;
+static TaskHandle_t s_task_handle = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static float s_bus_occupancy_percent = 0.0f;
+static float s_peak_occupancy_percent = 0.0f;
+static float s_planned_utilization_percent = 0.0f;
+static uint32_t s_deferred_polls = 0;
+
+uint32_t rs485_scheduler_slot_us(uint8_t function, uint16_t count)
+{
+    uint16_t request_bytes;
+    uint16_t response_bytes;
+
+    switch (function) {
+        case MODBUS_FC_READ_HOLDING:
+            request_bytes = 8;
+            response_bytes = 5 + count * 2;
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE:
+            request_bytes = 9 + count * 2;
+            response_bytes = 8;
+            break;
+        case MODBUS_FC_WRITE_SINGLE:
+        default:
+            request_bytes = 8;
+            response_bytes = 8;
+            break;
+    }
+
+    return modbus_master_frame_time_us(request_bytes + response_bytes) +
+           2 * modbus_master_inter_frame_us() + RS485_SCHED_TURNAROUND_US;
+}
+
+/**
+ * 规划占用率：Σ 时间片 / 周期（控制写按最小间隔计）
+ * @param control_only 只统计控制写作业
+ */
+static float compute_planned_utilization(bool control_only)
+{
+    float utilization = 0.0f;
+    for (int i = 0; i < s_job_count; i++) {
+        const rs485_job_t *job = &s_jobs[i];
+        if (control_only && !job->config.control) {
+            continue;
+        }
+        uint32_t interval_ms = job->config.period_ms;
+        if (job->config.min_interval_ms > 0 &&
+            (interval_ms == 0 || job->config.min_interval_ms < interval_ms)) {
+            interval_ms = job->config.min_interval_ms;
+        }
+        if (interval_ms > 0) {
+            utilization += (float)job->slot_us * 100.0f / ((float)interval_ms * 1000.0f);
+        }
+    }
+    return utilization;
+}
+
+int rs485_scheduler_add_job(const rs485_job_config_t *job)
+{
+    if (job == NULL || s_started || s_job_count >= RS485_SCHED_MAX_JOBS) {
+        return -1;
+    }
+
+    uint16_t max_count;
+    switch (job->function) {
+        case MODBUS_FC_READ_HOLDING:
+            max_count = MODBUS_MAX_READ_REGS;
+            break;
+        case MODBUS_FC_WRITE_SINGLE:
+            max_count = 1;
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE:
+            max_count = MODBUS_MAX_WRITE_REGS;
+            break;
+        default:
+            ESP_LOGE(TAG, "❌ Unsupported function code 0x%02X for job %s",
+                     job->function, job->name ? job->name : "?");
+            return -1;
+    }
+    if (job->count == 0 || job->count > max_count) {
+        ESP_LOGE(TAG, "❌ Invalid register count %u for job %s",
+                 (unsigned)job->count, job->name ? job->name : "?");
+        return -1;
+    }
+
+    rs485_job_t *slot = &s_jobs[s_job_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->config = *job;
+    slot->deadline_ms = job->deadline_ms;
+    if (slot->deadline_ms == 0) {
+        slot->deadline_ms = job->period_ms ? job->period_ms :
+                            (job->min_interval_ms ? job->min_interval_ms : RS485_SCHED_DEFAULT_DEADLINE_MS);
+    }
+    slot->stats.name = job->name;
+    slot->stats.slave = job->slave;
+
+    return s_job_count++;
+}
+
+void rs485_scheduler_request(int job_id)
+{
+    if (job_id < 0 || job_id >= s_job_count) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    s_jobs[job_id].requested = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (s_task_handle != NULL) {
+        xTaskNotifyGive(s_task_handle);
+    }
+}
+
+/**
+ * 释放到期的周期作业与已触发的按需作业
+ */
+static void release_jobs(uint32_t now)
+{
+    for (int i = 0; i < s_job_count; i++) {
+        rs485_job_t *job = &s_jobs[i];
+        bool requested = false;
+
+        taskENTER_CRITICAL(&s_lock);
+        if (job->requested &&
+            (job->config.min_interval_ms == 0 ||
+             (now - job->last_run_ms) >= job->config.min_interval_ms)) {
+            requested = true;
+            job->requested = false;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        bool periodic_due = job->config.period_ms > 0 &&
+                            (int32_t)(now - job->next_release_ms) >= 0;
+        if (periodic_due) {
+            job->next_release_ms += job->config.period_ms;
+            if ((int32_t)(now - job->next_release_ms) >= 0) {
+                job->next_release_ms = now + job->config.period_ms;
+            }
+        }
+
+        if (!requested && !periodic_due) {
+            continue;
+        }
+
+        if (job->pending) {
+            // 按需请求合并到已释放的实例；周期释放撞上未执行的实例记为重叠
+            if (periodic_due && !requested) {
+                taskENTER_CRITICAL(&s_lock);
+                job->stats.overruns++;
+                taskEXIT_CRITICAL(&s_lock);
+            }
+            continue;
+        }
+
+        job->pending = true;
+        job->deferred = false;
+        job->release_ms = now;
+        if (requested && job->config.period_ms > 0) {
+            // 按需写入后重新计时，周期释放仅作为保活
+            job->next_release_ms = now + job->config.period_ms;
+        }
+    }
+}
+
+/**
+ * 距离下一次控制写周期释放的时间（无则返回 UINT32_MAX）
+ */
+static uint32_t next_control_release_in_ms(uint32_t now)
+{
+    uint32_t nearest = UINT32_MAX;
+    for (int i = 0; i < s_job_count; i++) {
+        const rs485_job_t *job = &s_jobs[i];
+        if (!job->config.control || job->config.period_ms == 0) {
+            continue;
+        }
+        int32_t delta = (int32_t)(job->next_release_ms - now);
+        uint32_t in_ms = delta > 0 ? (uint32_t)delta : 0;
+        if (in_ms < nearest) {
+            nearest = in_ms;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * 选择下一个作业：控制写优先，同类按绝对截止时间最早（EDF）
+ * 轮询作业只有在下一次控制写释放前能完整放下时才执行
+ */
+static int select_job(uint32_t now)
+{
+    for (int pass = 0; pass < 2; pass++) {
+        bool want_control = (pass == 0);
+        int best = -1;
+        int32_t best_slack = INT32_MAX;
+
+        for (int i = 0; i < s_job_count; i++) {
+            const rs485_job_t *job = &s_jobs[i];
+            if (!job->pending || job->config.control != want_control) {
+                continue;
+            }
+            int32_t slack = (int32_t)(job->release_ms + job->deadline_ms - now);
+            if (best < 0 || slack < best_slack) {
+                best = i;
+                best_slack = slack;
+            }
+        }
+
+        if (best < 0) {
+            continue;
+        }
+        if (!want_control) {
+            uint32_t control_in_ms = next_control_release_in_ms(now);
+            if (control_in_ms != UINT32_MAX &&
+                (uint64_t)control_in_ms * 1000 < s_jobs[best].slot_us) {
+                if (!s_jobs[best].deferred) {
+                    s_jobs[best].deferred = true;
+                    taskENTER_CRITICAL(&s_lock);
+                    s_deferred_polls++;
+                    taskEXIT_CRITICAL(&s_lock);
+                }
+                return -1;
+            }
+        }
+        return best;
+    }
+    return -1;
+}
+
+/**
+ * 空闲等待时长：距最近的周期释放或被限频的按需请求
+ */
+static uint32_t idle_wait_ms(uint32_t now)
+{
+    uint32_t wait_ms = RS485_SCHED_IDLE_MAX_MS;
+    for (int i = 0; i < s_job_count; i++) {
+        const rs485_job_t *job = &s_jobs[i];
+        if (job->config.period_ms > 0) {
+            int32_t delta = (int32_t)(job->next_release_ms - now);
+            if (delta < (int32_t)wait_ms) {
+                wait_ms = delta > 1 ? (uint32_t)delta : 1;
+            }
+        }
+        if (job->requested && job->config.min_interval_ms > 0) {
+            int32_t delta = (int32_t)(job->last_run_ms + job->config.min_interval_ms - now);
+            if (delta < (int32_t)wait_ms) {
+                wait_ms = delta > 1 ? (uint32_t)delta : 1;
+            }
+        }
+    }
+    return wait_ms;
+}
+
+/**
+ * 执行一个作业，返回占用总线的时长（微秒）
+ */
+static uint32_t run_job(rs485_job_t *job)
+{
+    const rs485_job_config_t *cfg = &job->config;
+    esp_err_t ret;
+
+    job->pending = false;
+    if (cfg->function != MODBUS_FC_READ_HOLDING && cfg->prepare != NULL) {
+        cfg->prepare(job->values, cfg->count, cfg->ctx);
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    switch (cfg->function) {
+        case MODBUS_FC_READ_HOLDING:
+            ret = modbus_master_read_holding(cfg->slave, cfg->reg, cfg->count, job->values);
+            break;
+        case MODBUS_FC_WRITE_SINGLE:
+            ret = modbus_master_write_single(cfg->slave, cfg->reg, job->values[0]);
+            break;
+        case MODBUS_FC_WRITE_MULTIPLE:
+            ret = modbus_master_write_multiple(cfg->slave, cfg->reg, cfg->count, job->values);
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            break;
+    }
+    uint32_t busy_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    uint32_t done_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t response_ms = done_ms - job->release_ms;
+    job->last_run_ms = done_ms;
+
+    taskENTER_CRITICAL(&s_lock);
+    job->stats.runs++;
+    if (ret != ESP_OK) {
+        job->stats.errors++;
+    }
+    if (response_ms > job->deadline_ms) {
+        job->stats.missed_deadlines++;
+    }
+    if (response_ms > job->stats.max_response_ms) {
+        job->stats.max_response_ms = response_ms;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (response_ms > job->deadline_ms) {
+        static uint32_t last_miss_log_time = 0;
+        if (done_ms - last_miss_log_time > 5000) {
+            ESP_LOGW(TAG, "⚠️ Job %s missed deadline: %" PRIu32 "ms > %" PRIu32 "ms",
+                     cfg->name ? cfg->name : "?", response_ms, job->deadline_ms);
+            last_miss_log_time = done_ms;
+        }
+    }
+
+    if (cfg->complete != NULL) {
+        cfg->complete(ret, job->values, cfg->count, done_ms, cfg->ctx);
+    }
+    return busy_us;
+}
+
+static void rs485_scheduler_task(void *pvParameters)
+{
+    (void)pvParameters;
+    uint32_t window_start_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint64_t window_busy_us = 0;
+    uint32_t last_diag_ms = window_start_ms;
+
+    ESP_LOGI(TAG, "RS485 scheduler task started (%u jobs)", (unsigned)s_job_count);
+
+    // 🐕 订阅任务看门狗监控
+    esp_err_t wdt_ret = esp_task_wdt_add(NULL);
+    if (wdt_ret == ESP_OK) {
+        ESP_LOGI(TAG, "🐕 RS485调度任务已加入看门狗监控");
+    } else {
+        ESP_LOGW(TAG, "⚠️ RS485调度任务加入看门狗失败: %s", esp_err_to_name(wdt_ret));
+    }
+
+    while (1) {
+        esp_task_wdt_reset();
+        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+        release_jobs(now);
+        int job_index = select_job(now);
+        if (job_index >= 0) {
+            window_busy_us += run_job(&s_jobs[job_index]);
+        } else {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idle_wait_ms(now)) + 1);
+        }
+
+        now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        uint32_t window_ms = now - window_start_ms;
+        if (window_ms >= RS485_SCHED_WINDOW_MS) {
+            float occupancy = (float)window_busy_us * 100.0f / ((float)window_ms * 1000.0f);
+            taskENTER_CRITICAL(&s_lock);
+            s_bus_occupancy_percent = occupancy;
+            if (occupancy > s_peak_occupancy_percent) {
+                s_peak_occupancy_percent = occupancy;
+            }
+            taskEXIT_CRITICAL(&s_lock);
+            window_start_ms = now;
+            window_busy_us = 0;
+        }
+
+        if (now - last_diag_ms >= RS485_SCHED_DIAG_INTERVAL_MS) {
+            rs485_scheduler_print_diag();
+            modbus_master_print_diag();
+            last_diag_ms = now;
+        }
+    }
+}
+
+esp_err_t rs485_scheduler_start(void)
+{
+    if (s_started) {
+        return ESP_OK;
+    }
+    if (s_job_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    for (int i = 0; i < s_job_count; i++) {
+        rs485_job_t *job = &s_jobs[i];
+        job->slot_us = rs485_scheduler_slot_us(job->config.function, job->config.count);
+        job->stats.slot_us = job->slot_us;
+        // 错开各周期作业的首次释放，避免同一时刻扎堆
+        job->next_release_ms = now + (uint32_t)i * (job->slot_us / 1000 + 1);
+        ESP_LOGI(TAG, "🔧 Job[%d] %s slave=0x%02X fc=0x%02X reg=0x%04X n=%u slot=%" PRIu32 "us period=%" PRIu32 "ms%s",
+                 i, job->config.name ? job->config.name : "?", job->config.slave,
+                 job->config.function, job->config.reg, (unsigned)job->config.count,
+                 job->slot_us, job->config.period_ms, job->config.control ? " [control]" : "");
+    }
+
+    // 控制写优先于轮询，仅控制写就超出上限时无法保证其截止时间，拒绝启动
+    float control_utilization = compute_planned_utilization(true);
+    if (control_utilization > RS485_SCHED_MAX_UTILIZATION) {
+        ESP_LOGE(TAG, "❌ Planned RS485 control utilization %.1f%% exceeds %u%%, raise min_interval_ms or the baud rate",
+                 control_utilization, (unsigned)RS485_SCHED_MAX_UTILIZATION);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_planned_utilization_percent = compute_planned_utilization(false);
+    if (s_planned_utilization_percent > RS485_SCHED_MAX_UTILIZATION) {
+        ESP_LOGW(TAG, "⚠️ Planned RS485 utilization %.1f%% exceeds %u%%, polls will be deferred",
+                 s_planned_utilization_percent, (unsigned)RS485_SCHED_MAX_UTILIZATION);
+    } else {
+        ESP_LOGI(TAG, "✅ Planned RS485 utilization %.1f%%", s_planned_utilization_percent);
+    }
+
+    s_started = true;
+    if (xTaskCreate(rs485_scheduler_task, "rs485_sched", RS485_SCHED_TASK_STACK_SIZE, NULL,
+                    RS485_SCHED_TASK_PRIORITY, &s_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "❌ Failed to create RS485 scheduler task");
+        s_started = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void rs485_scheduler_get_stats(rs485_scheduler_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    taskENTER_CRITICAL(&s_lock);
+    stats->bus_occupancy_percent = s_bus_occupancy_percent;
+    stats->peak_occupancy_percent = s_peak_occupancy_percent;
+    stats->planned_utilization_percent = s_planned_utilization_percent;
+    stats->deferred_polls = s_deferred_polls;
+    stats->job_count = s_job_count;
+    for (int i = 0; i < s_job_count; i++) {
+        stats->jobs[i] = s_jobs[i].stats;
+        stats->missed_deadlines += s_jobs[i].stats.missed_deadlines;
+        stats->overruns += s_jobs[i].stats.overruns;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void rs485_scheduler_print_diag(void)
+{
+    rs485_scheduler_stats_t stats;
+    rs485_scheduler_get_stats(&stats);
+
+    ESP_LOGI(TAG, "📊 RS485 bus: occupancy=%.1f%% peak=%.1f%% planned=%.1f%% missed=%" PRIu32 " overrun=%" PRIu32 " deferred=%" PRIu32,
+             stats.bus_occupancy_percent, stats.peak_occupancy_percent,
+             stats.planned_utilization_percent, stats.missed_deadlines,
+             stats.overruns, stats.deferred_polls);
+    for (int i = 0; i < stats.job_count; i++) {
+        const rs485_job_stats_t *job = &stats.jobs[i];
+        ESP_LOGI(TAG, "📊   %s@0x%02X slot=%" PRIu32 "us runs=%" PRIu32 " err=%" PRIu32 " missed=%" PRIu32 " overrun=%" PRIu32 " max_rsp=%" PRIu32 "ms",
+                 job->name ? job->name : "?", job->slave, job->slot_us, job->runs,
+                 job->errors, job->missed_deadlines, job->overruns, job->max_response_ms);
+    }
+}
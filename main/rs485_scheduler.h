@@ -0,0 +1,119 @@
+#ifndef RS485_SCHEDULER_H
+#define RS485_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "modbus_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * RS485 总线时间片调度器（多 Modbus 从站）
+ *
+ *   - 每个作业 = 一个从站上的一次周期性读/写事务（0x03 / 0x06 / 0x10）
+ *   - 时间片长度由波特率和请求/应答帧长计算：请求 + 应答 + 2×t3.5 + 从站处理余量
+ *   - 控制写作业优先：按需触发立即释放，轮询只在不挤占下一次控制写的空隙中执行
+ *   - 同优先级内按截止时间最早者先执行（EDF）
+ *   - 统计总线占用率、截止时间错过次数、周期重叠（作业未执行就被再次释放）次数
+ *
+ * 事务本身不可抢占，控制写的最坏等待 = 一个轮询时间片。
+ */
+
+#define RS485_SCHED_MAX_JOBS            8
+#define RS485_SCHED_TURNAROUND_US       3000U   // 从站处理/收发切换余量
+#define RS485_SCHED_MAX_UTILIZATION     85U     // 规划占用率上限（%）：仅控制写超出时拒绝启动，含轮询超出时告警
+#define RS485_SCHED_WINDOW_MS           1000U   // 占用率统计窗口
+
+/**
+ * 作业回调：写作业在发送前调用 prepare 填充寄存器值；事务结束后调用 complete
+ */
+typedef void (*rs485_job_prepare_t)(uint16_t *values, uint16_t count, void *ctx);
+typedef void (*rs485_job_complete_t)(esp_err_t ret, const uint16_t *values, uint16_t count,
+                                     uint32_t now_ms, void *ctx);
+
+/**
+ * 作业描述
+ */
+typedef struct {
+    const char *name;               // 诊断用名称
+    uint8_t slave;                  // 从站地址
+    uint8_t function;               // MODBUS_FC_READ_HOLDING / WRITE_SINGLE / WRITE_MULTIPLE
+    uint16_t reg;                   // 起始寄存器
+    uint16_t count;                 // 寄存器数量（0x06 固定为 1）
+    uint32_t period_ms;             // 周期（0=仅按需触发）
+    uint32_t min_interval_ms;       // 按需触发的最小间隔（合并过密请求，用于规划占用率）
+    uint32_t deadline_ms;           // 相对释放时刻的截止时间（0=等于周期/最小间隔）
+    bool control;                   // 控制写：优先于轮询
+    rs485_job_prepare_t prepare;
+    rs485_job_complete_t complete;
+    void *ctx;
+} rs485_job_config_t;
+
+/**
+ * 单个作业统计
+ */
+typedef struct {
+    const char *name;
+    uint8_t slave;
+    uint32_t slot_us;               // 计算得到的时间片长度
+    uint32_t runs;
+    uint32_t errors;
+    uint32_t missed_deadlines;      // 完成时已超过截止时间
+    uint32_t overruns;              // 上一次释放尚未执行就到了下一次释放
+    uint32_t max_response_ms;       // 释放到完成的最大时长
+} rs485_job_stats_t;
+
+/**
+ * 调度器统计
+ */
+typedef struct {
+    float bus_occupancy_percent;    // 上一窗口实际总线占用率
+    float peak_occupancy_percent;
+    float planned_utilization_percent; // 按时间片/周期计算的规划占用率
+    uint32_t missed_deadlines;
+    uint32_t overruns;
+    uint32_t deferred_polls;        // 为控制写让路而推迟的轮询次数
+    uint8_t job_count;
+    rs485_job_stats_t jobs[RS485_SCHED_MAX_JOBS];
+} rs485_scheduler_stats_t;
+
+/**
+ * 注册作业（须在 rs485_scheduler_start 之前）
+ * @return 作业编号，<0 表示失败
+ */
+int rs485_scheduler_add_job(const rs485_job_config_t *job);
+
+/**
+ * 启动调度任务（modbus_master 须已初始化）
+ * @return ESP_ERR_INVALID_SIZE 仅控制写作业的规划占用率就超过 RS485_SCHED_MAX_UTILIZATION
+ */
+esp_err_t rs485_scheduler_start(void);
+
+/**
+ * 按需释放一个作业（通常为控制写），可在任意任务中调用
+ */
+void rs485_scheduler_request(int job_id);
+
+/**
+ * 计算一个作业的时间片长度（微秒）
+ */
+uint32_t rs485_scheduler_slot_us(uint8_t function, uint16_t count);
+
+/**
+ * 获取调度统计快照
+ */
+void rs485_scheduler_get_stats(rs485_scheduler_stats_t *stats);
+
+/**
+ * 打印总线占用率与各作业统计
+ */
+void rs485_scheduler_print_diag(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RS485_SCHEDULER_H */
@@ -289,7 +289,7 @@ esp_err_t sbus_init(void)
     }
 
     // 创建UART接收任务 (增加栈大小以支持调试输出)
-    xTaskCreate(sbus_uart_task, "sbus_uart_task", 4096, NULL, 12, NULL);
+    xTaskCreatePinnedToCore(sbus_uart_task, "sbus_uart_task", 4096, NULL, 12, NULL, CONTROL_TASK_CORE);
 
     ESP_LOGI(TAG, "✅ UART2 initialized successfully:");
     ESP_LOGI(TAG, "   📍 RX Pin: GPIO%" PRIu32, (uint32_t)SBUS_RX_PIN);
@@ -0,0 +1,179 @@
+#include "status_codec.h"
+
+#include <string.h>
+
+#define FLAG_KEYFRAME           0x01
+#define FLAG_SBUS_CONNECTED     0x02
+#define FLAG_CAN_CONNECTED      0x04
+#define FLAG_WIFI_CONNECTED     0x08
+
+#define FIELD_SBUS_CHANNEL_BASE 12      // 字段 12..27 为 SBUS 通道
+
+/**
+ * 点分十进制 IPv4 转为整数（无法解析返回 0）
+ */
+static uint32_t ipv4_to_u32(const char *ip)
+{
+    uint32_t result = 0;
+    int octets = 0;
+    uint32_t value = 0;
+    bool has_digit = false;
+
+    for (const char *p = ip; ; p++) {
+        if (*p >= '0' && *p <= '9') {
+            value = value * 10 + (uint32_t)(*p - '0');
+            if (value > 255) {
+                return 0;
+            }
+            has_digit = true;
+        } else if (*p == '.' || *p == '\0') {
+            if (!has_digit || octets >= 4) {
+                return 0;
+            }
+            result = (result << 8) | value;
+            octets++;
+            value = 0;
+            has_digit = false;
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            return 0;
+        }
+    }
+    return octets == 4 ? result : 0;
+}
+
+/**
+ * 按固定字段表取值（顺序与云端解码器一致，只能在末尾追加）
+ */
+static int64_t field_value(const device_status_data_t *s, int index)
+{
+    switch (index) {
+        case 0:  return s->wifi_rssi;
+        case 1:  return s->free_heap;
+        case 2:  return s->total_heap;
+        case 3:  return s->uptime_seconds;
+        case 4:  return s->task_count;
+        case 5:  return s->can_tx_count;
+        case 6:  return s->can_rx_count;
+        case 7:  return s->motor_left_speed;
+        case 8:  return s->motor_right_speed;
+        case 9:  return s->last_sbus_time;
+        case 10: return s->last_cmd_time;
+        case 11: return ipv4_to_u32(s->wifi_ip);
+        default: return s->sbus_channels[index - FIELD_SBUS_CHANNEL_BASE];
+    }
+}
+
+static bool put_varint(uint8_t *out, size_t size, size_t *pos, uint64_t value)
+{
+    do {
+        if (*pos >= size) {
+            return false;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[(*pos)++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return true;
+}
+
+static inline uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+void status_codec_init(status_codec_ctx_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->next_seq = 1;
+}
+
+esp_err_t status_codec_encode(status_codec_ctx_t *ctx, const char *device_id,
+                              const device_status_data_t *status, bool keyframe,
+                              uint8_t *out, size_t size, size_t *out_len)
+{
+    if (ctx == NULL || device_id == NULL || status == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    keyframe = keyframe || !ctx->has_base;
+    size_t id_len = strnlen(device_id, 255);
+    size_t pos = 0;
+
+    if (size < 3 + id_len) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t flags = keyframe ? FLAG_KEYFRAME : 0;
+    if (status->sbus_connected) flags |= FLAG_SBUS_CONNECTED;
+    if (status->can_connected) flags |= FLAG_CAN_CONNECTED;
+    if (status->wifi_connected) flags |= FLAG_WIFI_CONNECTED;
+
+    out[pos++] = STATUS_CODEC_VERSION;
+    out[pos++] = flags;
+    out[pos++] = (uint8_t)id_len;
+    memcpy(out + pos, device_id, id_len);
+    pos += id_len;
+
+    uint32_t seq = ctx->next_seq;
+    bool ok = put_varint(out, size, &pos, seq);
+    if (!keyframe) {
+        ok = ok && put_varint(out, size, &pos, ctx->base_seq);
+    }
+
+    // 计算差值与变化掩码（关键帧以全零为基准）
+    int64_t diffs[STATUS_CODEC_FIELD_COUNT];
+    uint32_t mask = 0;
+    for (int i = 0; i < STATUS_CODEC_FIELD_COUNT; i++) {
+        int64_t base = keyframe ? 0 : field_value(&ctx->base, i);
+        diffs[i] = field_value(status, i) - base;
+        if (diffs[i] != 0) {
+            mask |= 1UL << i;
+        }
+    }
+
+    ok = ok && put_varint(out, size, &pos, mask);
+    for (int i = 0; i < STATUS_CODEC_FIELD_COUNT && ok; i++) {
+        if (mask & (1UL << i)) {
+            ok = put_varint(out, size, &pos, zigzag(diffs[i]));
+        }
+    }
+    if (!ok) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ctx->next_seq++;
+    ctx->has_pending = true;
+    ctx->pending_seq = seq;
+    ctx->pending_keyframe = keyframe;
+    ctx->pending = *status;
+
+    if (out_len != NULL) {
+        *out_len = pos;
+    }
+    return ESP_OK;
+}
+
+void status_codec_ack(status_codec_ctx_t *ctx)
+{
+    if (!ctx->has_pending) {
+        return;
+    }
+    ctx->has_base = true;
+    ctx->base_seq = ctx->pending_seq;
+    ctx->base = ctx->pending;
+    ctx->has_pending = false;
+}
+
+void status_codec_reset(status_codec_ctx_t *ctx)
+{
+    ctx->has_base = false;
+    ctx->has_pending = false;
+}
+
+bool status_codec_last_was_keyframe(const status_codec_ctx_t *ctx)
+{
+    return ctx->pending_keyframe;
+}
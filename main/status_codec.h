@@ -0,0 +1,84 @@
+#ifndef STATUS_CODEC_H
+#define STATUS_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cloud_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 设备状态紧凑二进制编码（ESB1）
+ *
+ * 报文布局：
+ *   [0]     版本号 STATUS_CODEC_VERSION
+ *   [1]     标志：bit0 关键帧，bit1 sbus_connected，bit2 can_connected，bit3 wifi_connected
+ *   [2]     设备ID长度 N，随后 N 字节设备ID
+ *   varint  帧序号
+ *   varint  基准帧序号（仅增量帧）
+ *   varint  字段变化掩码（bit i 对应字段 i）
+ *   zigzag varint × 掩码置位数：字段值相对基准的差值
+ *
+ * 关键帧以全零为基准，增量帧以服务器最近确认的帧为基准；未变化的字段不占字节。
+ * 字段顺序见 status_codec.c 中的字段表，云端解码器（cloud_server/utils/status-codec.js）须保持一致。
+ */
+
+#define STATUS_CODEC_VERSION            1
+#define STATUS_CODEC_CONTENT_TYPE       "application/x-esp32-status"
+#define STATUS_CODEC_ENCODING_NAME      "esb1"      // 服务器在 X-Status-Encodings 响应头中声明支持
+#define STATUS_CODEC_FIELD_COUNT        28
+#define STATUS_CODEC_MAX_SIZE           (3 + 64 + 5 + 5 + 5 + STATUS_CODEC_FIELD_COUNT * 10)
+
+/**
+ * 编码上下文（保存增量基准）
+ */
+typedef struct {
+    bool has_base;                  // 服务器已确认过基准帧
+    uint32_t base_seq;
+    device_status_data_t base;
+    bool has_pending;               // 已发送待确认的帧
+    uint32_t pending_seq;
+    bool pending_keyframe;
+    device_status_data_t pending;
+    uint32_t next_seq;
+} status_codec_ctx_t;
+
+/**
+ * 初始化编码上下文（下一帧为关键帧）
+ */
+void status_codec_init(status_codec_ctx_t *ctx);
+
+/**
+ * 编码一帧状态
+ * @param keyframe true=强制关键帧；没有已确认基准时总是编码关键帧
+ * @param out_len 输出报文长度
+ * @return ESP_OK，缓冲区不足返回 ESP_ERR_NO_MEM
+ */
+esp_err_t status_codec_encode(status_codec_ctx_t *ctx, const char *device_id,
+                              const device_status_data_t *status, bool keyframe,
+                              uint8_t *out, size_t size, size_t *out_len);
+
+/**
+ * 服务器确认最近一帧，将其作为后续增量帧的基准
+ */
+void status_codec_ack(status_codec_ctx_t *ctx);
+
+/**
+ * 丢弃基准（发送失败或服务器缺少基准时调用，下一帧为关键帧）
+ */
+void status_codec_reset(status_codec_ctx_t *ctx);
+
+/**
+ * 最近编码的帧是否为关键帧
+ */
+bool status_codec_last_was_keyframe(const status_codec_ctx_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATUS_CODEC_H */
@@ -1,26 +1,84 @@
 #include "supabase_integration.h"
+#include "main.h"
 #include "cloud_client.h"
 #include "wifi_manager.h"
+#include "device_state.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
 #include <string.h>
 
 static const char *TAG = "SUPABASE_INTEGRATION";
 
+#if ENABLE_SUPABASE_INTEGRATION
+
+// 上传请求类型
+typedef enum {
+    UPLOAD_REQ_STATUS = 0,
+    UPLOAD_REQ_HEARTBEAT,
+    UPLOAD_REQ_COUNT
+} upload_request_t;
+
 // 全局变量
 static bool s_integration_running = false;
 static TimerHandle_t s_status_timer = NULL;
 static TimerHandle_t s_heartbeat_timer = NULL;
 static device_status_data_t s_current_status = {0};
 
+// 上传工作任务
+static QueueHandle_t s_upload_queue = NULL;
+static TaskHandle_t s_upload_task_handle = NULL;
+static bool s_request_pending[UPLOAD_REQ_COUNT] = {0};
+static supabase_upload_stats_t s_upload_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;   // 定时器服务任务、工作任务写，HTTP任务读
+
+#if SUPABASE_TIMER_PROBE_MS > 0
+static TimerHandle_t s_probe_timer = NULL;
+static int64_t s_probe_last_us = 0;
+#endif
+
 // 外部数据获取函数指针
 static get_sbus_data_func_t s_get_sbus_data = NULL;
 static get_motor_data_func_t s_get_motor_data = NULL;
 static get_can_data_func_t s_get_can_data = NULL;
 
+/**
+ * 投递上传请求（在定时器服务任务中调用，不阻塞）
+ * 同类请求尚未被处理时直接合并，避免网络缓慢时请求堆积
+ */
+static void post_upload_request(upload_request_t request)
+{
+    int64_t start_us = esp_timer_get_time();
+    bool coalesced = false;
+    bool posted = false;
+
+    if (__atomic_exchange_n(&s_request_pending[request], true, __ATOMIC_ACQ_REL)) {
+        coalesced = true;
+    } else if (xQueueSend(s_upload_queue, &request, 0) == pdPASS) {
+        posted = true;
+    } else {
+        __atomic_store_n(&s_request_pending[request], false, __ATOMIC_RELEASE);
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    taskENTER_CRITICAL(&s_stats_lock);
+    if (coalesced) {
+        s_upload_stats.coalesced++;
+    } else if (posted) {
+        s_upload_stats.posted++;
+    } else {
+        s_upload_stats.dropped++;
+    }
+    if (elapsed_us > s_upload_stats.callback_max_us) {
+        s_upload_stats.callback_max_us = elapsed_us;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
 /**
  * 状态定时器回调函数
  */
@@ -30,6 +88,48 @@ static void status_timer_callback(TimerHandle_t xTimer)
         return;
     }
     
+    post_upload_request(UPLOAD_REQ_STATUS);
+}
+
+/**
+ * 心跳定时器回调函数
+ */
+static void heartbeat_timer_callback(TimerHandle_t xTimer)
+{
+    if (!s_integration_running) {
+        return;
+    }
+    
+    post_upload_request(UPLOAD_REQ_HEARTBEAT);
+}
+
+#if SUPABASE_TIMER_PROBE_MS > 0
+/**
+ * 定时器服务延迟探针：记录实际触发间隔超出周期的部分
+ * 任何回调阻塞定时器服务任务都会体现为延迟
+ */
+static void probe_timer_callback(TimerHandle_t xTimer)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (s_probe_last_us > 0) {
+        int64_t lateness_us = (now_us - s_probe_last_us) - (int64_t)SUPABASE_TIMER_PROBE_MS * 1000;
+        uint32_t lateness = lateness_us > 0 ? (uint32_t)lateness_us : 0;
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_upload_stats.timer_lateness_last_us = lateness;
+        if (lateness > s_upload_stats.timer_lateness_max_us) {
+            s_upload_stats.timer_lateness_max_us = lateness;
+        }
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+    s_probe_last_us = now_us;
+}
+#endif
+
+/**
+ * 上报设备状态（工作任务中执行）
+ */
+static esp_err_t upload_status(void)
+{
     // 收集设备状态数据
     collect_device_status(&s_current_status);
     
@@ -45,34 +145,62 @@ static void status_timer_callback(TimerHandle_t xTimer)
             cloud_client_reconnect();
         }
     }
+    return ret;
 }
 
 /**
- * 心跳定时器回调函数
+ * 发送心跳包（工作任务中执行）
  */
-static void heartbeat_timer_callback(TimerHandle_t xTimer)
+static esp_err_t upload_heartbeat(void)
 {
-    if (!s_integration_running) {
-        return;
+    // 状态上报已在排队时心跳多余
+    if (__atomic_load_n(&s_request_pending[UPLOAD_REQ_STATUS], __ATOMIC_ACQUIRE)) {
+        return ESP_OK;
+    }
+
+    // 发送心跳包（取自共享状态快照）
+    device_status_data_t heartbeat;
+    esp_err_t ret = collect_device_status(&heartbeat);
+    if (ret != ESP_OK) {
+        return ret;
     }
     
-    // 发送简单的心跳包
-    device_status_data_t heartbeat = {0};
-    heartbeat.wifi_connected = wifi_manager_is_connected();
-    heartbeat.uptime_seconds = esp_timer_get_time() / 1000000;
-    heartbeat.free_heap = esp_get_free_heap_size();
-    heartbeat.timestamp = heartbeat.uptime_seconds;
-    
-    if (heartbeat.wifi_connected) {
-        strcpy(heartbeat.wifi_ip, wifi_manager_get_ip_address() ?: "0.0.0.0");
-        
-        wifi_status_t wifi_status;
-        if (wifi_manager_get_status(&wifi_status) == ESP_OK) {
-            heartbeat.wifi_rssi = wifi_status.rssi;
+    return cloud_client_send_device_status(&heartbeat);
+}
+
+/**
+ * 上传工作任务：串行执行定时器投递的网络请求
+ */
+static void upload_task(void *pvParameters)
+{
+    upload_request_t request;
+
+    while (1) {
+        if (xQueueReceive(s_upload_queue, &request, portMAX_DELAY) != pdPASS) {
+            continue;
         }
+        // 先清除挂起标记：处理期间到来的新请求会重新入队
+        __atomic_store_n(&s_request_pending[request], false, __ATOMIC_RELEASE);
+
+        if (!s_integration_running) {
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t ret = (request == UPLOAD_REQ_STATUS) ? upload_status() : upload_heartbeat();
+        uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_upload_stats.uploads++;
+        if (ret != ESP_OK) {
+            s_upload_stats.upload_failures++;
+        }
+        s_upload_stats.upload_last_ms = elapsed_ms;
+        if (elapsed_ms > s_upload_stats.upload_max_ms) {
+            s_upload_stats.upload_max_ms = elapsed_ms;
+        }
+        taskEXIT_CRITICAL(&s_stats_lock);
     }
-    
-    cloud_client_send_device_status(&heartbeat);
 }
 
 /**
@@ -84,6 +212,12 @@ esp_err_t collect_device_status(device_status_data_t* status)
         return ESP_ERR_INVALID_ARG;
     }
     
+    // 优先读取 device_state 发布的共享快照，避免重复采集
+    if (device_state_get_status(status) == ESP_OK) {
+        return ESP_OK;
+    }
+    
+    // 快照发布任务未运行时退回本模块的回调采集
     memset(status, 0, sizeof(device_status_data_t));
     
     // 基础系统信息
@@ -109,7 +243,7 @@ esp_err_t collect_device_status(device_status_data_t* status)
     
     // SBUS数据
     if (s_get_sbus_data) {
-        sbus_data_t sbus_data;
+        supabase_sbus_data_t sbus_data;
         if (s_get_sbus_data(&sbus_data) == ESP_OK) {
             status->sbus_connected = true;
             for (int i = 0; i < 16 && i < sizeof(sbus_data.channels)/sizeof(sbus_data.channels[0]); i++) {
@@ -121,7 +255,7 @@ esp_err_t collect_device_status(device_status_data_t* status)
     
     // 电机数据
     if (s_get_motor_data) {
-        motor_data_t motor_data;
+        supabase_motor_data_t motor_data;
         if (s_get_motor_data(&motor_data) == ESP_OK) {
             status->motor_left_speed = motor_data.left_speed;
             status->motor_right_speed = motor_data.right_speed;
@@ -131,7 +265,7 @@ esp_err_t collect_device_status(device_status_data_t* status)
     
     // CAN数据
     if (s_get_can_data) {
-        can_data_t can_data;
+        supabase_can_data_t can_data;
         if (s_get_can_data(&can_data) == ESP_OK) {
             status->can_connected = can_data.connected;
             status->can_tx_count = can_data.tx_count;
@@ -153,11 +287,21 @@ esp_err_t supabase_integration_init(void)
 {
     ESP_LOGI(TAG, "🚀 初始化Supabase集成...");
     
-    // 初始化云客户端
-    esp_err_t ret = cloud_client_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "❌ 云客户端初始化失败");
-        return ret;
+    // 创建上传请求队列与工作任务（网络I/O不在定时器服务任务中执行）
+    if (!s_upload_queue) {
+        s_upload_queue = xQueueCreate(SUPABASE_UPLOAD_QUEUE_LEN, sizeof(upload_request_t));
+        if (!s_upload_queue) {
+            ESP_LOGE(TAG, "❌ 创建上传请求队列失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (!s_upload_task_handle) {
+        if (xTaskCreate(upload_task, "supabase_upload", SUPABASE_UPLOAD_TASK_STACK, NULL,
+                        SUPABASE_UPLOAD_TASK_PRIORITY, &s_upload_task_handle) != pdPASS) {
+            ESP_LOGE(TAG, "❌ 创建上传工作任务失败");
+            s_upload_task_handle = NULL;
+            return ESP_ERR_NO_MEM;
+        }
     }
     
     // 创建状态上报定时器（30秒间隔）
@@ -177,7 +321,7 @@ esp_err_t supabase_integration_init(void)
     // 创建心跳定时器（5分钟间隔）
     s_heartbeat_timer = xTimerCreate(
         "heartbeat_timer",
-        pdMS_TO_TICKS(300000),  // 5分钟
+        pdMS_TO_TICKS(SUPABASE_HEARTBEAT_INTERVAL_MS),
         pdTRUE,  // 自动重载
         NULL,
         heartbeat_timer_callback
@@ -188,6 +332,20 @@ esp_err_t supabase_integration_init(void)
         return ESP_FAIL;
     }
     
+#if SUPABASE_TIMER_PROBE_MS > 0
+    // 定时器服务延迟探针
+    s_probe_timer = xTimerCreate(
+        "timer_probe",
+        pdMS_TO_TICKS(SUPABASE_TIMER_PROBE_MS),
+        pdTRUE,  // 自动重载
+        NULL,
+        probe_timer_callback
+    );
+    if (!s_probe_timer) {
+        ESP_LOGW(TAG, "⚠️ 创建定时器延迟探针失败，跳过延迟统计");
+    }
+#endif
+    
     ESP_LOGI(TAG, "✅ Supabase集成初始化完成");
     return ESP_OK;
 }
@@ -204,13 +362,6 @@ esp_err_t supabase_integration_start(void)
     
     ESP_LOGI(TAG, "🚀 启动Supabase集成...");
     
-    // 启动云客户端
-    esp_err_t ret = cloud_client_start();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "❌ 启动云客户端失败");
-        return ret;
-    }
-    
     // 启动定时器
     if (xTimerStart(s_status_timer, pdMS_TO_TICKS(1000)) != pdPASS) {
         ESP_LOGE(TAG, "❌ 启动状态定时器失败");
@@ -222,6 +373,13 @@ esp_err_t supabase_integration_start(void)
         return ESP_FAIL;
     }
     
+#if SUPABASE_TIMER_PROBE_MS > 0
+    if (s_probe_timer) {
+        s_probe_last_us = 0;
+        xTimerStart(s_probe_timer, pdMS_TO_TICKS(1000));
+    }
+#endif
+    
     s_integration_running = true;
     ESP_LOGI(TAG, "✅ Supabase集成启动成功");
     
@@ -250,8 +408,11 @@ esp_err_t supabase_integration_stop(void)
         xTimerStop(s_heartbeat_timer, pdMS_TO_TICKS(1000));
     }
     
-    // 停止云客户端
-    cloud_client_stop();
+#if SUPABASE_TIMER_PROBE_MS > 0
+    if (s_probe_timer) {
+        xTimerStop(s_probe_timer, pdMS_TO_TICKS(1000));
+    }
+#endif
     
     ESP_LOGI(TAG, "✅ Supabase集成已停止");
     return ESP_OK;
@@ -285,6 +446,18 @@ esp_err_t supabase_integration_send_status_now(void)
     return cloud_client_send_device_status(&s_current_status);
 }
 
+/**
+ * 获取上传与定时器服务延迟统计
+ */
+void supabase_integration_get_upload_stats(supabase_upload_stats_t* stats)
+{
+    if (stats) {
+        taskENTER_CRITICAL(&s_stats_lock);
+        *stats = s_upload_stats;
+        taskEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
 /**
  * 获取集成状态
  */
@@ -300,3 +473,5 @@ const device_status_data_t* supabase_integration_get_last_status(void)
 {
     return &s_current_status;
 }
+
+#endif /* ENABLE_SUPABASE_INTEGRATION */
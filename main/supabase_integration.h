@@ -9,20 +9,41 @@
 extern "C" {
 #endif
 
+// 上传工作任务配置（定时器回调只投递请求，网络I/O在工作任务中执行）
+#define SUPABASE_UPLOAD_QUEUE_LEN       4       // 上传请求队列长度（同类请求未处理前只保留一个）
+#define SUPABASE_UPLOAD_TASK_STACK      6144
+#define SUPABASE_UPLOAD_TASK_PRIORITY   5
+#define SUPABASE_HEARTBEAT_INTERVAL_MS  300000  // 心跳间隔（5分钟）
+#define SUPABASE_TIMER_PROBE_MS         100     // 定时器服务延迟探针周期（0=关闭）
+
+// 上传与定时器服务延迟统计
+typedef struct {
+    uint32_t posted;                // 已投递的上传请求
+    uint32_t coalesced;             // 同类请求尚未处理而被合并的次数
+    uint32_t dropped;               // 队列已满而丢弃的次数
+    uint32_t uploads;               // 工作任务完成的上传次数
+    uint32_t upload_failures;
+    uint32_t upload_last_ms;
+    uint32_t upload_max_ms;
+    uint32_t callback_max_us;       // 上报定时器回调最长耗时（占用定时器服务任务的时间）
+    uint32_t timer_lateness_last_us; // 探针定时器实际触发相对预期的延迟
+    uint32_t timer_lateness_max_us;
+} supabase_upload_stats_t;
+
 // SBUS数据结构
 typedef struct {
     uint16_t channels[16];
     bool failsafe;
     bool frame_lost;
     uint32_t timestamp;
-} sbus_data_t;
+} supabase_sbus_data_t;
 
 // 电机数据结构
 typedef struct {
     int left_speed;
     int right_speed;
     uint32_t timestamp;
-} motor_data_t;
+} supabase_motor_data_t;
 
 // CAN数据结构
 typedef struct {
@@ -31,21 +52,21 @@ typedef struct {
     uint32_t rx_count;
     uint32_t error_count;
     uint32_t timestamp;
-} can_data_t;
+} supabase_can_data_t;
 
 // 数据获取回调函数类型定义
-typedef esp_err_t (*get_sbus_data_func_t)(sbus_data_t* data);
-typedef esp_err_t (*get_motor_data_func_t)(motor_data_t* data);
-typedef esp_err_t (*get_can_data_func_t)(can_data_t* data);
+typedef esp_err_t (*get_sbus_data_func_t)(supabase_sbus_data_t* data);
+typedef esp_err_t (*get_motor_data_func_t)(supabase_motor_data_t* data);
+typedef esp_err_t (*get_can_data_func_t)(supabase_can_data_t* data);
 
 /**
- * 初始化Supabase集成
+ * 初始化Supabase集成（须在 cloud_client_init 之后调用，云客户端的生命周期由调用方管理）
  * @return ESP_OK=成功
  */
 esp_err_t supabase_integration_init(void);
 
 /**
- * 启动Supabase集成
+ * 启动Supabase集成（须在 cloud_client_start 之后调用）
  * @return ESP_OK=成功
  */
 esp_err_t supabase_integration_start(void);
@@ -80,6 +101,12 @@ esp_err_t collect_device_status(device_status_data_t* status);
  */
 esp_err_t supabase_integration_send_status_now(void);
 
+/**
+ * 获取上传与定时器服务延迟统计
+ * @param stats 输出统计
+ */
+void supabase_integration_get_upload_stats(supabase_upload_stats_t* stats);
+
 /**
  * 获取集成状态
  * @return true=运行中，false=已停止
@@ -0,0 +1,503 @@
+#include "telemetry_store.h"
+
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_crc.h"
+#include "esp_log.h"
+#include "esp_spiffs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+static const char *TAG = "TLM_STORE";
+
+#define TELEMETRY_RECORD_MAGIC      0x4C54U     // "TL"
+#define TELEMETRY_NVS_NAMESPACE     "telemetry"
+#define TELEMETRY_NVS_CURSOR_KEY    "cursor"
+#define TELEMETRY_SEGMENT_PREFIX    "tlm"
+#define TELEMETRY_PATH_MAX          40
+#define TELEMETRY_EVICT_LOG_MS      60000       // 淘汰告警日志最小间隔
+
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint16_t len;
+    uint32_t seq;
+    uint32_t crc;                               // CRC32(seq + 负载)
+} telemetry_record_header_t;
+
+static bool s_mounted = false;
+static SemaphoreHandle_t s_lock = NULL;
+static uint32_t s_first_segment = 1;            // 现存最旧分段
+static uint32_t s_write_segment = 1;            // 当前写入分段
+static uint32_t s_write_records = 0;            // 当前写入分段的记录数
+static uint32_t s_next_seq = 0;
+static telemetry_cursor_t s_read_cursor = {1, 0};
+static telemetry_store_stats_t s_stats = {0};
+
+static void segment_path(uint32_t segment, char *path, size_t size)
+{
+    snprintf(path, size, TELEMETRY_STORE_BASE_PATH "/" TELEMETRY_SEGMENT_PREFIX "%06" PRIu32 ".bin", segment);
+}
+
+static uint32_t segment_size(uint32_t segment)
+{
+    char path[TELEMETRY_PATH_MAX];
+    struct stat st;
+    segment_path(segment, path, sizeof(path));
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    return (uint32_t)st.st_size;
+}
+
+static uint32_t record_crc(uint32_t seq, const void *payload, uint16_t len)
+{
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)&seq, sizeof(seq));
+    return esp_crc32_le(crc, (const uint8_t *)payload, len);
+}
+
+/**
+ * 读取并校验一条记录
+ * @param payload 输出缓冲区（至少 TELEMETRY_STORE_MAX_PAYLOAD）
+ * @return ESP_OK / ESP_ERR_NOT_FOUND（到达文件末尾）/ ESP_ERR_INVALID_CRC（残缺或损坏）
+ */
+static esp_err_t read_record(FILE *f, telemetry_record_header_t *hdr, uint8_t *payload)
+{
+    size_t n = fread(hdr, 1, sizeof(*hdr), f);
+    if (n == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (n != sizeof(*hdr) || hdr->magic != TELEMETRY_RECORD_MAGIC ||
+        hdr->len == 0 || hdr->len > TELEMETRY_STORE_MAX_PAYLOAD) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (fread(payload, 1, hdr->len, f) != hdr->len ||
+        record_crc(hdr->seq, payload, hdr->len) != hdr->crc) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+/**
+ * 扫描分段：从 offset 起统计有效记录数
+ * @param end_offset 输出最后一条有效记录之后的偏移
+ * @param torn 输出是否遇到残缺/损坏记录
+ * @param last_seq 输出最后一条有效记录序号，可为 NULL
+ */
+static uint32_t scan_segment(uint32_t segment, uint32_t offset, uint32_t *end_offset,
+                             bool *torn, uint32_t *last_seq)
+{
+    static uint8_t payload[TELEMETRY_STORE_MAX_PAYLOAD];   // 调用方持有 s_lock 或处于初始化阶段
+    char path[TELEMETRY_PATH_MAX];
+    uint32_t count = 0;
+
+    *end_offset = offset;
+    *torn = false;
+
+    segment_path(segment, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return 0;
+    }
+    if (fseek(f, offset, SEEK_SET) == 0) {
+        telemetry_record_header_t hdr;
+        esp_err_t ret;
+        while ((ret = read_record(f, &hdr, payload)) == ESP_OK) {
+            count++;
+            *end_offset += sizeof(hdr) + hdr.len;
+            if (last_seq != NULL) {
+                *last_seq = hdr.seq;
+            }
+        }
+        *torn = (ret == ESP_ERR_INVALID_CRC);
+    }
+    fclose(f);
+    return count;
+}
+
+static void save_cursor(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(TELEMETRY_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    nvs_set_blob(nvs, TELEMETRY_NVS_CURSOR_KEY, &s_read_cursor, sizeof(s_read_cursor));
+    nvs_commit(nvs);
+    nvs_close(nvs);
+}
+
+static bool load_cursor(telemetry_cursor_t *cursor)
+{
+    nvs_handle_t nvs;
+    size_t size = sizeof(*cursor);
+    if (nvs_open(TELEMETRY_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(nvs, TELEMETRY_NVS_CURSOR_KEY, cursor, &size);
+    nvs_close(nvs);
+    return ret == ESP_OK && size == sizeof(*cursor);
+}
+
+/**
+ * 删除最旧分段；其中未上传的记录计入淘汰数
+ * 调用方须持有 s_lock，且 s_first_segment < s_write_segment
+ */
+static void evict_oldest_segment(void)
+{
+    static uint32_t last_log_time = 0;
+    uint32_t segment = s_first_segment;
+    uint32_t lost = 0;
+
+    if (s_read_cursor.segment <= segment) {
+        uint32_t end_offset;
+        bool torn;
+        lost = scan_segment(segment, s_read_cursor.offset, &end_offset, &torn, NULL);
+        s_read_cursor.segment = segment + 1;
+        s_read_cursor.offset = 0;
+        save_cursor();
+    }
+
+    char path[TELEMETRY_PATH_MAX];
+    uint32_t size = segment_size(segment);
+    segment_path(segment, path, sizeof(path));
+    unlink(path);
+
+    s_first_segment++;
+    s_stats.segments--;
+    s_stats.bytes_used = s_stats.bytes_used > size ? s_stats.bytes_used - size : 0;
+    s_stats.evicted += lost;
+    s_stats.pending_records = s_stats.pending_records > lost ? s_stats.pending_records - lost : 0;
+
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (lost > 0 && now - last_log_time >= TELEMETRY_EVICT_LOG_MS) {
+        ESP_LOGW(TAG, "⚠️ Store full, evicted segment %" PRIu32 " (%" PRIu32 " unsent records, %" PRIu32 " total)",
+                 segment, lost, s_stats.evicted);
+        last_log_time = now;
+    }
+}
+
+/**
+ * 删除游标之前已读完的分段
+ * 调用方须持有 s_lock
+ */
+static void delete_consumed_segments(void)
+{
+    while (s_first_segment < s_read_cursor.segment && s_first_segment < s_write_segment) {
+        char path[TELEMETRY_PATH_MAX];
+        uint32_t size = segment_size(s_first_segment);
+        segment_path(s_first_segment, path, sizeof(path));
+        unlink(path);
+        s_first_segment++;
+        s_stats.segments--;
+        s_stats.bytes_used = s_stats.bytes_used > size ? s_stats.bytes_used - size : 0;
+    }
+}
+
+esp_err_t telemetry_store_init(void)
+{
+    if (s_mounted) {
+        return ESP_OK;
+    }
+
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        if (s_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = TELEMETRY_STORE_BASE_PATH,
+        .partition_label = TELEMETRY_STORE_PARTITION_LABEL,
+        .max_files = 4,
+        .format_if_mount_failed = true,
+    };
+    ESP_LOGI(TAG, "🔧 Mounting SPIFFS partition '%s'...", TELEMETRY_STORE_PARTITION_LABEL);
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ SPIFFS mount failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 找出现存分段范围
+    uint32_t min_segment = UINT32_MAX;
+    uint32_t max_segment = 0;
+    uint32_t segments = 0;
+    uint32_t bytes_used = 0;
+    DIR *dir = opendir(TELEMETRY_STORE_BASE_PATH);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            uint32_t segment;
+            if (sscanf(entry->d_name, TELEMETRY_SEGMENT_PREFIX "%" SCNu32 ".bin", &segment) != 1 || segment == 0) {
+                continue;
+            }
+            segments++;
+            bytes_used += segment_size(segment);
+            if (segment < min_segment) {
+                min_segment = segment;
+            }
+            if (segment > max_segment) {
+                max_segment = segment;
+            }
+        }
+        closedir(dir);
+    }
+
+    if (segments == 0) {
+        s_first_segment = 1;
+        s_write_segment = 1;
+        s_write_records = 0;
+    } else {
+        s_first_segment = min_segment;
+        s_write_segment = max_segment;
+
+        // 恢复写入分段；末尾有残缺记录（掉电）时封存该分段，从下一分段继续写
+        uint32_t end_offset;
+        bool torn;
+        s_write_records = scan_segment(max_segment, 0, &end_offset, &torn, &s_next_seq);
+        s_next_seq++;
+        if (torn) {
+            ESP_LOGW(TAG, "⚠️ Torn record at segment %" PRIu32 " offset %" PRIu32 ", sealing segment",
+                     max_segment, end_offset);
+            s_write_segment = max_segment + 1;
+            s_write_records = 0;
+        }
+    }
+
+    s_stats.segments = segments;
+    s_stats.bytes_used = bytes_used;
+
+    // 恢复上传游标
+    telemetry_cursor_t cursor;
+    if (!load_cursor(&cursor) || cursor.segment < s_first_segment || cursor.segment > s_write_segment) {
+        cursor.segment = s_first_segment;
+        cursor.offset = 0;
+    }
+    s_read_cursor = cursor;
+
+    // 统计待上传记录
+    uint32_t pending = 0;
+    for (uint32_t segment = s_read_cursor.segment; segments > 0 && segment <= max_segment; segment++) {
+        uint32_t end_offset;
+        bool torn;
+        uint32_t offset = (segment == s_read_cursor.segment) ? s_read_cursor.offset : 0;
+        pending += scan_segment(segment, offset, &end_offset, &torn, NULL);
+    }
+    s_stats.pending_records = pending;
+
+    size_t total = 0;
+    size_t used = 0;
+    esp_spiffs_info(TELEMETRY_STORE_PARTITION_LABEL, &total, &used);
+
+    s_mounted = true;
+    s_stats.mounted = true;
+    ESP_LOGI(TAG, "✅ Telemetry store ready: %" PRIu32 " segments, %" PRIu32 " pending records, SPIFFS %u/%u KB",
+             segments, pending, (unsigned)(used / 1024), (unsigned)(total / 1024));
+    return ESP_OK;
+}
+
+bool telemetry_store_is_ready(void)
+{
+    return s_mounted;
+}
+
+esp_err_t telemetry_store_append(const void *record, uint16_t size)
+{
+    if (record == NULL || size == 0 || size > TELEMETRY_STORE_MAX_PAYLOAD) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (s_write_records >= TELEMETRY_STORE_SEGMENT_RECORDS) {
+        s_write_segment++;
+        s_write_records = 0;
+    }
+
+    uint32_t record_bytes = sizeof(telemetry_record_header_t) + size;
+    while (s_stats.bytes_used + record_bytes > TELEMETRY_STORE_MAX_BYTES &&
+           s_first_segment < s_write_segment) {
+        evict_oldest_segment();
+    }
+
+    telemetry_record_header_t hdr = {
+        .magic = TELEMETRY_RECORD_MAGIC,
+        .len = size,
+        .seq = s_next_seq,
+        .crc = record_crc(s_next_seq, record, size),
+    };
+
+    esp_err_t ret = ESP_FAIL;
+    for (int attempt = 0; attempt < 2 && ret != ESP_OK; attempt++) {
+        char path[TELEMETRY_PATH_MAX];
+        segment_path(s_write_segment, path, sizeof(path));
+        bool new_segment = (s_write_records == 0 && segment_size(s_write_segment) == 0);
+
+        FILE *f = fopen(path, "ab");
+        if (f != NULL) {
+            bool ok = fwrite(&hdr, 1, sizeof(hdr), f) == sizeof(hdr) &&
+                      fwrite(record, 1, size, f) == size;
+            ok = (fclose(f) == 0) && ok;
+            if (ok) {
+                if (new_segment) {
+                    s_stats.segments++;
+                }
+                ret = ESP_OK;
+                break;
+            }
+        }
+
+        // 写入失败（通常是分区已满）：当前分段可能留下残缺记录，封存后淘汰最旧分段重试
+        s_stats.write_errors++;
+        if (s_write_records > 0 || segment_size(s_write_segment) > 0) {
+            if (segment_size(s_write_segment) > 0 && s_write_records == 0) {
+                s_stats.segments++;
+            }
+            s_write_segment++;
+            s_write_records = 0;
+        }
+        if (s_first_segment < s_write_segment) {
+            evict_oldest_segment();
+        } else {
+            break;
+        }
+    }
+
+    if (ret == ESP_OK) {
+        s_next_seq++;
+        s_write_records++;
+        s_stats.appended++;
+        s_stats.pending_records++;
+        s_stats.bytes_used += record_bytes;
+    } else {
+        ESP_LOGE(TAG, "❌ Failed to append telemetry record");
+    }
+
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+int telemetry_store_peek(void *records, uint16_t record_size, int max_records, telemetry_cursor_t *next)
+{
+    static uint8_t payload[TELEMETRY_STORE_MAX_PAYLOAD];
+
+    if (records == NULL || next == NULL || max_records <= 0 || !s_mounted) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    telemetry_cursor_t cursor = s_read_cursor;
+    int count = 0;
+    bool at_end = false;
+
+    while (count < max_records && !at_end) {
+        char path[TELEMETRY_PATH_MAX];
+        segment_path(cursor.segment, path, sizeof(path));
+        FILE *f = fopen(path, "rb");
+        if (f == NULL || fseek(f, cursor.offset, SEEK_SET) != 0) {
+            if (f != NULL) {
+                fclose(f);
+            }
+            if (cursor.segment < s_write_segment) {
+                cursor.segment++;
+                cursor.offset = 0;
+            } else {
+                at_end = true;
+            }
+            continue;
+        }
+
+        bool next_segment = false;
+        while (count < max_records) {
+            telemetry_record_header_t hdr;
+            esp_err_t ret = read_record(f, &hdr, payload);
+            if (ret != ESP_OK) {
+                if (ret == ESP_ERR_INVALID_CRC) {
+                    s_stats.corrupt++;
+                }
+                // 已封存分段读到末尾或残缺处：转到下一分段
+                next_segment = (cursor.segment < s_write_segment);
+                at_end = !next_segment;
+                break;
+            }
+            cursor.offset += sizeof(hdr) + hdr.len;
+            if (hdr.len != record_size) {
+                // 旧版本固件写入的记录，格式不兼容
+                s_stats.corrupt++;
+                continue;
+            }
+            memcpy((uint8_t *)records + (size_t)count * record_size, payload, record_size);
+            count++;
+        }
+        fclose(f);
+
+        if (next_segment) {
+            cursor.segment++;
+            cursor.offset = 0;
+        }
+    }
+
+    // 已读到日志末尾，校正待上传计数
+    if (at_end) {
+        s_stats.pending_records = count;
+    }
+
+    xSemaphoreGive(s_lock);
+    *next = cursor;
+    return count;
+}
+
+esp_err_t telemetry_store_commit(const telemetry_cursor_t *next, uint32_t count)
+{
+    if (next == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 上传期间最旧分段可能已被淘汰，游标只前移
+    if (next->segment > s_read_cursor.segment ||
+        (next->segment == s_read_cursor.segment && next->offset > s_read_cursor.offset)) {
+        s_read_cursor = *next;
+        s_stats.committed += count;
+        s_stats.pending_records = s_stats.pending_records > count ? s_stats.pending_records - count : 0;
+        delete_consumed_segments();
+        save_cursor();
+    }
+
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+uint32_t telemetry_store_pending(void)
+{
+    return s_mounted ? s_stats.pending_records : 0;
+}
+
+void telemetry_store_get_stats(telemetry_store_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_lock != NULL) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+    }
+    *stats = s_stats;
+    if (s_lock != NULL) {
+        xSemaphoreGive(s_lock);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * SPIFFS 遥测存储转发队列
+ *
+ *   - 只追加的分段日志：/spiffs/tlmNNNNNN.bin，每段最多 TELEMETRY_STORE_SEGMENT_RECORDS 条记录
+ *   - 每条记录 = 头部（魔数/长度/序号/CRC32）+ 定长负载，写入后立即关闭文件落盘
+ *   - 掉电导致的残缺记录在启动时检测，所在分段封存，新记录写入下一分段
+ *   - 上传游标（分段号 + 偏移）保存在 NVS，批量上传确认后才前移
+ *   - 超出容量上限时删除最旧分段（未上传的记录计入淘汰数）
+ *
+ * 记录内容由调用方定义，存储层只负责定长二进制负载。
+ */
+
+#define TELEMETRY_STORE_BASE_PATH           "/spiffs"
+#define TELEMETRY_STORE_PARTITION_LABEL     "spiffs"
+#define TELEMETRY_STORE_SEGMENT_RECORDS     256                 // 每个分段文件的记录数
+#define TELEMETRY_STORE_MAX_BYTES           (8 * 1024 * 1024)   // 日志总容量上限（12MB 分区留出 SPIFFS 垃圾回收余量）
+#define TELEMETRY_STORE_MAX_PAYLOAD         512                 // 单条负载上限
+
+/**
+ * 读取位置
+ */
+typedef struct {
+    uint32_t segment;
+    uint32_t offset;
+} telemetry_cursor_t;
+
+/**
+ * 存储统计
+ */
+typedef struct {
+    bool mounted;
+    uint32_t pending_records;       // 尚未上传的记录数
+    uint32_t appended;              // 本次启动追加的记录数
+    uint32_t committed;             // 本次启动上传确认的记录数
+    uint32_t evicted;               // 因容量不足淘汰的未上传记录数
+    uint32_t corrupt;               // 校验失败或格式不符而跳过的记录数
+    uint32_t write_errors;
+    uint32_t bytes_used;            // 日志分段占用字节数
+    uint32_t segments;              // 现存分段数
+} telemetry_store_stats_t;
+
+/**
+ * 挂载 SPIFFS 并恢复日志状态（首次使用会格式化分区，耗时较长，应在后台任务中调用）
+ */
+esp_err_t telemetry_store_init(void);
+
+/**
+ * 是否已挂载可用
+ */
+bool telemetry_store_is_ready(void);
+
+/**
+ * 追加一条记录
+ */
+esp_err_t telemetry_store_append(const void *record, uint16_t size);
+
+/**
+ * 从上传游标处读取最多 max_records 条记录（不移动游标）
+ * @param records 输出缓冲区，按 record_size 连续存放
+ * @param next 输出读取结束位置，上传成功后传给 telemetry_store_commit
+ * @return 读取到的记录数
+ */
+int telemetry_store_peek(void *records, uint16_t record_size, int max_records, telemetry_cursor_t *next);
+
+/**
+ * 确认已上传，前移游标并删除已读完的分段
+ * @param count 本次确认的记录数（即 peek 返回值）
+ */
+esp_err_t telemetry_store_commit(const telemetry_cursor_t *next, uint32_t count);
+
+/**
+ * 待上传记录数
+ */
+uint32_t telemetry_store_pending(void);
+
+/**
+ * 获取统计快照
+ */
+void telemetry_store_get_stats(telemetry_store_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_STORE_H */
@@ -0,0 +1,417 @@
+#include "telemetry_stream.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "main.h"
+#include "can_bus_monitor.h"
+#include "device_state.h"
+#include "drv_payout.h"
+#include "motor_driver.h"
+#include "json_writer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+
+static const char *TAG = "TLM_STREAM";
+
+#define SSE_PREFIX      "data: "
+#define SSE_SUFFIX      "\n\n"
+
+static const char s_sse_headers[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 2000\n\n";
+
+/**
+ * 订阅者：发送缓冲中 [off, len) 为尚未写入套接字的数据
+ */
+typedef struct {
+    bool active;
+    bool closing;                   // 已请求 httpd 关闭会话，等待释放回调
+    int fd;
+    uint32_t interval_ms;
+    uint32_t next_due_ms;
+    uint16_t len;
+    uint16_t off;
+    uint32_t dropped;
+    char buf[TELEMETRY_STREAM_CLIENT_BUF_SIZE];
+} stream_client_t;
+
+static httpd_handle_t s_server = NULL;
+static SemaphoreHandle_t s_mutex = NULL;            // 保护订阅者（推送任务与 httpd 任务共用）
+static TaskHandle_t s_task = NULL;
+static stream_client_t s_clients[TELEMETRY_STREAM_MAX_CLIENTS];
+static char s_frame_buf[TELEMETRY_STREAM_FRAME_BUF_SIZE];
+static uint32_t s_frame_seq = 0;
+static telemetry_stream_stats_t s_stats = {0};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * 采集当前状态并序列化为一帧 SSE 数据
+ * @return 帧长度，0=失败
+ */
+static size_t build_frame(void)
+{
+    int64_t start = esp_timer_get_time();
+
+    // 设备状态快照只按 DEVICE_STATE_PUBLISH_INTERVAL_MS 发布，推送频率更高时
+    // SBUS 通道与电机速度直接读取各任务最近写入的值（单个字段的读写是原子的，
+    // 同一帧内的通道可能分属相邻两次 SBUS 帧），CAN 计数读取总线监测的累计值；
+    // state_version/state_age_ms 仍标注快照，供前端判断低频字段的新旧
+    device_state_snapshot_t snapshot;
+    bool state_ok = device_state_read(&snapshot) != 0;
+    uint32_t sbus_update = g_last_sbus_update;
+    uint32_t sbus_age = xTaskGetTickCount() - sbus_update;
+    can_bus_stats_t bus;
+    bool bus_ok = can_bus_monitor_get_stats(&bus) == ESP_OK;
+    int16_t track_speed = 0;
+    bool track_ok = motor_driver_get_track_speed(&track_speed) == ESP_OK;
+    drv_payout_status_t payout;
+    bool payout_ok = drv_payout_get_status(&payout) == ESP_OK;
+
+    // 字段名与 /api/device/status 一致，前端可直接合并
+    const size_t prefix_len = sizeof(SSE_PREFIX) - 1;
+    const size_t suffix_len = sizeof(SSE_SUFFIX) - 1;
+    json_writer_t w;
+    json_writer_init(&w, s_frame_buf + prefix_len, sizeof(s_frame_buf) - prefix_len - suffix_len);
+    json_writer_begin_object(&w, NULL);
+    json_writer_uint(&w, "seq", ++s_frame_seq);
+    json_writer_uint(&w, "uptime_ms", now_ms());
+    if (state_ok) {
+        json_writer_uint(&w, "state_version", snapshot.version);
+        json_writer_uint(&w, "state_age_ms", (uint32_t)((esp_timer_get_time() - snapshot.published_us) / 1000));
+    } else {
+        json_writer_null(&w, "state_version");
+    }
+    json_writer_bool(&w, "sbus_connected", sbus_update != 0 && sbus_age < pdMS_TO_TICKS(5000));
+    json_writer_uint(&w, "last_sbus_time", sbus_update);
+    json_writer_begin_array(&w, "sbus_channels");
+    for (int i = 0; i < 16; i++) {
+        json_writer_int(&w, NULL, g_last_sbus_channels[i]);
+    }
+    json_writer_end_array(&w);
+    json_writer_int(&w, "motor_left_speed", g_last_motor_left);
+    json_writer_int(&w, "motor_right_speed", g_last_motor_right);
+    json_writer_uint(&w, "last_cmd_time", g_last_motor_update);
+    bool driver_healthy = motor_driver_is_healthy();
+    json_writer_bool(&w, "can_connected", driver_healthy);
+    if (bus_ok) {
+        json_writer_uint(&w, "can_tx_count", bus.tx_frames_total);
+        json_writer_uint(&w, "can_rx_count", bus.rx_frames_total);
+    }
+    json_writer_bool(&w, "driver_healthy", driver_healthy);
+    if (track_ok) {
+        json_writer_int(&w, "track_speed_permille", track_speed);
+    }
+    if (bus_ok) {
+        json_writer_begin_object(&w, "can_bus");
+        json_writer_double(&w, "load_percent", bus.load_percent);
+        json_writer_uint(&w, "tx_fps", bus.tx_frames_per_sec);
+        json_writer_uint(&w, "rx_fps", bus.rx_frames_per_sec);
+        json_writer_uint(&w, "tec", bus.tx_error_counter);
+        json_writer_uint(&w, "rec", bus.rx_error_counter);
+        json_writer_uint(&w, "bus_errors", bus.bus_error_delta);
+        json_writer_end_object(&w);
+    } else {
+        json_writer_null(&w, "can_bus");
+    }
+    if (payout_ok) {
+        json_writer_begin_object(&w, "payout");
+        json_writer_bool(&w, "online", payout.online);
+        json_writer_int(&w, "target_pwm", payout.target_pwm);
+        if (payout.tension_valid) {
+            json_writer_uint(&w, "tension_raw", payout.tension_raw);
+        }
+        json_writer_begin_array(&w, "drums");
+        for (int i = 0; i < payout.drum_count && i < PAYOUT_MAX_DRUMS; i++) {
+            json_writer_begin_object(&w, NULL);
+            json_writer_bool(&w, "online", payout.drums[i].online);
+            json_writer_int(&w, "pwm", payout.drums[i].applied_pwm);
+            json_writer_int(&w, "speed", payout.drums[i].feedback_speed);
+            json_writer_uint(&w, "fault", payout.drums[i].fault_code);
+            json_writer_end_object(&w);
+        }
+        json_writer_end_array(&w);
+        json_writer_end_object(&w);
+    } else {
+        json_writer_null(&w, "payout");
+    }
+    json_writer_end_object(&w);
+
+    size_t json_len = 0;
+    if (json_writer_finish(&w, &json_len) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 遥测帧超出缓冲区 (%d字节)", TELEMETRY_STREAM_FRAME_BUF_SIZE);
+        return 0;
+    }
+    memcpy(s_frame_buf, SSE_PREFIX, prefix_len);
+    memcpy(s_frame_buf + prefix_len + json_len, SSE_SUFFIX, suffix_len);
+
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    s_stats.frames_built++;
+    s_stats.last_build_us = elapsed;
+    if (elapsed > s_stats.max_build_us) {
+        s_stats.max_build_us = elapsed;
+    }
+    return prefix_len + json_len + suffix_len;
+}
+
+/**
+ * 请求 httpd 关闭会话；订阅槽在会话释放回调中回收
+ */
+static void close_client(stream_client_t *client)
+{
+    if (client->closing) {
+        return;
+    }
+    client->closing = true;
+    client->len = client->off = 0;
+    if (s_server) {
+        httpd_sess_trigger_close(s_server, client->fd);
+    }
+}
+
+/**
+ * 非阻塞写出缓冲中的数据，套接字写满时保留剩余部分
+ */
+static void flush_client(stream_client_t *client)
+{
+    while (client->off < client->len) {
+        int sent = send(client->fd, client->buf + client->off, client->len - client->off, MSG_DONTWAIT);
+        if (sent > 0) {
+            client->off += sent;
+            s_stats.bytes_sent += sent;
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        ESP_LOGI(TAG, "📴 遥测订阅者断开 (fd=%d, errno=%d)", client->fd, errno);
+        s_stats.send_errors++;
+        close_client(client);
+        return;
+    }
+    client->len = client->off = 0;
+}
+
+/**
+ * 帧写入订阅者缓冲，放不下时丢弃
+ */
+static void queue_frame(stream_client_t *client, size_t frame_len)
+{
+    if (client->off > 0) {
+        memmove(client->buf, client->buf + client->off, client->len - client->off);
+        client->len -= client->off;
+        client->off = 0;
+    }
+    if (client->len + frame_len > sizeof(client->buf)) {
+        client->dropped++;
+        s_stats.frames_dropped++;
+        return;
+    }
+    memcpy(client->buf + client->len, s_frame_buf, frame_len);
+    client->len += frame_len;
+    s_stats.frames_queued++;
+}
+
+/**
+ * 一个推送周期：先续写积压数据，再给到期的订阅者排入本周期的帧
+ */
+static void stream_tick(void)
+{
+    uint32_t now = now_ms();
+    size_t frame_len = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < TELEMETRY_STREAM_MAX_CLIENTS; i++) {
+        stream_client_t *client = &s_clients[i];
+        if (!client->active || client->closing) {
+            continue;
+        }
+
+        flush_client(client);
+        if (client->closing || (int32_t)(now - client->next_due_ms) < 0) {
+            continue;
+        }
+
+        // 落后超过一个周期时不补发，从当前时刻重新计时
+        client->next_due_ms += client->interval_ms;
+        if ((int32_t)(now - client->next_due_ms) >= 0) {
+            client->next_due_ms = now + client->interval_ms;
+        }
+
+        if (frame_len == 0) {
+            frame_len = build_frame();
+            if (frame_len == 0) {
+                break;
+            }
+        }
+        queue_frame(client, frame_len);
+        flush_client(client);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+/**
+ * 推送任务：没有订阅者时挂起
+ */
+static void stream_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "📡 遥测推送任务已启动 (最高 %d Hz)", TELEMETRY_STREAM_MAX_HZ);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        if (__atomic_load_n(&s_stats.clients, __ATOMIC_RELAXED) == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+        }
+        stream_tick();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / TELEMETRY_STREAM_MAX_HZ));
+    }
+}
+
+/**
+ * httpd 会话释放回调（httpd 任务中调用）：回收订阅槽
+ */
+static void free_client(void *ctx)
+{
+    stream_client_t *client = (stream_client_t *)ctx;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (client->active) {
+        ESP_LOGI(TAG, "📴 遥测订阅结束 (fd=%d, 丢帧 %" PRIu32 ")", client->fd, client->dropped);
+        client->active = false;
+        client->closing = false;
+        client->len = client->off = 0;
+        s_stats.clients--;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t telemetry_stream_start(httpd_handle_t server)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_task == NULL) {
+        BaseType_t ret = xTaskCreate(stream_task, "tlm_stream", TELEMETRY_STREAM_TASK_STACK_SIZE,
+                                     NULL, TELEMETRY_STREAM_TASK_PRIORITY, &s_task);
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "❌ 创建遥测推送任务失败");
+            s_task = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_server = server;
+    return ESP_OK;
+}
+
+void telemetry_stream_stop(void)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < TELEMETRY_STREAM_MAX_CLIENTS; i++) {
+        if (s_clients[i].active) {
+            close_client(&s_clients[i]);
+        }
+    }
+    s_server = NULL;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t telemetry_stream_handler(httpd_req_t *req)
+{
+    if (s_mutex == NULL || s_server == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Stream not started");
+        return ESP_FAIL;
+    }
+
+    int hz = TELEMETRY_STREAM_DEFAULT_HZ;
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "hz", value, sizeof(value)) == ESP_OK) {
+        hz = atoi(value);
+        if (hz < 1) {
+            hz = 1;
+        } else if (hz > TELEMETRY_STREAM_MAX_HZ) {
+            hz = TELEMETRY_STREAM_MAX_HZ;
+        }
+    }
+
+    stream_client_t *client = NULL;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < TELEMETRY_STREAM_MAX_CLIENTS; i++) {
+        if (!s_clients[i].active) {
+            client = &s_clients[i];
+            break;
+        }
+    }
+    if (client == NULL) {
+        s_stats.rejected++;
+        xSemaphoreGive(s_mutex);
+        ESP_LOGW(TAG, "⚠️ 遥测订阅已满 (%d)，拒绝新订阅", TELEMETRY_STREAM_MAX_CLIENTS);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_sendstr(req, "Too many stream subscribers");
+        return ESP_OK;
+    }
+
+    // 响应头直接写入套接字，之后的帧由推送任务发送；httpd 只负责连接关闭
+    int fd = httpd_req_to_sockfd(req);
+    if (httpd_send(req, s_sse_headers, sizeof(s_sse_headers) - 1) != (int)(sizeof(s_sse_headers) - 1)) {
+        xSemaphoreGive(s_mutex);
+        return ESP_FAIL;
+    }
+
+    memset(client, 0, offsetof(stream_client_t, buf));
+    client->active = true;
+    client->fd = fd;
+    client->interval_ms = 1000 / hz;
+    client->next_due_ms = now_ms();
+    s_stats.clients++;
+    s_stats.subscribed++;
+    xSemaphoreGive(s_mutex);
+
+    req->sess_ctx = client;
+    req->free_ctx = free_client;
+
+    ESP_LOGI(TAG, "📡 新遥测订阅 (fd=%d, %d Hz, 当前 %" PRIu32 " 个)", fd, hz, s_stats.clients);
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+void telemetry_stream_get_stats(telemetry_stream_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,74 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 本地实时遥测推送（Server-Sent Events）
+ *
+ *   - GET /api/device/stream?hz=N 建立订阅，连接保持打开，按 N Hz（1~50）推送
+ *     SBUS通道、电机速度、CAN与放线设备状态，每帧一行 "data: {...}\n\n"
+ *   - SBUS/电机/CAN计数取自设备状态快照（device_state，每秒发布，帧中带 state_age_ms），
+ *     总线负载、驱动器链路与履带速度直接读取 can_bus_monitor 与电机驱动的统计
+ *   - 推送任务以最高频率运行，每个周期最多构建一帧，由到期的订阅者共享
+ *   - 每个订阅者有预分配的发送缓冲，非阻塞写套接字；客户端读得慢、缓冲放不下新帧时
+ *     丢弃该帧而不是等待，推送任务不会被任何客户端阻塞
+ *   - 客户端断开时由 httpd 会话释放回调回收订阅槽
+ */
+
+#define TELEMETRY_STREAM_MAX_CLIENTS        3       // 同时订阅上限（httpd 最多 HTTP_SERVER_MAX_OPEN_SOCKETS 个会话，其余留给普通请求）
+#define TELEMETRY_STREAM_MAX_HZ             50      // 推送任务周期 = 1000 / MAX_HZ 毫秒
+#define TELEMETRY_STREAM_DEFAULT_HZ         10
+#define TELEMETRY_STREAM_FRAME_BUF_SIZE     896     // 单帧上限（约 600 字节）
+#define TELEMETRY_STREAM_CLIENT_BUF_SIZE    2048    // 每个订阅者的发送缓冲（可积压约 3 帧）
+#define TELEMETRY_STREAM_TASK_STACK_SIZE    3072
+#define TELEMETRY_STREAM_TASK_PRIORITY      4       // 低于HTTP服务与云端任务
+
+/**
+ * 推送统计
+ */
+typedef struct {
+    uint32_t clients;               // 当前订阅数
+    uint32_t subscribed;            // 累计订阅数
+    uint32_t rejected;              // 订阅已满被拒绝的请求
+    uint32_t frames_built;
+    uint32_t frames_queued;         // 写入订阅者缓冲的帧（一帧发给多个订阅者计多次）
+    uint32_t frames_dropped;        // 订阅者缓冲已满而丢弃的帧
+    uint32_t send_errors;           // 发送失败而断开的订阅者
+    uint64_t bytes_sent;
+    uint32_t last_build_us;         // 最近一帧的采集 + 序列化耗时
+    uint32_t max_build_us;
+} telemetry_stream_stats_t;
+
+/**
+ * 绑定 HTTP 服务器并创建推送任务（httpd_start 之后调用）
+ */
+esp_err_t telemetry_stream_start(httpd_handle_t server);
+
+/**
+ * 断开全部订阅者（httpd_stop 之前调用）
+ */
+void telemetry_stream_stop(void);
+
+/**
+ * 订阅请求处理函数（注册到 API_DEVICE_STREAM）
+ */
+esp_err_t telemetry_stream_handler(httpd_req_t *req);
+
+/**
+ * 获取推送统计
+ */
+void telemetry_stream_get_stats(telemetry_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_STREAM_H */
@@ -0,0 +1,376 @@
+#include "udp_teleop.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "mbedtls/md.h"
+#include "nvs.h"
+
+static const char *TAG = "UDP_TELEOP";
+
+#define TELEOP_AUTH_LEN     16      // 参与认证的包头 + 载荷长度
+#define TELEOP_SPEED_LIMIT  100
+
+static QueueHandle_t s_cmd_queue = NULL;
+static uint8_t s_key[UDP_TELEOP_KEY_MAX_LEN];
+static size_t s_key_len = 0;
+static TaskHandle_t s_task = NULL;
+
+// 会话状态，仅在接收任务中读写；nonce 不落盘，重启后旧会话的包全部认证失败
+static bool s_session_valid = false;
+static uint32_t s_session = 0;
+static uint8_t s_nonce[UDP_TELEOP_NONCE_SIZE];
+static uint32_t s_last_seq = 0;
+static int64_t s_last_accept_us = 0;
+
+// 已下发、等待对应速度帧写入 CAN 的收包时间（0 表示没有）
+static int64_t s_pending_can_rx_us = 0;
+static uint64_t s_can_sum_us = 0;
+
+static udp_teleop_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint16_t read_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void stats_inc(uint32_t *counter)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    (*counter)++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * HMAC-SHA256(设备密钥, data) 的前 UDP_TELEOP_TAG_SIZE 字节
+ */
+static bool compute_tag(const uint8_t *data, size_t len, uint8_t *tag)
+{
+    uint8_t mac[32];
+    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+
+    if (md == NULL || mbedtls_md_hmac(md, s_key, s_key_len, data, len, mac) != 0) {
+        return false;
+    }
+    memcpy(tag, mac, UDP_TELEOP_TAG_SIZE);
+    return true;
+}
+
+/**
+ * 校验认证标签（逐字节比较全部字节，耗时与内容无关）
+ * @param nonce 非 NULL 时附加在包头 + 载荷之后参与认证
+ */
+static bool packet_tag_valid(const uint8_t *pkt, const uint8_t *nonce)
+{
+    uint8_t data[TELEOP_AUTH_LEN + UDP_TELEOP_NONCE_SIZE];
+    size_t len = TELEOP_AUTH_LEN;
+    uint8_t tag[UDP_TELEOP_TAG_SIZE];
+
+    memcpy(data, pkt, TELEOP_AUTH_LEN);
+    if (nonce != NULL) {
+        memcpy(data + TELEOP_AUTH_LEN, nonce, UDP_TELEOP_NONCE_SIZE);
+        len += UDP_TELEOP_NONCE_SIZE;
+    }
+    if (!compute_tag(data, len, tag)) {
+        return false;
+    }
+
+    uint8_t diff = 0;
+    for (int i = 0; i < UDP_TELEOP_TAG_SIZE; i++) {
+        diff |= (uint8_t)(tag[i] ^ pkt[TELEOP_AUTH_LEN + i]);
+    }
+    return diff == 0;
+}
+
+static void write_header(uint8_t *pkt, uint8_t type)
+{
+    pkt[0] = (uint8_t)(UDP_TELEOP_MAGIC & 0xFF);
+    pkt[1] = (uint8_t)(UDP_TELEOP_MAGIC >> 8);
+    pkt[2] = UDP_TELEOP_VERSION;
+    pkt[3] = type;
+}
+
+/**
+ * HELLO：链路空闲时为发送端的会话生成新 nonce（旧会话的包随之全部失效），
+ * 同一会话重发 HELLO 时回复当前 nonce
+ */
+static void handle_hello(int sock, const uint8_t *pkt, int64_t now_us, const struct sockaddr_in *from)
+{
+    uint32_t session = read_le32(pkt + 4);
+
+    if (!s_session_valid || session != s_session) {
+        int64_t last_us = __atomic_load_n(&s_last_accept_us, __ATOMIC_RELAXED);
+        if (s_session_valid && last_us != 0 &&
+            now_us - last_us < (int64_t)UDP_TELEOP_SESSION_IDLE_MS * 1000) {
+            // 遥控进行中，不让其他发送端接管
+            stats_inc(&s_stats.session_rejected);
+            return;
+        }
+
+        esp_fill_random(s_nonce, sizeof(s_nonce));
+        s_session = session;
+        s_last_seq = 0;
+        s_session_valid = true;
+        stats_inc(&s_stats.session_changes);
+        ESP_LOGI(TAG, "🎮 遥控会话 0x%08" PRIx32 " 来自 %s", session, inet_ntoa(from->sin_addr));
+    }
+
+    uint8_t reply[UDP_TELEOP_PACKET_SIZE] = {0};
+    write_header(reply, UDP_TELEOP_TYPE_CHALLENGE);
+    memcpy(reply + 4, pkt + 4, 4);
+    memcpy(reply + 8, s_nonce, UDP_TELEOP_NONCE_SIZE);
+    if (!compute_tag(reply, TELEOP_AUTH_LEN, reply + TELEOP_AUTH_LEN)) {
+        return;
+    }
+    if (sendto(sock, reply, sizeof(reply), 0, (const struct sockaddr *)from, sizeof(*from)) < 0) {
+        ESP_LOGW(TAG, "⚠️ 发送CHALLENGE失败: errno=%d", errno);
+        return;
+    }
+    stats_inc(&s_stats.challenges);
+}
+
+/**
+ * DRIVE：须属于当前会话、认证覆盖当前 nonce、seq 严格递增
+ */
+static void handle_drive(const uint8_t *pkt, int64_t now_us)
+{
+    int8_t left = (int8_t)pkt[12];
+    int8_t right = (int8_t)pkt[13];
+    if (left < -TELEOP_SPEED_LIMIT || left > TELEOP_SPEED_LIMIT ||
+        right < -TELEOP_SPEED_LIMIT || right > TELEOP_SPEED_LIMIT) {
+        stats_inc(&s_stats.bad_format);
+        return;
+    }
+
+    uint32_t session = read_le32(pkt + 4);
+    if (!s_session_valid || session != s_session) {
+        stats_inc(&s_stats.session_rejected);
+        return;
+    }
+    if (!packet_tag_valid(pkt, s_nonce)) {
+        stats_inc(&s_stats.bad_auth);
+        return;
+    }
+
+    uint32_t seq = read_le32(pkt + 8);
+    if (seq <= s_last_seq) {
+        stats_inc(&s_stats.out_of_order);
+        return;
+    }
+    s_last_seq = seq;
+    __atomic_store_n(&s_last_accept_us, now_us, __ATOMIC_RELAXED);
+
+    udp_teleop_cmd_t cmd = {
+        .speed_left = left,
+        .speed_right = right,
+        .seq = seq,
+        .rx_us = now_us,
+    };
+    bool coalesced = uxQueueMessagesWaiting(s_cmd_queue) > 0;
+    xQueueOverwrite(s_cmd_queue, &cmd);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.accepted++;
+    s_stats.session = session;
+    s_stats.last_seq = seq;
+    if (coalesced) {
+        s_stats.coalesced++;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void handle_packet(int sock, const uint8_t *pkt, int len, const struct sockaddr_in *from)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    stats_inc(&s_stats.rx_packets);
+
+    if (len != UDP_TELEOP_PACKET_SIZE ||
+        read_le16(pkt) != UDP_TELEOP_MAGIC ||
+        pkt[2] != UDP_TELEOP_VERSION) {
+        stats_inc(&s_stats.bad_format);
+        return;
+    }
+
+    switch (pkt[3]) {
+        case UDP_TELEOP_TYPE_DRIVE:
+            handle_drive(pkt, now_us);
+            break;
+        case UDP_TELEOP_TYPE_HELLO:
+            if (!packet_tag_valid(pkt, NULL)) {
+                stats_inc(&s_stats.bad_auth);
+                break;
+            }
+            handle_hello(sock, pkt, now_us, from);
+            break;
+        default:
+            stats_inc(&s_stats.bad_format);
+            break;
+    }
+}
+
+static void udp_teleop_task(void *pvParameters)
+{
+    (void)pvParameters;
+    // 预留余量，超长包按长度不符丢弃而不是被截断后误判
+    uint8_t pkt[UDP_TELEOP_PACKET_SIZE + 8];
+
+    while (1) {
+        int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "❌ 创建套接字失败: errno=%d", errno);
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(UDP_TELEOP_PORT);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            ESP_LOGE(TAG, "❌ 绑定端口 %d 失败: errno=%d", UDP_TELEOP_PORT, errno);
+            close(sock);
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+        ESP_LOGI(TAG, "🎮 UDP遥控监听端口 %d", UDP_TELEOP_PORT);
+
+        while (1) {
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            int len = recvfrom(sock, pkt, sizeof(pkt), 0, (struct sockaddr *)&from, &from_len);
+            if (len < 0) {
+                ESP_LOGW(TAG, "⚠️ 接收失败: errno=%d，重建套接字", errno);
+                break;
+            }
+            handle_packet(sock, pkt, len, &from);
+        }
+
+        close(sock);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+/**
+ * 从 NVS 读取设备密钥，长度不符或等于公开默认值时视为未配置
+ */
+static esp_err_t load_key(void)
+{
+    nvs_handle_t nvs;
+    size_t size = sizeof(s_key);
+
+    if (nvs_open(UDP_TELEOP_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = nvs_get_blob(nvs, UDP_TELEOP_NVS_KEY, s_key, &size);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    bool is_unset = size == strlen(UDP_TELEOP_UNSET_KEY) &&
+                    memcmp(s_key, UDP_TELEOP_UNSET_KEY, size) == 0;
+    if (size < UDP_TELEOP_KEY_MIN_LEN || is_unset) {
+        memset(s_key, 0, sizeof(s_key));
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_key_len = size;
+    return ESP_OK;
+}
+
+esp_err_t udp_teleop_start(QueueHandle_t cmd_queue)
+{
+    if (cmd_queue == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = load_key();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 未配置设备密钥 (NVS %s/%s: %s)，UDP遥控不启动",
+                 UDP_TELEOP_NVS_NAMESPACE, UDP_TELEOP_NVS_KEY, esp_err_to_name(ret));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_cmd_queue = cmd_queue;
+    if (xTaskCreate(udp_teleop_task, "udp_teleop", UDP_TELEOP_TASK_STACK_SIZE, NULL,
+                    UDP_TELEOP_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建UDP遥控任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void udp_teleop_mark_applied(const udp_teleop_cmd_t *cmd)
+{
+    if (cmd == NULL) {
+        return;
+    }
+
+    uint32_t apply_us = (uint32_t)(esp_timer_get_time() - cmd->rx_us);
+    __atomic_store_n(&s_pending_can_rx_us, cmd->rx_us, __ATOMIC_RELAXED);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.apply_last_us = apply_us;
+    if (apply_us > s_stats.apply_max_us) {
+        s_stats.apply_max_us = apply_us;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void udp_teleop_mark_can_tx(void)
+{
+    // 每个速度帧都会调用，没有待测命令时只有一次原子读
+    if (__atomic_load_n(&s_pending_can_rx_us, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+    int64_t rx_us = __atomic_exchange_n(&s_pending_can_rx_us, 0, __ATOMIC_RELAXED);
+    if (rx_us == 0) {
+        return;
+    }
+
+    uint32_t can_us = (uint32_t)(esp_timer_get_time() - rx_us);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.can_last_us = can_us;
+    if (can_us > s_stats.can_max_us) {
+        s_stats.can_max_us = can_us;
+    }
+    s_stats.can_samples++;
+    s_can_sum_us += can_us;
+    s_stats.can_avg_us = (uint32_t)(s_can_sum_us / s_stats.can_samples);
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void udp_teleop_mark_deadman(void)
+{
+    stats_inc(&s_stats.deadman_trips);
+}
+
+void udp_teleop_get_stats(udp_teleop_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    int64_t last_us = __atomic_load_n(&s_last_accept_us, __ATOMIC_RELAXED);
+    stats->active = last_us != 0 &&
+                    esp_timer_get_time() - last_us < (int64_t)UDP_TELEOP_DEADMAN_MS * 1000;
+}
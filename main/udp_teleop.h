@@ -0,0 +1,128 @@
+#ifndef UDP_TELEOP_H
+#define UDP_TELEOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 局域网 UDP 低延迟遥控
+ *
+ * 数据包（24 字节，小端），前 4 字节为公共包头：
+ *   0  u16  magic = UDP_TELEOP_MAGIC ("TP")
+ *   2  u8   version = UDP_TELEOP_VERSION
+ *   3  u8   type = UDP_TELEOP_TYPE_*
+ *
+ *   HELLO      发送端 → 设备   4 u32 session（发送端随机），8~15 填 0，
+ *                              16 u8[8] tag = HMAC(key, 前 16 字节)
+ *   CHALLENGE  设备 → 发送端   4 u32 session（回显），8 u8[8] nonce，
+ *                              16 u8[8] tag = HMAC(key, 前 16 字节)
+ *   DRIVE      发送端 → 设备   4 u32 session，8 u32 seq（从 1 起严格递增），
+ *                              12 i8 left，13 i8 right（-100~100），14 u16 填 0，
+ *                              16 u8[8] tag = HMAC(key, 前 16 字节 || nonce)
+ *   HMAC 为 HMAC-SHA256 取前 8 字节
+ *
+ *   - 设备密钥（16~64 字节）从 NVS 读取（命名空间 UDP_TELEOP_NVS_NAMESPACE，blob 键 UDP_TELEOP_NVS_KEY），
+ *     出厂时用 nvs_partition_gen 烧入，每台设备不同；未配置或与 UDP_TELEOP_UNSET_KEY 相同时不启动监听
+ *   - 防重放：nonce 由设备在每个新会话随机生成、只存在内存中，DRIVE 的认证覆盖 nonce，
+ *     重启或换会话后录下的旧包认证失败；会话内 seq 不大于已接受值的包（乱序/重放）丢弃
+ *   - 遥控进行中（UDP_TELEOP_SESSION_IDLE_MS 内有被接受的 DRIVE）不为其他会话发放 nonce
+ *   - 设备重启后没有会话，DRIVE 全部被拒；发送端在收不到 CHALLENGE 或重新连接时应重发 HELLO
+ *   - 通过认证的命令覆盖写入控制任务的输入队列（长度 1，只保留最新值），
+ *     控制任务超过 UDP_TELEOP_DEADMAN_MS 未收到新命令即停车并把控制权交还 SBUS
+ *   - 延迟统计：收包 → 控制任务下发 → 对应速度帧写入 CAN 控制器
+ */
+
+#define UDP_TELEOP_PORT                 4210
+#define UDP_TELEOP_MAGIC                0x5054  // "TP"
+#define UDP_TELEOP_VERSION              2
+#define UDP_TELEOP_TYPE_DRIVE           0
+#define UDP_TELEOP_TYPE_HELLO           1
+#define UDP_TELEOP_TYPE_CHALLENGE       2
+#define UDP_TELEOP_PACKET_SIZE          24
+#define UDP_TELEOP_TAG_SIZE             8
+#define UDP_TELEOP_NONCE_SIZE           8
+#define UDP_TELEOP_NVS_NAMESPACE        "udp_teleop"
+#define UDP_TELEOP_NVS_KEY              "psk"
+#define UDP_TELEOP_KEY_MIN_LEN          16
+#define UDP_TELEOP_KEY_MAX_LEN          64
+#define UDP_TELEOP_UNSET_KEY            "esp32-teleop-psk"  // 早期版本的公开默认值，视为未配置
+#define UDP_TELEOP_MAX_RATE_HZ          100     // 发送端上限；更快的包在输入队列中被合并
+#define UDP_TELEOP_DEADMAN_MS           250     // 超时停车（约 25 个包周期）
+#define UDP_TELEOP_SESSION_IDLE_MS      1000    // 为其他会话发放 nonce 前要求的空闲时间
+#define UDP_TELEOP_TASK_STACK_SIZE      3072
+#define UDP_TELEOP_TASK_PRIORITY        11      // 高于电机控制任务(10)，低于SBUS任务(12)
+
+/**
+ * 写入控制任务输入队列的命令
+ */
+typedef struct {
+    int8_t speed_left;
+    int8_t speed_right;
+    uint32_t seq;
+    int64_t rx_us;                  // 收包时间（esp_timer），用于延迟统计
+} udp_teleop_cmd_t;
+
+/**
+ * 遥控统计
+ */
+typedef struct {
+    bool active;                    // 最近 UDP_TELEOP_DEADMAN_MS 内有通过认证的包
+    uint32_t session;
+    uint32_t last_seq;
+    uint32_t rx_packets;
+    uint32_t accepted;
+    uint32_t bad_format;            // 长度/magic/版本/类型/速度范围不对
+    uint32_t bad_auth;
+    uint32_t out_of_order;          // seq 不大于已接受的 seq
+    uint32_t session_rejected;      // 不属于当前会话的 DRIVE，或遥控进行中其他会话的 HELLO
+    uint32_t session_changes;       // 发放的新 nonce
+    uint32_t challenges;            // 回复的 CHALLENGE
+    uint32_t coalesced;             // 控制任务取走前被新包覆盖
+    uint32_t deadman_trips;
+    uint32_t apply_last_us;         // 收包 → 控制任务下发
+    uint32_t apply_max_us;
+    uint32_t can_last_us;           // 收包 → 速度帧写入 CAN 控制器
+    uint32_t can_avg_us;
+    uint32_t can_max_us;
+    uint32_t can_samples;
+} udp_teleop_stats_t;
+
+/**
+ * 读取设备密钥并创建接收任务（须在 nvs_flash_init 之后调用）
+ * @param cmd_queue 控制任务输入队列（长度 1，元素为 udp_teleop_cmd_t）
+ * @return ESP_ERR_INVALID_STATE 未配置密钥或密钥为公开默认值，不启动监听
+ */
+esp_err_t udp_teleop_start(QueueHandle_t cmd_queue);
+
+/**
+ * 控制任务下发了一条遥控命令（在调用电机接口之后）
+ */
+void udp_teleop_mark_applied(const udp_teleop_cmd_t *cmd);
+
+/**
+ * 速度帧已写入 CAN 控制器（由电机驱动的 CAN 任务调用）
+ */
+void udp_teleop_mark_can_tx(void);
+
+/**
+ * 控制任务因超时停车
+ */
+void udp_teleop_mark_deadman(void);
+
+/**
+ * 获取遥控统计
+ */
+void udp_teleop_get_stats(udp_teleop_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_TELEOP_H */
@@ -5,6 +5,8 @@
 #include "esp_netif.h"
 #include "esp_mac.h"
 #include "nvs_flash.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -25,8 +27,210 @@ static esp_netif_t *s_sta_netif = NULL;
 // 添加连接状态标志，防止重复连接
 static bool s_connecting_in_progress = false;
 
+// 断线重连状态机
+static esp_timer_handle_t s_reconnect_timer = NULL;
+static portMUX_TYPE s_reconnect_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_auto_reconnect = false;       // 手动断开时关闭
+static bool s_reconnect_pending = false;    // 重连定时器已启动
+static uint32_t s_reconnect_attempt = 0;    // 本次断线以来的重连次数
+static bool s_last_attempt_fast = false;
+static int64_t s_link_lost_us = 0;          // 断线时刻（0=未处于断线恢复中）
+
+// 最近一次成功关联的AP（用于快速重连）
+static bool s_cached_ap_valid = false;
+static uint8_t s_cached_bssid[6] = {0};
+static uint8_t s_cached_channel = 0;
+static bool s_config_pinned = false;        // 当前STA配置是否锁定BSSID/信道
+
+static wifi_reconnect_stats_t s_reconnect_stats = {0};
+
+/**
+ * 计算下一次重连延迟：首次立即重连，之后指数退避并叠加随机抖动
+ */
+static uint32_t next_reconnect_delay_ms(uint32_t attempt)
+{
+    if (attempt == 0) {
+        return 0;
+    }
+
+    uint32_t shift = attempt - 1;
+    if (shift > 10) {
+        shift = 10;
+    }
+    uint32_t delay_ms = WIFI_RECONNECT_BASE_MS << shift;
+    if (delay_ms > WIFI_RECONNECT_MAX_MS) {
+        delay_ms = WIFI_RECONNECT_MAX_MS;
+    }
+
+    // 抖动取 [delay/2, delay]，避免多台设备同时重连
+    return delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+}
+
+/**
+ * 安排一次重连（事件处理函数中调用，只启动定时器，不阻塞事件循环）
+ */
+static void schedule_reconnect(void)
+{
+    portENTER_CRITICAL(&s_reconnect_lock);
+    if (!s_auto_reconnect || s_reconnect_pending) {
+        portEXIT_CRITICAL(&s_reconnect_lock);
+        return;
+    }
+    s_reconnect_pending = true;
+    uint32_t delay_ms = next_reconnect_delay_ms(s_reconnect_attempt);
+    portEXIT_CRITICAL(&s_reconnect_lock);
+
+    ESP_LOGI(TAG, "🔄 Reconnect #%lu scheduled in %lu ms",
+             (unsigned long)s_reconnect_attempt + 1, (unsigned long)delay_ms);
+
+    esp_timer_stop(s_reconnect_timer);
+    if (esp_timer_start_once(s_reconnect_timer, (uint64_t)delay_ms * 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to arm reconnect timer");
+        s_reconnect_pending = false;
+    }
+}
+
+/**
+ * 停止后台重连
+ */
+static void cancel_reconnect(void)
+{
+    portENTER_CRITICAL(&s_reconnect_lock);
+    s_reconnect_pending = false;
+    s_reconnect_attempt = 0;
+    s_link_lost_us = 0;
+    portEXIT_CRITICAL(&s_reconnect_lock);
+
+    if (s_reconnect_timer) {
+        esp_timer_stop(s_reconnect_timer);
+    }
+}
+
 /**
- * Wi-Fi事件处理函数
+ * 快速重连锁定缓存的BSSID/信道（跳过扫描），之后恢复全信道扫描以适应AP切换
+ */
+static void apply_reconnect_target(bool fast)
+{
+    if (fast == s_config_pinned) {
+        return;
+    }
+
+    wifi_config_t wifi_config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) != ESP_OK) {
+        return;
+    }
+
+    if (fast) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, s_cached_bssid, sizeof(s_cached_bssid));
+        wifi_config.sta.channel = s_cached_channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        wifi_config.sta.bssid_set = false;
+        wifi_config.sta.channel = 0;
+    }
+
+    if (esp_wifi_set_config(WIFI_IF_STA, &wifi_config) == ESP_OK) {
+        s_config_pinned = fast;
+    }
+}
+
+/**
+ * 重连定时器回调（esp_timer 任务中执行）
+ */
+static void reconnect_timer_callback(void* arg)
+{
+    portENTER_CRITICAL(&s_reconnect_lock);
+    s_reconnect_pending = false;
+    bool proceed = s_auto_reconnect && s_wifi_status.state != WIFI_STATE_CONNECTED;
+    uint32_t attempt = s_reconnect_attempt++;
+    portEXIT_CRITICAL(&s_reconnect_lock);
+
+    if (!proceed) {
+        return;
+    }
+
+    bool fast = s_cached_ap_valid && attempt < WIFI_FAST_RECONNECT_ATTEMPTS;
+    apply_reconnect_target(fast);
+    s_last_attempt_fast = fast;
+
+    s_reconnect_stats.attempts++;
+    s_wifi_status.retry_count = attempt + 1 > UINT8_MAX ? UINT8_MAX : (uint8_t)(attempt + 1);
+    s_wifi_status.state = WIFI_STATE_CONNECTING;
+    s_connecting_in_progress = true;
+
+    ESP_LOGI(TAG, "🔄 Reconnecting to Wi-Fi (attempt %lu%s)",
+             (unsigned long)attempt + 1, fast ? ", cached BSSID/channel" : "");
+
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Retry connection failed: %s", esp_err_to_name(ret));
+        s_connecting_in_progress = false;
+        s_wifi_status.state = WIFI_STATE_DISCONNECTED;
+        schedule_reconnect();
+    }
+}
+
+/**
+ * 记录一次断线恢复耗时
+ */
+static void record_reconnect_time(uint32_t elapsed_ms)
+{
+    static const uint32_t bucket_limits_ms[WIFI_RECONNECT_HIST_BUCKETS - 1] = {
+        250, 500, 1000, 2000, 5000, 10000, 30000
+    };
+
+    int bucket = WIFI_RECONNECT_HIST_BUCKETS - 1;
+    for (int i = 0; i < WIFI_RECONNECT_HIST_BUCKETS - 1; i++) {
+        if (elapsed_ms < bucket_limits_ms[i]) {
+            bucket = i;
+            break;
+        }
+    }
+
+    s_reconnect_stats.histogram[bucket]++;
+    s_reconnect_stats.recoveries++;
+    if (s_last_attempt_fast) {
+        s_reconnect_stats.fast_recoveries++;
+    }
+    s_reconnect_stats.last_ms = elapsed_ms;
+    if (s_reconnect_stats.min_ms == 0 || elapsed_ms < s_reconnect_stats.min_ms) {
+        s_reconnect_stats.min_ms = elapsed_ms;
+    }
+    if (elapsed_ms > s_reconnect_stats.max_ms) {
+        s_reconnect_stats.max_ms = elapsed_ms;
+    }
+}
+
+#if WIFI_STATIC_IP_ENABLE
+/**
+ * 配置静态IP（停止DHCP客户端）
+ */
+static esp_err_t apply_static_ip(void)
+{
+    esp_err_t ret = esp_netif_dhcpc_stop(s_sta_netif);
+    if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        return ret;
+    }
+
+    esp_netif_ip_info_t ip_info = {0};
+    ip_info.ip.addr = esp_ip4addr_aton(WIFI_STATIC_IP);
+    ip_info.gw.addr = esp_ip4addr_aton(WIFI_STATIC_GATEWAY);
+    ip_info.netmask.addr = esp_ip4addr_aton(WIFI_STATIC_NETMASK);
+    ret = esp_netif_set_ip_info(s_sta_netif, &ip_info);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    esp_netif_dns_info_t dns = {0};
+    dns.ip.u_addr.ip4.addr = esp_ip4addr_aton(WIFI_STATIC_DNS);
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    return esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+}
+#endif
+
+/**
+ * Wi-Fi事件处理函数（默认事件循环中执行，不得阻塞）
  */
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                               int32_t event_id, void* event_data)
@@ -34,43 +238,41 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         // 不在这里自动连接，等待显式调用wifi_manager_connect
         ESP_LOGI(TAG, "📡 Wi-Fi station started, ready for connection");
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        // 缓存关联的AP，断线后优先直接重连该AP
+        wifi_event_sta_connected_t* connected = (wifi_event_sta_connected_t*) event_data;
+        memcpy(s_cached_bssid, connected->bssid, sizeof(s_cached_bssid));
+        s_cached_channel = connected->channel;
+        s_cached_ap_valid = true;
+        ESP_LOGD(TAG, "📶 Associated, channel %d", connected->channel);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
         wifi_event_sta_disconnected_t* disconnected = (wifi_event_sta_disconnected_t*) event_data;
         ESP_LOGW(TAG, "🔌 Wi-Fi disconnected, reason: %d", disconnected->reason);
 
+        if (s_wifi_status.state == WIFI_STATE_CONNECTED) {
+            s_reconnect_stats.disconnects++;
+        }
+        if (s_link_lost_us == 0) {
+            s_link_lost_us = esp_timer_get_time();
+        }
         s_wifi_status.state = WIFI_STATE_DISCONNECTED;
         s_connecting_in_progress = false;
 
-        // 只有在重试次数未超限且不是手动断开的情况下才重试
-        if (s_wifi_status.retry_count < WIFI_RETRY_MAX &&
-            disconnected->reason != WIFI_REASON_ASSOC_LEAVE) {
-
-            ESP_LOGI(TAG, "🔄 Retry connecting to Wi-Fi (%d/%d)",
-                    s_wifi_status.retry_count + 1, WIFI_RETRY_MAX);
-
-            // 延迟重连，避免立即重试
-            vTaskDelay(pdMS_TO_TICKS(1000));
-
-            if (!s_connecting_in_progress) {
-                s_connecting_in_progress = true;
-                s_wifi_status.retry_count++;
-                s_wifi_status.state = WIFI_STATE_CONNECTING;
-
-                esp_err_t ret = esp_wifi_connect();
-                if (ret != ESP_OK) {
-                    ESP_LOGE(TAG, "❌ Retry connection failed: %s", esp_err_to_name(ret));
-                    s_connecting_in_progress = false;
-                    if (s_wifi_status.retry_count >= WIFI_RETRY_MAX) {
-                        xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-                        s_wifi_status.state = WIFI_STATE_FAILED;
-                    }
-                }
-            }
-        } else {
+        // 手动断开不重连
+        if (!s_auto_reconnect || disconnected->reason == WIFI_REASON_ASSOC_LEAVE) {
+            return;
+        }
+
+        // 连续失败达到上限时通知等待中的连接调用，后台继续退避重连
+        if (s_reconnect_attempt >= WIFI_RETRY_MAX) {
             xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
             s_wifi_status.state = WIFI_STATE_FAILED;
-            ESP_LOGE(TAG, "❌ Failed to connect to Wi-Fi after %d retries", WIFI_RETRY_MAX);
+            if (s_reconnect_attempt == WIFI_RETRY_MAX) {
+                ESP_LOGE(TAG, "❌ Failed to connect to Wi-Fi after %d retries, backing off", WIFI_RETRY_MAX);
+            }
         }
+
+        schedule_reconnect();
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         snprintf(s_wifi_status.ip_address, sizeof(s_wifi_status.ip_address),
@@ -79,6 +281,16 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         s_wifi_status.retry_count = 0;
         s_wifi_status.connect_time = xTaskGetTickCount();
         s_connecting_in_progress = false;
+
+        if (s_link_lost_us != 0) {
+            uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - s_link_lost_us) / 1000);
+            record_reconnect_time(elapsed_ms);
+            ESP_LOGI(TAG, "⚡ Wi-Fi link restored in %lu ms (%lu attempts%s)",
+                     (unsigned long)elapsed_ms, (unsigned long)s_reconnect_attempt,
+                     s_last_attempt_fast ? ", cached BSSID/channel" : "");
+        }
+        cancel_reconnect();
+
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
         ESP_LOGI(TAG, "✅ Connected to Wi-Fi, IP: %s", s_wifi_status.ip_address);
     }
@@ -143,6 +355,27 @@ esp_err_t wifi_manager_init(void)
         return ESP_FAIL;
     }
 
+#if WIFI_STATIC_IP_ENABLE
+    ret = apply_static_ip();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Failed to apply static IP, falling back to DHCP: %s", esp_err_to_name(ret));
+        esp_netif_dhcpc_start(s_sta_netif);
+    } else {
+        ESP_LOGI(TAG, "📍 Static IP: %s", WIFI_STATIC_IP);
+    }
+#endif
+
+    // 创建重连定时器
+    const esp_timer_create_args_t reconnect_timer_args = {
+        .callback = reconnect_timer_callback,
+        .name = "wifi_reconnect",
+    };
+    ret = esp_timer_create(&reconnect_timer_args, &s_reconnect_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to create reconnect timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
     // 初始化Wi-Fi
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ret = esp_wifi_init(&cfg);
@@ -235,6 +468,10 @@ esp_err_t wifi_manager_connect(const char* ssid, const char* password)
 
     ESP_LOGI(TAG, "🔗 Connecting to Wi-Fi: %s", ssid);
 
+    // 接管后台重连
+    s_auto_reconnect = false;
+    cancel_reconnect();
+
     // 如果已经连接到相同的网络，先断开
     if (s_wifi_status.state == WIFI_STATE_CONNECTED) {
         ESP_LOGI(TAG, "🔌 Disconnecting from current network...");
@@ -259,6 +496,8 @@ esp_err_t wifi_manager_connect(const char* ssid, const char* password)
         ESP_LOGE(TAG, "❌ Failed to set Wi-Fi config: %s", esp_err_to_name(ret));
         return ret;
     }
+    s_config_pinned = false;
+    s_cached_ap_valid = false;
 
     // 等待配置生效
     vTaskDelay(pdMS_TO_TICKS(100));
@@ -267,6 +506,7 @@ esp_err_t wifi_manager_connect(const char* ssid, const char* password)
     s_wifi_status.state = WIFI_STATE_CONNECTING;
     s_wifi_status.retry_count = 0;
     s_connecting_in_progress = true;
+    s_auto_reconnect = true;
     xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
 
     // 开始连接
@@ -292,14 +532,15 @@ esp_err_t wifi_manager_connect(const char* ssid, const char* password)
         ESP_LOGI(TAG, "📍 IP Address: %s", s_wifi_status.ip_address);
         return ESP_OK;
     } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGE(TAG, "❌ Failed to connect to Wi-Fi: %s", ssid);
-        s_connecting_in_progress = false;
+        ESP_LOGE(TAG, "❌ Failed to connect to Wi-Fi: %s (retrying in background)", ssid);
         return ESP_FAIL;
     } else {
         ESP_LOGE(TAG, "⏰ Wi-Fi connection timeout after %d ms", WIFI_CONNECT_TIMEOUT_MS);
         s_wifi_status.state = WIFI_STATE_FAILED;
         s_connecting_in_progress = false;
         // 停止连接尝试
+        s_auto_reconnect = false;
+        cancel_reconnect();
         esp_wifi_disconnect();
         return ESP_ERR_TIMEOUT;
     }
@@ -312,8 +553,10 @@ esp_err_t wifi_manager_disconnect(void)
 {
     ESP_LOGI(TAG, "🔌 Disconnecting from Wi-Fi...");
 
-    // 重置连接状态标志
+    // 重置连接状态标志，停止后台重连
     s_connecting_in_progress = false;
+    s_auto_reconnect = false;
+    cancel_reconnect();
 
     esp_err_t ret = esp_wifi_disconnect();
     if (ret == ESP_OK) {
@@ -339,7 +582,9 @@ esp_err_t wifi_manager_reset(void)
 {
     ESP_LOGI(TAG, "🔄 Resetting Wi-Fi manager state...");
 
-    // 先断开连接
+    // 停止后台重连并断开连接
+    s_auto_reconnect = false;
+    cancel_reconnect();
     esp_wifi_disconnect();
 
     // 重置所有状态
@@ -407,6 +652,24 @@ bool wifi_manager_is_connected(void)
     return true;
 }
 
+/**
+ * 后台重连是否进行中
+ */
+bool wifi_manager_is_reconnecting(void)
+{
+    return s_auto_reconnect && (s_reconnect_pending || s_connecting_in_progress);
+}
+
+/**
+ * 获取重连统计
+ */
+void wifi_manager_get_reconnect_stats(wifi_reconnect_stats_t* stats)
+{
+    if (stats) {
+        *stats = s_reconnect_stats;
+    }
+}
+
 /**
  * 获取IP地址字符串
  */
@@ -10,9 +10,22 @@
 // Wi-Fi配置参数
 #define WIFI_SSID_MAX_LEN       32
 #define WIFI_PASSWORD_MAX_LEN   64
-#define WIFI_RETRY_MAX          5
+#define WIFI_RETRY_MAX          5      // 连续失败次数达到后上报连接失败（后台重连不停止）
 #define WIFI_CONNECT_TIMEOUT_MS 15000  // 增加到15秒超时
 
+// 断线重连状态机（esp_timer 驱动，不阻塞默认事件循环）
+#define WIFI_RECONNECT_BASE_MS          250     // 退避基准间隔
+#define WIFI_RECONNECT_MAX_MS           30000   // 退避上限
+#define WIFI_FAST_RECONNECT_ATTEMPTS    2       // 前N次重连锁定缓存的BSSID/信道，跳过全信道扫描
+#define WIFI_RECONNECT_HIST_BUCKETS     8       // 重连耗时直方图桶数
+
+// 静态IP（跳过DHCP，缩短重连时间；0=使用DHCP）
+#define WIFI_STATIC_IP_ENABLE   0
+#define WIFI_STATIC_IP          "192.168.1.200"
+#define WIFI_STATIC_GATEWAY     "192.168.1.1"
+#define WIFI_STATIC_NETMASK     "255.255.255.0"
+#define WIFI_STATIC_DNS         "192.168.1.1"
+
 // Wi-Fi调试配置
 #define WIFI_DEBUG_ENABLED      1
 
@@ -41,6 +54,19 @@ typedef struct {
     uint32_t connect_time;
 } wifi_status_t;
 
+// 重连统计（耗时从断线到重新获得IP）
+typedef struct {
+    uint32_t disconnects;           // 已连接状态下的断线次数
+    uint32_t attempts;              // 发起的重连次数
+    uint32_t recoveries;            // 成功恢复次数
+    uint32_t fast_recoveries;       // 锁定BSSID/信道的快速重连恢复次数
+    uint32_t last_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    // 耗时分布：<250ms, <500ms, <1s, <2s, <5s, <10s, <30s, >=30s
+    uint32_t histogram[WIFI_RECONNECT_HIST_BUCKETS];
+} wifi_reconnect_stats_t;
+
 /**
  * 初始化Wi-Fi管理器
  * @return ESP_OK=成功
@@ -74,6 +100,18 @@ esp_err_t wifi_manager_get_status(wifi_status_t* status);
  */
 bool wifi_manager_is_connected(void);
 
+/**
+ * 后台重连是否进行中（断线后由状态机自动重连）
+ * @return true=正在等待或执行重连
+ */
+bool wifi_manager_is_reconnecting(void);
+
+/**
+ * 获取重连统计
+ * @param stats 输出统计
+ */
+void wifi_manager_get_reconnect_stats(wifi_reconnect_stats_t* stats);
+
 /**
  * 获取IP地址字符串
  * @return IP地址字符串指针
@@ -3,6 +3,9 @@ import { Card, Badge, Spinner, Alert, ProgressBar, Button, Form } from 'react-bo
 import { DeviceStatus as DeviceStatusType, deviceManagementAPI } from '../services/api'
 import { useDeviceAPI } from '../contexts/DeviceContext'
 
+// 实时推送中断后回退到轮询，每隔该时间重新尝试推送
+const TELEMETRY_STREAM_RETRY_MS = 30000
+
 const DeviceStatus: React.FC = () => {
   const [deviceStatus, setDeviceStatus] = useState<DeviceStatusType | null>(null)
   const [loading, setLoading] = useState(true)
@@ -41,9 +44,47 @@ const DeviceStatus: React.FC = () => {
       fetchDeviceStatus()
 
       if (autoRefresh) {
-        // 每2秒刷新一次状态
-        const interval = setInterval(() => fetchDeviceStatus(), 2000)
-        return () => clearInterval(interval)
+        // 优先使用设备实时推送；设备不支持或连接中断时回退到每2秒轮询，并定期重试推送
+        let interval: ReturnType<typeof setInterval> | null = null
+        let retryTimer: ReturnType<typeof setTimeout> | null = null
+        let closeStream = () => {}
+        let cancelled = false
+
+        const openStream = () => {
+          retryTimer = null
+          closeStream = deviceManagementAPI.openTelemetryStream(
+            selectedDevice.ip,
+            10,
+            (frame) => {
+              if (interval) {
+                clearInterval(interval)
+                interval = null
+              }
+              setDeviceStatus(prev => (prev ? { ...prev, ...frame } : prev))
+            },
+            () => {
+              if (cancelled) {
+                return
+              }
+              if (!interval) {
+                interval = setInterval(() => fetchDeviceStatus(), 2000)
+              }
+              retryTimer = setTimeout(openStream, TELEMETRY_STREAM_RETRY_MS)
+            }
+          )
+        }
+        openStream()
+
+        return () => {
+          cancelled = true
+          closeStream()
+          if (interval) {
+            clearInterval(interval)
+          }
+          if (retryTimer) {
+            clearTimeout(retryTimer)
+          }
+        }
       }
     } else {
       setDeviceStatus(null)
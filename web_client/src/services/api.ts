@@ -100,6 +100,32 @@ export interface DeviceStatus {
   can_rx_count: number
 }
 
+// 实时遥测推送帧（/api/device/stream），字段名与 DeviceStatus 一致
+export interface TelemetryFrame extends Pick<DeviceStatus,
+  'sbus_connected' | 'sbus_channels' | 'last_sbus_time' | 'motor_left_speed' | 'motor_right_speed' |
+  'last_cmd_time' | 'can_connected'>, Partial<Pick<DeviceStatus, 'can_tx_count' | 'can_rx_count'>> {
+  seq: number
+  uptime_ms: number
+  state_version: number | null   // 设备状态快照版本（低频字段），null=尚未发布
+  state_age_ms?: number
+  driver_healthy: boolean
+  track_speed_permille?: number
+  can_bus: {
+    load_percent: number
+    tx_fps: number
+    rx_fps: number
+    tec: number
+    rec: number
+    bus_errors: number
+  } | null
+  payout: {
+    online: boolean
+    target_pwm: number
+    tension_raw?: number
+    drums: { online: boolean; pwm: number; speed: number; fault: number }[]
+  } | null
+}
+
 
 
 export interface WiFiStatus {
@@ -491,6 +517,28 @@ export const deviceManagementAPI = {
     throw new Error(response.data.message || 'Failed to get device status')
   },
 
+  // 订阅指定设备的实时遥测（SSE），返回取消订阅函数；连接失败或中断时调用 onError
+  openTelemetryStream: (
+    ip: string,
+    hz: number,
+    onFrame: (frame: TelemetryFrame) => void,
+    onError: () => void
+  ): (() => void) => {
+    const source = new EventSource(`http://${ip}/api/device/stream?hz=${hz}`)
+    source.onmessage = (event) => {
+      try {
+        onFrame(JSON.parse(event.data) as TelemetryFrame)
+      } catch (err) {
+        console.warn('Invalid telemetry frame:', err)
+      }
+    }
+    source.onerror = () => {
+      source.close()
+      onError()
+    }
+    return () => source.close()
+  },
+
   // 获取指定设备的运行时间（轻量级API）
   getDeviceUptime: async (ip: string): Promise<DeviceUptime> => {
     const deviceApi = createApiInstance(ip)